@@ -107,6 +107,8 @@ typedef void (*PFN_rgPrint)(const char *pMessage, void *pUserData);
 typedef void (*PFN_rgOpenFile)(const char *pFilePath, void *pUserData, const void **ppOutData, uint32_t *pOutDataSize, void **ppOutFileUserHandle);
 typedef void (*PFN_rgCloseFile)(void *pFileUserHandle, void *pUserData);
 typedef RgBool32 (*PFN_rgIsLightVisibleFromSector)(uint32_t sectorID, void *pUserData);
+// pInOutView points to 16 floats of a column major view matrix.
+typedef void (*PFN_rgLateLatchView)(float *pInOutView, void *pUserData);
 
 typedef struct RgWin32SurfaceCreateInfo RgWin32SurfaceCreateInfo;
 typedef struct RgMetalSurfaceCreateInfo RgMetalSurfaceCreateInfo;
@@ -153,6 +155,16 @@ typedef struct RgXlibSurfaceCreateInfo
 } RgXlibSurfaceCreateInfo;
 #endif // RG_USE_SURFACE_XLIB
 
+typedef enum RgPresentMode
+{
+    // FIFO_RELAXED, if vsync is requested, MAILBOX otherwise.
+    RG_PRESENT_MODE_DEFAULT,
+    RG_PRESENT_MODE_IMMEDIATE,
+    RG_PRESENT_MODE_MAILBOX,
+    RG_PRESENT_MODE_FIFO,
+    RG_PRESENT_MODE_FIFO_RELAXED,
+} RgPresentMode;
+
 typedef struct RgInstanceCreateInfo
 {
     // Application name.
@@ -207,9 +219,14 @@ typedef struct RgInstanceCreateInfo
 
     // Size of a cubemap side to render rasterized sky in.
     uint32_t                    rasterizedSkyCubemapSize;  
+    // Only cubemap faces affected by changed sky geometry are redrawn.
+    // If not 0, at most this amount of faces is redrawn per frame, and the rest
+    // of the changed faces are redrawn in the next frames. 0 - no limit.
+    uint32_t                    rasterizedSkyCubemapFacesPerFrame;
 
     // Max amount of textures to be used during the execution.
-    // The value is clamped to [1024..4096]
+    // The value is clamped to [1024..4096]. If the device supports partially bound
+    // descriptors, the upper bound is 65536, or less if the device limits are lower.
     uint32_t                    maxTextureCount;
     // If true, 'filter' in RgStaticMaterialCreateInfo, RgDynamicMaterialCreateInfo, RgCubemapCreateInfo
     // will set only magnification filter.
@@ -231,6 +248,47 @@ typedef struct RgInstanceCreateInfo
     RgBool32                    overridenAlbedoAlphaTextureIsSRGB;
     RgBool32                    overridenRoughnessMetallicEmissionTextureIsSRGB;
     RgBool32                    overridenNormalTextureIsSRGB;
+    // If true, the contents of pOverridenTexturesFolderPath are indexed once, at the instance creation,
+    // and overriding textures are loaded only if they are in the index. So there are no
+    // failing file opens for the materials that are not overriden.
+    // Call rgRefreshOverridenTexturesIndex, if the folder contents were changed.
+    RgBool32                    overridenTexturesFolderIndexEnable;
+    // Optional. If not null, the index is read from this text file instead of scanning the folder.
+    // Each line is a file path relative to pOverridenTexturesFolderPath.
+    // The file is opened with pfnOpenFile, if it's set.
+    const char                  *pOverridenTexturesIndexManifestPath;
+    // Optional. Path to a texture pack created by Tools/CreateTexturePack.py from
+    // the contents of pOverridenTexturesFolderPath. Textures are looked up in the pack first,
+    // and the files in the folder are used only if the pack doesn't contain them.
+    // The pack is memory-mapped from the disk directly, pfnOpenFile is not used for it.
+    const char                  *pOverridenTexturesPackPath;
+    // If true, overriding textures with pregenerated mip levels are loaded progressively:
+    // on a material creation, only the mip tail is uploaded, and the higher mip levels
+    // are uploaded over the next frames, if the material is in use.
+    // If textureStreamingBudgetInMB is exceeded, the top mip levels of the least recently
+    // used textures are evicted. Statistics can be retrieved with rgGetTextureStreamingStats.
+    RgBool32                    textureStreamingEnable;
+    // Memory budget for the streamed textures. If 0, then 1024 MB will be used.
+    uint32_t                    textureStreamingBudgetInMB;
+    // Max of width and height of the largest mip level that is uploaded on a material creation.
+    // If 0, then 64 will be used.
+    uint32_t                    textureStreamingMipTailSize;
+    // If true, static material textures with identical contents (pixel data, format,
+    // size and mip levels) and sampler are uploaded only once, and share a descriptor slot.
+    // The contents are hashed on each material creation.
+    // Statistics can be retrieved with rgGetTextureDeduplicationStats.
+    RgBool32                    textureDeduplicationEnable;
+    // If true, static material textures that are provided only as raw RGBA8 data
+    // (i.e. there's no overriding file) are compressed on CPU to BC1 (opaque) or BC3 (with alpha).
+    // Mip levels for them are generated on CPU. Normal textures are not compressed.
+    RgBool32                    textureCompressionEnable;
+    // Count of worker threads for CPU texture processing: compression and, regardless of
+    // textureCompressionEnable, generation of mip levels for formats that can't be blitted.
+    // If 0, the count is chosen from the hardware concurrency.
+    uint32_t                    textureCompressionThreadCount;
+    // Folder to store compressed textures in, to skip encoding on next runs.
+    // The folder must exist. If null, the disk cache is disabled.
+    const char                  *pTextureCompressionCachePath;
 
     // Path to normal texture path. Ignores pOverridenTexturesFolderPath and pOverridenNormalTexturePostfix
     const char                  *pWaterNormalTexturePath;
@@ -253,6 +311,22 @@ typedef struct RgInstanceCreateInfo
     // screen space coords and NDC depth.
     RgBool32                    lensFlarePointToCheckIsInScreenSpace;
 
+    // If true, visible decals are binned into screen tiles and applied in one compute pass,
+    // instead of rasterizing a box for each decal. Preferable for many small overlapping decals.
+    RgBool32                    decalsTiled;
+
+    // Present modes to use, depending on RgStartFrameInfo::requestVSync.
+    // If a mode is not supported by the surface, the closest one is chosen,
+    // with FIFO as the last resort.
+    RgPresentMode               presentModeVsync;
+    RgPresentMode               presentModeNoVsync;
+    // Minimal amount of swapchain images. If 0, 3 is used.
+    // Clamped by the surface capabilities.
+    uint32_t                    swapchainMinImageCount;
+    // If true, the swapchain is recreated on a separate thread, when the surface is resized.
+    // Until it's done, frames are rendered but not presented.
+    RgBool32                    swapchainRecreateAsync;
+
 } RgInstanceCreateInfo;
 
 RGAPI RgResult RGCONV rgCreateInstance(
@@ -571,6 +645,14 @@ typedef struct RgExtent3D
     uint32_t    depth;
 } RgExtent3D;
 
+typedef struct RgRect2D
+{
+    int32_t     x;
+    int32_t     y;
+    uint32_t    width;
+    uint32_t    height;
+} RgRect2D;
+
 // Struct is used to transform from NDC to window coordinates.
 // x, y, width, height are specified in pixels. (x,y) defines top-left corner.
 typedef struct RgViewport
@@ -611,12 +693,33 @@ typedef struct RgLensFlareUploadInfo
     RgMaterial                              material;
     // Format is defined by 'lensFlarePointToCheckIsInScreenSpace'
     RgFloat3D                               pointToCheck;
+    // If true, the lens flare is a part of the static scene: it must be uploaded
+    // only between rgStartNewScene and rgSubmitStaticGeometries, and it will be
+    // drawn (if 'pointToCheck' is not hidden) in each frame until the next rgStartNewScene call.
+    // Its geometry is copied to the GPU only once.
+    RgBool32                                isStatic;
+    // Identifies a static lens flare for rgUpdateLensFlareIntensity. Ignored for non-static.
+    uint64_t                                uniqueID;
 } RgLensFlareUploadInfo;
 
 RGAPI RgResult RGCONV rgUploadLensFlare(
     RgInstance                              rgInstance,
     const RgLensFlareUploadInfo             *pUploadInfo);
 
+typedef struct RgUpdateLensFlareIntensityInfo
+{
+    uint64_t                                staticUniqueID;
+    // Multiplier for the RGB of vertex colors, 1.0 after the upload.
+    // If 0.0, the lens flare is not drawn.
+    float                                   intensity;
+} RgUpdateLensFlareIntensityInfo;
+
+// Change the intensity of a static lens flare without uploading its geometry again.
+// Only the changed values are copied to the GPU.
+RGAPI RgResult RGCONV rgUpdateLensFlareIntensity(
+    RgInstance                              rgInstance,
+    const RgUpdateLensFlareIntensityInfo    *pUpdateInfo);
+
 
 
 typedef struct RgDecalUploadInfo
@@ -652,6 +755,8 @@ typedef struct RgSphericalLightUploadInfo
     float           radius;
     // There will be no light after this distance.
     float           falloffDistance;
+    // Look notes in RgPolygonalLightUploadInfo::isStatic
+    RgBool32        isStatic;
 } RgSphericalLightUploadInfo;
 
 typedef struct RgPolygonalLightUploadInfo
@@ -670,6 +775,13 @@ typedef struct RgPolygonalLightUploadInfo
     PFN_rgIsLightVisibleFromSector  pfnIsLightVisibleFromSector;
     // Is passed to pfnIsLightVisibleFromSector.
     void                            *pUserDataForPfn;
+    // If true, the light is a part of the static scene: it must be uploaded
+    // only between rgStartNewScene and rgSubmitStaticGeometries, and it will be
+    // visible in each frame until the next rgStartNewScene call.
+    // Static light sector lists are built at the upload time, so
+    // rgSetPotentialVisibility should be called before uploading static lights.
+    // 'uniqueID' is ignored for static lights.
+    RgBool32                        isStatic;
 } RgPolygonalLightUploadInfo;
 
 // Only one spotlight is available in a scene.
@@ -792,6 +904,11 @@ typedef struct RgDynamicMaterialUpdateInfo
 {
     RgMaterial              dynamicMaterial;
     RgTextureSet            textures;
+    // If not 0, only these regions of the textures are updated, and only their
+    // footprints in mip levels are regenerated. Each pData must still point to
+    // the whole image, but only the regions are read from it.
+    uint32_t                dirtyRectCount;
+    const RgRect2D          *pDirtyRects;
 } RgDynamicMaterialUpdateInfo;
 
 typedef struct RgAnimatedMaterialCreateInfo
@@ -805,6 +922,16 @@ RGAPI RgResult RGCONV rgCreateStaticMaterial(
     const RgStaticMaterialCreateInfo    *pCreateInfo,
     RgMaterial                          *pResult);
 
+// Create 'count' static materials at once. It's preferable to rgCreateStaticMaterial
+// when loading many materials, as their upload is recorded in one batch.
+// If an error occurs, pResults contains materials that were created before it,
+// and RG_NO_MATERIAL for others.
+RGAPI RgResult RGCONV rgCreateStaticMaterials(
+    RgInstance                          rgInstance,
+    uint32_t                            count,
+    const RgStaticMaterialCreateInfo    *pCreateInfos,
+    RgMaterial                          *pResults);
+
 RGAPI RgResult RGCONV rgCreateAnimatedMaterial(
     RgInstance                          rgInstance,
     const RgAnimatedMaterialCreateInfo  *pCreateInfo,
@@ -883,6 +1010,94 @@ RGAPI RgResult RGCONV rgDestroyCubemap(
     RgInstance                          rgInstance,
     RgCubemap                           cubemap);
 
+// Rebuild the index of overriding textures, if the contents of the folder were changed.
+// Overriden textures folder index must be enabled in RgInstanceCreateInfo.
+RGAPI RgResult RGCONV rgRefreshOverridenTexturesIndex(
+    RgInstance                          rgInstance);
+
+typedef struct RgTextureStreamingStats
+{
+    uint32_t    streamedTextureCount;
+    // Textures that have all of their mip levels in the memory.
+    uint32_t    fullyResidentTextureCount;
+    // Textures that are in use, but not all of their mip levels are uploaded yet.
+    uint32_t    pendingTextureCount;
+    uint64_t    residentBytes;
+    // Memory that would be required to have all streamed textures fully resident.
+    uint64_t    fullResidencyBytes;
+    uint64_t    budgetBytes;
+    uint64_t    lastFrameStreamedInBytes;
+    uint64_t    lastFrameEvictedBytes;
+} RgTextureStreamingStats;
+
+// Texture streaming must be enabled in RgInstanceCreateInfo.
+RGAPI RgResult RGCONV rgGetTextureStreamingStats(
+    RgInstance                          rgInstance,
+    RgTextureStreamingStats             *pOutStats);
+
+typedef struct RgTextureDeduplicationStats
+{
+    // Uploaded textures that are tracked for sharing.
+    uint32_t    uniqueTextureCount;
+    // Textures that are referenced by more than one material.
+    uint32_t    sharedTextureCount;
+    // Amount of material textures that reuse an already uploaded one.
+    uint32_t    reusedReferenceCount;
+    uint64_t    savedBytes;
+    // Saved bytes by mip level, 0 is the largest one.
+    // Levels that are out of bounds are added to the last element.
+    uint64_t    savedBytesPerMipLevel[16];
+} RgTextureDeduplicationStats;
+
+// Texture deduplication must be enabled in RgInstanceCreateInfo.
+RGAPI RgResult RGCONV rgGetTextureDeduplicationStats(
+    RgInstance                          rgInstance,
+    RgTextureDeduplicationStats         *pOutStats);
+
+typedef struct RgTextureSlotStats
+{
+    // Size of the texture array, i.e. clamped maxTextureCount.
+    uint32_t    slotCount;
+    uint32_t    usedSlotCount;
+    // Freed slots that can't be reused until the frames in flight are finished.
+    uint32_t    pendingSlotCount;
+    uint32_t    peakUsedSlotCount;
+    // Slots with greater or equal indices were never used.
+    uint32_t    usedRangeEnd;
+    // Amount of textures that couldn't be created, as all slots were in use.
+    uint32_t    failedAllocationCount;
+} RgTextureSlotStats;
+
+RGAPI RgResult RGCONV rgGetTextureSlotStats(
+    RgInstance                          rgInstance,
+    RgTextureSlotStats                  *pOutStats);
+
+typedef struct RgFrameLatencyStats
+{
+    // True, if the last started frame was in the low latency mode.
+    RgBool32    isLowLatencyActive;
+    // Time from the submission of the frame command buffers to the completion
+    // of their execution, after which the frame can be presented. In milliseconds.
+    // Negative, if there is no measured frame yet.
+    float       lastLatency;
+    // Exponential moving average of the latency.
+    float       averageLatency;
+    // Time that CPU spent waiting for the frames in flight during the last frame.
+    float       lastCpuWaitTime;
+    uint32_t    measuredFrameCount;
+    // GPU time of the last completed frame, measured with timestamp queries.
+    // In milliseconds. Negative, if there is no measured frame yet.
+    float       lastGpuFrameTime;
+    // GPU time of the uploads of the last rgCreateStaticMaterials batch, that was called
+    // inside of a frame; only the first batch in a frame is measured.
+    // In milliseconds. Negative, if there is no measured batch yet.
+    float       lastStaticMaterialBatchGpuTime;
+} RgFrameLatencyStats;
+
+RGAPI RgResult RGCONV rgGetFrameLatencyStats(
+    RgInstance                          rgInstance,
+    RgFrameLatencyStats                 *pOutStats);
+
 
 
 typedef struct RgStartFrameInfo
@@ -893,6 +1108,12 @@ typedef struct RgStartFrameInfo
     // Reuse sky geometry from the previous frames.
     // The rasterized skybox cubemap won't be rerendered.
     RgBool32        requestRasterizedSkyGeometryReuse;
+    // Reduce the latency between the input and the presentation:
+    // the swapchain image is acquired after the frame is submitted,
+    // and the submission is delayed until the previous frame is finished,
+    // so the GPU queue never holds more than one frame.
+    // Also, allows late latching of the camera, see RgDrawFrameInfo::pfnLateLatchView.
+    RgBool32        requestLowLatency;
 } RgStartFrameInfo;
 
 RGAPI RgResult RGCONV rgStartFrame(
@@ -950,6 +1171,29 @@ typedef struct RgDrawFrameDebugParams
     RgBool32    showSectors;
 } RgDrawFrameDebugParams;
 
+typedef enum RgDenoiserQuality
+{
+    // 4 a-trous iterations, everything is denoised in full resolution.
+    RG_DENOISER_QUALITY_HIGH,
+    // 3 a-trous iterations, indirect illumination is denoised in half resolution.
+    RG_DENOISER_QUALITY_MEDIUM,
+    // 2 a-trous iterations, indirect illumination is denoised in half resolution,
+    // gradient estimation is skipped while the camera is static.
+    RG_DENOISER_QUALITY_LOW,
+    // Choose one of the above, according to the measured GPU frame time.
+    RG_DENOISER_QUALITY_AUTO,
+} RgDenoiserQuality;
+
+typedef struct RgDrawFrameDenoiserParams
+{
+    // Default: RG_DENOISER_QUALITY_HIGH
+    RgDenoiserQuality   quality;
+    // Target GPU frame time in milliseconds, if quality is RG_DENOISER_QUALITY_AUTO.
+    // If <= 0, then default value is used.
+    // Default: 16.6
+    float               autoTargetGpuFrameTime;
+} RgDrawFrameDenoiserParams;
+
 typedef struct RgDrawFrameShadowParams
 {
     // Shadow rays are cast, if illumination bounce index is in [0, maxBounceShadows).
@@ -976,6 +1220,11 @@ typedef struct RgDrawFrameBloomParams
     // -1.0 is zero saturation, 0.0 is default
     float       bloomEmissionSaturationBias;
     float       bloomSkyMultiplier;
+    // If true, all bloom mips are downsampled in one dispatch.
+    // Mips after the first one are filtered with a box filter, instead of 13-tap one.
+    RgBool32    singlePassDownsample;
+    // If true, the last upsample step is done while applying bloom to the final image.
+    RgBool32    fuseUpsampleWithApply;
 } RgDrawFrameBloomParams;
 
 typedef struct RgPostEffectWipe
@@ -1046,6 +1295,12 @@ typedef struct RgDrawFramePostEffectsParams
     const RgPostEffectDistortedSides        *pDistortedSides;
     const RgPostEffectColorTint             *pColorTint;
     const RgPostEffectCRT                   *pCRT;
+    // If true, color tint, inverse black-and-white, hue shift, chromatic aberration,
+    // distorted sides and radial blur are evaluated in as few compute dispatches as possible,
+    // instead of one dispatch per effect. The result is the same, except near the frame borders:
+    // where a stage samples outside of the frame, the chain reads zero, while separate dispatches
+    // would read the contents of an intermediate image there.
+    RgBool32                                fuseSimpleEffects;
 } RgDrawFramePostEffectsParams;
 
 typedef enum RgMediaType
@@ -1124,6 +1379,19 @@ typedef struct RgDrawFrameRenderResolutionParams
     RgRenderResolutionMode      resolutionMode;
     // Used, if resolutionMode is CUSTOM
     RgExtent2D                  renderSize;
+    // If true, render size is changed each frame to achieve the target GPU frame time.
+    // The size defined by resolutionMode (or renderSize) is scaled by a value
+    // in [dynamicMinScale, dynamicMaxScale]. Framebuffers are allocated once
+    // for the maximum scale, so changing the scale doesn't cause reallocation.
+    RgBool32                    dynamicResolution;
+    // Target GPU frame time in milliseconds. If <= 0, then default value is used.
+    // Default: 16.6
+    float                       dynamicTargetGpuFrameTime;
+    // Bounds for the render size scale, must be in (0, 1].
+    // If <= 0, then default values are used.
+    // Default: 0.5 and 1.0
+    float                       dynamicMinScale;
+    float                       dynamicMaxScale;
 } RgDrawFrameRenderResolutionParams;
 
 typedef struct RgDrawFrameLensFlareParams
@@ -1141,6 +1409,18 @@ typedef enum RgDrawFrameRayCullFlagBits
 } RgDrawFrameRayCullFlagBits;
 typedef RgFlags RgDrawFrameRayCullFlags;
 
+typedef enum RgIndirectIlluminationRate
+{
+    // Indirect diffuse illumination is traced for each pixel.
+    RG_INDIRECT_ILLUMINATION_RATE_FULL,
+    // Half of the pixels per frame in a checkerboard pattern, alternating each frame.
+    RG_INDIRECT_ILLUMINATION_RATE_HALF_CHECKERBOARD,
+    // One pixel in each 2x2 block per frame, all 4 are traced in 4 frames.
+    RG_INDIRECT_ILLUMINATION_RATE_QUARTER_INTERLEAVED,
+    // Half of the pixels per frame, selected using blue noise.
+    RG_INDIRECT_ILLUMINATION_RATE_HALF_BLUE_NOISE,
+} RgIndirectIlluminationRate;
+
 typedef struct RgDrawFrameInfo
 {
     // View and projection matrices are column major.
@@ -1162,6 +1442,22 @@ typedef struct RgDrawFrameInfo
     double                  currentTime;
     RgBool32                disableEyeAdaptation;
     RgBool32                useSqrtRoughnessForIndirect;
+    // Trace indirect diffuse illumination only for a subset of pixels each frame,
+    // missing samples are reconstructed by the temporal accumulation of the denoiser.
+    // Specular bounces are always traced.
+    RgIndirectIlluminationRate indirectIlluminationRate;
+    // Cull lens flares on a separate compute queue, overlapping the illumination tracing.
+    // Ignored, if the device doesn't expose a second queue in the graphics family.
+    RgBool32                enableAsyncCompute;
+    // Low latency mode only. If not null, it's called right before the submission
+    // to override the view matrix with the most recent one. Geometry that was uploaded
+    // with rgUploadRasterizedGeometry still uses the 'view' matrix.
+    // Decal and lens flare culling is done on CPU while recording the frame,
+    // so it also uses the 'view' matrix: the view passed to the callback shouldn't
+    // differ from 'view' a lot, otherwise decals and lens flares may pop at the screen edges.
+    // Ignored, if async compute was used in the frame.
+    PFN_rgLateLatchView     pfnLateLatchView;
+    void                    *pLateLatchUserData;
 
     // Set to null, to use default values.
     const RgDrawFrameRenderResolutionParams     *pRenderResolutionParams;
@@ -1173,6 +1469,7 @@ typedef struct RgDrawFrameInfo
     const RgDrawFrameTexturesParams             *pTexturesParams;
     const RgDrawFrameLensFlareParams            *pLensFlareParams;
     const RgDrawFrameDebugParams                *pDebugParams;
+    const RgDrawFrameDenoiserParams             *pDenoiserParams;
     const RgDrawFramePostEffectsParams          postEffectParams;
 
 } RgDrawFrameInfo;
@@ -152,7 +152,7 @@ void ASManager::CreateDescriptors()
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
 
     {
-        std::array<VkDescriptorSetLayoutBinding, 9> bindings{};
+        std::array<VkDescriptorSetLayoutBinding, 10> bindings{};
 
         // static vertex data
         bindings[0].binding = BINDING_VERTEX_BUFFER_STATIC;
@@ -201,7 +201,12 @@ void ASManager::CreateDescriptors()
         bindings[8].descriptorCount = 1;
         bindings[8].stageFlags = VK_SHADER_STAGE_ALL;
 
-        static_assert(bindings.size() == 9, "");
+        bindings[9].binding = BINDING_ANIMATED_MATERIALS;
+        bindings[9].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[9].descriptorCount = 1;
+        bindings[9].stageFlags = VK_SHADER_STAGE_ALL;
+
+        static_assert(bindings.size() == 10, "");
 
         VkDescriptorSetLayoutCreateInfo layoutInfo = {};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -270,7 +275,7 @@ void ASManager::CreateDescriptors()
 
 void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
 {
-    constexpr  uint32_t bindingCount = 9;
+    constexpr  uint32_t bindingCount = 10;
 
     std::array<VkDescriptorBufferInfo, bindingCount> bufferInfos{};
     std::array<VkWriteDescriptorSet, bindingCount> writes{};
@@ -321,6 +326,11 @@ void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
     trBufInfo.offset = 0;
     trBufInfo.range = VK_WHOLE_SIZE;
 
+    VkDescriptorBufferInfo &amBufInfo = bufferInfos[BINDING_ANIMATED_MATERIALS];
+    amBufInfo.buffer = textureMgr->GetAnimatedMaterialTableBuffer();
+    amBufInfo.offset = 0;
+    amBufInfo.range = VK_WHOLE_SIZE;
+
 
     // writes
     VkWriteDescriptorSet &stVertWrt = writes[BINDING_VERTEX_BUFFER_STATIC];
@@ -404,6 +414,15 @@ void ASManager::UpdateBufferDescriptors(uint32_t frameIndex)
     trWrt.descriptorCount = 1;
     trWrt.pBufferInfo = &trBufInfo;
 
+    VkWriteDescriptorSet &amWrt = writes[BINDING_ANIMATED_MATERIALS];
+    amWrt.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    amWrt.dstSet = buffersDescSets[frameIndex];
+    amWrt.dstBinding = BINDING_ANIMATED_MATERIALS;
+    amWrt.dstArrayElement = 0;
+    amWrt.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    amWrt.descriptorCount = 1;
+    amWrt.pBufferInfo = &amBufInfo;
+
     vkUpdateDescriptorSets(device, writes.size(), writes.data(), 0, nullptr);
 }
 
@@ -530,9 +549,9 @@ uint32_t ASManager::AddStaticGeometry(uint32_t frameIndex, const RgGeometryUploa
     {
         MaterialTextures materials[3] =
         {
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[0]),
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[1]),
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[0]),
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[1]),
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[2])
         };
 
         return collectorStatic->AddGeometry(frameIndex, info, materials);
@@ -548,9 +567,9 @@ uint32_t ASManager::AddDynamicGeometry(uint32_t frameIndex, const RgGeometryUplo
     {
         MaterialTextures materials[3] =
         {
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[0]),
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[1]),
-            textureMgr->GetMaterialTextures(info.geomMaterial.layerMaterials[2])
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[0]),
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[1]),
+            textureMgr->GetGeometryMaterialTextures(info.geomMaterial.layerMaterials[2])
         };
 
         return collectorDynamic[frameIndex]->AddGeometry(frameIndex, info, materials);
@@ -0,0 +1,150 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "AnimatedMaterialTable.h"
+
+#include <algorithm>
+
+#include "Generated/ShaderCommonC.h"
+
+constexpr VkDeviceSize ANIMATED_MATERIAL_ENTRY_SIZE = sizeof(uint32_t);
+
+RTGL1::AnimatedMaterialTable::AnimatedMaterialTable(VkDevice _device, std::shared_ptr<MemoryAllocator> _allocator)
+:
+    slotCount(0),
+    dirtyBegin(0),
+    dirtyEnd(0)
+{
+    const uint32_t entryCount = ANIMATED_MATERIAL_COUNT_MAX * TEXTURES_PER_MATERIAL_COUNT;
+
+    tableBuffer = std::make_unique<AutoBuffer>(_device, std::move(_allocator));
+    tableBuffer->Create(entryCount * ANIMATED_MATERIAL_ENTRY_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Animated material table");
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        memset(tableBuffer->GetMapped(i), 0, entryCount * ANIMATED_MATERIAL_ENTRY_SIZE);
+    }
+
+    // initialize device local buffer on the first copy
+    dirtyBegin = 0;
+    dirtyEnd = entryCount;
+}
+
+uint32_t RTGL1::AnimatedMaterialTable::AllocateSlot()
+{
+    if (!freeSlots.empty())
+    {
+        uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+
+        return slot;
+    }
+
+    if (slotCount >= ANIMATED_MATERIAL_COUNT_MAX)
+    {
+        return ANIMATED_MATERIAL_NO_SLOT;
+    }
+
+    return slotCount++;
+}
+
+void RTGL1::AnimatedMaterialTable::FreeSlot(uint32_t slot)
+{
+    assert(slot < slotCount);
+    assert(std::find(freeSlots.begin(), freeSlots.end(), slot) == freeSlots.end());
+
+    freeSlots.push_back(slot);
+}
+
+void RTGL1::AnimatedMaterialTable::Write(uint32_t slot, const MaterialTextures &textures)
+{
+    assert(slot < slotCount);
+
+    const uint32_t first = slot * TEXTURES_PER_MATERIAL_COUNT;
+
+    // the table is the same for each frame, so write to all staging buffers
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        uint32_t *pDst = static_cast<uint32_t *>(tableBuffer->GetMapped(i));
+        memcpy(&pDst[first], textures.indices, TEXTURES_PER_MATERIAL_COUNT * ANIMATED_MATERIAL_ENTRY_SIZE);
+    }
+
+    if (dirtyBegin == dirtyEnd)
+    {
+        dirtyBegin = first;
+        dirtyEnd = first + TEXTURES_PER_MATERIAL_COUNT;
+    }
+    else
+    {
+        dirtyBegin = std::min(dirtyBegin, first);
+        dirtyEnd = std::max(dirtyEnd, first + TEXTURES_PER_MATERIAL_COUNT);
+    }
+}
+
+RTGL1::MaterialTextures RTGL1::AnimatedMaterialTable::GetIndirectTextures(uint32_t slot)
+{
+    MaterialTextures r = {};
+
+    for (uint32_t t = 0; t < TEXTURES_PER_MATERIAL_COUNT; t++)
+    {
+        r.indices[t] = MATERIAL_ANIMATED_TEXTURE_BIT | (slot * TEXTURES_PER_MATERIAL_COUNT + t);
+    }
+
+    return r;
+}
+
+void RTGL1::AnimatedMaterialTable::CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (dirtyBegin == dirtyEnd)
+    {
+        return;
+    }
+
+    VkBufferCopy copyInfo = {};
+    copyInfo.srcOffset = copyInfo.dstOffset = dirtyBegin * ANIMATED_MATERIAL_ENTRY_SIZE;
+    copyInfo.size = (dirtyEnd - dirtyBegin) * ANIMATED_MATERIAL_ENTRY_SIZE;
+
+    tableBuffer->CopyFromStaging(cmd, frameIndex, &copyInfo, 1);
+
+    VkBufferMemoryBarrier b = {};
+    b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    b.buffer = tableBuffer->GetDeviceLocal();
+    b.offset = copyInfo.dstOffset;
+    b.size = copyInfo.size;
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+        0,
+        0, nullptr,
+        1, &b,
+        0, nullptr);
+
+    dirtyBegin = dirtyEnd = 0;
+}
+
+VkBuffer RTGL1::AnimatedMaterialTable::GetBuffer() const
+{
+    return tableBuffer->GetDeviceLocal();
+}
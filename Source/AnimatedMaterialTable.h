@@ -0,0 +1,71 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "AutoBuffer.h"
+#include "Const.h"
+#include "Material.h"
+
+namespace RTGL1
+{
+
+// GPU table: animated material slot -> texture indices of its current frame.
+// Geometry instances reference the slot entries instead of the actual textures,
+// so changing an animation frame is just a write of TEXTURES_PER_MATERIAL_COUNT values,
+// regardless of how many geometries use the material.
+class AnimatedMaterialTable
+{
+public:
+    AnimatedMaterialTable(VkDevice device, std::shared_ptr<MemoryAllocator> allocator);
+    ~AnimatedMaterialTable() = default;
+
+    AnimatedMaterialTable(const AnimatedMaterialTable &other) = delete;
+    AnimatedMaterialTable(AnimatedMaterialTable &&other) noexcept = delete;
+    AnimatedMaterialTable &operator=(const AnimatedMaterialTable &other) = delete;
+    AnimatedMaterialTable &operator=(AnimatedMaterialTable &&other) noexcept = delete;
+
+    // Returns ANIMATED_MATERIAL_NO_SLOT, if there's no free space.
+    uint32_t AllocateSlot();
+    void FreeSlot(uint32_t slot);
+
+    void Write(uint32_t slot, const MaterialTextures &textures);
+    // Texture indices to store in a geometry instance,
+    // shaders resolve them to the current values in the table.
+    static MaterialTextures GetIndirectTextures(uint32_t slot);
+
+    // Copy changed entries to the device local buffer.
+    void CopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex);
+    VkBuffer GetBuffer() const;
+
+private:
+    std::unique_ptr<AutoBuffer> tableBuffer;
+
+    std::vector<uint32_t> freeSlots;
+    uint32_t slotCount;
+
+    // range of entries to copy
+    uint32_t dirtyBegin;
+    uint32_t dirtyEnd;
+};
+
+}
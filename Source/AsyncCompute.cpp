@@ -0,0 +1,127 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "AsyncCompute.h"
+
+using namespace RTGL1;
+
+AsyncCompute::AsyncCompute(VkDevice _device, std::shared_ptr<Queues> _queues, std::shared_ptr<CommandBufferManager> _cmdManager)
+    :
+    device(_device),
+    queues(std::move(_queues)),
+    cmdManager(std::move(_cmdManager)),
+    timelineSemaphore(VK_NULL_HANDLE),
+    lastTimelineValue(0),
+    isEnabled(false),
+    graphicsSignaledValue(0),
+    computeSignaledValue(0)
+{
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = lastTimelineValue;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    VkResult r = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timelineSemaphore);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, timelineSemaphore, VK_OBJECT_TYPE_SEMAPHORE, "Async compute timeline semaphore");
+}
+
+AsyncCompute::~AsyncCompute()
+{
+    vkDestroySemaphore(device, timelineSemaphore, nullptr);
+}
+
+bool AsyncCompute::IsAvailable() const
+{
+    return queues->IsAsyncComputeAvailable();
+}
+
+void AsyncCompute::PrepareForFrame(bool enable)
+{
+    isEnabled = enable && IsAvailable();
+    graphicsSignaledValue = 0;
+    computeSignaledValue = 0;
+}
+
+bool AsyncCompute::IsEnabled() const
+{
+    return isEnabled;
+}
+
+VkCommandBuffer AsyncCompute::SplitGraphicsCmd(VkCommandBuffer graphicsCmd)
+{
+    assert(isEnabled);
+
+    lastTimelineValue++;
+    graphicsSignaledValue = lastTimelineValue;
+
+    CommandBufferManager::SubmitSemaphore signal = {};
+    signal.semaphore = timelineSemaphore;
+    signal.timelineValue = graphicsSignaledValue;
+
+    cmdManager->Submit(graphicsCmd, nullptr, 0, &signal, 1, VK_NULL_HANDLE);
+
+    return cmdManager->StartGraphicsCmd();
+}
+
+VkCommandBuffer AsyncCompute::StartComputeCmd()
+{
+    assert(isEnabled);
+    return cmdManager->StartAsyncComputeCmd();
+}
+
+void AsyncCompute::SubmitComputeCmd(VkCommandBuffer computeCmd)
+{
+    assert(isEnabled);
+    assert(graphicsSignaledValue > 0);
+
+    CommandBufferManager::SubmitSemaphore wait = {};
+    wait.semaphore = timelineSemaphore;
+    wait.timelineValue = graphicsSignaledValue;
+    wait.waitStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    lastTimelineValue++;
+    computeSignaledValue = lastTimelineValue;
+
+    CommandBufferManager::SubmitSemaphore signal = {};
+    signal.semaphore = timelineSemaphore;
+    signal.timelineValue = computeSignaledValue;
+
+    cmdManager->Submit(computeCmd, &wait, 1, &signal, 1, VK_NULL_HANDLE);
+}
+
+bool AsyncCompute::GetWaitForCompute(VkPipelineStageFlags waitStages, CommandBufferManager::SubmitSemaphore &result) const
+{
+    if (computeSignaledValue == 0)
+    {
+        return false;
+    }
+
+    result.semaphore = timelineSemaphore;
+    result.timelineValue = computeSignaledValue;
+    result.waitStages = waitStages;
+
+    return true;
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "CommandBufferManager.h"
+
+namespace RTGL1
+{
+
+// Splits the frame work between the graphics queue and the async compute queue.
+// Dependencies are expressed with one timeline semaphore: its value is increased
+// on every signal, so the order of submissions within a frame is preserved.
+class AsyncCompute
+{
+public:
+    AsyncCompute(VkDevice device, std::shared_ptr<Queues> queues, std::shared_ptr<CommandBufferManager> cmdManager);
+    ~AsyncCompute();
+
+    AsyncCompute(const AsyncCompute &other) = delete;
+    AsyncCompute(AsyncCompute &&other) noexcept = delete;
+    AsyncCompute &operator=(const AsyncCompute &other) = delete;
+    AsyncCompute &operator=(AsyncCompute &&other) noexcept = delete;
+
+    bool IsAvailable() const;
+
+    // Must be called once per frame, before recording the frame work.
+    void PrepareForFrame(bool enable);
+    // True, if async compute was requested for this frame and the device supports it.
+    bool IsEnabled() const;
+
+    // Submit the graphics work that was recorded up to this point,
+    // so the async compute work can depend on it.
+    // Returns a new graphics command buffer that continues the frame.
+    VkCommandBuffer SplitGraphicsCmd(VkCommandBuffer graphicsCmd);
+
+    VkCommandBuffer StartComputeCmd();
+    // The compute work waits for the last graphics split.
+    void SubmitComputeCmd(VkCommandBuffer computeCmd);
+
+    // Get the semaphore that the final graphics submission of the frame must wait on.
+    // Returns false, if there was no async compute work in the frame.
+    bool GetWaitForCompute(VkPipelineStageFlags waitStages, CommandBufferManager::SubmitSemaphore &result) const;
+
+private:
+    VkDevice device;
+    std::shared_ptr<Queues> queues;
+    std::shared_ptr<CommandBufferManager> cmdManager;
+
+    VkSemaphore timelineSemaphore;
+    uint64_t lastTimelineValue;
+
+    bool isEnabled;
+    // 0, if wasn't signaled in the current frame
+    uint64_t graphicsSignaledValue;
+    uint64_t computeSignaledValue;
+};
+
+}
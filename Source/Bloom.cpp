@@ -25,6 +25,7 @@
 #include "Generated/ShaderCommonC.h"
 #include "CmdLabel.h"
 #include "RenderResolutionHelper.h"
+#include "RenderGraph.h"
 #include "Utils.h"
 
 
@@ -39,6 +40,7 @@ RTGL1::Bloom::Bloom(
     framebuffers(std::move(_framebuffers)),
     pipelineLayout(VK_NULL_HANDLE),
     downsamplePipelines{},
+    downsampleSinglePassPipeline(VK_NULL_HANDLE),
     upsamplePipelines{},
     applyPipelines{}
 {
@@ -64,21 +66,9 @@ RTGL1::Bloom::~Bloom()
 
 void RTGL1::Bloom::Prepare(VkCommandBuffer cmd, uint32_t frameIndex,
                            const std::shared_ptr<const GlobalUniform> &uniform,
-                           const std::shared_ptr<const Tonemapping> &tonemapping)
+                           const std::shared_ptr<const Tonemapping> &tonemapping,
+                           bool singlePassDownsample, bool fuseUpsample)
 {
-    VkMemoryBarrier2KHR memoryBarrier = {};
-    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR;
-    memoryBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT_KHR;
-    memoryBarrier.dstAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT_KHR | VK_ACCESS_2_SHADER_READ_BIT_KHR;
-    memoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
-    memoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
-
-    VkDependencyInfoKHR dependencyInfo = {};
-    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
-    dependencyInfo.memoryBarrierCount = 1;
-    dependencyInfo.pMemoryBarriers = &memoryBarrier;
-
-
     // bind desc sets
     VkDescriptorSet sets[] =
     {
@@ -92,61 +82,88 @@ void RTGL1::Bloom::Prepare(VkCommandBuffer cmd, uint32_t frameIndex,
                             0, std::size(sets), sets,
                             0, nullptr);
 
-    for (int i = 0; i < COMPUTE_BLOOM_STEP_COUNT; i++)
+    // i-th downsample step reads mips[i] and writes mips[i + 1],
+    // i-th upsample step reads mips[i + 1] and writes mips[i] or the result
+    constexpr FramebufferImageIndex mips[] =
     {
-        uint32_t wgCountX = Utils::GetWorkGroupCount(uniform->GetData()->renderWidth  / (float)(1 << (i + 1)), COMPUTE_BLOOM_DOWNSAMPLE_GROUP_SIZE_X);
-        uint32_t wgCountY = Utils::GetWorkGroupCount(uniform->GetData()->renderHeight / (float)(1 << (i + 1)), COMPUTE_BLOOM_DOWNSAMPLE_GROUP_SIZE_Y);
+        FB_IMAGE_INDEX_PRE_FINAL,
+        FB_IMAGE_INDEX_BLOOM_MIP1,
+        FB_IMAGE_INDEX_BLOOM_MIP2,
+        FB_IMAGE_INDEX_BLOOM_MIP3,
+        FB_IMAGE_INDEX_BLOOM_MIP4,
+        FB_IMAGE_INDEX_BLOOM_MIP5,
+    };
+    static_assert(std::size(mips) == COMPUTE_BLOOM_STEP_COUNT + 1, "Recheck COMPUTE_BLOOM_STEP_COUNT");
 
-        CmdLabel label(cmd, "Bloom downsample iteration");
+    const float renderWidth = uniform->GetData()->renderWidth;
+    const float renderHeight = uniform->GetData()->renderHeight;
 
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, downsamplePipelines[i]);
+    RenderGraph graph(framebuffers);
 
-        switch (i)
+    if (singlePassDownsample)
+    {
+        // each workgroup writes a tile of all mips
+        uint32_t wgCountX = Utils::GetWorkGroupCount(renderWidth  / 2.0f, COMPUTE_BLOOM_DOWNSAMPLE_SINGLE_PASS_GROUP_SIZE * 2);
+        uint32_t wgCountY = Utils::GetWorkGroupCount(renderHeight / 2.0f, COMPUTE_BLOOM_DOWNSAMPLE_SINGLE_PASS_GROUP_SIZE * 2);
+
+        VkPipeline pipeline = downsampleSinglePassPipeline;
+
+        graph.AddPass("Bloom downsample single pass", VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR,
+                      { mips[0] }, { mips[1], mips[2], mips[3], mips[4], mips[5] },
+                      [pipeline, wgCountX, wgCountY] (VkCommandBuffer c)
+                      {
+                          vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                          vkCmdDispatch(c, wgCountX, wgCountY, 1);
+                      });
+    }
+    else
+    {
+        for (int i = 0; i < COMPUTE_BLOOM_STEP_COUNT; i++)
         {
-            case 0: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_PRE_FINAL); break;
-            case 1: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP1); break;
-            case 2: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP2); break;
-            case 3: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP3); break;
-            case 4: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP4); break;
-            default:assert(0);  
+            uint32_t wgCountX = Utils::GetWorkGroupCount(renderWidth  / (float)(1 << (i + 1)), COMPUTE_BLOOM_DOWNSAMPLE_GROUP_SIZE_X);
+            uint32_t wgCountY = Utils::GetWorkGroupCount(renderHeight / (float)(1 << (i + 1)), COMPUTE_BLOOM_DOWNSAMPLE_GROUP_SIZE_Y);
+
+            VkPipeline pipeline = downsamplePipelines[i];
+
+            graph.AddPass("Bloom downsample iteration", VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR,
+                          { mips[i] }, { mips[i + 1] },
+                          [pipeline, wgCountX, wgCountY] (VkCommandBuffer c)
+                          {
+                              vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                              vkCmdDispatch(c, wgCountX, wgCountY, 1);
+                          });
         }
-
-        vkCmdDispatch(cmd, wgCountX, wgCountY, 1);
     }
 
-
-    svkCmdPipelineBarrier2KHR(cmd, &dependencyInfo);
-
+    // if fused, the last step is done in Apply
+    const int lastUpsampleStep = fuseUpsample ? 1 : 0;
 
     // start from the other side
-    for (int i = COMPUTE_BLOOM_STEP_COUNT - 1; i >= 0; i--)
+    for (int i = COMPUTE_BLOOM_STEP_COUNT - 1; i >= lastUpsampleStep; i--)
     {
-        uint32_t wgCountX = Utils::GetWorkGroupCount(uniform->GetData()->renderWidth  / (float)(1 << i), COMPUTE_BLOOM_UPSAMPLE_GROUP_SIZE_X);
-        uint32_t wgCountY = Utils::GetWorkGroupCount(uniform->GetData()->renderHeight / (float)(1 << i), COMPUTE_BLOOM_UPSAMPLE_GROUP_SIZE_Y);
-
-        CmdLabel label(cmd, "Bloom upsample iteration");
-
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, upsamplePipelines[i]);
-
-        switch (i)
-        {
-            case 4: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP5); break;
-            case 3: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP4); break;
-            case 2: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP3); break;
-            case 1: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP2); break;
-            case 0: framebuffers->BarrierOne(cmd, frameIndex, FB_IMAGE_INDEX_BLOOM_MIP1); break;
-            default:assert(0);
-        }
-
-        vkCmdDispatch(cmd, wgCountX, wgCountY, 1);
+        uint32_t wgCountX = Utils::GetWorkGroupCount(renderWidth  / (float)(1 << i), COMPUTE_BLOOM_UPSAMPLE_GROUP_SIZE_X);
+        uint32_t wgCountY = Utils::GetWorkGroupCount(renderHeight / (float)(1 << i), COMPUTE_BLOOM_UPSAMPLE_GROUP_SIZE_Y);
+
+        VkPipeline pipeline = upsamplePipelines[i];
+
+        graph.AddPass("Bloom upsample iteration", VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR,
+                      { mips[i + 1] }, { i == 0 ? FB_IMAGE_INDEX_BLOOM_RESULT : mips[i] },
+                      [pipeline, wgCountX, wgCountY] (VkCommandBuffer c)
+                      {
+                          vkCmdBindPipeline(c, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                          vkCmdDispatch(c, wgCountX, wgCountY, 1);
+                      });
     }
 
+    // consumed in Apply, which synchronizes the access itself
+    graph.MarkOutput(fuseUpsample ? FB_IMAGE_INDEX_BLOOM_MIP1 : FB_IMAGE_INDEX_BLOOM_RESULT);
 
-    svkCmdPipelineBarrier2KHR(cmd, &dependencyInfo);
+    graph.Execute(cmd, frameIndex);
 }
 
 RTGL1::FramebufferImageIndex RTGL1::Bloom::Apply(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<const GlobalUniform> &uniform,
-                                                 uint32_t width, uint32_t height, FramebufferImageIndex inputFramebuf)
+                                                 uint32_t width, uint32_t height, FramebufferImageIndex inputFramebuf,
+                                                 bool fuseUpsample)
 {
 
     CmdLabel label(cmd, "Bloom apply");
@@ -172,12 +189,12 @@ RTGL1::FramebufferImageIndex RTGL1::Bloom::Apply(VkCommandBuffer cmd, uint32_t f
                             0, std::size(sets), sets,
                             0, nullptr);
 
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, applyPipelines[isSourcePing]);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, applyPipelines[fuseUpsample][isSourcePing]);
 
     FramebufferImageIndex fs[] =
     {
     inputFramebuf,
-    FB_IMAGE_INDEX_BLOOM_RESULT
+    fuseUpsample ? FB_IMAGE_INDEX_BLOOM_MIP1 : FB_IMAGE_INDEX_BLOOM_RESULT
     };
     framebuffers->BarrierMultiple(cmd, frameIndex, fs);
 
@@ -278,28 +295,52 @@ void RTGL1::Bloom::CreateStepPipelines(const ShaderManager *shaderManager)
             SET_DEBUG_NAME(device, upsamplePipelines[i], VK_OBJECT_TYPE_PIPELINE, upsmplDebugNames[i]);
         }
     }
+
+    {
+        assert(downsampleSinglePassPipeline == VK_NULL_HANDLE);
+
+        VkComputePipelineCreateInfo plInfo = {};
+        plInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        plInfo.layout = pipelineLayout;
+        plInfo.stage = shaderManager->GetStageInfo("CBloomDownsampleSinglePass");
+
+        VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &downsampleSinglePassPipeline);
+        VK_CHECKERROR(r);
+
+        SET_DEBUG_NAME(device, downsampleSinglePassPipeline, VK_OBJECT_TYPE_PIPELINE, "Bloom downsample single pass pipeline");
+    }
 }
 
 void RTGL1::Bloom::CreateApplyPipelines(const ShaderManager *shaderManager)
 {
-    for (VkPipeline t : applyPipelines)
+    for (const auto &ts : applyPipelines)
     {
-        assert(t == VK_NULL_HANDLE);
+        for (VkPipeline t : ts)
+        {
+            assert(t == VK_NULL_HANDLE);
+        }
     }
 
 
-    uint32_t isSourcePing = 0;
-
-    VkSpecializationMapEntry specEntry = {};
-    specEntry.constantID = 0;
-    specEntry.offset = 0;
-    specEntry.size = sizeof(isSourcePing);
+    struct
+    {
+        uint32_t isSourcePing;
+        uint32_t isUpsampleFused;
+    } specData = {};
+
+    VkSpecializationMapEntry specEntries[2] = {};
+    specEntries[0].constantID = 0;
+    specEntries[0].offset = offsetof(decltype(specData), isSourcePing);
+    specEntries[0].size = sizeof(specData.isSourcePing);
+    specEntries[1].constantID = 1;
+    specEntries[1].offset = offsetof(decltype(specData), isUpsampleFused);
+    specEntries[1].size = sizeof(specData.isUpsampleFused);
 
     VkSpecializationInfo specInfo = {};
-    specInfo.mapEntryCount = 1;
-    specInfo.pMapEntries = &specEntry;
-    specInfo.dataSize = sizeof(isSourcePing);
-    specInfo.pData = &isSourcePing;
+    specInfo.mapEntryCount = std::size(specEntries);
+    specInfo.pMapEntries = specEntries;
+    specInfo.dataSize = sizeof(specData);
+    specInfo.pData = &specData;
 
 
     VkComputePipelineCreateInfo plInfo = {};
@@ -308,15 +349,22 @@ void RTGL1::Bloom::CreateApplyPipelines(const ShaderManager *shaderManager)
     plInfo.stage = shaderManager->GetStageInfo("CBloomApply");
     plInfo.stage.pSpecializationInfo = &specInfo;
 
-    for (int b = 0; b <= 1; b++)
+    for (uint32_t f = 0; f <= 1; f++)
     {
-        // modify specInfo.pData
-        isSourcePing = b;
+        for (uint32_t b = 0; b <= 1; b++)
+        {
+            // modify specInfo.pData
+            specData.isSourcePing = b;
+            specData.isUpsampleFused = f;
+
+            VkPipeline &pipeline = applyPipelines[f][b];
         
-        VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &applyPipelines[isSourcePing]);
-        VK_CHECKERROR(r);
+            VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &plInfo, nullptr, &pipeline);
+            VK_CHECKERROR(r);
 
-        SET_DEBUG_NAME(device, applyPipelines[isSourcePing], VK_OBJECT_TYPE_PIPELINE, ("Bloom apply from " + std::string(isSourcePing ? "Ping" : "Pong")).c_str());
+            SET_DEBUG_NAME(device, pipeline, VK_OBJECT_TYPE_PIPELINE, 
+                           ("Bloom apply from " + std::string(b ? "Ping" : "Pong") + (f ? " with upsample" : "")).c_str());
+        }
     }
 }
 
@@ -328,15 +376,21 @@ void RTGL1::Bloom::DestroyPipelines()
         p = VK_NULL_HANDLE;
     }
 
+    vkDestroyPipeline(device, downsampleSinglePassPipeline, nullptr);
+    downsampleSinglePassPipeline = VK_NULL_HANDLE;
+
     for (VkPipeline &p : upsamplePipelines)
     {
         vkDestroyPipeline(device, p, nullptr);
         p = VK_NULL_HANDLE;
     }
 
-    for (VkPipeline &t : applyPipelines)
+    for (auto &ts : applyPipelines)
     {
-        vkDestroyPipeline(device, t, nullptr);
-        t = VK_NULL_HANDLE;
+        for (VkPipeline &t : ts)
+        {
+            vkDestroyPipeline(device, t, nullptr);
+            t = VK_NULL_HANDLE;
+        }
     }
 }
@@ -49,15 +49,18 @@ public:
     Bloom &operator=(const Bloom &other) = delete;
     Bloom &operator=(Bloom &&other) noexcept = delete;
 
+    // If fuseUpsample is true, then Apply must be called with the same value
     void Prepare(
         VkCommandBuffer cmd, uint32_t frameIndex,
         const std::shared_ptr<const GlobalUniform> &uniform,
-        const std::shared_ptr<const Tonemapping> &tonemapping);
+        const std::shared_ptr<const Tonemapping> &tonemapping,
+        bool singlePassDownsample, bool fuseUpsample);
 
     FramebufferImageIndex Apply(
         VkCommandBuffer cmd, uint32_t frameIndex,
         const std::shared_ptr<const GlobalUniform> &uniform,
-        uint32_t width, uint32_t height, FramebufferImageIndex inputFramebuf);
+        uint32_t width, uint32_t height, FramebufferImageIndex inputFramebuf,
+        bool fuseUpsample);
 
     void OnShaderReload(const ShaderManager *shaderManager) override;
 
@@ -76,9 +79,11 @@ private:
     VkPipelineLayout pipelineLayout;
 
     VkPipeline downsamplePipelines[5];
+    VkPipeline downsampleSinglePassPipeline;
     VkPipeline upsamplePipelines[5];
     
-    VkPipeline applyPipelines[2];
+    // [isUpsampleFused][isSourcePing]
+    VkPipeline applyPipelines[2][2];
 };
 
 }
\ No newline at end of file
@@ -48,6 +48,10 @@ CommandBufferManager::CommandBufferManager(VkDevice device, std::shared_ptr<Queu
         cmdPoolInfo.queueFamilyIndex = queues->GetIndexTransfer();
         r = vkCreateCommandPool(device, &cmdPoolInfo, nullptr, &transferCmds[i].pool);
         VK_CHECKERROR(r);
+
+        cmdPoolInfo.queueFamilyIndex = queues->GetIndexGraphics();
+        r = vkCreateCommandPool(device, &cmdPoolInfo, nullptr, &asyncComputeCmds[i].pool);
+        VK_CHECKERROR(r);
     }
 }
 
@@ -60,6 +64,7 @@ CommandBufferManager::~CommandBufferManager()
         vkDestroyCommandPool(device, graphicsCmds[i].pool, nullptr);
         vkDestroyCommandPool(device, computeCmds[i].pool, nullptr);
         vkDestroyCommandPool(device, transferCmds[i].pool, nullptr);
+        vkDestroyCommandPool(device, asyncComputeCmds[i].pool, nullptr);
     }
 }
 
@@ -70,10 +75,12 @@ void CommandBufferManager::PrepareForFrame(uint32_t frameIndex)
     vkResetCommandPool(device, graphicsCmds[frameIndex].pool, 0);
     vkResetCommandPool(device, computeCmds[frameIndex].pool, 0);
     vkResetCommandPool(device, transferCmds[frameIndex].pool, 0);
+    vkResetCommandPool(device, asyncComputeCmds[frameIndex].pool, 0);
 
     graphicsCmds[frameIndex].curCount = 0;
     computeCmds[frameIndex].curCount = 0;
     transferCmds[frameIndex].curCount = 0;
+    asyncComputeCmds[frameIndex].curCount = 0;
 
     currentFrameIndex = frameIndex;
 }
@@ -144,6 +151,19 @@ VkCommandBuffer CommandBufferManager::StartTransferCmd()
     return StartCmd(currentFrameIndex, transferCmds[currentFrameIndex], queues.lock()->GetTransfer());
 }
 
+VkCommandBuffer CommandBufferManager::StartAsyncComputeCmd()
+{
+    if (queues.expired())
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    auto qs = queues.lock();
+    assert(qs->IsAsyncComputeAvailable());
+
+    return StartCmd(currentFrameIndex, asyncComputeCmds[currentFrameIndex], qs->GetAsyncCompute());
+}
+
 void CommandBufferManager::Submit(VkCommandBuffer cmd, VkFence fence)
 {
     VkResult r = vkEndCommandBuffer(cmd);
@@ -192,6 +212,66 @@ void CommandBufferManager::Submit(VkCommandBuffer cmd, VkSemaphore waitSemaphore
     VK_CHECKERROR(r);
 }
 
+void CommandBufferManager::Submit(VkCommandBuffer cmd,
+                                  const SubmitSemaphore *pWaitSemaphores, uint32_t waitSemaphoreCount,
+                                  const SubmitSemaphore *pSignalSemaphores, uint32_t signalSemaphoreCount,
+                                  VkFence fence)
+{
+    constexpr uint32_t MaxSemaphoreCount = 4;
+
+    assert(waitSemaphoreCount <= MaxSemaphoreCount);
+    assert(signalSemaphoreCount <= MaxSemaphoreCount);
+
+    VkResult r = vkEndCommandBuffer(cmd);
+    VK_CHECKERROR(r);
+
+    VkSemaphore             waits[MaxSemaphoreCount] = {};
+    uint64_t                waitValues[MaxSemaphoreCount] = {};
+    VkPipelineStageFlags    waitStages[MaxSemaphoreCount] = {};
+    VkSemaphore             signals[MaxSemaphoreCount] = {};
+    uint64_t                signalValues[MaxSemaphoreCount] = {};
+
+    for (uint32_t i = 0; i < waitSemaphoreCount; i++)
+    {
+        waits[i] = pWaitSemaphores[i].semaphore;
+        waitValues[i] = pWaitSemaphores[i].timelineValue;
+        waitStages[i] = pWaitSemaphores[i].waitStages;
+    }
+
+    for (uint32_t i = 0; i < signalSemaphoreCount; i++)
+    {
+        signals[i] = pSignalSemaphores[i].semaphore;
+        signalValues[i] = pSignalSemaphores[i].timelineValue;
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = waitSemaphoreCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+    timelineInfo.signalSemaphoreValueCount = signalSemaphoreCount;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmd;
+    submitInfo.waitSemaphoreCount = waitSemaphoreCount;
+    submitInfo.pWaitSemaphores = waits;
+    submitInfo.pWaitDstStageMask = waitStages;
+    submitInfo.signalSemaphoreCount = signalSemaphoreCount;
+    submitInfo.pSignalSemaphores = signals;
+
+    auto &qs = cmdQueues[currentFrameIndex];
+    assert(qs.find(cmd) != qs.end());
+
+    VkQueue q = qs[cmd];
+    qs.erase(cmd);
+
+    r = vkQueueSubmit(q, 1, &submitInfo, fence);
+    VK_CHECKERROR(r);
+}
+
 
 void CommandBufferManager::WaitGraphicsIdle()
 {
@@ -220,6 +300,18 @@ void CommandBufferManager::WaitTransferIdle()
     }
 }
 
+void CommandBufferManager::WaitAsyncComputeIdle()
+{
+    if (auto qs = queues.lock())
+    {
+        if (qs->IsAsyncComputeAvailable())
+        {
+            VkResult r = vkQueueWaitIdle(qs->GetAsyncCompute());
+            VK_CHECKERROR(r);
+        }
+    }
+}
+
 void CommandBufferManager::WaitDeviceIdle()
 {
     vkDeviceWaitIdle(device);
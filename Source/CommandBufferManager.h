@@ -31,6 +31,16 @@ namespace RTGL1
 
 class CommandBufferManager
 {
+public:
+    struct SubmitSemaphore
+    {
+        VkSemaphore             semaphore;
+        // ignored for binary semaphores
+        uint64_t                timelineValue;
+        // ignored for signal semaphores
+        VkPipelineStageFlags    waitStages;
+    };
+
 public:
     explicit CommandBufferManager(VkDevice device, std::shared_ptr<Queues> queues);
     ~CommandBufferManager();
@@ -48,14 +58,22 @@ public:
     VkCommandBuffer StartComputeCmd();
     // Start transfer command buffer for current frame index
     VkCommandBuffer StartTransferCmd();
+    // Start command buffer for the async compute queue for current frame index
+    VkCommandBuffer StartAsyncComputeCmd();
 
     void Submit(VkCommandBuffer cmd, VkFence fence = VK_NULL_HANDLE);
     void Submit(VkCommandBuffer cmd, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStages, VkSemaphore signalSemaphore, VkFence fence);
+    // Submit with any count of binary and timeline semaphores
+    void Submit(VkCommandBuffer cmd,
+                const SubmitSemaphore *pWaitSemaphores, uint32_t waitSemaphoreCount,
+                const SubmitSemaphore *pSignalSemaphores, uint32_t signalSemaphoreCount,
+                VkFence fence);
 
 
     void WaitGraphicsIdle();
     void WaitComputeIdle();
     void WaitTransferIdle();
+    void WaitAsyncComputeIdle();
     void WaitDeviceIdle();
 
 private:
@@ -80,6 +98,8 @@ private:
     AllocatedCmds graphicsCmds[MAX_FRAMES_IN_FLIGHT];
     AllocatedCmds computeCmds[MAX_FRAMES_IN_FLIGHT];
     AllocatedCmds transferCmds[MAX_FRAMES_IN_FLIGHT];
+    // pools are of the graphics family, as the async compute queue belongs to it
+    AllocatedCmds asyncComputeCmds[MAX_FRAMES_IN_FLIGHT];
 
     std::weak_ptr<Queues> queues;
     rgl::unordered_map<VkCommandBuffer, VkQueue> cmdQueues[MAX_FRAMES_IN_FLIGHT];
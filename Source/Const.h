@@ -32,15 +32,26 @@ constexpr uint32_t      TEXTURE_FILE_EXTENSION_MAX_LENGTH       = 16;
 
 constexpr uint32_t      TEXTURE_COUNT_MIN                       = 1024;
 constexpr uint32_t      TEXTURE_COUNT_MAX                       = 4096;
+// if partially bound descriptors are supported
+constexpr uint32_t      TEXTURE_COUNT_MAX_PARTIALLY_BOUND       = 65536;
+// sampled image descriptors that are left for other descriptor sets
+constexpr uint32_t      TEXTURE_COUNT_RESERVED_DESCRIPTORS      = 1024;
+constexpr uint32_t      TEXTURE_NO_SLOT                         = UINT32_MAX;
 constexpr uint32_t      EMPTY_TEXTURE_INDEX                     = 0;
 constexpr uint32_t      MATERIALS_MAX_LAYER_COUNT               = 3;
 constexpr uint32_t      TEXTURES_PER_MATERIAL_COUNT             = 3;
+constexpr uint32_t      ANIMATED_MATERIAL_COUNT_MAX             = 4096;
+constexpr uint32_t      ANIMATED_MATERIAL_NO_SLOT               = UINT32_MAX;
 
 constexpr const char    *DEFAULT_TEXTURES_PATH                  = "";
 constexpr const char    *DEFAULT_TEXTURES_POSTFIXES[TEXTURES_PER_MATERIAL_COUNT] = { "", "_rme", "_n" };
 
 constexpr uint32_t      MAX_PREGENERATED_MIPMAP_LEVELS          = 20;
 
+constexpr uint32_t      TEXTURE_STREAMING_DEFAULT_BUDGET_MB     = 1024;
+constexpr uint32_t      TEXTURE_STREAMING_DEFAULT_MIP_TAIL_SIZE = 64;
+constexpr uint32_t      TEXTURE_STREAMING_MAX_UPLOAD_PER_FRAME  = 16 * 1024 * 1024;
+
 // Use WORLD2 mask bit as SKY
 #define RAYCULLMASK_SKY_IS_WORLD2 1
 
@@ -37,6 +37,8 @@ RTGL1::CubemapManager::CubemapManager(
     std::shared_ptr<SamplerManager> _samplerManager,
     const std::shared_ptr<CommandBufferManager> &_cmdManager,
     std::shared_ptr<UserFileLoad> _userFileLoad,
+    std::shared_ptr<const OverrideFolderIndex> _overrideFolderIndex,
+    std::shared_ptr<const TexturePack> _texturePack,
     const char *_defaultTexturesPath,
     const char *_overridenTexturePostfix)
 :
@@ -48,9 +50,10 @@ RTGL1::CubemapManager::CubemapManager(
     defaultTexturesPath = _defaultTexturesPath != nullptr ? _defaultTexturesPath : DEFAULT_TEXTURES_PATH;
     overridenTexturePostfix = _overridenTexturePostfix != nullptr ? _overridenTexturePostfix : DEFAULT_TEXTURES_POSTFIXES[MATERIAL_COLOR_TEXTURE_INDEX];
 
-    imageLoader = std::make_shared<ImageLoader>(std::move(_userFileLoad));
+    imageLoader = std::make_shared<ImageLoader>(std::move(_userFileLoad), std::move(_overrideFolderIndex), std::move(_texturePack));
     cubemapDesc = std::make_shared<TextureDescriptors>(device, samplerManager, MAX_CUBEMAP_COUNT, BINDING_CUBEMAPS);
     cubemapUploader = std::make_shared<CubemapUploader>(device, allocator);
+    cubemapSlots = std::make_shared<TextureSlotAllocator>(MAX_CUBEMAP_COUNT);
 
     VkCommandBuffer cmd = _cmdManager->StartGraphicsCmd();
     CreateEmptyCubemap(cmd);
@@ -109,15 +112,6 @@ uint32_t RTGL1::CubemapManager::CreateCubemap(VkCommandBuffer cmd, uint32_t fram
 {
     using namespace std::string_literals;
 
-    auto f = std::find_if(cubemaps.begin(), cubemaps.end(), [] (const Texture &t)
-    {
-        // also check if texture's members are all empty or all filled
-        assert((t.image == VK_NULL_HANDLE && t.view == VK_NULL_HANDLE) ||
-               (t.image != VK_NULL_HANDLE && t.view != VK_NULL_HANDLE));
-
-        return t.image == VK_NULL_HANDLE && t.view == VK_NULL_HANDLE;
-    });
-
     TextureUploader::UploadInfo upload = {};
     upload.cmd = cmd;
     upload.frameIndex = frameIndex;
@@ -243,11 +237,30 @@ uint32_t RTGL1::CubemapManager::CreateCubemap(VkCommandBuffer cmd, uint32_t fram
         return RG_EMPTY_CUBEMAP;
     }
 
-    f->image = i.image;
-    f->view = i.view;
-    f->samplerHandle = SamplerManager::Handle(info.filter, RG_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, RG_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 0);
+    const uint32_t slot = cubemapSlots->Allocate();
 
-    return std::distance(cubemaps.begin(), f);
+    if (slot == TEXTURE_NO_SLOT)
+    {
+        // clean created data, when it won't be in use
+        Texture t = {};
+        t.image = i.image;
+        t.view = i.view;
+        cubemapsToDestroy[frameIndex].push_back(t);
+
+        // TODO: properly warn user, add severity to print
+        assert(false && "Too many cubemaps");
+
+        return RG_EMPTY_CUBEMAP;
+    }
+
+    Texture &t = cubemaps[slot];
+    assert(t.image == VK_NULL_HANDLE && t.view == VK_NULL_HANDLE);
+
+    t.image = i.image;
+    t.view = i.view;
+    t.samplerHandle = SamplerManager::Handle(info.filter, RG_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, RG_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 0);
+
+    return slot;
 }
 
 void RTGL1::CubemapManager::DestroyCubemap(uint32_t frameIndex, uint32_t cubemapIndex)
@@ -257,7 +270,8 @@ void RTGL1::CubemapManager::DestroyCubemap(uint32_t frameIndex, uint32_t cubemap
         throw RgException(RG_WRONG_ARGUMENT, "Wrong cubemap ID=" + std::to_string(cubemapIndex));
     }
 
-    if (cubemaps[cubemapIndex].image == VK_NULL_HANDLE)
+    // empty cubemap is used as a fallback, it must not be destroyed
+    if (cubemapIndex == RG_EMPTY_CUBEMAP || cubemaps[cubemapIndex].image == VK_NULL_HANDLE)
     {
         return;
     }
@@ -271,6 +285,9 @@ void RTGL1::CubemapManager::DestroyCubemap(uint32_t frameIndex, uint32_t cubemap
     t.image = VK_NULL_HANDLE;
     t.view = VK_NULL_HANDLE;
     t.samplerHandle = SamplerManager::Handle();
+
+    // the index can be reused, when the frame won't be in use
+    cubemapSlots->Free(frameIndex, cubemapIndex);
 }
 
 VkDescriptorSetLayout RTGL1::CubemapManager::GetDescSetLayout() const
@@ -293,6 +310,8 @@ void RTGL1::CubemapManager::PrepareForFrame(uint32_t frameIndex)
     }
     cubemapsToDestroy[frameIndex].clear();
 
+    cubemapSlots->PrepareForFrame(frameIndex);
+
     // clear staging buffer that are not in use
     cubemapUploader->ClearStaging(frameIndex);
 }
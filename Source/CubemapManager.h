@@ -29,6 +29,7 @@
 #include "MemoryAllocator.h"
 #include "SamplerManager.h"
 #include "TextureDescriptors.h"
+#include "TextureSlotAllocator.h"
 #include "CubemapUploader.h"
 #include "CommandBufferManager.h"
 #include "ImageLoader.h"
@@ -45,6 +46,8 @@ public:
         std::shared_ptr<SamplerManager> samplerManager,
         const std::shared_ptr<CommandBufferManager> &cmdManager,
         std::shared_ptr<UserFileLoad> userFileLoad,
+        std::shared_ptr<const OverrideFolderIndex> overrideFolderIndex,
+        std::shared_ptr<const TexturePack> texturePack,
         const char *defaultTexturesPath,
         const char *albedoAlphaPostfix);
     ~CubemapManager();
@@ -78,6 +81,7 @@ private:
     std::shared_ptr<CubemapUploader>    cubemapUploader;
 
     std::vector<Texture>    cubemaps;
+    std::shared_ptr<TextureSlotAllocator> cubemapSlots;
     std::vector<Texture>    cubemapsToDestroy[MAX_FRAMES_IN_FLIGHT];
 
     std::string defaultTexturesPath;
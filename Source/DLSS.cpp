@@ -258,16 +258,16 @@ static NVSDK_NGX_PerfQuality_Value ToNGXPerfQuality(RgRenderResolutionMode mode)
 bool RTGL1::DLSS::AreSameDlssFeatureValues(const RenderResolutionHelper &renderResolution) const
 {
     return  
-        prevDlssFeatureValues.renderWidth    == renderResolution.Width() &&
-        prevDlssFeatureValues.renderHeight   == renderResolution.Height() &&
+        prevDlssFeatureValues.renderWidth    == renderResolution.AllocatedWidth() &&
+        prevDlssFeatureValues.renderHeight   == renderResolution.AllocatedHeight() &&
         prevDlssFeatureValues.upscaledWidth  == renderResolution.UpscaledWidth() &&
         prevDlssFeatureValues.upscaledHeight == renderResolution.UpscaledHeight();
 }
 
 void RTGL1::DLSS::SaveDlssFeatureValues(const RenderResolutionHelper &renderResolution)
 {
-    prevDlssFeatureValues.renderWidth = renderResolution.Width();
-    prevDlssFeatureValues.renderHeight = renderResolution.Height();
+    prevDlssFeatureValues.renderWidth = renderResolution.AllocatedWidth();
+    prevDlssFeatureValues.renderHeight = renderResolution.AllocatedHeight();
     prevDlssFeatureValues.upscaledWidth = renderResolution.UpscaledWidth();
     prevDlssFeatureValues.upscaledHeight = renderResolution.UpscaledHeight();
 }
@@ -294,8 +294,9 @@ bool RTGL1::DLSS::ValidateDlssFeature(VkCommandBuffer cmd, const RenderResolutio
 
 
     NVSDK_NGX_DLSS_Create_Params dlssParams = {};
-    dlssParams.Feature.InWidth = renderResolution.Width();
-    dlssParams.Feature.InHeight = renderResolution.Height();
+    // feature is created for the max size, dynamic resolution only changes the subrect
+    dlssParams.Feature.InWidth = renderResolution.AllocatedWidth();
+    dlssParams.Feature.InHeight = renderResolution.AllocatedHeight();
     dlssParams.Feature.InTargetWidth = renderResolution.UpscaledWidth();
     dlssParams.Feature.InTargetHeight = renderResolution.UpscaledHeight();
     // dlssParams.Feature.InPerfQualityValue = ToNGXPerfQuality(renderResolution.GetResolutionMode());
@@ -376,14 +377,16 @@ RTGL1::FramebufferImageIndex RTGL1::DLSS::Apply(VkCommandBuffer cmd, uint32_t fr
     //             offset of the viewport render
     int resetAccumulation = 0;
     NVSDK_NGX_Coordinates sourceOffset = { 0, 0 };
-    NVSDK_NGX_Dimensions  sourceSize = { renderResolution.Width(),         renderResolution.Height()          };
-    NVSDK_NGX_Dimensions  targetSize = { renderResolution.UpscaledWidth(), renderResolution.UpscaledHeight()  };
+    NVSDK_NGX_Dimensions  sourceSize = { renderResolution.Width(),          renderResolution.Height()           };
+    NVSDK_NGX_Dimensions  targetSize = { renderResolution.UpscaledWidth(),  renderResolution.UpscaledHeight()   };
+    // with dynamic resolution, source is a subrect of the allocated images
+    NVSDK_NGX_Dimensions  sourceResourceSize = { renderResolution.AllocatedWidth(), renderResolution.AllocatedHeight() };
 
 
-    NVSDK_NGX_Resource_VK unresolvedColorResource   = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_FINAL,       sourceSize);
+    NVSDK_NGX_Resource_VK unresolvedColorResource   = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_FINAL,       sourceResourceSize);
     NVSDK_NGX_Resource_VK resolvedColorResource     = ToNGXResource(framebuffers, frameIndex, outputImage,                    targetSize, true);
-    NVSDK_NGX_Resource_VK motionVectorsResource     = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_MOTION_DLSS, sourceSize);
-    NVSDK_NGX_Resource_VK depthResource             = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_DEPTH_DLSS,  sourceSize);
+    NVSDK_NGX_Resource_VK motionVectorsResource     = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_MOTION_DLSS, sourceResourceSize);
+    NVSDK_NGX_Resource_VK depthResource             = ToNGXResource(framebuffers, frameIndex, FI::FB_IMAGE_INDEX_DEPTH_DLSS,  sourceResourceSize);
 
 
     NVSDK_NGX_VK_DLSS_Eval_Params evalParams = {};
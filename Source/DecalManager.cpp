@@ -20,12 +20,20 @@
 
 #include "DecalManager.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "CmdLabel.h"
 #include "Matrix.h"
+#include "Utils.h"
 #include "Generated/ShaderCommonC.h"
 
 
-constexpr uint32_t DECAL_MAX_COUNT = 4096;
+constexpr uint32_t DECAL_MAX_COUNT = 16384;
+
+// Enough for 8K render resolution with COMPUTE_DECAL_APPLY_GROUP_SIZE_X=16
+constexpr uint32_t DECAL_MAX_TILE_COUNT = 1 << 17;
+constexpr uint32_t DECAL_MAX_TILE_INDEX_COUNT = 1 << 20;
 
 constexpr uint32_t CUBE_VERTEX_COUNT = 14;
 constexpr VkPrimitiveTopology CUBE_TOPOLOGY = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
@@ -37,15 +45,21 @@ RTGL1::DecalManager::DecalManager(
     const std::shared_ptr<ShaderManager> &_shaderManager,
     const std::shared_ptr<GlobalUniform> &_uniform,
     std::shared_ptr<Framebuffers> _storageFramebuffers,
-    const std::shared_ptr<TextureManager> &_textureManager)
+    const std::shared_ptr<TextureManager> &_textureManager,
+    bool _tiled)
 :
     device(_device),
     storageFramebuffers(std::move(_storageFramebuffers)),
-    decalCount(0),
+    visibleCount(0),
+    tiled(_tiled),
+    tileCountX(0),
+    tileCountY(0),
+    isTiledThisFrame(false),
     renderPass(VK_NULL_HANDLE),
     passFramebuffers{},
     pipelineLayout(VK_NULL_HANDLE),
     pipeline(VK_NULL_HANDLE),
+    tiledPipeline(VK_NULL_HANDLE),
     descPool(VK_NULL_HANDLE),
     descSetLayout(VK_NULL_HANDLE),
     descSet(VK_NULL_HANDLE)
@@ -55,6 +69,21 @@ RTGL1::DecalManager::DecalManager(
         DECAL_MAX_COUNT * sizeof(ShDecalInstance),
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Decal instance buffer");
 
+    instances.reserve(DECAL_MAX_COUNT);
+
+    if (tiled)
+    {
+        tileBuffer = std::make_unique<AutoBuffer>(_allocator);
+        tileBuffer->Create(
+            DECAL_MAX_TILE_COUNT * sizeof(TileRange),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Decal tile buffer");
+
+        tileIndexBuffer = std::make_unique<AutoBuffer>(_allocator);
+        tileIndexBuffer->Create(
+            DECAL_MAX_TILE_INDEX_COUNT * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Decal tile index buffer");
+    }
+
     CreateDescriptors();
     CreateRenderPass();
     VkDescriptorSetLayout setLayouts[] =
@@ -82,21 +111,20 @@ RTGL1::DecalManager::~DecalManager()
 
 void RTGL1::DecalManager::PrepareForFrame(uint32_t frameIndex)
 {
-    decalCount = 0;
+    instances.clear();
+    visibleCount = 0;
+    isTiledThisFrame = false;
 }
 
 void RTGL1::DecalManager::Upload(uint32_t frameIndex, const RgDecalUploadInfo &uploadInfo,
                                  const std::shared_ptr<TextureManager> &textureManager)
 {
-    if (decalCount >= DECAL_MAX_COUNT)
+    if (instances.size() >= DECAL_MAX_COUNT)
     {
         assert(0);
         return;
     }
 
-    const uint32_t decalIndex = decalCount;
-    decalCount++;
-
     const MaterialTextures mat = textureManager->GetMaterialTextures(uploadInfo.material);
 
     ShDecalInstance instance = {};
@@ -104,29 +132,236 @@ void RTGL1::DecalManager::Upload(uint32_t frameIndex, const RgDecalUploadInfo &u
     instance.textureRougnessMetallic = mat.indices[MATERIAL_ROUGHNESS_METALLIC_EMISSION_INDEX];
     instance.textureNormals          = mat.indices[MATERIAL_NORMAL_INDEX];
     Matrix::ToMat4Transposed(instance.transform, uploadInfo.transform);
+    Matrix::Inverse(instance.worldToLocal, instance.transform);
+
+    instances.push_back(instance);
+}
+
+bool RTGL1::DecalManager::GetScreenRect(const ShDecalInstance &decal, const float *viewProj, uint32_t width, uint32_t height, ScreenRect *pOutRect)
+{
+    float mvp[16];
+    Matrix::Multiply(mvp, decal.transform, viewProj);
+
+    // x<-w, x>w, y<-w, y>w, w<0: each is a half-space,
+    // so if all corners are in one of them, the box is outside
+    uint32_t outsideAll = 0b11111;
+    bool anyBehindViewer = false;
+
+    float ndcMin[2] = { 1.0f, 1.0f };
+    float ndcMax[2] = { -1.0f, -1.0f };
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        const float corner[3] =
+        {
+            (i & 1) ? 0.5f : -0.5f,
+            (i & 2) ? 0.5f : -0.5f,
+            (i & 4) ? 0.5f : -0.5f,
+        };
+
+        float clip[4];
+        for (uint32_t r = 0; r < 4; r++)
+        {
+            clip[r] = mvp[0 * 4 + r] * corner[0] + mvp[1 * 4 + r] * corner[1] + mvp[2 * 4 + r] * corner[2] + mvp[3 * 4 + r];
+        }
+
+        const float x = clip[0], y = clip[1], w = clip[3];
 
+        uint32_t outside = 0;
+        outside |= x < -w ? 0b00001 : 0;
+        outside |= x >  w ? 0b00010 : 0;
+        outside |= y < -w ? 0b00100 : 0;
+        outside |= y >  w ? 0b01000 : 0;
+        outside |= w <= 0 ? 0b10000 : 0;
+
+        outsideAll &= outside;
+
+        if (w <= 0.0001f)
+        {
+            anyBehindViewer = true;
+            continue;
+        }
+
+        ndcMin[0] = std::min(ndcMin[0], x / w);
+        ndcMin[1] = std::min(ndcMin[1], y / w);
+        ndcMax[0] = std::max(ndcMax[0], x / w);
+        ndcMax[1] = std::max(ndcMax[1], y / w);
+    }
+
+    if (outsideAll != 0)
     {
-        ShDecalInstance *dst = (ShDecalInstance *)instanceBuffer->GetMapped(frameIndex);
-        memcpy(&dst[decalIndex], &instance, sizeof(ShDecalInstance));
+        return false;
     }
+
+    // projected bounds are unreliable, if some corners are behind
+    if (anyBehindViewer)
+    {
+        *pOutRect = { 0, 0, width - 1, height - 1 };
+        return true;
+    }
+
+    // expand by a pixel to account for jittering
+    const auto toPix = [] (float ndc, uint32_t size, float expand)
+    {
+        float p = std::floor((ndc * 0.5f + 0.5f) * float(size) + expand);
+        return (uint32_t)std::clamp(p, 0.0f, float(size - 1));
+    };
+
+    *pOutRect =
+    {
+        toPix(ndcMin[0], width, -1.0f),
+        toPix(ndcMin[1], height, -1.0f),
+        toPix(ndcMax[0], width, 1.0f),
+        toPix(ndcMax[1], height, 1.0f),
+    };
+    return true;
 }
 
-void RTGL1::DecalManager::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
+void RTGL1::DecalManager::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform)
 {
-    if (decalCount == 0)
+    visibleCount = 0;
+    isTiledThisFrame = false;
+
+    if (instances.empty())
+    {
+        return;
+    }
+
+    const ShGlobalUniform *gu = uniform->GetData();
+    const uint32_t width = (uint32_t)gu->renderWidth;
+    const uint32_t height = (uint32_t)gu->renderHeight;
+
+    float viewProj[16];
+    Matrix::Multiply(viewProj, gu->view, gu->projection);
+
+    // write only visible decals, keeping upload order for blending
+    ShDecalInstance *dst = (ShDecalInstance *)instanceBuffer->GetMapped(frameIndex);
+    visibleRects.clear();
+
+    for (const ShDecalInstance &decal : instances)
+    {
+        ScreenRect rect;
+
+        if (!GetScreenRect(decal, viewProj, width, height, &rect))
+        {
+            continue;
+        }
+
+        memcpy(&dst[visibleCount], &decal, sizeof(ShDecalInstance));
+        visibleCount++;
+
+        if (tiled)
+        {
+            visibleRects.push_back(rect);
+        }
+    }
+
+    if (visibleCount == 0)
     {
         return;
     }
 
     CmdLabel label(cmd, "Copying decal data");
 
-    instanceBuffer->CopyFromStaging(cmd, frameIndex, decalCount * sizeof(ShDecalInstance));
+    instanceBuffer->CopyFromStaging(cmd, frameIndex, visibleCount * sizeof(ShDecalInstance));
+
+    if (tiled)
+    {
+        isTiledThisFrame = BinIntoTiles(cmd, frameIndex, width, height);
+    }
+}
+
+bool RTGL1::DecalManager::BinIntoTiles(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t width, uint32_t height)
+{
+    assert(tiled && visibleRects.size() == visibleCount);
+
+    tileCountX = Utils::GetWorkGroupCount(width, COMPUTE_DECAL_APPLY_GROUP_SIZE_X);
+    tileCountY = Utils::GetWorkGroupCount(height, COMPUTE_DECAL_APPLY_GROUP_SIZE_X);
+
+    const uint32_t tileCount = tileCountX * tileCountY;
+
+    if (tileCount > DECAL_MAX_TILE_COUNT)
+    {
+        return false;
+    }
+
+    tileRanges.assign(tileCount, TileRange{ 0, 0 });
+
+    // count decals per tile
+    uint32_t totalIndexCount = 0;
+
+    for (const ScreenRect &r : visibleRects)
+    {
+        for (uint32_t ty = r.minY / COMPUTE_DECAL_APPLY_GROUP_SIZE_X; ty <= r.maxY / COMPUTE_DECAL_APPLY_GROUP_SIZE_X; ty++)
+        {
+            for (uint32_t tx = r.minX / COMPUTE_DECAL_APPLY_GROUP_SIZE_X; tx <= r.maxX / COMPUTE_DECAL_APPLY_GROUP_SIZE_X; tx++)
+            {
+                tileRanges[ty * tileCountX + tx].count++;
+            }
+        }
+
+        totalIndexCount += 
+            (r.maxX / COMPUTE_DECAL_APPLY_GROUP_SIZE_X - r.minX / COMPUTE_DECAL_APPLY_GROUP_SIZE_X + 1) *
+            (r.maxY / COMPUTE_DECAL_APPLY_GROUP_SIZE_X - r.minY / COMPUTE_DECAL_APPLY_GROUP_SIZE_X + 1);
+    }
+
+    if (totalIndexCount > DECAL_MAX_TILE_INDEX_COUNT)
+    {
+        return false;
+    }
+
+    // prefix sum; count is reset to be used as a cursor
+    uint32_t offset = 0;
+
+    for (TileRange &t : tileRanges)
+    {
+        t.offset = offset;
+        offset += t.count;
+        t.count = 0;
+    }
+
+    // fill in decal order, so the compute pass blends them in the same order as the raster path
+    tileIndices.resize(totalIndexCount);
+
+    for (uint32_t i = 0; i < visibleCount; i++)
+    {
+        const ScreenRect &r = visibleRects[i];
+
+        for (uint32_t ty = r.minY / COMPUTE_DECAL_APPLY_GROUP_SIZE_X; ty <= r.maxY / COMPUTE_DECAL_APPLY_GROUP_SIZE_X; ty++)
+        {
+            for (uint32_t tx = r.minX / COMPUTE_DECAL_APPLY_GROUP_SIZE_X; tx <= r.maxX / COMPUTE_DECAL_APPLY_GROUP_SIZE_X; tx++)
+            {
+                TileRange &t = tileRanges[ty * tileCountX + tx];
+
+                tileIndices[t.offset + t.count] = i;
+                t.count++;
+            }
+        }
+    }
+
+    memcpy(tileBuffer->GetMapped(frameIndex), tileRanges.data(), tileCount * sizeof(TileRange));
+    memcpy(tileIndexBuffer->GetMapped(frameIndex), tileIndices.data(), totalIndexCount * sizeof(uint32_t));
+
+    tileBuffer->CopyFromStaging(cmd, frameIndex, tileCount * sizeof(TileRange));
+
+    if (totalIndexCount > 0)
+    {
+        tileIndexBuffer->CopyFromStaging(cmd, frameIndex, totalIndexCount * sizeof(uint32_t));
+    }
+
+    return true;
 }
 
 void RTGL1::DecalManager::Draw(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, const std::shared_ptr<Framebuffers> &framebuffers, const std::shared_ptr<TextureManager> &textureManager)
 {
-    if (decalCount == 0)
+    if (visibleCount == 0)
+    {
+        return;
+    }
+
+    if (isTiledThisFrame)
     {
+        DrawTiled(cmd, frameIndex, uniform, framebuffers, textureManager);
         return;
     }
 
@@ -141,7 +376,7 @@ void RTGL1::DecalManager::Draw(VkCommandBuffer cmd, uint32_t frameIndex, const s
         b.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT_KHR;
         b.buffer = instanceBuffer->GetDeviceLocal();
         b.offset = 0;
-        b.size = decalCount * sizeof(ShDecalInstance);
+        b.size = visibleCount * sizeof(ShDecalInstance);
 
         VkDependencyInfoKHR info = {};
         info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
@@ -195,11 +430,78 @@ void RTGL1::DecalManager::Draw(VkCommandBuffer cmd, uint32_t frameIndex, const s
     vkCmdSetScissor(cmd, 0, 1, &renderArea);
     vkCmdSetViewport(cmd, 0, 1, &viewport);
 
-    vkCmdDraw(cmd, CUBE_VERTEX_COUNT, decalCount, 0, 0);
+    vkCmdDraw(cmd, CUBE_VERTEX_COUNT, visibleCount, 0, 0);
 
     vkCmdEndRenderPass(cmd);
 }
 
+void RTGL1::DecalManager::DrawTiled(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform, const std::shared_ptr<Framebuffers> &framebuffers, const std::shared_ptr<TextureManager> &textureManager)
+{
+    assert(isTiledThisFrame && tiledPipeline != VK_NULL_HANDLE);
+
+    CmdLabel label(cmd, "Decal tiled apply");
+
+    {
+        VkBufferMemoryBarrier2KHR bs[3] = {};
+
+        VkBuffer buffers[] =
+        {
+            instanceBuffer->GetDeviceLocal(),
+            tileBuffer->GetDeviceLocal(),
+            tileIndexBuffer->GetDeviceLocal(),
+        };
+        static_assert(std::size(bs) == std::size(buffers), "");
+
+        for (uint32_t i = 0; i < std::size(bs); i++)
+        {
+            VkBufferMemoryBarrier2KHR &b = bs[i];
+            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+            b.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT_KHR;
+            b.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR;
+            b.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
+            b.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT_KHR;
+            b.buffer = buffers[i];
+            b.offset = 0;
+            b.size = VK_WHOLE_SIZE;
+        }
+
+        VkDependencyInfoKHR info = {};
+        info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+        info.bufferMemoryBarrierCount = std::size(bs);
+        info.pBufferMemoryBarriers = bs;
+
+        svkCmdPipelineBarrier2KHR(cmd, &info);
+    }
+
+    {
+        FramebufferImageIndex fs[] =
+        {
+            FB_IMAGE_INDEX_ALBEDO,
+            FB_IMAGE_INDEX_SURFACE_POSITION,
+        };
+
+        framebuffers->BarrierMultiple(cmd, frameIndex, fs);
+    }
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, tiledPipeline);
+
+    VkDescriptorSet sets[] =
+    {
+        uniform->GetDescSet(frameIndex),
+        framebuffers->GetDescSet(frameIndex),
+        textureManager->GetDescSet(frameIndex),
+        descSet
+    };
+
+    vkCmdBindDescriptorSets(
+        cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+        0, std::size(sets), sets,
+        0, nullptr);
+
+    // one workgroup per tile
+    vkCmdDispatch(cmd, tileCountX, tileCountY, 1);
+}
+
 void RTGL1::DecalManager::OnShaderReload(const ShaderManager *shaderManager)
 {
     DestroyPipelines();
@@ -409,6 +711,20 @@ void RTGL1::DecalManager::CreatePipelines(const ShaderManager *shaderManager)
 
     VkResult r = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &pipeline);
     VK_CHECKERROR(r);
+
+    if (tiled)
+    {
+        assert(tiledPipeline == VK_NULL_HANDLE);
+
+        // same layout, as the sets are identical
+        VkComputePipelineCreateInfo compInfo = {};
+        compInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        compInfo.layout = pipelineLayout;
+        compInfo.stage = shaderManager->GetStageInfo("CDecalApplyTiled");
+
+        r = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &compInfo, nullptr, &tiledPipeline);
+        VK_CHECKERROR(r);
+    }
 }
 
 void RTGL1::DecalManager::DestroyPipelines()
@@ -417,14 +733,22 @@ void RTGL1::DecalManager::DestroyPipelines()
 
     vkDestroyPipeline(device, pipeline, nullptr);
     pipeline = VK_NULL_HANDLE;
+
+    if (tiledPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(device, tiledPipeline, nullptr);
+        tiledPipeline = VK_NULL_HANDLE;
+    }
 }
 
 void RTGL1::DecalManager::CreateDescriptors()
 {
+    const uint32_t bindingCount = tiled ? 3 : 1;
+
     {
         VkDescriptorPoolSize poolSize = {};
         poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        poolSize.descriptorCount = 1;
+        poolSize.descriptorCount = bindingCount;
 
         VkDescriptorPoolCreateInfo poolInfo = {};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -438,16 +762,27 @@ void RTGL1::DecalManager::CreateDescriptors()
         SET_DEBUG_NAME(device, descPool, VK_OBJECT_TYPE_DESCRIPTOR_POOL, "Decal desc pool");
     }
     {
-        VkDescriptorSetLayoutBinding binding = {};
-        binding.binding = BINDING_DECAL_INSTANCES;
-        binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        binding.descriptorCount = 1;
-        binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        VkDescriptorSetLayoutBinding bindings[3] = {};
+
+        bindings[0].binding = BINDING_DECAL_INSTANCES;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+        bindings[1].binding = BINDING_DECAL_TILES;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        bindings[2].binding = BINDING_DECAL_TILE_INDICES;
+        bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[2].descriptorCount = 1;
+        bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
 
         VkDescriptorSetLayoutCreateInfo info = {};
         info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        info.bindingCount = 1;
-        info.pBindings = &binding;
+        info.bindingCount = bindingCount;
+        info.pBindings = bindings;
 
         VkResult r = vkCreateDescriptorSetLayout(device, &info, nullptr, &descSetLayout);
         VK_CHECKERROR(r);
@@ -468,20 +803,33 @@ void RTGL1::DecalManager::CreateDescriptors()
         SET_DEBUG_NAME(device, descSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Decal desc set");
     }
     {
-        VkDescriptorBufferInfo b = {};
-        b.buffer = instanceBuffer->GetDeviceLocal();
-        b.offset = 0;
-        b.range = VK_WHOLE_SIZE;
-
-        VkWriteDescriptorSet w = {};
-        w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        w.dstSet = descSet;
-        w.dstBinding = BINDING_DECAL_INSTANCES;
-        w.dstArrayElement = 0;
-        w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        w.descriptorCount = 1;
-        w.pBufferInfo = &b;
-
-        vkUpdateDescriptorSets(device, 1, &w, 0, nullptr);
+        VkDescriptorBufferInfo bs[3] = {};
+        VkWriteDescriptorSet ws[3] = {};
+
+        const uint32_t dstBindings[] = { BINDING_DECAL_INSTANCES, BINDING_DECAL_TILES, BINDING_DECAL_TILE_INDICES };
+
+        bs[0].buffer = instanceBuffer->GetDeviceLocal();
+
+        if (tiled)
+        {
+            bs[1].buffer = tileBuffer->GetDeviceLocal();
+            bs[2].buffer = tileIndexBuffer->GetDeviceLocal();
+        }
+
+        for (uint32_t i = 0; i < bindingCount; i++)
+        {
+            bs[i].offset = 0;
+            bs[i].range = VK_WHOLE_SIZE;
+
+            ws[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            ws[i].dstSet = descSet;
+            ws[i].dstBinding = dstBindings[i];
+            ws[i].dstArrayElement = 0;
+            ws[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            ws[i].descriptorCount = 1;
+            ws[i].pBufferInfo = &bs[i];
+        }
+
+        vkUpdateDescriptorSets(device, bindingCount, ws, 0, nullptr);
     }
 }
@@ -20,11 +20,14 @@
 
 #pragma once
 
+#include <vector>
+
 #include "AutoBuffer.h"
 #include "Framebuffers.h"
 #include "GlobalUniform.h"
 #include "ShaderManager.h"
 #include "TextureManager.h"
+#include "Generated/ShaderCommonC.h"
 
 namespace RTGL1
 {
@@ -37,7 +40,8 @@ public:
                  const std::shared_ptr<ShaderManager> &shaderManager,
                  const std::shared_ptr<GlobalUniform> &uniform,
                  std::shared_ptr<Framebuffers> _storageFramebuffers,
-                 const std::shared_ptr<TextureManager> &textureManager);
+                 const std::shared_ptr<TextureManager> &textureManager,
+                 bool tiled);
     ~DecalManager() override;
 
     DecalManager(const DecalManager &other) = delete;
@@ -48,7 +52,9 @@ public:
     void PrepareForFrame(uint32_t frameIndex);
     void Upload(uint32_t frameIndex, const RgDecalUploadInfo &uploadInfo,
                 const std::shared_ptr<TextureManager> &textureManager);
-    void SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex);
+    // Cull decals against the view frustum and copy only visible ones.
+    // If tiled mode is enabled, also bin them into screen tiles.
+    void SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<GlobalUniform> &uniform);
     void Draw(VkCommandBuffer cmd, uint32_t frameIndex,
               const std::shared_ptr<GlobalUniform> &uniform,
               const std::shared_ptr<Framebuffers> &framebuffers,
@@ -58,6 +64,18 @@ public:
     void OnFramebuffersSizeChange(const ResolutionState &resolutionState) override;
 
 private:
+    // Inclusive pixel bounds of a decal's box on the screen
+    struct ScreenRect
+    {
+        uint32_t minX, minY, maxX, maxY;
+    };
+
+    struct TileRange
+    {
+        uint32_t offset;
+        uint32_t count;
+    };
+
     void CreateRenderPass();
     void CreateFramebuffers(uint32_t width, uint32_t height);
     void DestroyFramebuffers();
@@ -66,18 +84,42 @@ private:
     void DestroyPipelines();
     void CreateDescriptors();
 
+    // Returns false, if [-0.5, 0.5] box of the decal is entirely outside of the view frustum.
+    // Otherwise, pOutRect is set to conservative pixel bounds of the box.
+    static bool GetScreenRect(const ShDecalInstance &decal, const float *viewProj, uint32_t width, uint32_t height, ScreenRect *pOutRect);
+    bool BinIntoTiles(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t width, uint32_t height);
+    void DrawTiled(VkCommandBuffer cmd, uint32_t frameIndex,
+                   const std::shared_ptr<GlobalUniform> &uniform,
+                   const std::shared_ptr<Framebuffers> &framebuffers,
+                   const std::shared_ptr<TextureManager> &textureManager);
+
 private:
     VkDevice device;
     std::shared_ptr<Framebuffers> storageFramebuffers;
 
     std::unique_ptr<AutoBuffer> instanceBuffer;
-    uint32_t decalCount;
+    // All decals uploaded in this frame, culled in SubmitForFrame
+    std::vector<ShDecalInstance> instances;
+    uint32_t visibleCount;
+
+    // Tiled mode, buffers are null if disabled
+    bool tiled;
+    std::unique_ptr<AutoBuffer> tileBuffer;
+    std::unique_ptr<AutoBuffer> tileIndexBuffer;
+    std::vector<ScreenRect> visibleRects;
+    std::vector<TileRange> tileRanges;
+    std::vector<uint32_t> tileIndices;
+    uint32_t tileCountX;
+    uint32_t tileCountY;
+    // False, if tile data didn't fit into the buffers, so raster path is used
+    bool isTiledThisFrame;
 
     VkRenderPass renderPass;
     VkFramebuffer passFramebuffers[MAX_FRAMES_IN_FLIGHT];
 
     VkPipelineLayout pipelineLayout;
     VkPipeline pipeline;
+    VkPipeline tiledPipeline;
 
     VkDescriptorPool descPool;
     VkDescriptorSetLayout descSetLayout;
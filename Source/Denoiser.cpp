@@ -20,6 +20,7 @@
 
 #include "Denoiser.h"
 
+#include <algorithm>
 #include <cmath>
 #include "Generated/ShaderCommonC.h"
 #include "CmdLabel.h"
@@ -80,6 +81,12 @@ void RTGL1::Denoiser::MergeSamples(
     typedef FramebufferImageIndex FI;
 
 #if GRADIENT_ESTIMATION_ENABLED
+
+    // skipped by the denoiser quality settings
+    if (!uniform->GetData()->denoiserGradientsEnabled)
+    {
+        return;
+    }
  
     CmdLabel label(cmd, "Gradient Merging");
 
@@ -147,7 +154,10 @@ void RTGL1::Denoiser::Denoise(
 
 
 #if GRADIENT_ESTIMATION_ENABLED
+    const bool gradientsEnabled = uniform->GetData()->denoiserGradientsEnabled;
+
     // gradient samples
+    if (gradientsEnabled)
     {
         uint32_t wgGradCountX = Utils::GetWorkGroupCount(uniform->GetData()->renderWidth / COMPUTE_ASVGF_STRATA_SIZE, COMPUTE_GRADIENT_SAMPLES_GROUP_SIZE_X);
         uint32_t wgGradCountY = Utils::GetWorkGroupCount(uniform->GetData()->renderHeight / COMPUTE_ASVGF_STRATA_SIZE, COMPUTE_GRADIENT_SAMPLES_GROUP_SIZE_X);
@@ -170,7 +180,7 @@ void RTGL1::Denoiser::Denoise(
     }
     
     // gradient atrous
-
+    if (gradientsEnabled)
     {
         CmdLabel label(cmd, "Gradient Atrous");
 
@@ -253,7 +263,11 @@ void RTGL1::Denoiser::Denoise(
 
     // atrous
 
-    for (uint32_t i = 0; i < COMPUTE_SVGF_ATROUS_ITERATION_COUNT; i++)
+    // at least 2 iterations, as the first one is a special case
+    const uint32_t atrousIterationCount = std::clamp<uint32_t>(uniform->GetData()->denoiserAtrousIterationCount, 2, COMPUTE_SVGF_ATROUS_ITERATION_COUNT);
+    assert(atrousIterationCount == uniform->GetData()->denoiserAtrousIterationCount);
+
+    for (uint32_t i = 0; i < atrousIterationCount; i++)
     {
         uint32_t wgCountX = Utils::GetWorkGroupCount(uniform->GetData()->renderWidth, COMPUTE_SVGF_ATROUS_GROUP_SIZE_X);
         uint32_t wgCountY = Utils::GetWorkGroupCount(uniform->GetData()->renderHeight, COMPUTE_SVGF_ATROUS_GROUP_SIZE_X);
@@ -330,6 +344,12 @@ void RTGL1::Denoiser::Denoise(
             }
         }
 
+        // last iteration composes the result
+        if (i + 1 == atrousIterationCount && i != COMPUTE_SVGF_ATROUS_ITERATION_COUNT - 1)
+        {
+            framebuffers->BarrierOne(cmd, frameIndex, FI::FB_IMAGE_INDEX_THROUGHPUT);
+        }
+
         vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, atrous[i]);
         vkCmdDispatch(cmd, wgCountX, wgCountY, 1);
     }
@@ -0,0 +1,198 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "RgException.h"
+
+namespace RTGL1
+{
+
+class DenoiserQualityHelper
+{
+public:
+    DenoiserQualityHelper() = default;
+    ~DenoiserQualityHelper() = default;
+
+    DenoiserQualityHelper(const DenoiserQualityHelper &other) = delete;
+    DenoiserQualityHelper(DenoiserQualityHelper &&other) noexcept = delete;
+    DenoiserQualityHelper &operator=(const DenoiserQualityHelper &other) = delete;
+    DenoiserQualityHelper &operator=(DenoiserQualityHelper &&other) noexcept = delete;
+
+    // lastGpuFrameTime is in milliseconds, negative if unknown
+    void Setup(const RgDrawFrameDenoiserParams *pParams, const float view[16], float lastGpuFrameTime)
+    {
+        const bool isCameraStatic = IsSameView(view, prevView);
+        memcpy(prevView, view, sizeof(prevView));
+
+
+        RgDenoiserQuality requested = pParams != nullptr ? pParams->quality : RG_DENOISER_QUALITY_HIGH;
+
+        switch (requested)
+        {
+            case RG_DENOISER_QUALITY_HIGH:
+            case RG_DENOISER_QUALITY_MEDIUM:
+            case RG_DENOISER_QUALITY_LOW:
+                quality = requested;
+                break;
+
+            case RG_DENOISER_QUALITY_AUTO:
+            {
+                assert(pParams != nullptr);
+                float target = pParams->autoTargetGpuFrameTime > 0.0f ? pParams->autoTargetGpuFrameTime : DEFAULT_TARGET_GPU_FRAME_TIME;
+
+                quality = ChooseAuto(target, lastGpuFrameTime);
+                break;
+            }
+
+            default:
+                throw RgException(RG_WRONG_ARGUMENT, "RgDrawFrameDenoiserParams::quality is incorrect");
+        }
+
+        if (requested != RG_DENOISER_QUALITY_AUTO)
+        {
+            // start from the best quality, when auto mode is enabled again
+            autoQuality = RG_DENOISER_QUALITY_HIGH;
+            smoothedGpuFrameTime = -1.0f;
+            framesSinceAutoChange = 0;
+        }
+
+        switch (quality)
+        {
+            case RG_DENOISER_QUALITY_HIGH:
+                atrousIterationCount = 4;
+                indirHalfRes = false;
+                gradientsEnabled = true;
+                break;
+
+            case RG_DENOISER_QUALITY_MEDIUM:
+                atrousIterationCount = 3;
+                indirHalfRes = true;
+                gradientsEnabled = true;
+                break;
+
+            case RG_DENOISER_QUALITY_LOW:
+            default:
+                atrousIterationCount = 2;
+                indirHalfRes = true;
+                // camera movement is the main source of temporal lag,
+                // so gradients are still required while it moves
+                gradientsEnabled = !isCameraStatic;
+                break;
+        }
+    }
+
+    RgDenoiserQuality GetQuality() const
+    {
+        return quality;
+    }
+
+    uint32_t GetAtrousIterationCount() const
+    {
+        return atrousIterationCount;
+    }
+
+    bool IsIndirHalfRes() const
+    {
+        return indirHalfRes;
+    }
+
+    bool AreGradientsEnabled() const
+    {
+        return gradientsEnabled;
+    }
+
+private:
+    RgDenoiserQuality ChooseAuto(float targetGpuFrameTime, float lastGpuFrameTime)
+    {
+        if (lastGpuFrameTime < 0.0f)
+        {
+            return autoQuality;
+        }
+
+        smoothedGpuFrameTime = smoothedGpuFrameTime < 0.0f ? 
+            lastGpuFrameTime : 
+            smoothedGpuFrameTime + (lastGpuFrameTime - smoothedGpuFrameTime) * AUTO_SMOOTHING_FACTOR;
+
+        framesSinceAutoChange++;
+
+        // don't change too often, as the new quality needs some frames to be measured
+        if (framesSinceAutoChange < AUTO_MIN_FRAMES_BETWEEN_CHANGES)
+        {
+            return autoQuality;
+        }
+
+        if (smoothedGpuFrameTime > targetGpuFrameTime)
+        {
+            if (autoQuality != RG_DENOISER_QUALITY_LOW)
+            {
+                autoQuality = autoQuality == RG_DENOISER_QUALITY_HIGH ? RG_DENOISER_QUALITY_MEDIUM : RG_DENOISER_QUALITY_LOW;
+                framesSinceAutoChange = 0;
+            }
+        }
+        // hysteresis to prevent switching back and forth
+        else if (smoothedGpuFrameTime < targetGpuFrameTime * AUTO_RAISE_THRESHOLD)
+        {
+            if (autoQuality != RG_DENOISER_QUALITY_HIGH)
+            {
+                autoQuality = autoQuality == RG_DENOISER_QUALITY_LOW ? RG_DENOISER_QUALITY_MEDIUM : RG_DENOISER_QUALITY_HIGH;
+                framesSinceAutoChange = 0;
+            }
+        }
+
+        return autoQuality;
+    }
+
+    static bool IsSameView(const float a[16], const float b[16])
+    {
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            if (std::abs(a[i] - b[i]) > 0.0001f)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    constexpr static float DEFAULT_TARGET_GPU_FRAME_TIME = 16.6f;
+    constexpr static float AUTO_SMOOTHING_FACTOR = 0.1f;
+    constexpr static float AUTO_RAISE_THRESHOLD = 0.75f;
+    constexpr static uint32_t AUTO_MIN_FRAMES_BETWEEN_CHANGES = 30;
+
+    RgDenoiserQuality quality = RG_DENOISER_QUALITY_HIGH;
+    uint32_t atrousIterationCount = 4;
+    bool indirHalfRes = false;
+    bool gradientsEnabled = true;
+
+    RgDenoiserQuality autoQuality = RG_DENOISER_QUALITY_HIGH;
+    float smoothedGpuFrameTime = -1.0f;
+    uint32_t framesSinceAutoChange = 0;
+
+    float prevView[16] = {};
+};
+
+}
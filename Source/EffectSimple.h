@@ -92,6 +92,27 @@ public:
         return Dispatch(args.cmd, args.frameIndex, args.framebuffers, args.width, args.height, inputFramebuf, descSets);
     }
 
+    // State set by the last Setup call, to evaluate the effect outside of its own shader
+    uint32_t GetTransitionType() const
+    {
+        return push.transitionType;
+    }
+
+    float GetTransitionBeginTime() const
+    {
+        return push.transitionBeginTime;
+    }
+
+    float GetTransitionDuration() const
+    {
+        return push.transitionDuration;
+    }
+
+    const PUSH_CONST &GetCustomPush() const
+    {
+        return push.custom;
+    }
+
 protected:
     bool GetPushConstData(uint8_t(&pData)[128], uint32_t *pDataSize) const override
     {
@@ -0,0 +1,335 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "EffectSimpleFused.h"
+
+namespace
+{
+
+// Source image loads per pixel, that each stage requires from the previous one
+constexpr uint32_t STAGE_SOURCE_LOADS[EFFECT_SIMPLE_FUSED_COUNT] =
+{
+    2, // EFFECT_SIMPLE_FUSED_COLOR_TINT
+    1, // EFFECT_SIMPLE_FUSED_INVERSE_BW
+    1, // EFFECT_SIMPLE_FUSED_HUE_SHIFT
+    3, // EFFECT_SIMPLE_FUSED_CHROMATIC_ABERRATION
+    1, // EFFECT_SIMPLE_FUSED_DISTORTED_SIDES
+    3, // EFFECT_SIMPLE_FUSED_RADIAL_BLUR
+};
+
+uint32_t MakePipelineKey(uint32_t effectMask, bool isSourcePing)
+{
+    return (effectMask << 1) | (isSourcePing ? 1 : 0);
+}
+
+// Greedily merge consecutive stages, until a pixel would need too many source loads.
+// Returns the count of groups, i.e. dispatches.
+uint32_t SplitIntoGroups(uint32_t effectMask, uint32_t (&groupMasks)[EFFECT_SIMPLE_FUSED_COUNT])
+{
+    uint32_t groupCount = 0;
+
+    uint32_t groupMask = 0;
+    uint32_t groupLoads = 1;
+
+    for (uint32_t effect = 0; effect < EFFECT_SIMPLE_FUSED_COUNT; effect++)
+    {
+        if ((effectMask & (1u << effect)) == 0)
+        {
+            continue;
+        }
+
+        if (groupMask != 0 && groupLoads * STAGE_SOURCE_LOADS[effect] > RTGL1::EFFECT_SIMPLE_FUSED_MAX_SOURCE_LOADS)
+        {
+            groupMasks[groupCount++] = groupMask;
+
+            groupMask = 0;
+            groupLoads = 1;
+        }
+
+        groupMask |= 1u << effect;
+        groupLoads *= STAGE_SOURCE_LOADS[effect];
+    }
+
+    if (groupMask != 0)
+    {
+        groupMasks[groupCount++] = groupMask;
+    }
+
+    return groupCount;
+}
+
+}
+
+RTGL1::EffectSimpleFused::EffectSimpleFused(
+    VkDevice _device,
+    const std::shared_ptr<const Framebuffers> &_framebuffers,
+    const std::shared_ptr<const GlobalUniform> &_uniform,
+    const std::shared_ptr<const ShaderManager> &_shaderManager)
+:
+    device(_device),
+    pipelineLayout(VK_NULL_HANDLE),
+    push{},
+    addedEffectMask(0)
+{
+    static_assert(sizeof(PushConst) <= 128, "Push constant must have size <= 128");
+
+    VkDescriptorSetLayout setLayouts[] =
+    {
+        _framebuffers->GetDescSetLayout(),
+        _uniform->GetDescSetLayout(),
+    };
+
+    VkPushConstantRange pushRange = {};
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(PushConst);
+
+    VkPipelineLayoutCreateInfo plLayoutInfo = {};
+    plLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    plLayoutInfo.setLayoutCount = std::size(setLayouts);
+    plLayoutInfo.pSetLayouts = setLayouts;
+    plLayoutInfo.pushConstantRangeCount = 1;
+    plLayoutInfo.pPushConstantRanges = &pushRange;
+
+    VkResult r = vkCreatePipelineLayout(device, &plLayoutInfo, nullptr, &pipelineLayout);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, pipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Effect simple fused pipeline layout");
+
+    CreatePipelines(_shaderManager.get());
+}
+
+RTGL1::EffectSimpleFused::~EffectSimpleFused()
+{
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    DestroyPipelines();
+}
+
+template<typename PUSH_CONST>
+void RTGL1::EffectSimpleFused::AddTransition(uint32_t effect, const EffectSimple<PUSH_CONST> &src)
+{
+    // effects must be added in the order of the shader stages
+    assert(effect < EFFECT_SIMPLE_FUSED_COUNT);
+    assert((addedEffectMask >> effect) == 0);
+
+    push.transitionType[effect] = src.GetTransitionType();
+    push.transitionBeginTime[effect] = src.GetTransitionBeginTime();
+    push.transitionDuration[effect] = src.GetTransitionDuration();
+
+    addedEffectMask |= 1u << effect;
+}
+
+void RTGL1::EffectSimpleFused::Add(const EffectColorTint &effect)
+{
+    AddTransition(EFFECT_SIMPLE_FUSED_COLOR_TINT, effect);
+
+    push.colorTintIntensity = effect.GetCustomPush().intensity;
+    push.colorTintR = effect.GetCustomPush().r;
+    push.colorTintG = effect.GetCustomPush().g;
+    push.colorTintB = effect.GetCustomPush().b;
+}
+
+void RTGL1::EffectSimpleFused::Add(const EffectInverseBW &effect)
+{
+    AddTransition(EFFECT_SIMPLE_FUSED_INVERSE_BW, effect);
+}
+
+void RTGL1::EffectSimpleFused::Add(const EffectHueShift &effect)
+{
+    AddTransition(EFFECT_SIMPLE_FUSED_HUE_SHIFT, effect);
+}
+
+void RTGL1::EffectSimpleFused::Add(const EffectChromaticAberration &effect)
+{
+    AddTransition(EFFECT_SIMPLE_FUSED_CHROMATIC_ABERRATION, effect);
+
+    push.chromaticAberrationIntensity = effect.GetCustomPush().intensity;
+}
+
+void RTGL1::EffectSimpleFused::Add(const EffectDistortedSides &effect)
+{
+    AddTransition(EFFECT_SIMPLE_FUSED_DISTORTED_SIDES, effect);
+}
+
+void RTGL1::EffectSimpleFused::Add(const EffectRadialBlur &effect)
+{
+    AddTransition(EFFECT_SIMPLE_FUSED_RADIAL_BLUR, effect);
+}
+
+RTGL1::FramebufferImageIndex RTGL1::EffectSimpleFused::Apply(const CommonnlyUsedEffectArguments &args, FramebufferImageIndex inputFramebuf)
+{
+    FramebufferImageIndex result = inputFramebuf;
+
+    uint32_t groupMasks[EFFECT_SIMPLE_FUSED_COUNT];
+    const uint32_t groupCount = SplitIntoGroups(addedEffectMask, groupMasks);
+
+    for (uint32_t i = 0; i < groupCount; i++)
+    {
+        result = Dispatch(args, groupMasks[i], result);
+    }
+
+    addedEffectMask = 0;
+    return result;
+}
+
+RTGL1::FramebufferImageIndex RTGL1::EffectSimpleFused::Dispatch(const CommonnlyUsedEffectArguments &args, uint32_t effectMask, FramebufferImageIndex inputFramebuf)
+{
+    CmdLabel label(args.cmd, "EffectSimpleFused");
+
+
+    assert(inputFramebuf == FB_IMAGE_INDEX_UPSCALED_PING || inputFramebuf == FB_IMAGE_INDEX_UPSCALED_PONG);
+    bool isSourcePing = inputFramebuf == FB_IMAGE_INDEX_UPSCALED_PING;
+
+
+    const uint32_t wgCountX = Utils::GetWorkGroupCount(args.width, COMPUTE_EFFECT_GROUP_SIZE_X);
+    const uint32_t wgCountY = Utils::GetWorkGroupCount(args.height, COMPUTE_EFFECT_GROUP_SIZE_Y);
+
+    VkDescriptorSet descSets[] =
+    {
+        args.framebuffers->GetDescSet(args.frameIndex),
+        args.uniform->GetDescSet(args.frameIndex),
+    };
+
+    vkCmdBindDescriptorSets(args.cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipelineLayout,
+                            0, std::size(descSets), descSets,
+                            0, nullptr);
+
+    vkCmdBindPipeline(args.cmd, VK_PIPELINE_BIND_POINT_COMPUTE, GetPipeline(effectMask, isSourcePing));
+
+    vkCmdPushConstants(args.cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+
+    FramebufferImageIndex fs[] =
+    {
+        inputFramebuf,
+    };
+    args.framebuffers->BarrierMultiple(args.cmd, args.frameIndex, fs);
+
+    vkCmdDispatch(args.cmd, wgCountX, wgCountY, 1);
+
+
+    return isSourcePing ? FB_IMAGE_INDEX_UPSCALED_PONG : FB_IMAGE_INDEX_UPSCALED_PING;
+}
+
+VkPipeline RTGL1::EffectSimpleFused::GetPipeline(uint32_t effectMask, bool isSourcePing) const
+{
+    auto found = pipelines.find(MakePipelineKey(effectMask, isSourcePing));
+
+    // all masks that SplitIntoGroups can produce are created beforehand
+    assert(found != pipelines.end());
+    return found != pipelines.end() ? found->second : VK_NULL_HANDLE;
+}
+
+void RTGL1::EffectSimpleFused::CreatePipelines(const ShaderManager *shaderManager)
+{
+    assert(pipelines.empty());
+
+    // gather the groups for every combination of effects,
+    // so no pipeline is created while recording a frame
+    std::vector<uint32_t> keys;
+    rgl::unordered_set<uint32_t> uniqueKeys;
+
+    for (uint32_t effectMask = 1; effectMask < (1u << EFFECT_SIMPLE_FUSED_COUNT); effectMask++)
+    {
+        uint32_t groupMasks[EFFECT_SIMPLE_FUSED_COUNT];
+        const uint32_t groupCount = SplitIntoGroups(effectMask, groupMasks);
+
+        for (uint32_t i = 0; i < groupCount; i++)
+        {
+            for (bool isSourcePing : { false, true })
+            {
+                const uint32_t key = MakePipelineKey(groupMasks[i], isSourcePing);
+
+                if (uniqueKeys.insert(key).second)
+                {
+                    keys.push_back(key);
+                }
+            }
+        }
+    }
+
+    struct SpecData
+    {
+        uint32_t isSourcePing;
+        uint32_t effectMask;
+    };
+
+    VkSpecializationMapEntry specEntries[2] = {};
+    specEntries[0].constantID = 0;
+    specEntries[0].offset = offsetof(SpecData, isSourcePing);
+    specEntries[0].size = sizeof(SpecData::isSourcePing);
+    specEntries[1].constantID = 1;
+    specEntries[1].offset = offsetof(SpecData, effectMask);
+    specEntries[1].size = sizeof(SpecData::effectMask);
+
+    const VkPipelineShaderStageCreateInfo stageInfo = shaderManager->GetStageInfo("EffectSimpleFused");
+
+    std::vector<SpecData> specData(keys.size());
+    std::vector<VkSpecializationInfo> specInfos(keys.size());
+    std::vector<VkComputePipelineCreateInfo> plInfos(keys.size());
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        specData[i].isSourcePing = keys[i] & 1;
+        specData[i].effectMask = keys[i] >> 1;
+
+        specInfos[i] = {};
+        specInfos[i].mapEntryCount = std::size(specEntries);
+        specInfos[i].pMapEntries = specEntries;
+        specInfos[i].dataSize = sizeof(SpecData);
+        specInfos[i].pData = &specData[i];
+
+        plInfos[i] = {};
+        plInfos[i].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        plInfos[i].layout = pipelineLayout;
+        plInfos[i].stage = stageInfo;
+        plInfos[i].stage.pSpecializationInfo = &specInfos[i];
+    }
+
+    // one call, so the driver can compile them in parallel
+    std::vector<VkPipeline> result(keys.size(), VK_NULL_HANDLE);
+
+    VkResult r = vkCreateComputePipelines(device, VK_NULL_HANDLE, (uint32_t)plInfos.size(), plInfos.data(), nullptr, result.data());
+    VK_CHECKERROR(r);
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        SET_DEBUG_NAME(device, result[i], VK_OBJECT_TYPE_PIPELINE,
+                       (std::string("EffectSimpleFused ") + std::to_string(specData[i].effectMask) + " from " + (specData[i].isSourcePing ? "Ping" : "Pong")).c_str());
+
+        pipelines[keys[i]] = result[i];
+    }
+}
+
+void RTGL1::EffectSimpleFused::OnShaderReload(const ShaderManager *shaderManager)
+{
+    DestroyPipelines();
+    CreatePipelines(shaderManager);
+}
+
+void RTGL1::EffectSimpleFused::DestroyPipelines()
+{
+    for (auto &p : pipelines)
+    {
+        vkDestroyPipeline(device, p.second, nullptr);
+    }
+
+    pipelines.clear();
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Containers.h"
+#include "EffectSimple_Instances.h"
+#include "Generated/ShaderCommonC.h"
+
+namespace RTGL1
+{
+
+// Max amount of source image loads per pixel in one fused dispatch.
+// Stages that read neighbors (color tint, chromatic aberration, radial blur)
+// multiply the cost of all previous stages, so such chains are split.
+constexpr uint32_t EFFECT_SIMPLE_FUSED_MAX_SOURCE_LOADS = 4;
+
+// Applies a sequence of simple effects in as few compute dispatches as possible,
+// instead of one dispatch and one ping-pong image roundtrip per effect.
+class EffectSimpleFused final : public IShaderDependency
+{
+public:
+    explicit EffectSimpleFused(
+        VkDevice device,
+        const std::shared_ptr<const Framebuffers> &framebuffers,
+        const std::shared_ptr<const GlobalUniform> &uniform,
+        const std::shared_ptr<const ShaderManager> &shaderManager);
+    ~EffectSimpleFused() override;
+
+    EffectSimpleFused(const EffectSimpleFused &other) = delete;
+    EffectSimpleFused(EffectSimpleFused &&other) noexcept = delete;
+    EffectSimpleFused &operator=(const EffectSimpleFused &other) = delete;
+    EffectSimpleFused &operator=(EffectSimpleFused &&other) noexcept = delete;
+
+    // Add effects, which Setup returned true, in the order:
+    // color tint, inverse BW, hue shift, chromatic aberration, distorted sides, radial blur
+    void Add(const EffectColorTint &effect);
+    void Add(const EffectInverseBW &effect);
+    void Add(const EffectHueShift &effect);
+    void Add(const EffectChromaticAberration &effect);
+    void Add(const EffectDistortedSides &effect);
+    void Add(const EffectRadialBlur &effect);
+
+    // Apply added effects and clear the list. Returns the framebuffer with the result.
+    FramebufferImageIndex Apply(const CommonnlyUsedEffectArguments &args, FramebufferImageIndex inputFramebuf);
+
+    void OnShaderReload(const ShaderManager *shaderManager) override;
+
+private:
+    template<typename PUSH_CONST>
+    void AddTransition(uint32_t effect, const EffectSimple<PUSH_CONST> &src);
+
+    FramebufferImageIndex Dispatch(const CommonnlyUsedEffectArguments &args, uint32_t effectMask, FramebufferImageIndex inputFramebuf);
+
+    VkPipeline GetPipeline(uint32_t effectMask, bool isSourcePing) const;
+    void CreatePipelines(const ShaderManager *shaderManager);
+    void DestroyPipelines();
+
+private:
+    struct PushConst
+    {
+        uint32_t transitionType[EFFECT_SIMPLE_FUSED_COUNT];
+        float transitionBeginTime[EFFECT_SIMPLE_FUSED_COUNT];
+        float transitionDuration[EFFECT_SIMPLE_FUSED_COUNT];
+        float colorTintIntensity;
+        float colorTintR;
+        float colorTintG;
+        float colorTintB;
+        float chromaticAberrationIntensity;
+    };
+
+private:
+    VkDevice device;
+
+    VkPipelineLayout pipelineLayout;
+    // (effect mask << 1) | isSourcePing -> pipeline,
+    // created at shader load for all groups that Apply can dispatch
+    rgl::unordered_map<uint32_t, VkPipeline> pipelines;
+
+    PushConst push;
+    uint32_t addedEffectMask;
+};
+
+}
@@ -79,9 +79,11 @@ struct EffectWipe final : public EffectBase
             return false;
         }
 
-        if (params->beginNow)
+        // the image of the current frame might be not acquired yet, if low latency mode is active
+        uint32_t previousSwapchainIndex = swapchain->GetLastPresentedImageIndex();
+
+        if (params->beginNow && previousSwapchainIndex != UINT32_MAX)
         {
-            uint32_t previousSwapchainIndex = Utils::GetPreviousByModulo(swapchain->GetCurrentImageIndex(), swapchain->GetImageCount());
             VkImage src = swapchain->GetImage(previousSwapchainIndex);
 
             VkImage dst = args.framebuffers->GetImage(FB_IMAGE_INDEX_WIPE_EFFECT_SOURCE, args.frameIndex);
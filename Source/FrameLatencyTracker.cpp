@@ -0,0 +1,101 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FrameLatencyTracker.h"
+
+using namespace RTGL1;
+
+namespace
+{
+
+constexpr float LATENCY_AVERAGE_WEIGHT = 0.1f;
+
+float ToMilliseconds(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration<float, std::milli>(d).count();
+}
+
+}
+
+FrameLatencyTracker::FrameLatencyTracker()
+:
+    submitTime{},
+    isPending{},
+    cpuWaitTime(0.0f),
+    lastCpuWaitTime(0.0f),
+    isLowLatency(false),
+    lastLatency(-1.0f),
+    averageLatency(-1.0f),
+    measuredFrameCount(0)
+{}
+
+void FrameLatencyTracker::OnSubmit(uint32_t frameIndex)
+{
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    submitTime[frameIndex] = Clock::now();
+    isPending[frameIndex] = true;
+}
+
+void FrameLatencyTracker::OnCompleted(uint32_t frameIndex)
+{
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    if (!isPending[frameIndex])
+    {
+        return;
+    }
+    isPending[frameIndex] = false;
+
+    lastLatency = ToMilliseconds(Clock::now() - submitTime[frameIndex]);
+
+    averageLatency = measuredFrameCount == 0 ?
+        lastLatency :
+        averageLatency + (lastLatency - averageLatency) * LATENCY_AVERAGE_WEIGHT;
+
+    measuredFrameCount++;
+}
+
+void FrameLatencyTracker::BeginCpuWait()
+{
+    cpuWaitStart = Clock::now();
+}
+
+void FrameLatencyTracker::EndCpuWait()
+{
+    cpuWaitTime += ToMilliseconds(Clock::now() - cpuWaitStart);
+}
+
+void FrameLatencyTracker::StartNewFrame(bool _isLowLatency)
+{
+    isLowLatency = _isLowLatency;
+
+    lastCpuWaitTime = cpuWaitTime;
+    cpuWaitTime = 0.0f;
+}
+
+void FrameLatencyTracker::GetStats(RgFrameLatencyStats *pOutStats) const
+{
+    pOutStats->isLowLatencyActive = isLowLatency;
+    pOutStats->lastLatency = lastLatency;
+    pOutStats->averageLatency = averageLatency;
+    pOutStats->lastCpuWaitTime = lastCpuWaitTime;
+    pOutStats->measuredFrameCount = measuredFrameCount;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+
+#include <RTGL1/RTGL1.h>
+
+#include "Common.h"
+
+namespace RTGL1
+{
+
+// Measures CPU time from the submission of a frame to the moment,
+// when its fence was found signaled. As the fence is only polled,
+// the values are the upper bounds of the real latency.
+class FrameLatencyTracker
+{
+public:
+    FrameLatencyTracker();
+    ~FrameLatencyTracker() = default;
+
+    FrameLatencyTracker(const FrameLatencyTracker &other) = delete;
+    FrameLatencyTracker(FrameLatencyTracker &&other) noexcept = delete;
+    FrameLatencyTracker &operator=(const FrameLatencyTracker &other) = delete;
+    FrameLatencyTracker &operator=(FrameLatencyTracker &&other) noexcept = delete;
+
+    void OnSubmit(uint32_t frameIndex);
+    // Must be called when the fence of the frame with the same index is known to be signaled.
+    // Repeated calls for the same submission are ignored.
+    void OnCompleted(uint32_t frameIndex);
+
+    void BeginCpuWait();
+    void EndCpuWait();
+    // Resets the accumulated wait time, should be called once per frame.
+    void StartNewFrame(bool isLowLatency);
+
+    void GetStats(RgFrameLatencyStats *pOutStats) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point submitTime[MAX_FRAMES_IN_FLIGHT];
+    bool isPending[MAX_FRAMES_IN_FLIGHT];
+
+    Clock::time_point cpuWaitStart;
+    float cpuWaitTime;
+    float lastCpuWaitTime;
+
+    bool isLowLatency;
+    float lastLatency;
+    float averageLatency;
+    uint32_t measuredFrameCount;
+};
+
+}
@@ -56,6 +56,7 @@ Framebuffers::Framebuffers(
     allocator(std::move(_allocator)),
     cmdManager(std::move(_cmdManager)),
     currentResolution{},
+    activeResolution{},
     descSetLayout(VK_NULL_HANDLE),
     descPool(VK_NULL_HANDLE),
     descSets{}
@@ -196,9 +197,14 @@ void RTGL1::Framebuffers::CreateSamplers()
     }
 }
 
-bool RTGL1::Framebuffers::PrepareForSize(ResolutionState resolutionState)
+bool RTGL1::Framebuffers::PrepareForSize(ResolutionState allocated, ResolutionState active)
 {
-    if (currentResolution == resolutionState)
+    assert(active.renderWidth <= allocated.renderWidth &&
+           active.renderHeight <= allocated.renderHeight);
+
+    activeResolution = active;
+
+    if (currentResolution == allocated)
     {
         return false;
     }
@@ -206,9 +212,9 @@ bool RTGL1::Framebuffers::PrepareForSize(ResolutionState resolutionState)
     vkDeviceWaitIdle(device);
 
     DestroyImages();
-    CreateImages(resolutionState);
+    CreateImages(allocated);
 
-    assert(currentResolution == resolutionState);
+    assert(currentResolution == allocated);
     return true;
 }
 
@@ -226,7 +232,7 @@ void Framebuffers::PresentToSwapchain(
 
     BarrierOne(cmd, frameIndex, framebufImageIndex);
 
-    VkExtent2D srcExtent = GetFramebufSize(ShFramebuffers_Flags[framebufImageIndex], currentResolution);
+    VkExtent2D srcExtent = GetFramebufSize(ShFramebuffers_Flags[framebufImageIndex], activeResolution);
 
     swapchain->BlitForPresent(
         cmd, GetImage(framebufImageIndex, frameIndex),
@@ -249,8 +255,8 @@ RTGL1::FramebufferImageIndex RTGL1::Framebuffers::BlitForEffects(VkCommandBuffer
     VkImage srcImage = images[src];
     VkImage dstImage = images[dst];
 
-    VkExtent2D srcExtent = GetFramebufSize(ShFramebuffers_Flags[src], currentResolution);
-    VkExtent2D dstExtent = GetFramebufSize(ShFramebuffers_Flags[dst], currentResolution);
+    VkExtent2D srcExtent = GetFramebufSize(ShFramebuffers_Flags[src], activeResolution);
+    VkExtent2D dstExtent = GetFramebufSize(ShFramebuffers_Flags[dst], activeResolution);
 
     // if source has almost the same size as the surface, then use nearest blit
     if (std::abs((int)srcExtent.width  - (int)dstExtent.width) < 8 &&
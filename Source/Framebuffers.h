@@ -51,7 +51,9 @@ public:
     Framebuffers &operator=(const Framebuffers &other) = delete;
     Framebuffers &operator=(Framebuffers &&other) noexcept = delete;
 
-    bool PrepareForSize(ResolutionState resolutionState);
+    // Images are recreated only if allocated size is changed.
+    // Active size is a part of allocated one, that is used in the current frame.
+    bool PrepareForSize(ResolutionState allocated, ResolutionState active);
 
     enum class BarrierType { All, Storage, ColorAttachment, Transfer };
 
@@ -110,6 +112,7 @@ private:
     std::shared_ptr<CommandBufferManager> cmdManager;
 
     ResolutionState currentResolution;
+    ResolutionState activeResolution;
 
     std::vector<VkImage> images;
     std::vector<VkDeviceMemory> imageMemories;
@@ -234,6 +234,7 @@ CONST = {
     "BINDING_PREV_POSITIONS_BUFFER_DYNAMIC"     : 6,
     "BINDING_PREV_INDEX_BUFFER_DYNAMIC"         : 7,
     "BINDING_PER_TRIANGLE_INFO"                 : 8,
+    "BINDING_ANIMATED_MATERIALS"                : 9,
     "BINDING_GLOBAL_UNIFORM"                    : 0,
     "BINDING_ACCELERATION_STRUCTURE_MAIN"       : 0,
     "BINDING_TEXTURES"                          : 0,
@@ -255,6 +256,8 @@ CONST = {
     "BINDING_LENS_FLARES_DRAW_CMDS"             : 1,
     "BINDING_DRAW_LENS_FLARES_INSTANCES"        : 0,
     "BINDING_DECAL_INSTANCES"                   : 0,
+    "BINDING_DECAL_TILES"                       : 1,
+    "BINDING_DECAL_TILE_INDICES"                : 2,
     
     "INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC"                : "1 << 0",
     "INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON"           : "1 << 1",
@@ -288,6 +291,8 @@ CONST = {
     "MATERIAL_NORMAL_INDEX"                         : 2,
     
     "MATERIAL_NO_TEXTURE"                   : 0,
+    # if set, the rest of the bits is an index in the animated material table
+    "MATERIAL_ANIMATED_TEXTURE_BIT"         : "0x80000000u",
 
     "MATERIAL_BLENDING_FLAG_OPAQUE"         : "1 << 0",
     "MATERIAL_BLENDING_FLAG_ALPHA"          : "1 << 1",
@@ -333,12 +338,20 @@ CONST = {
     "COMPUTE_BLOOM_UPSAMPLE_GROUP_SIZE_Y"   : 16,
     "COMPUTE_BLOOM_DOWNSAMPLE_GROUP_SIZE_X" : 16,
     "COMPUTE_BLOOM_DOWNSAMPLE_GROUP_SIZE_Y" : 16,
+    "COMPUTE_BLOOM_DOWNSAMPLE_SINGLE_PASS_GROUP_SIZE" : 16,
     "COMPUTE_BLOOM_APPLY_GROUP_SIZE_X"      : 16,
     "COMPUTE_BLOOM_APPLY_GROUP_SIZE_Y"      : 16,
     "COMPUTE_BLOOM_STEP_COUNT"              : 5,
 
     "COMPUTE_EFFECT_GROUP_SIZE_X"           : 16,
     "COMPUTE_EFFECT_GROUP_SIZE_Y"           : 16,
+    "EFFECT_SIMPLE_FUSED_COLOR_TINT"                : 0,
+    "EFFECT_SIMPLE_FUSED_INVERSE_BW"                : 1,
+    "EFFECT_SIMPLE_FUSED_HUE_SHIFT"                 : 2,
+    "EFFECT_SIMPLE_FUSED_CHROMATIC_ABERRATION"      : 3,
+    "EFFECT_SIMPLE_FUSED_DISTORTED_SIDES"           : 4,
+    "EFFECT_SIMPLE_FUSED_RADIAL_BLUR"               : 5,
+    "EFFECT_SIMPLE_FUSED_COUNT"                     : 6,
 
     "COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_X"    : 16,
     "COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_Y"    : 16,
@@ -362,7 +375,7 @@ CONST = {
     "COMPUTE_ASVGF_GRADIENT_ATROUS_ITERATION_COUNT"     : 4,  
 
     "COMPUTE_INDIRECT_DRAW_FLARES_GROUP_SIZE_X"         : 256,
-    "LENS_FLARES_MAX_DRAW_CMD_COUNT"                    : 512,
+    "COMPUTE_DECAL_APPLY_GROUP_SIZE_X"                  : 16,
 
     "DEBUG_SHOW_FLAG_MOTION_VECTORS"        : "1 << 0",
     "DEBUG_SHOW_FLAG_GRADIENTS"             : "1 << 1",
@@ -378,6 +391,11 @@ CONST = {
     "MEDIA_TYPE_GLASS"                      : 2,
     "MEDIA_TYPE_COUNT"                      : 3,
 
+    "INDIRECT_ILLUMINATION_RATE_FULL"                   : 0,
+    "INDIRECT_ILLUMINATION_RATE_HALF_CHECKERBOARD"      : 1,
+    "INDIRECT_ILLUMINATION_RATE_QUARTER_INTERLEAVED"    : 2,
+    "INDIRECT_ILLUMINATION_RATE_HALF_BLUE_NOISE"        : 3,
+
     "GEOM_INST_NO_TRIANGLE_INFO"            : "UINT32_MAX",
     "SECTOR_INDEX_NONE"                     : ((1 << 15) - 1),
 }
@@ -565,6 +583,17 @@ GLOBAL_UNIFORM_STRUCT = [
     (TYPE_UINT32,       1,      "areFramebufsInitedByRT",           1),
 
     (TYPE_FLOAT32,      1,      "bloomEmissionSaturationBias",      1),
+    (TYPE_UINT32,       1,      "denoiserAtrousIterationCount",     1),
+    (TYPE_UINT32,       1,      "denoiserIndirHalfRes",             1),
+    (TYPE_UINT32,       1,      "denoiserGradientsEnabled",         1),
+
+    (TYPE_UINT32,       1,      "indirectIlluminationRate",         1),
+    (TYPE_FLOAT32,      1,      "renderWidthPrev",                  1),
+    (TYPE_FLOAT32,      1,      "renderHeightPrev",                 1),
+    # ratio of the render size to the allocated framebuffer size
+    (TYPE_FLOAT32,      1,      "renderAreaScaleX",                 1),
+
+    (TYPE_FLOAT32,      1,      "renderAreaScaleY",                 1),
     (TYPE_FLOAT32,      1,      "_pad1",                            1),
     (TYPE_FLOAT32,      1,      "_pad2",                            1),
     (TYPE_FLOAT32,      1,      "_pad3",                            1),
@@ -651,10 +680,12 @@ INDIRECT_DRAW_CMD_STRUCT = [
 
 LENS_FLARES_INSTANCE_STRUCT = [
     (TYPE_UINT32,       1,      "textureIndex",         1),
+    (TYPE_FLOAT32,      1,      "intensity",            1),
 ]
 
 DECAL_INSTANCE_STRUCT = [
     (TYPE_FLOAT32,     44,      "transform",                1),
+    (TYPE_FLOAT32,     44,      "worldToLocal",             1),
     (TYPE_UINT32,       1,      "textureAlbedoAlpha",       1),
     (TYPE_UINT32,       1,      "textureRougnessMetallic",  1),
     (TYPE_UINT32,       1,      "textureNormals",           1),
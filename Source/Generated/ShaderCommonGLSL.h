@@ -18,6 +18,7 @@
 #define BINDING_PREV_POSITIONS_BUFFER_DYNAMIC (6)
 #define BINDING_PREV_INDEX_BUFFER_DYNAMIC (7)
 #define BINDING_PER_TRIANGLE_INFO (8)
+#define BINDING_ANIMATED_MATERIALS (9)
 #define BINDING_GLOBAL_UNIFORM (0)
 #define BINDING_ACCELERATION_STRUCTURE_MAIN (0)
 #define BINDING_TEXTURES (0)
@@ -39,6 +40,8 @@
 #define BINDING_LENS_FLARES_DRAW_CMDS (1)
 #define BINDING_DRAW_LENS_FLARES_INSTANCES (0)
 #define BINDING_DECAL_INSTANCES (0)
+#define BINDING_DECAL_TILES (1)
+#define BINDING_DECAL_TILE_INDICES (2)
 #define INSTANCE_CUSTOM_INDEX_FLAG_DYNAMIC (1 << 0)
 #define INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON (1 << 1)
 #define INSTANCE_CUSTOM_INDEX_FLAG_FIRST_PERSON_VIEWER (1 << 2)
@@ -66,6 +69,7 @@
 #define MATERIAL_ROUGHNESS_METALLIC_EMISSION_INDEX (1)
 #define MATERIAL_NORMAL_INDEX (2)
 #define MATERIAL_NO_TEXTURE (0)
+#define MATERIAL_ANIMATED_TEXTURE_BIT (0x80000000u)
 #define MATERIAL_BLENDING_FLAG_OPAQUE (1 << 0)
 #define MATERIAL_BLENDING_FLAG_ALPHA (1 << 1)
 #define MATERIAL_BLENDING_FLAG_ADD (1 << 2)
@@ -105,11 +109,19 @@
 #define COMPUTE_BLOOM_UPSAMPLE_GROUP_SIZE_Y (16)
 #define COMPUTE_BLOOM_DOWNSAMPLE_GROUP_SIZE_X (16)
 #define COMPUTE_BLOOM_DOWNSAMPLE_GROUP_SIZE_Y (16)
+#define COMPUTE_BLOOM_DOWNSAMPLE_SINGLE_PASS_GROUP_SIZE (16)
 #define COMPUTE_BLOOM_APPLY_GROUP_SIZE_X (16)
 #define COMPUTE_BLOOM_APPLY_GROUP_SIZE_Y (16)
 #define COMPUTE_BLOOM_STEP_COUNT (5)
 #define COMPUTE_EFFECT_GROUP_SIZE_X (16)
 #define COMPUTE_EFFECT_GROUP_SIZE_Y (16)
+#define EFFECT_SIMPLE_FUSED_COLOR_TINT (0)
+#define EFFECT_SIMPLE_FUSED_INVERSE_BW (1)
+#define EFFECT_SIMPLE_FUSED_HUE_SHIFT (2)
+#define EFFECT_SIMPLE_FUSED_CHROMATIC_ABERRATION (3)
+#define EFFECT_SIMPLE_FUSED_DISTORTED_SIDES (4)
+#define EFFECT_SIMPLE_FUSED_RADIAL_BLUR (5)
+#define EFFECT_SIMPLE_FUSED_COUNT (6)
 #define COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_X (16)
 #define COMPUTE_LUM_HISTOGRAM_GROUP_SIZE_Y (16)
 #define COMPUTE_LUM_HISTOGRAM_BIN_COUNT (256)
@@ -128,7 +140,7 @@
 #define COMPUTE_ASVGF_STRATA_SIZE (3)
 #define COMPUTE_ASVGF_GRADIENT_ATROUS_ITERATION_COUNT (4)
 #define COMPUTE_INDIRECT_DRAW_FLARES_GROUP_SIZE_X (256)
-#define LENS_FLARES_MAX_DRAW_CMD_COUNT (512)
+#define COMPUTE_DECAL_APPLY_GROUP_SIZE_X (16)
 #define DEBUG_SHOW_FLAG_MOTION_VECTORS (1 << 0)
 #define DEBUG_SHOW_FLAG_GRADIENTS (1 << 1)
 #define DEBUG_SHOW_FLAG_SECTORS (1 << 2)
@@ -140,6 +152,10 @@
 #define MEDIA_TYPE_WATER (1)
 #define MEDIA_TYPE_GLASS (2)
 #define MEDIA_TYPE_COUNT (3)
+#define INDIRECT_ILLUMINATION_RATE_FULL (0)
+#define INDIRECT_ILLUMINATION_RATE_HALF_CHECKERBOARD (1)
+#define INDIRECT_ILLUMINATION_RATE_QUARTER_INTERLEAVED (2)
+#define INDIRECT_ILLUMINATION_RATE_HALF_BLUE_NOISE (3)
 #define GEOM_INST_NO_TRIANGLE_INFO (UINT32_MAX)
 #define SECTOR_INDEX_NONE (32767)
 
@@ -262,6 +278,14 @@ struct ShGlobalUniform
     uint applyViewProjToLensFlares;
     uint areFramebufsInitedByRT;
     float bloomEmissionSaturationBias;
+    uint denoiserAtrousIterationCount;
+    uint denoiserIndirHalfRes;
+    uint denoiserGradientsEnabled;
+    uint indirectIlluminationRate;
+    float renderWidthPrev;
+    float renderHeightPrev;
+    float renderAreaScaleX;
+    float renderAreaScaleY;
     float _pad1;
     float _pad2;
     float _pad3;
@@ -343,11 +367,13 @@ struct ShIndirectDrawCommand
 struct ShLensFlareInstance
 {
     uint textureIndex;
+    float intensity;
 };
 
 struct ShDecalInstance
 {
     mat4 transform;
+    mat4 worldToLocal;
     uint textureAlbedoAlpha;
     uint textureRougnessMetallic;
     uint textureNormals;
@@ -542,7 +542,10 @@ void RTGL1::GeomInfoManager::WriteStaticGeomInfoMaterials(uint32_t simpleIndex,
         // copy new material info
         uint32_t *pMatArr = &dst->materials0A;
 
-        memcpy(&pMatArr[layer * TEXTURES_PER_MATERIAL_COUNT], src.indices, TEXTURES_PER_MATERIAL_COUNT * sizeof(uint32_t));
+        // no materials2C member, don't overwrite the next one
+        const uint32_t count = layer == MATERIALS_MAX_LAYER_COUNT - 1 ? TEXTURES_PER_MATERIAL_COUNT - 1 : TEXTURES_PER_MATERIAL_COUNT;
+
+        memcpy(&pMatArr[layer * TEXTURES_PER_MATERIAL_COUNT], src.indices, count * sizeof(uint32_t));
 
         // mark to be copied
         MarkGeomInfoIndexToCopy(i, simpleToLocalIndex[simpleIndex], flagsId);
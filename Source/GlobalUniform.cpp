@@ -22,6 +22,7 @@
 
 #include "Generated/ShaderCommonC.h"
 #include "CmdLabel.h"
+#include "Matrix.h"
 #include <cstring>
 
 using namespace RTGL1;
@@ -119,6 +120,25 @@ void GlobalUniform::Upload(VkCommandBuffer cmd, uint32_t frameIndex)
     uniformBuffer->CopyFromStaging(cmd, frameIndex, sizeof(ShGlobalUniform));
 }
 
+void GlobalUniform::LateLatchView(uint32_t frameIndex, const float view[16])
+{
+    ShGlobalUniform *gu = uniformData.get();
+
+    memcpy(gu->view, view, 16 * sizeof(float));
+    Matrix::Inverse(gu->invView, view);
+
+    gu->cameraPosition[0] = gu->invView[12];
+    gu->cameraPosition[1] = gu->invView[13];
+    gu->cameraPosition[2] = gu->invView[14];
+
+    // patch only the changed members, the rest is still in the staging buffer
+    auto *mapped = static_cast<ShGlobalUniform *>(uniformBuffer->GetMapped(frameIndex));
+
+    memcpy(mapped->view, gu->view, sizeof(gu->view));
+    memcpy(mapped->invView, gu->invView, sizeof(gu->invView));
+    memcpy(mapped->cameraPosition, gu->cameraPosition, sizeof(gu->cameraPosition));
+}
+
 ShGlobalUniform *GlobalUniform::GetData()
 {
     return uniformData.get();
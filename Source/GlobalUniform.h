@@ -40,6 +40,9 @@ public:
 
     // Send current data
     void Upload(VkCommandBuffer cmd, uint32_t frameIndex);
+    // Overwrite the view matrix in the already uploaded data. As the copy
+    // is executed by GPU, it's valid until the submission of the frame cmd.
+    void LateLatchView(uint32_t frameIndex, const float view[16]);
 
     // Getters for modifying uniform buffer data that will be uploaded
     ShGlobalUniform *GetData();
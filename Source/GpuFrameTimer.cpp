@@ -0,0 +1,161 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "GpuFrameTimer.h"
+
+using namespace RTGL1;
+
+namespace
+{
+
+// frame begin and end, upload begin and end
+constexpr uint32_t QUERIES_PER_FRAME = 4;
+
+}
+
+GpuFrameTimer::GpuFrameTimer(VkDevice _device, const std::shared_ptr<PhysicalDevice> &_physDevice)
+:
+    device(_device),
+    queryPool(VK_NULL_HANDLE),
+    timestampPeriod(_physDevice->GetTimestampPeriod()),
+    wasWritten{},
+    wasUploadBegun{},
+    wasUploadWritten{},
+    lastFrameTime(-1.0f),
+    lastUploadTime(-1.0f)
+{
+    if (timestampPeriod <= 0.0f)
+    {
+        return;
+    }
+
+    VkQueryPoolCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    info.queryCount = MAX_FRAMES_IN_FLIGHT * QUERIES_PER_FRAME;
+
+    VkResult r = vkCreateQueryPool(device, &info, nullptr, &queryPool);
+    VK_CHECKERROR(r);
+
+    SET_DEBUG_NAME(device, queryPool, VK_OBJECT_TYPE_QUERY_POOL, "GPU frame timer query pool");
+}
+
+GpuFrameTimer::~GpuFrameTimer()
+{
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+    }
+}
+
+void GpuFrameTimer::ReadResults(uint32_t frameIndex)
+{
+    if (queryPool == VK_NULL_HANDLE || !wasWritten[frameIndex])
+    {
+        return;
+    }
+
+    const uint32_t queryCount = wasUploadWritten[frameIndex] ? 4 : 2;
+    uint64_t timestamps[QUERIES_PER_FRAME] = {};
+
+    VkResult r = vkGetQueryPoolResults(
+        device, queryPool,
+        frameIndex * QUERIES_PER_FRAME, queryCount,
+        sizeof(timestamps), timestamps, sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT);
+
+    // fence was waited, so results must be available,
+    // but ignore the frame in any other case
+    if (r != VK_SUCCESS)
+    {
+        return;
+    }
+
+    if (timestamps[1] >= timestamps[0])
+    {
+        lastFrameTime = (float)((double)(timestamps[1] - timestamps[0]) * timestampPeriod / 1000000.0);
+    }
+
+    if (wasUploadWritten[frameIndex] && timestamps[3] >= timestamps[2])
+    {
+        lastUploadTime = (float)((double)(timestamps[3] - timestamps[2]) * timestampPeriod / 1000000.0);
+    }
+}
+
+void GpuFrameTimer::WriteBegin(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (queryPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkCmdResetQueryPool(cmd, queryPool, frameIndex * QUERIES_PER_FRAME, QUERIES_PER_FRAME);
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, frameIndex * QUERIES_PER_FRAME + 0);
+
+    wasUploadBegun[frameIndex] = false;
+    wasUploadWritten[frameIndex] = false;
+}
+
+void GpuFrameTimer::WriteEnd(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (queryPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, frameIndex * QUERIES_PER_FRAME + 1);
+    wasWritten[frameIndex] = true;
+}
+
+bool GpuFrameTimer::WriteUploadBegin(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    // a query can't be written twice without a reset
+    if (queryPool == VK_NULL_HANDLE || wasUploadBegun[frameIndex])
+    {
+        return false;
+    }
+
+    wasUploadBegun[frameIndex] = true;
+
+    // wait for the previous commands, so only the upload is measured
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, frameIndex * QUERIES_PER_FRAME + 2);
+    return true;
+}
+
+void GpuFrameTimer::WriteUploadEnd(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (queryPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, frameIndex * QUERIES_PER_FRAME + 3);
+    wasUploadWritten[frameIndex] = true;
+}
+
+float GpuFrameTimer::GetLastFrameTime() const
+{
+    return lastFrameTime;
+}
+
+float GpuFrameTimer::GetLastUploadTime() const
+{
+    return lastUploadTime;
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+#include "PhysicalDevice.h"
+
+namespace RTGL1
+{
+
+// Measures GPU time of the frame command buffers using timestamp queries.
+// Also, measures a static material batch upload, that was recorded in a frame.
+class GpuFrameTimer
+{
+public:
+    GpuFrameTimer(VkDevice device, const std::shared_ptr<PhysicalDevice> &physDevice);
+    ~GpuFrameTimer();
+
+    GpuFrameTimer(const GpuFrameTimer &other) = delete;
+    GpuFrameTimer(GpuFrameTimer &&other) noexcept = delete;
+    GpuFrameTimer &operator=(const GpuFrameTimer &other) = delete;
+    GpuFrameTimer &operator=(GpuFrameTimer &&other) noexcept = delete;
+
+    // Must be called after waiting for the fence of the frame with the same index.
+    void ReadResults(uint32_t frameIndex);
+
+    void WriteBegin(VkCommandBuffer cmd, uint32_t frameIndex);
+    void WriteEnd(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    // Must be called between WriteBegin and WriteEnd, with the same command buffer.
+    // Only the first upload in a frame is measured.
+    bool WriteUploadBegin(VkCommandBuffer cmd, uint32_t frameIndex);
+    void WriteUploadEnd(VkCommandBuffer cmd, uint32_t frameIndex);
+
+    // In milliseconds. Negative, if there is no measured frame yet.
+    float GetLastFrameTime() const;
+    // In milliseconds. Negative, if there is no measured upload yet.
+    float GetLastUploadTime() const;
+
+private:
+    VkDevice device;
+    VkQueryPool queryPool;
+    float timestampPeriod;
+
+    bool wasWritten[MAX_FRAMES_IN_FLIGHT];
+    bool wasUploadBegun[MAX_FRAMES_IN_FLIGHT];
+    bool wasUploadWritten[MAX_FRAMES_IN_FLIGHT];
+    float lastFrameTime;
+    float lastUploadTime;
+};
+
+}
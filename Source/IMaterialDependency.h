@@ -29,8 +29,9 @@ class IMaterialDependency
 {
 public:
     virtual ~IMaterialDependency() = default;
-    // If material was changed, for example, animated texture changed its current frame,
-    // then this function will be called. If material was destroyed, "newInfo" will have empty texture indices.
+    // If material was destroyed, this function will be called with empty texture indices in "newInfo".
+    // Animated material frame changes are resolved on GPU through AnimatedMaterialTable,
+    // and reported here only if the table didn't have a free slot for the material.
     virtual void OnMaterialChange(uint32_t materialIndex, const MaterialTextures &newInfo) = 0;
 };
 
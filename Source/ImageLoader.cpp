@@ -22,13 +22,20 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #include <ktx.h>
 #include <ktxvulkan.h>
 
 using namespace RTGL1;
 
-ImageLoader::ImageLoader(std::shared_ptr<UserFileLoad> _userFileLoad) : userFileLoad(std::move( _userFileLoad))
+ImageLoader::ImageLoader(std::shared_ptr<UserFileLoad> _userFileLoad, 
+                         std::shared_ptr<const OverrideFolderIndex> _folderIndex,
+                         std::shared_ptr<const TexturePack> _texturePack)
+    :
+    userFileLoad(std::move( _userFileLoad)),
+    folderIndex(std::move(_folderIndex)),
+    texturePack(std::move(_texturePack))
 {}
 
 ImageLoader::~ImageLoader()
@@ -40,6 +47,12 @@ bool ImageLoader::LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture)
 {
     KTX_error_code r;
 
+    // avoid failing file opens
+    if (folderIndex && !folderIndex->MayExist(pFilePath))
+    {
+        return false;
+    }
+
     if (userFileLoad->Exists())
     {
         auto fileHandle = userFileLoad->Open(pFilePath);
@@ -78,6 +91,11 @@ bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo)
         return false;
     }
 
+    if (texturePack && LoadFromPack(pFilePath, pResultInfo))
+    {
+        return true;
+    }
+
     ktxTexture *pTexture = nullptr;
     bool loaded = LoadTextureFile(pFilePath, &pTexture);
 
@@ -86,6 +104,14 @@ bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo)
         return false;
     }
 
+    FillResultInfo(pTexture, pResultInfo);
+
+    loadedImages.push_back(static_cast<void*>(pTexture));
+    return true;
+}
+
+void ImageLoader::FillResultInfo(ktxTexture *pTexture, ResultInfo *pResultInfo)
+{
     assert(pTexture->numDimensions == 2);
     assert(pTexture->numLevels <= MAX_PREGENERATED_MIPMAP_LEVELS);
     assert(pTexture->numLayers == 1);
@@ -118,9 +144,142 @@ bool ImageLoader::Load(const char *pFilePath, ResultInfo *pResultInfo)
         pResultInfo->levelOffsets[level] = static_cast<uint32_t>(offset);
         pResultInfo->levelSizes[level] = static_cast<uint32_t>(size);
     }
+}
+
+bool ImageLoader::LoadFromPack(const char *pFilePath, ResultInfo *pResultInfo)
+{
+    uint64_t fileSize = 0;
+    const uint8_t *pFile = texturePack->Find(pFilePath, &fileSize);
 
+    if (pFile == nullptr)
+    {
+        return false;
+    }
 
-    loadedImages.push_back(static_cast<void*>(pTexture));
+    // mapped memory can be used directly
+    if (ParseUncompressedKTX2(pFile, fileSize, pResultInfo))
+    {
+        return true;
+    }
+
+    // supercompressed, let libktx inflate it
+    ktxTexture *pTexture = nullptr;
+    KTX_error_code r = ktxTexture_CreateFromMemory(pFile, static_cast<ktx_size_t>(fileSize),
+                                                   KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+                                                   &pTexture);
+
+    if (r != KTX_SUCCESS)
+    {
+        *pResultInfo = {};
+        return false;
+    }
+
+    FillResultInfo(pTexture, pResultInfo);
+
+    loadedImages.push_back(static_cast<void *>(pTexture));
+    return true;
+}
+
+bool ImageLoader::ParseUncompressedKTX2(const uint8_t *pFile, uint64_t fileSize, ResultInfo *pResultInfo)
+{
+    static constexpr uint8_t KTX2_IDENTIFIER[] =
+    {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+
+    // identifier, 9 uint32 fields and 4 uint32 + 2 uint64 for dfd, kvd, sgd
+    constexpr uint64_t KTX2_HEADER_SIZE = 80;
+    constexpr uint64_t KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;
+
+    if (fileSize < KTX2_HEADER_SIZE || memcmp(pFile, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+    {
+        return false;
+    }
+
+    const auto readU32 = [pFile] (uint64_t offset)
+    {
+        uint32_t v;
+        memcpy(&v, pFile + offset, sizeof(v));
+        return v;
+    };
+
+    const auto readU64 = [pFile] (uint64_t offset)
+    {
+        uint64_t v;
+        memcpy(&v, pFile + offset, sizeof(v));
+        return v;
+    };
+
+    const uint32_t vkFormat = readU32(12);
+    const uint32_t pixelWidth = readU32(20);
+    const uint32_t pixelHeight = readU32(24);
+    const uint32_t pixelDepth = readU32(28);
+    const uint32_t layerCount = readU32(32);
+    const uint32_t faceCount = readU32(36);
+    const uint32_t levelCount = std::max(readU32(40), 1u);
+    const uint32_t supercompressionScheme = readU32(44);
+
+    if (vkFormat == VK_FORMAT_UNDEFINED || supercompressionScheme != 0)
+    {
+        return false;
+    }
+
+    if (pixelHeight == 0 || pixelDepth > 1 || layerCount > 1 || faceCount != 1)
+    {
+        assert(0 && "Only 2D textures are supported");
+        return false;
+    }
+
+    if (fileSize < KTX2_HEADER_SIZE + levelCount * KTX2_LEVEL_INDEX_ENTRY_SIZE)
+    {
+        return false;
+    }
+
+    ResultInfo info = {};
+    info.levelCount = std::min(levelCount, MAX_PREGENERATED_MIPMAP_LEVELS);
+
+    uint64_t byteOffsets[MAX_PREGENERATED_MIPMAP_LEVELS];
+    uint64_t byteLengths[MAX_PREGENERATED_MIPMAP_LEVELS];
+
+    uint64_t dataStart = UINT64_MAX;
+    uint64_t dataEnd = 0;
+
+    for (uint32_t level = 0; level < info.levelCount; level++)
+    {
+        const uint64_t entry = KTX2_HEADER_SIZE + level * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+
+        byteOffsets[level] = readU64(entry);
+        byteLengths[level] = readU64(entry + 8);
+
+        if (byteLengths[level] == 0 || byteOffsets[level] > fileSize || byteLengths[level] > fileSize - byteOffsets[level])
+        {
+            return false;
+        }
+
+        dataStart = std::min(dataStart, byteOffsets[level]);
+        dataEnd = std::max(dataEnd, byteOffsets[level] + byteLengths[level]);
+    }
+
+    if (dataEnd - dataStart > UINT32_MAX)
+    {
+        return false;
+    }
+
+    // levels are stored from the smallest to the largest,
+    // so point to the start of the level data and make offsets relative to it
+    for (uint32_t level = 0; level < info.levelCount; level++)
+    {
+        info.levelOffsets[level] = static_cast<uint32_t>(byteOffsets[level] - dataStart);
+        info.levelSizes[level] = static_cast<uint32_t>(byteLengths[level]);
+    }
+
+    info.isPregenerated = true;
+    info.pData = pFile + dataStart;
+    info.dataSize = static_cast<uint32_t>(dataEnd - dataStart);
+    info.baseSize = { pixelWidth, pixelHeight };
+    info.format = static_cast<VkFormat>(vkFormat);
+
+    *pResultInfo = info;
     return true;
 }
 
@@ -25,6 +25,8 @@
 #include "Common.h"
 #include "Const.h"
 #include "UserFunction.h"
+#include "OverrideFolderIndex.h"
+#include "TexturePack.h"
 
 struct ktxTexture;
 
@@ -56,7 +58,11 @@ public:
     };
 
 public:
-    explicit ImageLoader(std::shared_ptr<UserFileLoad> userFileLoad);
+    // If folderIndex is not null, files that are not in it won't be opened.
+    // If texturePack is not null, files are searched in it first.
+    explicit ImageLoader(std::shared_ptr<UserFileLoad> userFileLoad,
+                         std::shared_ptr<const OverrideFolderIndex> folderIndex = nullptr,
+                         std::shared_ptr<const TexturePack> texturePack = nullptr);
     ~ImageLoader();
 
     ImageLoader(const ImageLoader &other) = delete;
@@ -72,9 +78,14 @@ public:
 
 private:
     bool LoadTextureFile(const char *pFilePath, ktxTexture **ppTexture);
+    bool LoadFromPack(const char *pFilePath, ResultInfo *pResultInfo);
+    static bool ParseUncompressedKTX2(const uint8_t *pFile, uint64_t fileSize, ResultInfo *pResultInfo);
+    void FillResultInfo(ktxTexture *pTexture, ResultInfo *pResultInfo);
 
 private:
     std::shared_ptr<UserFileLoad> userFileLoad;
+    std::shared_ptr<const OverrideFolderIndex> folderIndex;
+    std::shared_ptr<const TexturePack> texturePack;
     std::vector<void *> loadedImages;
 };
 
@@ -20,12 +20,17 @@
 
 #include "LensFlares.h"
 
+#include <algorithm>
+
+#include "RgException.h"
 #include "Utils.h"
 #include "Generated/ShaderCommonC.h"
 
 
-constexpr VkDeviceSize MAX_VERTEX_COUNT   = 1 << 16;
-constexpr VkDeviceSize MAX_INDEX_COUNT    = 1 << 18;
+// Initial capacities, buffers are doubled when they are exceeded
+constexpr uint32_t INITIAL_FLARE_CAPACITY   = 512;
+constexpr uint32_t INITIAL_VERTEX_CAPACITY  = 1 << 16;
+constexpr uint32_t INITIAL_INDEX_CAPACITY   = 1 << 18;
 
 constexpr const char *VERT_SHADER = "VertLensFlare";
 constexpr const char *FRAG_SHADER = "FragLensFlare";
@@ -39,20 +44,23 @@ struct RasterizerVertex
 };
 
 
-// indirectDrawCommands: one uint32_t - for count, the rest - cmds
-constexpr VkDeviceSize GetIndirectDrawCommandsOffset()
+// indirectDrawCommands: one uint32_t (padded to 16 bytes) - for count, the rest - cmds
+constexpr VkDeviceSize GetIndirectDrawCountOffset()
 {
     return 0;
 }
-constexpr VkDeviceSize GetIndirectDrawCountOffset()
+constexpr VkDeviceSize GetIndirectDrawCommandsOffset()
 {
-    return LENS_FLARES_MAX_DRAW_CMD_COUNT * sizeof(RTGL1::ShIndirectDrawCommand);
+    return 16;
 }
-constexpr RTGL1::ShIndirectDrawCommand *GetIndirectDrawCommandsArrayStart(void *pCullingInputBuffer)
+constexpr VkDeviceSize GetIndirectDrawCommandsSize(uint32_t flareCapacity)
 {
-    return (RTGL1::ShIndirectDrawCommand *)((uint8_t*)pCullingInputBuffer + GetIndirectDrawCommandsOffset());
+    return GetIndirectDrawCommandsOffset() + flareCapacity * sizeof(RTGL1::ShIndirectDrawCommand);
 }
 
+constexpr VkBufferUsageFlags INDIRECT_DRAW_COMMANDS_USAGE =
+    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
 
 static_assert(sizeof(RasterizerVertex) == sizeof(RgRasterizedGeometryVertexStruct), "");
 static_assert(offsetof(RasterizerVertex, position) == offsetof(RgRasterizedGeometryVertexStruct, position),    "");
@@ -77,12 +85,19 @@ RTGL1::LensFlares::LensFlares(
     const RgInstanceCreateInfo &_instanceInfo)
 :
     device(_device),
+    allocator(_allocator),
     uniform(std::move(_uniform)),
     framebuffers(std::move(_framebuffers)),
     textureManager(std::move(_textureManager)),
     cullingInputCount(0),
     vertexCount(0),
     indexCount(0),
+    flareCapacity(INITIAL_FLARE_CAPACITY),
+    vertexCapacity(INITIAL_VERTEX_CAPACITY),
+    indexCapacity(INITIAL_INDEX_CAPACITY),
+    isRecordingStatic(false),
+    staticSubmitRequested(false),
+    staticCopyPending(false),
     vertFragPipelineLayout(VK_NULL_HANDLE),
     rasterDescPool(VK_NULL_HANDLE),
     rasterDescSet(VK_NULL_HANDLE),
@@ -103,29 +118,30 @@ RTGL1::LensFlares::LensFlares(
 
 
     cullingInput->Create(
-        LENS_FLARES_MAX_DRAW_CMD_COUNT * sizeof(ShIndirectDrawCommand),
+        flareCapacity * sizeof(ShIndirectDrawCommand),
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, "Lens flares culling input");
 
     indirectDrawCommands.Init(
         _allocator, 
-        LENS_FLARES_MAX_DRAW_CMD_COUNT * sizeof(ShIndirectDrawCommand) + sizeof(uint32_t),
-        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Lens flares draw cmds");
+        GetIndirectDrawCommandsSize(flareCapacity),
+        INDIRECT_DRAW_COMMANDS_USAGE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Lens flares draw cmds");
 
     vertexBuffer->Create(
-        MAX_VERTEX_COUNT * sizeof(RasterizerVertex),
+        vertexCapacity * sizeof(RasterizerVertex),
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "Lens flares vertex buffer");
     
     indexBuffer->Create(
-        MAX_INDEX_COUNT * sizeof(uint32_t),
+        indexCapacity * sizeof(uint32_t),
         VK_BUFFER_USAGE_INDEX_BUFFER_BIT, "Lens flares index buffer");
 
     instanceBuffer->Create(
-        LENS_FLARES_MAX_DRAW_CMD_COUNT * sizeof(ShLensFlareInstance),
+        flareCapacity * sizeof(ShLensFlareInstance),
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Lens flares instance buffer");
 
 
     CreateCullDescriptors();
     CreateRasterDescriptors();
+    UpdateDescriptors();
 
 
     CreatePipelineLayouts(uniform->GetDescSetLayout(), textureManager->GetDescSetLayout(), rasterDescSetLayout, cullDescSetLayout, framebuffers->GetDescSetLayout());
@@ -153,29 +169,82 @@ RTGL1::LensFlares::~LensFlares()
 
 void RTGL1::LensFlares::PrepareForFrame(uint32_t frameIndex)
 {
-    cullingInputCount = 0;
-    vertexCount = 0;
-    indexCount = 0;
+    if (staticSubmitRequested)
+    {
+        // static lens flares are drawn from this frame
+        std::swap(staticSubmitted, staticRecording);
+        staticRecording.Clear();
+
+        staticIntensityChanged.clear();
+        staticCopyPending = true;
+        staticSubmitRequested = false;
+    }
+
+    // dynamic lens flares are placed after static ones
+    cullingInputCount = (uint32_t)staticSubmitted.cullingInput.size();
+    vertexCount = (uint32_t)staticSubmitted.vertices.size();
+    indexCount = (uint32_t)staticSubmitted.indices.size();
+
+    EnsureCapacity(frameIndex, cullingInputCount, vertexCount, indexCount);
 }
 
 void RTGL1::LensFlares::Upload(uint32_t frameIndex, const RgLensFlareUploadInfo &uploadInfo)
 {
-    if (cullingInputCount + 1 >= LENS_FLARES_MAX_DRAW_CMD_COUNT)
+    if (uploadInfo.isStatic)
     {
-        assert(!"Too many lens flares");
-        return;
+        AddStatic(uploadInfo);
     }
-    if (vertexCount + uploadInfo.vertexCount >= MAX_VERTEX_COUNT)
+    else
     {
-        assert(!"Too many lens flare vertices");
-        return;
+        AddDynamic(frameIndex, uploadInfo);
     }
-    if (indexCount + uploadInfo.indexCount >= MAX_INDEX_COUNT)
+}
+
+void RTGL1::LensFlares::AddStatic(const RgLensFlareUploadInfo &uploadInfo)
+{
+    if (!isRecordingStatic)
     {
-        assert(!"Too many lens flare indices");
-        return;
+        throw RgException(RG_WRONG_FUNCTION_CALL, "Static lens flares must be uploaded only between rgStartNewScene and rgSubmitStaticGeometries calls");
     }
 
+    StaticLensFlares &st = staticRecording;
+
+    const uint32_t instanceIndex = (uint32_t)st.cullingInput.size();
+
+    if (!st.uniqueIDToIndex.emplace(uploadInfo.uniqueID, instanceIndex).second)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Static lens flare with unique ID=" + std::to_string(uploadInfo.uniqueID) + " already exists");
+    }
+
+    ShIndirectDrawCommand input = {};
+    input.vertexOffset = (int32_t)st.vertices.size();
+    input.firstIndex = (uint32_t)st.indices.size();
+    input.indexCount = uploadInfo.indexCount;
+    input.firstInstance = instanceIndex;
+    input.instanceCount = 1;
+    input.positionToCheck_X = uploadInfo.pointToCheck.data[0];
+    input.positionToCheck_Y = uploadInfo.pointToCheck.data[1];
+    input.positionToCheck_Z = uploadInfo.pointToCheck.data[2];
+
+    ShLensFlareInstance instance = {};
+    instance.textureIndex = textureManager->GetMaterialTextures(uploadInfo.material).indices[MATERIAL_ALBEDO_ALPHA_INDEX];
+    instance.intensity = 1.0f;
+
+    const uint32_t *pIndices = (const uint32_t *)uploadInfo.pIndexData;
+
+    st.vertices.insert(st.vertices.end(), uploadInfo.pVertexData, uploadInfo.pVertexData + uploadInfo.vertexCount);
+    st.indices.insert(st.indices.end(), pIndices, pIndices + uploadInfo.indexCount);
+    st.cullingInput.push_back(input);
+    st.instances.push_back(instance);
+}
+
+void RTGL1::LensFlares::AddDynamic(uint32_t frameIndex, const RgLensFlareUploadInfo &uploadInfo)
+{
+    EnsureCapacity(frameIndex, 
+                   cullingInputCount + 1, 
+                   vertexCount + uploadInfo.vertexCount, 
+                   indexCount + uploadInfo.indexCount);
+
 
     const uint32_t instanceIndex = cullingInputCount;
     const uint32_t vertexIndex = vertexCount;
@@ -202,6 +271,7 @@ void RTGL1::LensFlares::Upload(uint32_t frameIndex, const RgLensFlareUploadInfo
     // instances
     ShLensFlareInstance instance = {};
     instance.textureIndex = textureManager->GetMaterialTextures(uploadInfo.material).indices[MATERIAL_ALBEDO_ALPHA_INDEX];
+    instance.intensity = 1.0f;
 
     {
         ShLensFlareInstance *dst = (ShLensFlareInstance *)instanceBuffer->GetMapped(frameIndex);
@@ -221,22 +291,209 @@ void RTGL1::LensFlares::Upload(uint32_t frameIndex, const RgLensFlareUploadInfo
     input.positionToCheck_Z = uploadInfo.pointToCheck.data[2];
 
     {
-        ShIndirectDrawCommand *dst = GetIndirectDrawCommandsArrayStart(cullingInput->GetMapped(frameIndex));
+        ShIndirectDrawCommand *dst = (ShIndirectDrawCommand *)cullingInput->GetMapped(frameIndex);
         memcpy(&dst[instanceIndex], &input, sizeof(ShIndirectDrawCommand));
     }
 }
 
+void RTGL1::LensFlares::UpdateIntensity(const RgUpdateLensFlareIntensityInfo &updateInfo)
+{
+    const float intensity = std::max(0.0f, updateInfo.intensity);
+
+    // not submitted yet, so it will be fully copied anyway
+    {
+        auto f = staticRecording.uniqueIDToIndex.find(updateInfo.staticUniqueID);
+
+        if (f != staticRecording.uniqueIDToIndex.end())
+        {
+            staticRecording.instances[f->second].intensity = intensity;
+            staticRecording.cullingInput[f->second].instanceCount = intensity > 0.0f ? 1 : 0;
+            return;
+        }
+    }
+
+    auto f = staticSubmitted.uniqueIDToIndex.find(updateInfo.staticUniqueID);
+
+    if (f == staticSubmitted.uniqueIDToIndex.end())
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Can't find static lens flare with unique ID=" + std::to_string(updateInfo.staticUniqueID));
+    }
+
+    staticSubmitted.instances[f->second].intensity = intensity;
+    // zero instance count is skipped by culling
+    staticSubmitted.cullingInput[f->second].instanceCount = intensity > 0.0f ? 1 : 0;
+
+    staticIntensityChanged.insert(f->second);
+}
+
+void RTGL1::LensFlares::StartNewStatic()
+{
+    staticRecording.Clear();
+    isRecordingStatic = true;
+    staticSubmitRequested = false;
+}
+
+void RTGL1::LensFlares::SubmitStatic()
+{
+    // submit even if nothing was recorded, 
+    // so static lens flares will be cleared
+    if (isRecordingStatic)
+    {
+        staticSubmitRequested = true;
+        isRecordingStatic = false;
+    }
+}
+
+void RTGL1::LensFlares::StaticLensFlares::Clear()
+{
+    vertices.clear();
+    indices.clear();
+    cullingInput.clear();
+    instances.clear();
+    uniqueIDToIndex.clear();
+}
+
 void RTGL1::LensFlares::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
 {
-    if (cullingInputCount == 0 || vertexCount == 0 || indexCount == 0)
+    const uint32_t staticFlareCount = (uint32_t)staticSubmitted.cullingInput.size();
+    const uint32_t staticVertexCount = (uint32_t)staticSubmitted.vertices.size();
+    const uint32_t staticIndexCount = (uint32_t)staticSubmitted.indices.size();
+
+    // where dynamic data starts
+    uint32_t flareStart = staticFlareCount;
+    uint32_t vertexStart = staticVertexCount;
+    uint32_t indexStart = staticIndexCount;
+
+    auto *dstCullingInput = (ShIndirectDrawCommand *)cullingInput->GetMapped(frameIndex);
+    auto *dstInstances = (ShLensFlareInstance *)instanceBuffer->GetMapped(frameIndex);
+
+    if (staticCopyPending)
+    {
+        // write static data to the beginning of the staging, and copy it along with dynamic
+        memcpy(vertexBuffer->GetMapped(frameIndex), staticSubmitted.vertices.data(), staticVertexCount * sizeof(RasterizerVertex));
+        memcpy(indexBuffer->GetMapped(frameIndex),  staticSubmitted.indices.data(),  staticIndexCount * sizeof(uint32_t));
+        memcpy(dstCullingInput, staticSubmitted.cullingInput.data(), staticFlareCount * sizeof(ShIndirectDrawCommand));
+        memcpy(dstInstances,    staticSubmitted.instances.data(),    staticFlareCount * sizeof(ShLensFlareInstance));
+
+        flareStart = vertexStart = indexStart = 0;
+
+        staticCopyPending = false;
+        staticIntensityChanged.clear();
+    }
+
+    std::vector<VkBufferCopy> cullingInputCopies;
+    std::vector<VkBufferCopy> instanceCopies;
+
+    // only intensity of the static lens flares can be changed
+    for (uint32_t i : staticIntensityChanged)
+    {
+        dstCullingInput[i] = staticSubmitted.cullingInput[i];
+        dstInstances[i] = staticSubmitted.instances[i];
+
+        cullingInputCopies.push_back({ i * sizeof(ShIndirectDrawCommand), i * sizeof(ShIndirectDrawCommand), sizeof(ShIndirectDrawCommand) });
+        instanceCopies.push_back({ i * sizeof(ShLensFlareInstance), i * sizeof(ShLensFlareInstance), sizeof(ShLensFlareInstance) });
+    }
+    staticIntensityChanged.clear();
+
+    if (cullingInputCount > flareStart)
+    {
+        const uint32_t count = cullingInputCount - flareStart;
+
+        cullingInputCopies.push_back({ flareStart * sizeof(ShIndirectDrawCommand), flareStart * sizeof(ShIndirectDrawCommand), count * sizeof(ShIndirectDrawCommand) });
+        instanceCopies.push_back({ flareStart * sizeof(ShLensFlareInstance), flareStart * sizeof(ShLensFlareInstance), count * sizeof(ShLensFlareInstance) });
+    }
+
+    if (!cullingInputCopies.empty())
+    {
+        cullingInput->CopyFromStaging(cmd, frameIndex, cullingInputCopies.data(), (uint32_t)cullingInputCopies.size());
+        instanceBuffer->CopyFromStaging(cmd, frameIndex, instanceCopies.data(), (uint32_t)instanceCopies.size());
+    }
+
+    if (vertexCount > vertexStart)
+    {
+        vertexBuffer->CopyFromStaging(cmd, frameIndex, (vertexCount - vertexStart) * sizeof(RasterizerVertex), vertexStart * sizeof(RasterizerVertex));
+    }
+
+    if (indexCount > indexStart)
+    {
+        indexBuffer->CopyFromStaging(cmd, frameIndex, (indexCount - indexStart) * sizeof(uint32_t), indexStart * sizeof(uint32_t));
+    }
+}
+
+void RTGL1::LensFlares::EnsureCapacity(uint32_t frameIndex, uint32_t requiredFlareCount, uint32_t requiredVertexCount, uint32_t requiredIndexCount)
+{
+    if (requiredFlareCount <= flareCapacity &&
+        requiredVertexCount <= vertexCapacity &&
+        requiredIndexCount <= indexCapacity)
     {
         return;
     }
 
-      cullingInput->CopyFromStaging(cmd, frameIndex, cullingInputCount * sizeof(ShIndirectDrawCommand));
-      vertexBuffer->CopyFromStaging(cmd, frameIndex, vertexCount       * sizeof(RasterizerVertex));
-       indexBuffer->CopyFromStaging(cmd, frameIndex, indexCount        * sizeof(uint32_t));
-    instanceBuffer->CopyFromStaging(cmd, frameIndex, cullingInputCount * sizeof(ShLensFlareInstance));
+    // buffers and descriptor sets can be in use by the frames in flight;
+    // growing is rare, as capacity is doubled
+    vkDeviceWaitIdle(device);
+
+    const auto grow = [] (uint32_t capacity, uint32_t required)
+    {
+        while (capacity < required)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    };
+
+    // recreate, but keep the data that was already written to the staging in this frame
+    const auto recreate = [this, frameIndex] (std::unique_ptr<AutoBuffer> &buffer, VkDeviceSize newSize, VkBufferUsageFlags usage, const char *pDebugName, VkDeviceSize sizeToKeep)
+    {
+        auto newBuffer = std::make_unique<AutoBuffer>(allocator);
+        newBuffer->Create(newSize, usage, pDebugName);
+
+        memcpy(newBuffer->GetMapped(frameIndex), buffer->GetMapped(frameIndex), sizeToKeep);
+
+        buffer = std::move(newBuffer);
+    };
+
+    if (requiredFlareCount > flareCapacity)
+    {
+        flareCapacity = grow(flareCapacity, requiredFlareCount);
+
+        recreate(cullingInput, flareCapacity * sizeof(ShIndirectDrawCommand),
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, "Lens flares culling input",
+                 cullingInputCount * sizeof(ShIndirectDrawCommand));
+
+        recreate(instanceBuffer, flareCapacity * sizeof(ShLensFlareInstance),
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Lens flares instance buffer",
+                 cullingInputCount * sizeof(ShLensFlareInstance));
+
+        indirectDrawCommands.Destroy();
+        indirectDrawCommands.Init(
+            allocator,
+            GetIndirectDrawCommandsSize(flareCapacity),
+            INDIRECT_DRAW_COMMANDS_USAGE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Lens flares draw cmds");
+    }
+
+    if (requiredVertexCount > vertexCapacity)
+    {
+        vertexCapacity = grow(vertexCapacity, requiredVertexCount);
+
+        recreate(vertexBuffer, vertexCapacity * sizeof(RasterizerVertex),
+                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "Lens flares vertex buffer",
+                 vertexCount * sizeof(RasterizerVertex));
+    }
+
+    if (requiredIndexCount > indexCapacity)
+    {
+        indexCapacity = grow(indexCapacity, requiredIndexCount);
+
+        recreate(indexBuffer, indexCapacity * sizeof(uint32_t),
+                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT, "Lens flares index buffer",
+                 indexCount * sizeof(uint32_t));
+    }
+
+    // new device-local buffers don't have static data
+    staticCopyPending = true;
+
+    UpdateDescriptors();
 }
 
 void RTGL1::LensFlares::SetParams(const RgDrawFrameLensFlareParams *pLensFlareParams)
@@ -260,9 +517,12 @@ void RTGL1::LensFlares::Cull(VkCommandBuffer cmd, uint32_t frameIndex)
         return;
     }
 
+    // reset draw count, shader will increment it
+    vkCmdFillBuffer(cmd, indirectDrawCommands.GetBuffer(), GetIndirectDrawCountOffset(), sizeof(uint32_t), 0);
+
     // sync
     {
-        VkBufferMemoryBarrier2KHR bs[1] = {};
+        VkBufferMemoryBarrier2KHR bs[2] = {};
         {
             VkBufferMemoryBarrier2KHR &b = bs[0];
             b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
@@ -274,6 +534,17 @@ void RTGL1::LensFlares::Cull(VkCommandBuffer cmd, uint32_t frameIndex)
             b.offset = 0;
             b.size = cullingInputCount * sizeof(ShIndirectDrawCommand);
         }
+        {
+            VkBufferMemoryBarrier2KHR &b = bs[1];
+            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+            b.srcStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT_KHR;
+            b.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR;
+            b.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
+            b.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT_KHR | VK_ACCESS_2_SHADER_WRITE_BIT_KHR;
+            b.buffer = indirectDrawCommands.GetBuffer();
+            b.offset = GetIndirectDrawCountOffset();
+            b.size = sizeof(uint32_t);
+        }
 
         VkDependencyInfoKHR info = {};
         info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
@@ -403,7 +674,7 @@ void RTGL1::LensFlares::Draw(VkCommandBuffer cmd, uint32_t frameIndex)
     vkCmdDrawIndexedIndirectCount(cmd, 
                                   indirectDrawCommands.GetBuffer(), GetIndirectDrawCommandsOffset(),
                                   indirectDrawCommands.GetBuffer(), GetIndirectDrawCountOffset(),
-                                  LENS_FLARES_MAX_DRAW_CMD_COUNT,
+                                  flareCapacity,
                                   sizeof(ShIndirectDrawCommand));
 }
 
@@ -547,43 +818,6 @@ void RTGL1::LensFlares::CreateCullDescriptors()
 
         SET_DEBUG_NAME(device, cullDescSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Lens flare cull desc set");
     }
-    {
-        VkDescriptorBufferInfo bufs[2] = {};
-        VkWriteDescriptorSet writes[2] = {};
-
-        {
-            VkDescriptorBufferInfo &b = bufs[0];
-            b.buffer = cullingInput->GetDeviceLocal();
-            b.offset = 0;
-            b.range = VK_WHOLE_SIZE;
-
-            VkWriteDescriptorSet &w = writes[0];
-            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            w.dstSet = cullDescSet;
-            w.dstBinding = BINDING_LENS_FLARES_CULLING_INPUT;
-            w.dstArrayElement = 0;
-            w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            w.descriptorCount = 1;
-            w.pBufferInfo = &b;
-        }
-        {
-            VkDescriptorBufferInfo &b = bufs[1];
-            b.buffer = indirectDrawCommands.GetBuffer();
-            b.offset = 0;
-            b.range = VK_WHOLE_SIZE;
-
-            VkWriteDescriptorSet &w = writes[1];
-            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            w.dstSet = cullDescSet;
-            w.dstBinding = BINDING_LENS_FLARES_DRAW_CMDS;
-            w.dstArrayElement = 0;
-            w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            w.descriptorCount = 1;
-            w.pBufferInfo = &b;
-        }
-
-        vkUpdateDescriptorSets(device, std::size(writes), writes, 0, nullptr);
-    }
 }
 
 void RTGL1::LensFlares::CreateRasterDescriptors()
@@ -634,6 +868,47 @@ void RTGL1::LensFlares::CreateRasterDescriptors()
 
         SET_DEBUG_NAME(device, rasterDescSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Lens flare raster desc set");
     }
+}
+
+void RTGL1::LensFlares::UpdateDescriptors()
+{
+    {
+        VkDescriptorBufferInfo bufs[2] = {};
+        VkWriteDescriptorSet writes[2] = {};
+
+        {
+            VkDescriptorBufferInfo &b = bufs[0];
+            b.buffer = cullingInput->GetDeviceLocal();
+            b.offset = 0;
+            b.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet &w = writes[0];
+            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w.dstSet = cullDescSet;
+            w.dstBinding = BINDING_LENS_FLARES_CULLING_INPUT;
+            w.dstArrayElement = 0;
+            w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            w.descriptorCount = 1;
+            w.pBufferInfo = &b;
+        }
+        {
+            VkDescriptorBufferInfo &b = bufs[1];
+            b.buffer = indirectDrawCommands.GetBuffer();
+            b.offset = 0;
+            b.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet &w = writes[1];
+            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w.dstSet = cullDescSet;
+            w.dstBinding = BINDING_LENS_FLARES_DRAW_CMDS;
+            w.dstArrayElement = 0;
+            w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            w.descriptorCount = 1;
+            w.pBufferInfo = &b;
+        }
+
+        vkUpdateDescriptorSets(device, std::size(writes), writes, 0, nullptr);
+    }
     {
         VkDescriptorBufferInfo b = {};
         b.buffer = instanceBuffer->GetDeviceLocal();
@@ -652,4 +927,3 @@ void RTGL1::LensFlares::CreateRasterDescriptors()
         vkUpdateDescriptorSets(device, 1, &w, 0, nullptr);
     }
 }
-
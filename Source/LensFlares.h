@@ -20,7 +20,10 @@
 
 #pragma once
 
+#include <vector>
+
 #include "AutoBuffer.h"
+#include "Containers.h"
 #include "Framebuffers.h"
 #include "GlobalUniform.h"
 #include "ShaderManager.h"
@@ -50,6 +53,11 @@ public:
 
     void PrepareForFrame(uint32_t frameIndex);
     void Upload(uint32_t frameIndex, const RgLensFlareUploadInfo &uploadInfo);
+    void UpdateIntensity(const RgUpdateLensFlareIntensityInfo &updateInfo);
+    // Static lens flares persist until the next StartNewStatic,
+    // the uploaded ones are drawn after SubmitStatic, starting from the next frame.
+    void StartNewStatic();
+    void SubmitStatic();
     void SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex);
     void SetParams(const RgDrawFrameLensFlareParams *pLensFlareParams);
     void Cull(VkCommandBuffer cmd, uint32_t frameIndex);
@@ -61,6 +69,26 @@ public:
     void OnShaderReload(const ShaderManager *shaderManager) override;
 
 private:
+    // Geometry of static lens flares, it's kept on CPU to restore
+    // the device-local buffers after growing
+    struct StaticLensFlares
+    {
+        std::vector<RgRasterizedGeometryVertexStruct> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<ShIndirectDrawCommand> cullingInput;
+        std::vector<ShLensFlareInstance> instances;
+        rgl::unordered_map<uint64_t, uint32_t> uniqueIDToIndex;
+
+        void Clear();
+    };
+
+    void AddStatic(const RgLensFlareUploadInfo &uploadInfo);
+    void AddDynamic(uint32_t frameIndex, const RgLensFlareUploadInfo &uploadInfo);
+    // Grow the buffers, if required counts don't fit.
+    // Staging data of the current frame is preserved.
+    void EnsureCapacity(uint32_t frameIndex, uint32_t requiredFlareCount, uint32_t requiredVertexCount, uint32_t requiredIndexCount);
+    void UpdateDescriptors();
+
     void CreateCullDescriptors();
     void CreateRasterDescriptors();
     void CreatePipelineLayouts(VkDescriptorSetLayout uniform,
@@ -73,6 +101,7 @@ private:
 
 private:
     VkDevice device;
+    std::shared_ptr<MemoryAllocator> allocator;
     std::shared_ptr<GlobalUniform> uniform;
     std::shared_ptr<Framebuffers> framebuffers;
     std::shared_ptr<TextureManager> textureManager;
@@ -89,6 +118,21 @@ private:
     uint32_t vertexCount;
     uint32_t indexCount;
 
+    uint32_t flareCapacity;
+    uint32_t vertexCapacity;
+    uint32_t indexCapacity;
+
+    // Static lens flares occupy the beginning of the buffers,
+    // only the dynamic range is copied each frame
+    StaticLensFlares staticSubmitted;
+    StaticLensFlares staticRecording;
+    bool isRecordingStatic;
+    bool staticSubmitRequested;
+    // Static range must be fully copied to the device-local buffers
+    bool staticCopyPending;
+    // Submitted static lens flares, which intensity was changed since the last copy
+    rgl::unordered_set<uint32_t> staticIntensityChanged;
+
 
     VkPipelineLayout vertFragPipelineLayout;
     std::unique_ptr<RasterizerPipelines> rasterPipelines;
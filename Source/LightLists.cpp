@@ -20,6 +20,8 @@
 
 #include "LightLists.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "RgException.h"
@@ -41,7 +43,8 @@ RTGL1::LightLists::LightLists(
     std::shared_ptr<SectorVisibility> _sectorVisibility,
     const char *_pDebugName)
 :
-    sectorVisibility(std::move(_sectorVisibility))
+    sectorVisibility(std::move(_sectorVisibility)),
+    isStaticSubmitted(false)
 {
     using namespace std::string_literals;
 
@@ -75,11 +78,23 @@ void RTGL1::LightLists::Reset()
     {
         v = {};
     }
+
+    for (auto &v : staticLightLists)
+    {
+        v = {};
+    }
+
+    isStaticSubmitted = false;
 }
 
-void RTGL1::LightLists::AddLightToSectorLightList(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex)
+void RTGL1::LightLists::SubmitStatic()
 {
-    auto &v = lightLists[lightSectorIndex.GetArrayIndex()];
+    isStaticSubmitted = true;
+}
+
+void RTGL1::LightLists::AddLightToSectorLightList(SectorLightLists &dstLists, LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex)
+{
+    auto &v = dstLists[lightSectorIndex.GetArrayIndex()];
 
     // guarantee capacity of >= VECTOR_START_CAPACITY
     v.reserve(VECTOR_START_CAPACITY);
@@ -92,9 +107,25 @@ void RTGL1::LightLists::AddLightToSectorLightList(LightArrayIndex lightIndex, Se
 
 void RTGL1::LightLists::InsertLight(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex,
                                     PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn)
+{
+    InsertLight(lightLists, lightIndex, lightSectorIndex, pfnRgIsLightVisibleFromSector, pUserDataForPfn);
+}
+
+void RTGL1::LightLists::InsertStaticLight(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex,
+                                          PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn)
+{
+    // static lights can be added only once per scene
+    assert(!isStaticSubmitted);
+
+    InsertLight(staticLightLists, lightIndex, lightSectorIndex, pfnRgIsLightVisibleFromSector, pUserDataForPfn);
+}
+
+void RTGL1::LightLists::InsertLight(SectorLightLists &dstLists,
+                                    LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex,
+                                    PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn)
 {
     // sector is always visible from itself, so append the light unconditionally
-    AddLightToSectorLightList(lightIndex, lightSectorIndex);
+    AddLightToSectorLightList(dstLists, lightIndex, lightSectorIndex);
 
 
     if (sectorVisibility->ArePotentiallyVisibleSectorsExist(lightSectorIndex))
@@ -117,7 +148,7 @@ void RTGL1::LightLists::InsertLight(LightArrayIndex lightIndex, SectorArrayIndex
             }
 
             // append given light to light list of such sector
-            AddLightToSectorLightList(lightIndex, visibleSector);
+            AddLightToSectorLightList(dstLists, lightIndex, visibleSector);
         }
     }
 }
@@ -152,9 +183,20 @@ void RTGL1::LightLists::BuildArrays(
 
 
         const std::vector<LightArrayIndex> &sectorLightList = lightLists[sectorIndex.GetArrayIndex()];
+        const std::vector<LightArrayIndex> &sectorStaticLightList = staticLightLists[sectorIndex.GetArrayIndex()];
 
         const uint32_t startArrayOffset = iter;
-        const uint32_t endArrayOffset   = iter + (uint32_t)sectorLightList.size();
+
+        // static lights are placed first, they're already in the sector's list
+        if (isStaticSubmitted && !sectorStaticLightList.empty())
+        {
+            uint32_t count = std::min((uint32_t)sectorStaticLightList.size(), (uint32_t)MAX_LIGHT_LIST_SIZE);
+            assert(count == sectorStaticLightList.size());
+
+            static_assert(sizeof(LightArrayIndex) == sizeof(LightArrayIndex::index_t), "LightArrayIndex must be a plain index");
+            memcpy(&pOutputPlainLightList[iter], sectorStaticLightList.data(), count * sizeof(LightArrayIndex::index_t));
+            iter += count;
+        }
 
         // copy all potentially visible lights of this sector to the dedicated light list part
         for (const LightArrayIndex &i : sectorLightList)
@@ -169,6 +211,8 @@ void RTGL1::LightLists::BuildArrays(
             iter++;
         }
 
+        const uint32_t endArrayOffset = iter;
+
         // write start/end, so the sector's light list can be accessed by sector array index
         pOutputSectorToLightListStartEnd[sectorIndex.GetArrayIndex() * 2 + 0] = startArrayOffset;
         pOutputSectorToLightListStartEnd[sectorIndex.GetArrayIndex() * 2 + 1] = endArrayOffset;
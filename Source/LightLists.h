@@ -50,6 +50,11 @@ public:
 
     void InsertLight(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex, 
                      PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn);
+    // Static lights are not cleared in PrepareForFrame, only in Reset.
+    // They're appended to sector light lists after SubmitStatic.
+    void InsertStaticLight(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex,
+                           PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn);
+    void SubmitStatic();
     void BuildAndCopyFromStaging(VkCommandBuffer cmd, uint32_t frameIndex);
 
     SectorArrayIndex SectorIDToArrayIndex(SectorID id) const;
@@ -58,7 +63,12 @@ public:
     VkBuffer GetSectorToLightListRegionDeviceLocalBuffer();
 
 private:
-    void AddLightToSectorLightList(LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex);
+    typedef std::array<std::vector<LightArrayIndex>, MAX_SECTOR_COUNT> SectorLightLists;
+
+    void InsertLight(SectorLightLists &dstLists,
+                     LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex,
+                     PFN_rgIsLightVisibleFromSector pfnRgIsLightVisibleFromSector, void *pUserDataForPfn);
+    static void AddLightToSectorLightList(SectorLightLists &dstLists, LightArrayIndex lightIndex, SectorArrayIndex lightSectorIndex);
 
     void BuildArrays(
         LightArrayIndex::index_t *pOutputPlainLightList, uint32_t *pOutputPlainLightListSize,
@@ -69,7 +79,11 @@ private:
 
     // light list for each sector in the current frame,
     // assume that it's indexed by 'SectorArrayIndex'
-    std::array<std::vector<LightArrayIndex>, MAX_SECTOR_COUNT> lightLists;
+    SectorLightLists lightLists;
+    // precomputed light lists of static lights, they're
+    // rebuilt only when a new static scene is uploaded
+    SectorLightLists staticLightLists;
+    bool isStaticSubmitted;
 
     std::shared_ptr<AutoBuffer> plainLightList;
     std::shared_ptr<AutoBuffer> sectorToLightListRegion;
@@ -20,6 +20,7 @@
 
 #include "LightManager.h"
 
+#include <algorithm>
 #include <cmath>
 #include <array>
 
@@ -53,6 +54,11 @@ RTGL1::LightManager::LightManager(
     spotLightCountPrev(0),
     polyLightCount(0),
     polyLightCountPrev(0),
+    sphLightCountStatic(0),
+    polyLightCountStatic(0),
+    staticLightsWereAdded(false),
+    staticLightsSubmitRequested(false),
+    staticLightsAge(0),
     descSetLayout(VK_NULL_HANDLE),
     descPool(VK_NULL_HANDLE),
     descSets{},
@@ -145,6 +151,43 @@ static void FillInfoSpotlight(const RgSpotlightUploadInfo &info, RTGL1::ShGlobal
 
 }
 
+static void FillMatchPrevForStatic(uint32_t *pMatchPrev, uint32_t staticLightCount, uint32_t staticLightsAge, uint32_t lightCountPrev)
+{
+    assert(staticLightsAge == 0 || lightCountPrev >= staticLightCount);
+
+    // static lights have the same indices while the static scene is the same,
+    // so they're matched only once, and the device-local part is reused
+    const uint32_t dynamicStart = staticLightsAge > 0 ? staticLightCount : 0;
+
+    if (staticLightsAge == 1)
+    {
+        for (uint32_t i = 0; i < staticLightCount; i++)
+        {
+            pMatchPrev[i] = i;
+        }
+    }
+
+    if (lightCountPrev > dynamicStart)
+    {
+        memset(pMatchPrev + dynamicStart, 0xFF, sizeof(uint32_t) * (lightCountPrev - dynamicStart));
+    }
+}
+
+static void CopyToPrev(VkCommandBuffer cmd, VkBuffer src, VkBuffer dst, VkDeviceSize elementSize, uint32_t start, uint32_t end)
+{
+    if (end <= start)
+    {
+        return;
+    }
+
+    VkBufferCopy info = {};
+    info.srcOffset = start * elementSize;
+    info.dstOffset = start * elementSize;
+    info.size = (end - start) * elementSize;
+
+    vkCmdCopyBuffer(cmd, src, dst, 1, &info);
+}
+
 void RTGL1::LightManager::PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
 {
     sphLightCountPrev = sphLightCount;
@@ -152,39 +195,37 @@ void RTGL1::LightManager::PrepareForFrame(VkCommandBuffer cmd, uint32_t frameInd
     spotLightCountPrev = spotLightCount;
     polyLightCountPrev = polyLightCount;
 
-    sphLightCount = 0;
+    if (staticLightsSubmitRequested)
+    {
+        // static lights are visible from this frame
+        sphLightCountStatic = (uint32_t)sphLightsStatic.size();
+        polyLightCountStatic = (uint32_t)polyLightsStatic.size();
+
+        lightListsForSpherical->SubmitStatic();
+        lightListsForPolygonal->SubmitStatic();
+
+        staticLightsAge = 0;
+        staticLightsSubmitRequested = false;
+    }
+
+    // dynamic lights are placed after static ones
+    sphLightCount = sphLightCountStatic;
     dirLightCount = 0;
     spotLightCount = 0;
-    polyLightCount = 0;
+    polyLightCount = polyLightCountStatic;
 
     // TODO: similar system to just swap desc sets, instead of copying
-    if (sphLightCountPrev > 0)
-    {
-        VkBufferCopy info = {};
-        info.srcOffset = 0;
-        info.dstOffset = 0;
-        info.size = sphLightCountPrev * sizeof(ShLightSpherical);
-
-        vkCmdCopyBuffer(
-            cmd,
-            sphericalLights->GetDeviceLocal(), sphericalLightsPrev.GetBuffer(),
-            1, &info);
-    }
-    if (polyLightCountPrev > 0)
     {
-        VkBufferCopy info = {};
-        info.srcOffset = 0;
-        info.dstOffset = 0;
-        info.size = polyLightCountPrev * sizeof(ShLightPolygonal);
-
-        vkCmdCopyBuffer(
-            cmd,
-            polygonalLights->GetDeviceLocal(), polygonalLightsPrev.GetBuffer(),
-            1, &info);
+        // static part of "Prev" buffers was already copied, if static lights weren't changed
+        const uint32_t sphStart  = GetStaticLightsCopyStart(sphLightCountStatic);
+        const uint32_t polyStart = GetStaticLightsCopyStart(polyLightCountStatic);
+
+        CopyToPrev(cmd, sphericalLights->GetDeviceLocal(), sphericalLightsPrev.GetBuffer(), sizeof(ShLightSpherical), sphStart, sphLightCountPrev);
+        CopyToPrev(cmd, polygonalLights->GetDeviceLocal(), polygonalLightsPrev.GetBuffer(), sizeof(ShLightPolygonal), polyStart, polyLightCountPrev);
     }
 
-    memset(sphericalLightMatchPrev->GetMapped(frameIndex), 0xFF, sizeof(uint32_t) * sphLightCountPrev);
-    memset(polygonalLightMatchPrev->GetMapped(frameIndex), 0xFF, sizeof(uint32_t) * polyLightCountPrev);
+    FillMatchPrevForStatic((uint32_t *)sphericalLightMatchPrev->GetMapped(frameIndex), sphLightCountStatic, staticLightsAge, sphLightCountPrev);
+    FillMatchPrevForStatic((uint32_t *)polygonalLightMatchPrev->GetMapped(frameIndex), polyLightCountStatic, staticLightsAge, polyLightCountPrev);
 
     sphericalUniqueIDToPrevIndex[frameIndex].clear();
     polygonalUniqueIDToPrevIndex[frameIndex].clear();
@@ -209,10 +250,34 @@ void RTGL1::LightManager::Reset()
     spotLightCount = spotLightCountPrev = 0;
     polyLightCount = polyLightCountPrev = 0;
 
+    sphLightsStatic.clear();
+    polyLightsStatic.clear();
+    sphLightCountStatic = 0;
+    polyLightCountStatic = 0;
+    staticLightsWereAdded = false;
+    staticLightsSubmitRequested = false;
+    staticLightsAge = 0;
+
     lightListsForSpherical->Reset();
     lightListsForPolygonal->Reset();
 }
 
+void RTGL1::LightManager::SubmitStatic()
+{
+    if (staticLightsWereAdded)
+    {
+        staticLightsSubmitRequested = true;
+        staticLightsWereAdded = false;
+    }
+}
+
+uint32_t RTGL1::LightManager::GetStaticLightsCopyStart(uint32_t staticLightCount) const
+{
+    // if static lights are valid in the device-local buffer
+    // since the previous frame, only dynamic lights should be copied
+    return staticLightsAge >= 2 ? staticLightCount : 0;
+}
+
 static bool IsColorTooDim(const RgFloat3D &c)
 {
     return c.data[0] + c.data[1] + c.data[2] < RTGL1::MIN_COLOR_SUM;
@@ -225,15 +290,38 @@ void RTGL1::LightManager::AddSphericalLight(uint32_t frameIndex, const RgSpheric
         return;
     }
 
-    if (sphLightCount >= MAX_LIGHT_COUNT_SPHERICAL)
+    const SectorID sectorId = SectorID{ info.sectorID };
+    const SectorArrayIndex sectorArrayIndex = lightListsForSpherical->SectorIDToArrayIndex(sectorId);
+
+
+    if (info.isStatic)
     {
-        assert(0);
+        if (sphLightsStatic.size() >= MAX_LIGHT_COUNT_SPHERICAL)
+        {
+            assert(0);
+            return;
+        }
+
+        // static light index is its index in the static array, 
+        // it's not changing until the next static scene
+        const LightArrayIndex index = LightArrayIndex{ (uint32_t)sphLightsStatic.size() };
+
+        sphLightsStatic.emplace_back();
+        FillInfoSpherical(info, &sphLightsStatic.back());
+
+        lightListsForSpherical->InsertStaticLight(index, sectorArrayIndex,
+                                                  nullptr, nullptr);
+
+        staticLightsWereAdded = true;
         return;
     }
 
 
-    const SectorID sectorId = SectorID{ info.sectorID };
-    const SectorArrayIndex sectorArrayIndex = lightListsForSpherical->SectorIDToArrayIndex(sectorId);
+    if (sphLightCount >= MAX_LIGHT_COUNT_SPHERICAL)
+    {
+        assert(0);
+        return;
+    }
 
 
     const LightArrayIndex index = LightArrayIndex{ sphLightCount };
@@ -262,15 +350,36 @@ void RTGL1::LightManager::AddPolygonalLight(uint32_t frameIndex, const RgPolygon
         return;
     }
 
-    if (polyLightCount >= MAX_LIGHT_COUNT_POLYGONAL)
+    const SectorID sectorId = SectorID{ info.sectorID };
+    const SectorArrayIndex sectorArrayIndex = lightListsForPolygonal->SectorIDToArrayIndex(sectorId);
+
+
+    if (info.isStatic)
     {
-        assert(0);
+        if (polyLightsStatic.size() >= MAX_LIGHT_COUNT_POLYGONAL)
+        {
+            assert(0);
+            return;
+        }
+
+        const LightArrayIndex index = LightArrayIndex{ (uint32_t)polyLightsStatic.size() };
+
+        polyLightsStatic.emplace_back();
+        FillInfoPolygonal(info, &polyLightsStatic.back());
+
+        lightListsForPolygonal->InsertStaticLight(index, sectorArrayIndex,
+                                                  info.pfnIsLightVisibleFromSector, info.pUserDataForPfn);
+
+        staticLightsWereAdded = true;
         return;
     }
 
 
-    const SectorID sectorId = SectorID{ info.sectorID };
-    const SectorArrayIndex sectorArrayIndex = lightListsForPolygonal->SectorIDToArrayIndex(sectorId);
+    if (polyLightCount >= MAX_LIGHT_COUNT_POLYGONAL)
+    {
+        assert(0);
+        return;
+    }
 
 
     const LightArrayIndex index = LightArrayIndex{ polyLightCount };
@@ -355,11 +464,33 @@ void RTGL1::LightManager::CopyFromStaging(VkCommandBuffer cmd, uint32_t frameInd
 {
     CmdLabel label(cmd, "Copying lights");
 
-    sphericalLights->CopyFromStaging(cmd, frameIndex, sizeof(ShLightSpherical) * sphLightCount);
-    polygonalLights->CopyFromStaging(cmd, frameIndex, sizeof(ShLightPolygonal) * polyLightCount);
+    if (staticLightsAge == 0)
+    {
+        // static lights were just submitted, upload them once
+        memcpy(sphericalLights->GetMapped(frameIndex), sphLightsStatic.data(), sizeof(ShLightSpherical) * sphLightCountStatic);
+        memcpy(polygonalLights->GetMapped(frameIndex), polyLightsStatic.data(), sizeof(ShLightPolygonal) * polyLightCountStatic);
+    }
+
+    {
+        // static lights are persistent in device-local buffer, copy only dynamic range
+        const uint32_t sphStart  = staticLightsAge > 0 ? sphLightCountStatic : 0;
+        const uint32_t polyStart = staticLightsAge > 0 ? polyLightCountStatic : 0;
+
+        assert(sphLightCount >= sphStart && polyLightCount >= polyStart);
+
+        sphericalLights->CopyFromStaging(cmd, frameIndex, sizeof(ShLightSpherical) * (sphLightCount - sphStart), sizeof(ShLightSpherical) * sphStart);
+        polygonalLights->CopyFromStaging(cmd, frameIndex, sizeof(ShLightPolygonal) * (polyLightCount - polyStart), sizeof(ShLightPolygonal) * polyStart);
+    }
+
+    {
+        const uint32_t sphStart  = std::min(GetStaticLightsCopyStart(sphLightCountStatic), sphLightCountPrev);
+        const uint32_t polyStart = std::min(GetStaticLightsCopyStart(polyLightCountStatic), polyLightCountPrev);
+
+        sphericalLightMatchPrev->CopyFromStaging(cmd, frameIndex, sizeof(uint32_t) * (sphLightCountPrev - sphStart), sizeof(uint32_t) * sphStart);
+        polygonalLightMatchPrev->CopyFromStaging(cmd, frameIndex, sizeof(uint32_t) * (polyLightCountPrev - polyStart), sizeof(uint32_t) * polyStart);
+    }
 
-    sphericalLightMatchPrev->CopyFromStaging(cmd, frameIndex, sizeof(uint32_t) * sphLightCountPrev);
-    polygonalLightMatchPrev->CopyFromStaging(cmd, frameIndex, sizeof(uint32_t) * polyLightCountPrev);
+    staticLightsAge = std::min(staticLightsAge + 1, 2u);
 
     lightListsForSpherical->BuildAndCopyFromStaging(cmd, frameIndex);
     lightListsForPolygonal->BuildAndCopyFromStaging(cmd, frameIndex);
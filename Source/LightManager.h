@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "RTGL1/RTGL1.h"
 #include "Common.h"
 #include "Containers.h"
@@ -30,6 +32,9 @@
 namespace RTGL1
 {
 
+struct ShLightSpherical;
+struct ShLightPolygonal;
+
 class LightManager
 {
 public:
@@ -43,6 +48,8 @@ public:
 
     void PrepareForFrame(VkCommandBuffer cmd, uint32_t frameIndex);
     void Reset();
+    // Static lights that were added after Reset will be visible from the next frame.
+    void SubmitStatic();
 
     uint32_t GetSpotlightCount() const;
     uint32_t GetSpotlightCountPrev() const;
@@ -72,6 +79,8 @@ private:
     void CreateDescriptors();
     void UpdateDescriptors(uint32_t frameIndex);
 
+    uint32_t GetStaticLightsCopyStart(uint32_t staticLightCount) const;
+
 private:
     VkDevice device;
 
@@ -108,6 +117,21 @@ private:
     uint32_t polyLightCount;
     uint32_t polyLightCountPrev;
 
+    // Static lights occupy [0, staticCount) in the light arrays,
+    // dynamic lights are placed after them. So the device-local
+    // static part is persistent and only dynamic range is copied each frame.
+    std::vector<ShLightSpherical> sphLightsStatic;
+    std::vector<ShLightPolygonal> polyLightsStatic;
+    uint32_t sphLightCountStatic;
+    uint32_t polyLightCountStatic;
+    // Static lights were added, they must be submitted on the next frame.
+    bool staticLightsWereAdded;
+    bool staticLightsSubmitRequested;
+    // How many times the current static lights were copied to device-local:
+    // 0 - not uploaded yet, 1 - previous frame has the same static lights,
+    // 2 - static part of "Prev" and "MatchPrev" buffers is already valid.
+    uint32_t staticLightsAge;
+
     VkDescriptorSetLayout descSetLayout;
     VkDescriptorPool descPool;
     VkDescriptorSet descSets[MAX_FRAMES_IN_FLIGHT];
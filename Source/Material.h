@@ -55,6 +55,8 @@ struct AnimatedMaterial
     // Indices of static materials.
     std::vector<uint32_t>   materialIndices;
     uint32_t                currentFrame = 0;
+    // Slot in AnimatedMaterialTable, that contains textures of the current frame.
+    uint32_t                tableSlot = ANIMATED_MATERIAL_NO_SLOT;
 };
 
 
@@ -0,0 +1,347 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MipmapGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace RTGL1;
+
+namespace
+{
+
+enum class ChannelType
+{
+    UNORM8,
+    UNORM16,
+    SFLOAT16,
+    SFLOAT32,
+};
+
+struct FormatDesc
+{
+    ChannelType type;
+    uint32_t    channelCount;
+    // first channels that are sRGB encoded, alpha is always linear
+    uint32_t    srgbChannelCount;
+};
+
+bool GetFormatDesc(VkFormat format, FormatDesc *pDesc)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R8_UNORM:                *pDesc = { ChannelType::UNORM8, 1, 0 }; return true;
+        case VK_FORMAT_R8_SRGB:                 *pDesc = { ChannelType::UNORM8, 1, 1 }; return true;
+        case VK_FORMAT_R8G8_UNORM:              *pDesc = { ChannelType::UNORM8, 2, 0 }; return true;
+        case VK_FORMAT_R8G8_SRGB:               *pDesc = { ChannelType::UNORM8, 2, 2 }; return true;
+        case VK_FORMAT_R8G8B8A8_UNORM:          *pDesc = { ChannelType::UNORM8, 4, 0 }; return true;
+        case VK_FORMAT_R8G8B8A8_SRGB:           *pDesc = { ChannelType::UNORM8, 4, 3 }; return true;
+        case VK_FORMAT_B8G8R8A8_UNORM:          *pDesc = { ChannelType::UNORM8, 4, 0 }; return true;
+        case VK_FORMAT_B8G8R8A8_SRGB:           *pDesc = { ChannelType::UNORM8, 4, 3 }; return true;
+        case VK_FORMAT_R16_UNORM:               *pDesc = { ChannelType::UNORM16, 1, 0 }; return true;
+        case VK_FORMAT_R16G16_UNORM:            *pDesc = { ChannelType::UNORM16, 2, 0 }; return true;
+        case VK_FORMAT_R16G16B16A16_UNORM:      *pDesc = { ChannelType::UNORM16, 4, 0 }; return true;
+        case VK_FORMAT_R16_SFLOAT:              *pDesc = { ChannelType::SFLOAT16, 1, 0 }; return true;
+        case VK_FORMAT_R16G16_SFLOAT:           *pDesc = { ChannelType::SFLOAT16, 2, 0 }; return true;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:     *pDesc = { ChannelType::SFLOAT16, 4, 0 }; return true;
+        case VK_FORMAT_R32_SFLOAT:              *pDesc = { ChannelType::SFLOAT32, 1, 0 }; return true;
+        case VK_FORMAT_R32G32_SFLOAT:           *pDesc = { ChannelType::SFLOAT32, 2, 0 }; return true;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:     *pDesc = { ChannelType::SFLOAT32, 4, 0 }; return true;
+        default: return false;
+    }
+}
+
+uint32_t GetChannelSize(ChannelType type)
+{
+    switch (type)
+    {
+        case ChannelType::UNORM8:   return 1;
+        case ChannelType::UNORM16:  return 2;
+        case ChannelType::SFLOAT16: return 2;
+        case ChannelType::SFLOAT32: return 4;
+        default: assert(0); return 0;
+    }
+}
+
+struct SRGBTables
+{
+    float       toLinear[256];
+    // linear value quantized to 12 bits -> sRGB
+    uint8_t     fromLinear[4096];
+
+    SRGBTables()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            const float c = (float)i / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        for (uint32_t i = 0; i < 4096; i++)
+        {
+            const float l = (float)i / 4095.0f;
+            const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            fromLinear[i] = (uint8_t)std::min(255.0f, std::max(0.0f, c * 255.0f + 0.5f));
+        }
+    }
+};
+
+const SRGBTables &GetSRGBTables()
+{
+    static const SRGBTables tables;
+    return tables;
+}
+
+float HalfToFloat(uint16_t h)
+{
+    const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    const uint32_t exponent = (h >> 10) & 0x1F;
+    const uint32_t mantissa = h & 0x3FF;
+
+    uint32_t bits;
+
+    if (exponent == 0)
+    {
+        // zero or subnormal
+        const float f = std::ldexp((float)mantissa, -24);
+        memcpy(&bits, &f, sizeof(bits));
+        bits |= sign;
+    }
+    else if (exponent == 31)
+    {
+        // inf or nan
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+uint16_t FloatToHalf(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+
+    const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    const int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+    const uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (((bits >> 23) & 0xFF) == 0xFF)
+    {
+        // inf or nan
+        return (uint16_t)(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+    }
+    if (exponent >= 31)
+    {
+        return (uint16_t)(sign | 0x7C00);
+    }
+    if (exponent <= 0)
+    {
+        // subnormal or zero
+        if (exponent < -10)
+        {
+            return sign;
+        }
+
+        const uint32_t m = mantissa | 0x800000;
+        const uint32_t shift = (uint32_t)(14 - exponent);
+
+        // round to nearest
+        return (uint16_t)(sign | ((m + (1u << (shift - 1))) >> shift));
+    }
+
+    // round to nearest, carry into exponent is correct
+    return (uint16_t)(sign | (((uint32_t)exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
+
+float LoadChannel(const uint8_t *p, ChannelType type, bool isSRGB)
+{
+    switch (type)
+    {
+        case ChannelType::UNORM8:
+            return isSRGB ? GetSRGBTables().toLinear[p[0]] : (float)p[0] / 255.0f;
+
+        case ChannelType::UNORM16:
+        {
+            uint16_t v;
+            memcpy(&v, p, sizeof(v));
+            return (float)v / 65535.0f;
+        }
+        case ChannelType::SFLOAT16:
+        {
+            uint16_t v;
+            memcpy(&v, p, sizeof(v));
+            return HalfToFloat(v);
+        }
+        case ChannelType::SFLOAT32:
+        {
+            float v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        default:
+            assert(0);
+            return 0;
+    }
+}
+
+void StoreChannel(uint8_t *p, ChannelType type, bool isSRGB, float value)
+{
+    switch (type)
+    {
+        case ChannelType::UNORM8:
+        {
+            const float c = std::min(1.0f, std::max(0.0f, value));
+            p[0] = isSRGB ? GetSRGBTables().fromLinear[(uint32_t)(c * 4095.0f + 0.5f)] : (uint8_t)(c * 255.0f + 0.5f);
+            break;
+        }
+        case ChannelType::UNORM16:
+        {
+            const float c = std::min(1.0f, std::max(0.0f, value));
+            const uint16_t v = (uint16_t)(c * 65535.0f + 0.5f);
+            memcpy(p, &v, sizeof(v));
+            break;
+        }
+        case ChannelType::SFLOAT16:
+        {
+            const uint16_t v = FloatToHalf(value);
+            memcpy(p, &v, sizeof(v));
+            break;
+        }
+        case ChannelType::SFLOAT32:
+        {
+            memcpy(p, &value, sizeof(value));
+            break;
+        }
+        default:
+            assert(0);
+    }
+}
+
+}
+
+
+MipmapGenerator::MipmapGenerator(std::shared_ptr<WorkerPool> _workerPool)
+:
+    workerPool(std::move(_workerPool))
+{}
+
+bool MipmapGenerator::IsFormatSupported(VkFormat format)
+{
+    FormatDesc desc;
+    return GetFormatDesc(format, &desc);
+}
+
+uint32_t MipmapGenerator::GetLevelCount(const RgExtent2D &baseSize)
+{
+    return std::min((uint32_t)std::log2(baseSize.width), (uint32_t)std::log2(baseSize.height)) + 1;
+}
+
+uint32_t MipmapGenerator::Generate(
+    const uint8_t *pBase, const RgExtent2D &baseSize, VkFormat format, uint32_t maxLevelCount,
+    std::vector<uint8_t> &levels, uint32_t pLevelOffsets[MAX_PREGENERATED_MIPMAP_LEVELS], uint32_t pLevelSizes[MAX_PREGENERATED_MIPMAP_LEVELS]) const
+{
+    FormatDesc desc;
+
+    if (!GetFormatDesc(format, &desc) || baseSize.width == 0 || baseSize.height == 0)
+    {
+        return 0;
+    }
+
+    assert(maxLevelCount > 0);
+
+    const uint32_t channelSize = GetChannelSize(desc.type);
+    const uint32_t texelSize = channelSize * desc.channelCount;
+    const uint32_t levelCount = std::min(std::min(GetLevelCount(baseSize), maxLevelCount), MAX_PREGENERATED_MIPMAP_LEVELS);
+
+    uint32_t totalSize = 0;
+
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        const uint32_t w = std::max(baseSize.width >> level, 1u);
+        const uint32_t h = std::max(baseSize.height >> level, 1u);
+
+        pLevelOffsets[level] = totalSize;
+        pLevelSizes[level] = w * h * texelSize;
+        totalSize += pLevelSizes[level];
+    }
+
+    levels.resize(totalSize);
+    memcpy(levels.data(), pBase, pLevelSizes[0]);
+
+    for (uint32_t level = 1; level < levelCount; level++)
+    {
+        const uint32_t srcW = std::max(baseSize.width >> (level - 1), 1u);
+        const uint32_t srcH = std::max(baseSize.height >> (level - 1), 1u);
+        const uint32_t dstW = std::max(baseSize.width >> level, 1u);
+        const uint32_t dstH = std::max(baseSize.height >> level, 1u);
+
+        const uint8_t *pSrc = &levels[pLevelOffsets[level - 1]];
+        uint8_t *pDst = &levels[pLevelOffsets[level]];
+
+        // rows of a level are independent
+        const std::function<void(uint32_t)> downsampleRow = [&] (uint32_t y)
+        {
+            const uint32_t y0 = std::min(y * 2, srcH - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, srcH - 1);
+
+            for (uint32_t x = 0; x < dstW; x++)
+            {
+                const uint32_t x0 = std::min(x * 2, srcW - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, srcW - 1);
+
+                const uint8_t *s[4] =
+                {
+                    &pSrc[(y0 * srcW + x0) * texelSize],
+                    &pSrc[(y0 * srcW + x1) * texelSize],
+                    &pSrc[(y1 * srcW + x0) * texelSize],
+                    &pSrc[(y1 * srcW + x1) * texelSize],
+                };
+
+                uint8_t *d = &pDst[(y * dstW + x) * texelSize];
+
+                for (uint32_t c = 0; c < desc.channelCount; c++)
+                {
+                    const bool isSRGB = c < desc.srgbChannelCount;
+                    const uint32_t offset = c * channelSize;
+
+                    const float avg = 0.25f * (
+                        LoadChannel(s[0] + offset, desc.type, isSRGB) +
+                        LoadChannel(s[1] + offset, desc.type, isSRGB) +
+                        LoadChannel(s[2] + offset, desc.type, isSRGB) +
+                        LoadChannel(s[3] + offset, desc.type, isSRGB));
+
+                    StoreChannel(d + offset, desc.type, isSRGB, avg);
+                }
+            }
+        };
+
+        workerPool->ParallelFor(dstH, downsampleRow);
+    }
+
+    return levelCount;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "Common.h"
+#include "Const.h"
+#include "WorkerPool.h"
+
+namespace RTGL1
+{
+
+// Generates mip levels on CPU with a 2x2 box filter,
+// for formats that can't be blitted on GPU.
+// Color channels of sRGB formats are averaged in linear space.
+class MipmapGenerator
+{
+public:
+    explicit MipmapGenerator(std::shared_ptr<WorkerPool> workerPool);
+    ~MipmapGenerator() = default;
+
+    MipmapGenerator(const MipmapGenerator &other) = delete;
+    MipmapGenerator(MipmapGenerator &&other) noexcept = delete;
+    MipmapGenerator &operator=(const MipmapGenerator &other) = delete;
+    MipmapGenerator &operator=(MipmapGenerator &&other) noexcept = delete;
+
+    static bool IsFormatSupported(VkFormat format);
+    // Same count as for the mip levels that are generated on GPU.
+    static uint32_t GetLevelCount(const RgExtent2D &baseSize);
+
+    // Write all levels, including the base one, tightly packed to "levels".
+    // Returns the count of written levels, or 0 if the format is not supported.
+    uint32_t Generate(
+        const uint8_t *pBase, const RgExtent2D &baseSize, VkFormat format, uint32_t maxLevelCount,
+        std::vector<uint8_t> &levels,
+        uint32_t pLevelOffsets[MAX_PREGENERATED_MIPMAP_LEVELS],
+        uint32_t pLevelSizes[MAX_PREGENERATED_MIPMAP_LEVELS]) const;
+
+private:
+    std::shared_ptr<WorkerPool> workerPool;
+};
+
+}
@@ -0,0 +1,293 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OverrideFolderIndex.h"
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+
+#include "RgException.h"
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif
+
+using namespace RTGL1;
+
+OverrideFolderIndex::OverrideFolderIndex(const char *_folderPath, const char *_manifestPath, std::shared_ptr<UserFileLoad> _userFileLoad)
+    :
+    folderPath(Normalize(_folderPath != nullptr ? _folderPath : "")),
+    manifestPath(_manifestPath != nullptr ? _manifestPath : ""),
+    userFileLoad(std::move(_userFileLoad))
+{
+    if (!folderPath.empty() && folderPath.back() != '/')
+    {
+        folderPath += '/';
+    }
+
+    Refresh();
+}
+
+void OverrideFolderIndex::Refresh()
+{
+    files.clear();
+
+    // without a folder, every path is relative to the working directory,
+    // so the index is disabled instead of scanning the whole tree
+    if (folderPath.empty())
+    {
+        return;
+    }
+
+    if (!manifestPath.empty())
+    {
+        ReadManifest();
+    }
+    else
+    {
+        std::set<FileId> visited;
+        ScanFolder(folderPath, visited);
+    }
+}
+
+bool OverrideFolderIndex::MayExist(const char *filePath) const
+{
+    if (filePath == nullptr)
+    {
+        return false;
+    }
+
+    if (folderPath.empty())
+    {
+        return true;
+    }
+
+    std::string p = Normalize(filePath);
+
+    // not in the indexed folder, so can't say anything
+    if (p.length() <= folderPath.length() || p.compare(0, folderPath.length(), folderPath) != 0)
+    {
+        return true;
+    }
+
+    return files.find(p) != files.end();
+}
+
+uint32_t OverrideFolderIndex::GetFileCount() const
+{
+    return static_cast<uint32_t>(files.size());
+}
+
+void OverrideFolderIndex::ScanFolder(const std::string &folder, std::set<FileId> &visited)
+{
+#ifdef _WIN32
+    WIN32_FIND_DATAA findData;
+    HANDLE h = FindFirstFileA((folder + "*").c_str(), &findData);
+
+    if (h == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    do
+    {
+        const char *name = findData.cFileName;
+
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+        {
+            continue;
+        }
+
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            // junctions and symlinks may point to an ancestor
+            if (findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+            {
+                continue;
+            }
+
+            ScanFolder(folder + name + "/", visited);
+        }
+        else
+        {
+            files.insert(Normalize((folder + name).c_str()));
+        }
+    }
+    while (FindNextFileA(h, &findData));
+
+    FindClose(h);
+#else
+    DIR *dir = opendir(folder.c_str());
+
+    if (dir == nullptr)
+    {
+        return;
+    }
+
+    // symlinked folders are followed, but each folder is scanned only once,
+    // so a link to an ancestor doesn't recurse infinitely
+    struct stat dirSt = {};
+    if (fstat(dirfd(dir), &dirSt) != 0 ||
+        !visited.insert(FileId(dirSt.st_dev, dirSt.st_ino)).second)
+    {
+        closedir(dir);
+        return;
+    }
+
+    while (const dirent *entry = readdir(dir))
+    {
+        const char *name = entry->d_name;
+
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+        {
+            continue;
+        }
+
+        std::string path = folder + name;
+
+        struct stat st = {};
+        if (stat(path.c_str(), &st) != 0)
+        {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode))
+        {
+            ScanFolder(path + "/", visited);
+        }
+        else if (S_ISREG(st.st_mode))
+        {
+            files.insert(Normalize(path.c_str()));
+        }
+    }
+
+    closedir(dir);
+#endif
+}
+
+void OverrideFolderIndex::ReadManifest()
+{
+    std::string contents;
+
+    if (userFileLoad && userFileLoad->Exists())
+    {
+        auto fileHandle = userFileLoad->Open(manifestPath.c_str());
+
+        if (!fileHandle.Contains())
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Couldn't open overriden textures index manifest: " + manifestPath);
+        }
+
+        contents.assign(static_cast<const char *>(fileHandle.pData), fileHandle.dataSize);
+    }
+    else
+    {
+        std::ifstream file(manifestPath, std::ios::binary);
+
+        if (!file.is_open())
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "Couldn't open overriden textures index manifest: " + manifestPath);
+        }
+
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    const char *pStart = contents.c_str();
+    const char *pEnd = pStart + contents.length();
+
+    for (const char *p = pStart; p <= pEnd; p++)
+    {
+        if (p == pEnd || *p == '\n')
+        {
+            AddManifestLine(pStart, p);
+            pStart = p + 1;
+        }
+    }
+}
+
+void OverrideFolderIndex::AddManifestLine(const char *pStart, const char *pEnd)
+{
+    while (pStart < pEnd && isspace(static_cast<unsigned char>(*pStart)))
+    {
+        pStart++;
+    }
+
+    // also removes '\r'
+    while (pEnd > pStart && isspace(static_cast<unsigned char>(*(pEnd - 1))))
+    {
+        pEnd--;
+    }
+
+    if (pStart == pEnd || *pStart == '#')
+    {
+        return;
+    }
+
+    files.insert(folderPath + Normalize(pStart, pEnd));
+}
+
+std::string OverrideFolderIndex::Normalize(const char *path)
+{
+    return Normalize(path, path + strlen(path));
+}
+
+std::string OverrideFolderIndex::Normalize(const char *pStart, const char *pEnd)
+{
+    std::string r;
+    r.reserve(pEnd - pStart);
+
+    for (const char *p = pStart; p < pEnd; p++)
+    {
+        char c = *p == '\\' ? '/' : *p;
+
+        // collapse repeated delimiters
+        if (c == '/' && !r.empty() && r.back() == '/')
+        {
+            continue;
+        }
+
+    #ifdef _WIN32
+        // file system is case-insensitive
+        c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    #endif
+
+        r += c;
+    }
+
+    // relative paths that are generated with the "./" prefix
+    while (r.compare(0, 2, "./") == 0)
+    {
+        r.erase(0, 2);
+    }
+
+    return r;
+}
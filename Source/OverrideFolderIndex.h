@@ -0,0 +1,82 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <set>
+#include <string>
+
+#include "Common.h"
+#include "Containers.h"
+#include "UserFunction.h"
+
+namespace RTGL1
+{
+
+// Set of files in the folder with overriding textures.
+// Allows to skip opening files that don't exist,
+// as most of the generated override paths don't have a file.
+class OverrideFolderIndex
+{
+public:
+    // If folderPath is null or empty, the index is disabled.
+    // If manifestPath is null, the folder is scanned recursively.
+    // Otherwise, manifest is a text file with one path per line,
+    // relative to the folder; empty lines and lines starting with '#' are ignored.
+    OverrideFolderIndex(const char *folderPath, const char *manifestPath, std::shared_ptr<UserFileLoad> userFileLoad);
+    ~OverrideFolderIndex() = default;
+
+    OverrideFolderIndex(const OverrideFolderIndex &other) = delete;
+    OverrideFolderIndex(OverrideFolderIndex &&other) noexcept = delete;
+    OverrideFolderIndex &operator=(const OverrideFolderIndex &other) = delete;
+    OverrideFolderIndex &operator=(OverrideFolderIndex &&other) noexcept = delete;
+
+    // Rescan the folder or reread the manifest.
+    void Refresh();
+
+    // False, only if the path is inside of the indexed folder,
+    // and there is no such file in the index. Always true, if the index is disabled.
+    bool MayExist(const char *filePath) const;
+
+    uint32_t GetFileCount() const;
+
+    // Forward slashes, no repeated delimiters, no "./" prefix;
+    // lowercase on case-insensitive file systems.
+    static std::string Normalize(const char *path);
+
+private:
+    // device and inode of a scanned folder
+    typedef std::pair<uint64_t, uint64_t> FileId;
+
+    void ScanFolder(const std::string &folder, std::set<FileId> &visited);
+    void ReadManifest();
+    void AddManifestLine(const char *pStart, const char *pEnd);
+
+    static std::string Normalize(const char *pStart, const char *pEnd);
+
+private:
+    std::string folderPath;
+    std::string manifestPath;
+    std::shared_ptr<UserFileLoad> userFileLoad;
+
+    rgl::unordered_set<std::string> files;
+};
+
+}
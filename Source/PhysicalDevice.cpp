@@ -20,6 +20,7 @@
 
 #include "PhysicalDevice.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -28,7 +29,8 @@
 using namespace RTGL1;
 
 PhysicalDevice::PhysicalDevice(VkInstance instance)
-    : physDevice(VK_NULL_HANDLE), memoryProperties{}, rtPipelineProperties{}
+    : physDevice(VK_NULL_HANDLE), memoryProperties{}, rtPipelineProperties{}, timestampPeriod(0.0f),
+    descriptorPartiallyBoundSupported(false), maxSampledImageDescriptorCount(0)
 {
     VkResult r;
 
@@ -47,8 +49,12 @@ PhysicalDevice::PhysicalDevice(VkInstance instance)
 
     for (VkPhysicalDevice p : physicalDevices)
     {
+        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
         VkPhysicalDeviceRayTracingPipelineFeaturesKHR rtFeatures = {};
         rtFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
+        rtFeatures.pNext = &indexingFeatures;
 
         VkPhysicalDeviceFeatures2 deviceFeatures2 = {};
         deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
@@ -67,6 +73,15 @@ PhysicalDevice::PhysicalDevice(VkInstance instance)
             vkGetPhysicalDeviceProperties2(physDevice, &deviceProp2);
             vkGetPhysicalDeviceMemoryProperties(physDevice, &memoryProperties);
 
+            if (deviceProp2.properties.limits.timestampComputeAndGraphics)
+            {
+                timestampPeriod = deviceProp2.properties.limits.timestampPeriod;
+            }
+
+            descriptorPartiallyBoundSupported = indexingFeatures.descriptorBindingPartiallyBound;
+            maxSampledImageDescriptorCount = std::min(deviceProp2.properties.limits.maxPerStageDescriptorSampledImages,
+                                                      deviceProp2.properties.limits.maxDescriptorSetSampledImages);
+
             break;
         }
     }
@@ -131,3 +146,18 @@ const VkPhysicalDeviceRayTracingPipelinePropertiesKHR &PhysicalDevice::GetRTPipe
 {
     return rtPipelineProperties;
 }
+
+float PhysicalDevice::GetTimestampPeriod() const
+{
+    return timestampPeriod;
+}
+
+bool PhysicalDevice::IsDescriptorPartiallyBoundSupported() const
+{
+    return descriptorPartiallyBoundSupported;
+}
+
+uint32_t PhysicalDevice::GetMaxSampledImageDescriptorCount() const
+{
+    return maxSampledImageDescriptorCount;
+}
@@ -40,12 +40,21 @@ public:
     uint32_t GetMemoryTypeIndex(uint32_t memoryTypeBits, VkFlags requirementsMask) const;
     const VkPhysicalDeviceMemoryProperties &GetMemoryProperties() const;
     const VkPhysicalDeviceRayTracingPipelinePropertiesKHR &GetRTPipelineProperties() const;
+    // Nanoseconds per timestamp tick. Zero, if timestamps are not supported.
+    float GetTimestampPeriod() const;
+    // If true, descriptors in arrays can be left unwritten, if shaders don't access them.
+    bool IsDescriptorPartiallyBoundSupported() const;
+    // Max amount of sampled image descriptors in a pipeline stage.
+    uint32_t GetMaxSampledImageDescriptorCount() const;
 
 private:
     // selected physical device
     VkPhysicalDevice physDevice;
     VkPhysicalDeviceMemoryProperties memoryProperties;
     VkPhysicalDeviceRayTracingPipelinePropertiesKHR rtPipelineProperties;
+    float timestampPeriod;
+    bool descriptorPartiallyBoundSupported;
+    uint32_t maxSampledImageDescriptorCount;
 };
 
 }
\ No newline at end of file
@@ -52,14 +52,27 @@ VkQueue Queues::GetTransfer() const
     return transfer;
 }
 
+VkQueue Queues::GetAsyncCompute() const
+{
+    return asyncCompute;
+}
+
+bool Queues::IsAsyncComputeAvailable() const
+{
+    return hasAsyncCompute && asyncCompute != VK_NULL_HANDLE;
+}
+
 Queues::Queues(VkPhysicalDevice physDevice, VkSurfaceKHR surface) :
     defaultQueuePriority(0),
+    graphicsQueuePriorities{ 0, 0 },
     indexGraphics(UINT32_MAX),
     indexCompute(UINT32_MAX),
     indexTransfer(UINT32_MAX),
     graphics(VK_NULL_HANDLE),
     compute(VK_NULL_HANDLE),
-    transfer(VK_NULL_HANDLE)
+    transfer(VK_NULL_HANDLE),
+    hasAsyncCompute(false),
+    asyncCompute(VK_NULL_HANDLE)
 {
     uint32_t queueFamilyCount = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(physDevice, &queueFamilyCount, nullptr);
@@ -110,6 +123,10 @@ Queues::Queues(VkPhysicalDevice physDevice, VkSurfaceKHR surface) :
     {
         indexTransfer = indexGraphics;
     }
+
+    // the additional queue is taken from the graphics family,
+    // so resources can be shared without queue family ownership transfers
+    hasAsyncCompute = queueFamilyProperties[indexGraphics].queueCount >= 2;
 }
 
 Queues::~Queues()
@@ -120,6 +137,11 @@ void Queues::SetDevice(VkDevice device)
     vkGetDeviceQueue(device, indexGraphics, 0, &graphics);
     vkGetDeviceQueue(device, indexCompute, 0, &compute);
     vkGetDeviceQueue(device, indexTransfer, 0, &transfer);
+
+    if (hasAsyncCompute)
+    {
+        vkGetDeviceQueue(device, indexGraphics, 1, &asyncCompute);
+    }
 }
 
 void Queues::GetDeviceQueueCreateInfos(std::vector<VkDeviceQueueCreateInfo>& outInfos) const
@@ -128,8 +150,8 @@ void Queues::GetDeviceQueueCreateInfos(std::vector<VkDeviceQueueCreateInfo>& out
 
     queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
     queueInfo.queueFamilyIndex = indexGraphics;
-    queueInfo.queueCount = 1;
-    queueInfo.pQueuePriorities = &defaultQueuePriority;
+    queueInfo.queueCount = hasAsyncCompute ? 2 : 1;
+    queueInfo.pQueuePriorities = graphicsQueuePriorities;
     outInfos.push_back(queueInfo);
 
     if (indexCompute != indexGraphics)
@@ -48,9 +48,15 @@ public:
     VkQueue GetCompute() const;
     VkQueue GetTransfer() const;
 
+    // Second queue of the graphics family, that is used for overlapping
+    // compute work with the main graphics queue. Null, if not available.
+    VkQueue GetAsyncCompute() const;
+    bool IsAsyncComputeAvailable() const;
+
 private:
     std::vector<VkQueueFamilyProperties> queueFamilyProperties;
     float defaultQueuePriority;
+    float graphicsQueuePriorities[2];
 
     uint32_t indexGraphics;
     uint32_t indexCompute;
@@ -59,6 +65,9 @@ private:
     VkQueue graphics;
     VkQueue compute;
     VkQueue transfer;
+
+    bool hasAsyncCompute;
+    VkQueue asyncCompute;
 };
 
 }
\ No newline at end of file
@@ -161,6 +161,15 @@ RgResult rgUploadLensFlare(RgInstance rgInstance, const RgLensFlareUploadInfo *p
     CATCH_OR_RETURN;
 }
 
+RgResult rgUpdateLensFlareIntensity(RgInstance rgInstance, const RgUpdateLensFlareIntensityInfo *pUpdateInfo)
+{
+    try
+    {
+        GetDevice(rgInstance)->UpdateLensFlareIntensity(pUpdateInfo);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgUploadDecal(RgInstance rgInstance, const RgDecalUploadInfo *pUploadInfo)
 {
     try
@@ -236,6 +245,21 @@ RgResult rgCreateStaticMaterial(RgInstance rgInstance, const RgStaticMaterialCre
     CATCH_OR_RETURN;
 }
 
+RgResult rgCreateStaticMaterials(RgInstance rgInstance, uint32_t count, const RgStaticMaterialCreateInfo *pCreateInfos,
+                                 RgMaterial *pResults)
+{
+    for (uint32_t i = 0; pResults != nullptr && i < count; i++)
+    {
+        pResults[i] = RG_NO_MATERIAL;
+    }
+
+    try
+    {
+        GetDevice(rgInstance)->CreateStaticMaterials(count, pCreateInfos, pResults);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgCreateAnimatedMaterial(RgInstance rgInstance, const RgAnimatedMaterialCreateInfo *pCreateInfo,
                                  RgMaterial *pResult)
 {
@@ -304,6 +328,51 @@ RgResult rgDestroyCubemap(RgInstance rgInstance, RgCubemap cubemap)
     CATCH_OR_RETURN;
 }
 
+RgResult rgRefreshOverridenTexturesIndex(RgInstance rgInstance)
+{
+    try
+    {
+        GetDevice(rgInstance)->RefreshOverridenTexturesIndex();
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgGetTextureStreamingStats(RgInstance rgInstance, RgTextureStreamingStats *pOutStats)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetTextureStreamingStats(pOutStats);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgGetTextureDeduplicationStats(RgInstance rgInstance, RgTextureDeduplicationStats *pOutStats)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetTextureDeduplicationStats(pOutStats);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgGetTextureSlotStats(RgInstance rgInstance, RgTextureSlotStats *pOutStats)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetTextureSlotStats(pOutStats);
+    }
+    CATCH_OR_RETURN;
+}
+
+RgResult rgGetFrameLatencyStats(RgInstance rgInstance, RgFrameLatencyStats *pOutStats)
+{
+    try
+    {
+        GetDevice(rgInstance)->GetFrameLatencyStats(pOutStats);
+    }
+    CATCH_OR_RETURN;
+}
+
 RgResult rgStartFrame(RgInstance rgInstance, const RgStartFrameInfo *pStartInfo)
 {
     try
@@ -45,6 +45,8 @@ RTGL1::RasterPass::RasterPass(
     rasterSkyRenderPass(VK_NULL_HANDLE),
     rasterWidth(0),
     rasterHeight(0),
+    framebufWidth(0),
+    framebufHeight(0),
     rasterFramebuffers{},
     rasterSkyFramebuffers{},
     depthImages{},
@@ -142,6 +144,16 @@ void RTGL1::RasterPass::CreateFramebuffers(uint32_t renderWidth, uint32_t render
 
     depthCopying->CreateFramebuffers(depthViews, renderWidth, renderHeight);
 
+    this->rasterWidth = renderWidth;
+    this->rasterHeight = renderHeight;
+    this->framebufWidth = renderWidth;
+    this->framebufHeight = renderHeight;
+}
+
+void RTGL1::RasterPass::SetRenderSize(uint32_t renderWidth, uint32_t renderHeight)
+{
+    assert(renderWidth <= framebufWidth && renderHeight <= framebufHeight);
+
     this->rasterWidth = renderWidth;
     this->rasterHeight = renderHeight;
 }
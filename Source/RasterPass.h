@@ -53,6 +53,9 @@ public:
                             const std::shared_ptr<MemoryAllocator> &allocator,
                             const std::shared_ptr<CommandBufferManager> &cmdManager);
     void DestroyFramebuffers();
+    // Framebuffers are allocated for the maximum size,
+    // but with dynamic resolution only their part is used
+    void SetRenderSize(uint32_t renderWidth, uint32_t renderHeight);
 
     void OnShaderReload(const ShaderManager *shaderManager) override;
 
@@ -84,6 +87,8 @@ private:
 
     uint32_t rasterWidth;
     uint32_t rasterHeight;
+    uint32_t framebufWidth;
+    uint32_t framebufHeight;
 
     VkFramebuffer rasterFramebuffers[MAX_FRAMES_IN_FLIGHT];
     VkFramebuffer rasterSkyFramebuffers[MAX_FRAMES_IN_FLIGHT];
@@ -21,6 +21,7 @@
 #include "RasterizedDataCollector.h"
 
 #include <algorithm>
+#include <cfloat>
 
 #include "Utils.h"
 #include "RgException.h"
@@ -83,9 +84,9 @@ RasterizedDataCollector::RasterizedDataCollector(
 RasterizedDataCollector::~RasterizedDataCollector()
 {}
 
-void RasterizedDataCollector::AddGeometry(uint32_t frameIndex, 
-                                          const RgRasterizedGeometryUploadInfo &info, 
-                                          const float *pViewProjection, const RgViewport *pViewport)
+const RasterizedDataCollector::DrawInfo *RasterizedDataCollector::AddGeometry(uint32_t frameIndex, 
+                                                                              const RgRasterizedGeometryUploadInfo &info, 
+                                                                              const float *pViewProjection, const RgViewport *pViewport)
 {
     assert(info.vertexCount > 0);
 
@@ -132,13 +133,13 @@ void RasterizedDataCollector::AddGeometry(uint32_t frameIndex,
     if ((uint64_t)curVertexCount + info.vertexCount >= vertexBuffer->GetSize() / sizeof(RasterizerVertex))
     {
         assert(0 && "Increase the size of \"rasterizedMaxVertexCount\". Vertex buffer size reached the limit.");
-        return;
+        return nullptr;
     }
 
     if ((uint64_t)curIndexCount + info.indexCount >= indexBuffer->GetSize() / sizeof(uint32_t))
     {
         assert(0 && "Increase the size of \"rasterizedMaxIndexCount\". Index buffer size reached the limit.");
-        return;
+        return nullptr;
     }
 
 
@@ -146,7 +147,7 @@ void RasterizedDataCollector::AddGeometry(uint32_t frameIndex,
 
     if (pDrawInfo == nullptr)
     {
-        return;
+        return nullptr;
     }
 
     DrawInfo &drawInfo = *pDrawInfo;
@@ -213,7 +214,7 @@ void RasterizedDataCollector::AddGeometry(uint32_t frameIndex,
         if ((uint64_t)curIndexCount + info.indexCount >= indexBuffer->GetSize() / sizeof(uint32_t))
         {
             assert(0);
-            return;
+            return pDrawInfo;
         }
 
         uint32_t *dstIndices = (uint32_t*)indexBuffer->GetMapped(frameIndex) + curIndexCount;
@@ -224,34 +225,49 @@ void RasterizedDataCollector::AddGeometry(uint32_t frameIndex,
 
         curIndexCount += info.indexCount;
     }
+
+    return pDrawInfo;
 }
 
 void RasterizedDataCollector::CopyFromSeparateArrays(const RgRasterizedGeometryUploadInfo &info, RasterizerVertex *dstVerts)
 {
     assert(info.pArrays != nullptr);
 
-    const auto &src = *info.pArrays;
-
     for (uint32_t i = 0; i < info.vertexCount; i++)
     {
-        auto *srcPos        = (float*)      ((uint8_t*)src.pVertexData      + (uint64_t)i * src.vertexStride);
-        auto *srcColor      = (uint32_t*)   ((uint8_t*)src.pColorData       + (uint64_t)i * src.colorStride);
-        auto *srcTexCoord   = (float*)      ((uint8_t*)src.pTexCoordData    + (uint64_t)i * src.texCoordStride);
+        RasterizerVertex vert = GetVertex(info, i);
+
+        // write to mapped memory
+        memcpy(dstVerts + i, &vert, sizeof(RasterizerVertex));
+    }
+}
+
+RasterizedDataCollector::RasterizerVertex RasterizedDataCollector::GetVertex(const RgRasterizedGeometryUploadInfo &info, uint32_t i)
+{
+    RasterizerVertex vert;
+
+    if (info.pArrays == nullptr)
+    {
+        memcpy(&vert, &info.pStructs[i], sizeof(RasterizerVertex));
+        return vert;
+    }
 
-        RasterizerVertex vert;
+    const auto &src = *info.pArrays;
 
-        vert.position[0] = srcPos[0];
-        vert.position[1] = srcPos[1];
-        vert.position[2] = srcPos[2];
+    auto *srcPos        = (float*)      ((uint8_t*)src.pVertexData      + (uint64_t)i * src.vertexStride);
+    auto *srcColor      = (uint32_t*)   ((uint8_t*)src.pColorData       + (uint64_t)i * src.colorStride);
+    auto *srcTexCoord   = (float*)      ((uint8_t*)src.pTexCoordData    + (uint64_t)i * src.texCoordStride);
 
-        vert.color = src.pColorData ? *srcColor : UINT32_MAX;
+    vert.position[0] = srcPos[0];
+    vert.position[1] = srcPos[1];
+    vert.position[2] = srcPos[2];
 
-        vert.texCoord[0] = src.pTexCoordData ? srcTexCoord[0] : 0;
-        vert.texCoord[1] = src.pTexCoordData ? srcTexCoord[1] : 0;
+    vert.color = src.pColorData ? *srcColor : UINT32_MAX;
 
-        // write to mapped memory
-        memcpy(dstVerts + i, &vert, sizeof(RasterizerVertex));
-    }
+    vert.texCoord[0] = src.pTexCoordData ? srcTexCoord[0] : 0;
+    vert.texCoord[1] = src.pTexCoordData ? srcTexCoord[1] : 0;
+
+    return vert;
 }
 
 void RasterizedDataCollector::CopyFromArrayOfStructs(const RgRasterizedGeometryUploadInfo &info, RasterizerVertex *dstVerts)
@@ -278,6 +294,11 @@ void RasterizedDataCollector::CopyFromStaging(VkCommandBuffer cmd, uint32_t fram
     indexBuffer->CopyFromStaging(cmd, frameIndex, sizeof(uint32_t) * curIndexCount);
 }
 
+std::shared_ptr<TextureManager> RasterizedDataCollector::GetTextureManager() const
+{
+    return textureMgr.lock();
+}
+
 VkBuffer RasterizedDataCollector::GetVertexBuffer() const
 {
     return vertexBuffer->GetDeviceLocal();
@@ -357,7 +378,13 @@ bool RasterizedDataCollectorSky::TryAddGeometry(uint32_t frameIndex, const RgRas
 {
     if (info.renderType == RG_RASTERIZED_GEOMETRY_RENDER_TYPE_SKY)
     {
-        AddGeometry(frameIndex, info, viewProjection, viewport);
+        const DrawInfo *pAdded = AddGeometry(frameIndex, info, viewProjection, viewport);
+
+        if (pAdded != nullptr)
+        {
+            skyDrawStates.push_back(MakeState(info, *pAdded));
+        }
+
         return true;
     }
 
@@ -367,10 +394,162 @@ bool RasterizedDataCollectorSky::TryAddGeometry(uint32_t frameIndex, const RgRas
 void RasterizedDataCollectorSky::Clear(uint32_t frameIndex)
 {
     skyDrawInfos.clear();
+    skyDrawStates.clear();
 
     RasterizedDataCollector::Clear(frameIndex);
 }
 
+namespace
+{
+
+void HashBytes(uint64_t &hash, const void *pData, size_t size)
+{
+    // FNV-1a
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<const uint8_t *>(pData)[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+}
+
+RasterizedDataCollectorSky::SkyDrawState RasterizedDataCollectorSky::MakeState(const RgRasterizedGeometryUploadInfo &uploadInfo, const DrawInfo &info) const
+{
+    SkyDrawState state = {};
+
+    // read user's data instead of the mapped staging memory, which might be uncached;
+    // indices are relative to the first vertex, so the hash doesn't depend on a position in the buffers
+    state.hash = 14695981039346656037ull;
+    HashBytes(state.hash, uploadInfo.pIndexData, sizeof(uint32_t) * info.indexCount);
+    HashBytes(state.hash, &info.transform, sizeof(info.transform));
+    HashBytes(state.hash, info.color, sizeof(info.color));
+    // material handles are generational, unlike texture slots;
+    // texture index is still needed, as it changes with the frame of an animated material
+    HashBytes(state.hash, &uploadInfo.material, sizeof(uploadInfo.material));
+    HashBytes(state.hash, &info.textureIndex, sizeof(info.textureIndex));
+    HashBytes(state.hash, &info.pipelineState, sizeof(info.pipelineState));
+    HashBytes(state.hash, &info.blendFuncSrc, sizeof(info.blendFuncSrc));
+    HashBytes(state.hash, &info.blendFuncDst, sizeof(info.blendFuncDst));
+
+    for (uint32_t a = 0; a < 3; a++)
+    {
+        state.boundsMin[a] = FLT_MAX;
+        state.boundsMax[a] = -FLT_MAX;
+    }
+
+    const auto &m = info.transform.matrix;
+
+    for (uint32_t i = 0; i < info.vertexCount; i++)
+    {
+        const RasterizerVertex v = GetVertex(uploadInfo, i);
+        HashBytes(state.hash, &v, sizeof(v));
+
+        const float *p = v.position;
+
+        for (uint32_t a = 0; a < 3; a++)
+        {
+            float w = m[a][0] * p[0] + m[a][1] * p[1] + m[a][2] * p[2] + m[a][3];
+
+            state.boundsMin[a] = std::min(state.boundsMin[a], w);
+            state.boundsMax[a] = std::max(state.boundsMax[a], w);
+        }
+    }
+
+    state.textureIndex = info.textureIndex;
+
+    if (const auto mgr = GetTextureManager())
+    {
+        state.isAlwaysChanged = mgr->IsDynamicMaterial(uploadInfo.material);
+        state.textureVersion = mgr->GetTextureVersion(info.textureIndex);
+    }
+
+    return state;
+}
+
+uint32_t RasterizedDataCollectorSky::GetCubemapFaces(const SkyDrawState &state, const float *viewProjCubemap)
+{
+    uint32_t faces = 0;
+
+    for (uint32_t f = 0; f < 6; f++)
+    {
+        const float *vp = &viewProjCubemap[16 * f];
+
+        // count corners that are outside of each plane: x < -w, x > w, y < -w, y > w, z < 0 (behind near plane)
+        uint32_t outside[5] = {};
+
+        for (uint32_t c = 0; c < 8; c++)
+        {
+            const float p[3] =
+            {
+                (c & 1) ? state.boundsMax[0] : state.boundsMin[0],
+                (c & 2) ? state.boundsMax[1] : state.boundsMin[1],
+                (c & 4) ? state.boundsMax[2] : state.boundsMin[2],
+            };
+
+            // column-major
+            float clip[4];
+            for (uint32_t r = 0; r < 4; r++)
+            {
+                clip[r] = vp[0 + r] * p[0] + vp[4 + r] * p[1] + vp[8 + r] * p[2] + vp[12 + r];
+            }
+
+            outside[0] += clip[0] < -clip[3];
+            outside[1] += clip[0] >  clip[3];
+            outside[2] += clip[1] < -clip[3];
+            outside[3] += clip[1] >  clip[3];
+            outside[4] += clip[2] <  0;
+        }
+
+        // conservative: the face is affected, if the box is not fully outside of any plane
+        if (outside[0] < 8 && outside[1] < 8 && outside[2] < 8 && outside[3] < 8 && outside[4] < 8)
+        {
+            faces |= 1u << f;
+        }
+    }
+
+    return faces;
+}
+
+uint32_t RasterizedDataCollectorSky::TakeChangedCubemapFaces(const float *viewProjCubemap)
+{
+    uint32_t faces = 0;
+
+    // texture contents could be changed since the states were made
+    if (const auto mgr = GetTextureManager())
+    {
+        for (SkyDrawState &s : skyDrawStates)
+        {
+            s.textureVersion = mgr->GetTextureVersion(s.textureIndex);
+        }
+    }
+
+    const size_t count = std::max(skyDrawStates.size(), prevSkyDrawStates.size());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const SkyDrawState *cur  = i < skyDrawStates.size()     ? &skyDrawStates[i]     : nullptr;
+        const SkyDrawState *prev = i < prevSkyDrawStates.size() ? &prevSkyDrawStates[i] : nullptr;
+
+        // draw order matters because of blending, so compare by index
+        bool isSame = 
+            cur != nullptr && prev != nullptr && 
+            cur->hash == prev->hash && 
+            cur->textureVersion == prev->textureVersion &&
+            !cur->isAlwaysChanged;
+
+        if (!isSame)
+        {
+            // both old and new areas must be redrawn
+            faces |= cur  != nullptr ? GetCubemapFaces(*cur,  viewProjCubemap) : 0;
+            faces |= prev != nullptr ? GetCubemapFaces(*prev, viewProjCubemap) : 0;
+        }
+    }
+
+    prevSkyDrawStates = skyDrawStates;
+    return faces;
+}
+
 const std::vector<RasterizedDataCollector::DrawInfo> & RasterizedDataCollectorSky::GetSkyDrawInfos() const
 {
     return skyDrawInfos;
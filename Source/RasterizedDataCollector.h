@@ -83,14 +83,19 @@ public:
     static void GetVertexLayout(VkVertexInputAttributeDescription *outAttrs, uint32_t *outAttrsCount);
 
 protected:
-    void AddGeometry(uint32_t frameIndex,
-                     const RgRasterizedGeometryUploadInfo &info, 
-                     const float *viewProjection, const RgViewport *viewport);
+    struct RasterizerVertex;
+
+protected:
+    // Returns null, if geometry wasn't added
+    const DrawInfo *AddGeometry(uint32_t frameIndex,
+                                const RgRasterizedGeometryUploadInfo &info, 
+                                const float *viewProjection, const RgViewport *viewport);
 
     virtual DrawInfo *PushInfo(RgRasterizedGeometryRenderType renderType) = 0;
 
-private:
-    struct RasterizerVertex;
+    // Read vertex from user's data, as it will be stored in the vertex buffer
+    static RasterizerVertex GetVertex(const RgRasterizedGeometryUploadInfo &info, uint32_t index);
+    std::shared_ptr<TextureManager> GetTextureManager() const;
 
 private:
     static void CopyFromSeparateArrays(const RgRasterizedGeometryUploadInfo &info, RasterizerVertex *dstVerts);
@@ -163,11 +168,37 @@ public:
 
     const std::vector<DrawInfo> &GetSkyDrawInfos() const;
 
+    // Compare current sky draw infos with the ones that were current
+    // in the previous call, and return a mask of cubemap faces that are affected
+    // by the difference. 'viewProjCubemap' is 6 column-major 4x4 matrices.
+    uint32_t TakeChangedCubemapFaces(const float *viewProjCubemap);
+
 protected:
     DrawInfo *PushInfo(RgRasterizedGeometryRenderType renderType) override;
 
+private:
+    struct SkyDrawState
+    {
+        uint64_t    hash;
+        // world space bounds
+        float       boundsMin[3];
+        float       boundsMax[3];
+        // e.g. dynamic material's texture content can be changed without changing the hash
+        bool        isAlwaysChanged;
+        // texture slot contents can change without changing the hash,
+        // e.g. with texture streaming, so its version is compared too
+        uint32_t    textureIndex;
+        uint32_t    textureVersion;
+    };
+
+    SkyDrawState MakeState(const RgRasterizedGeometryUploadInfo &uploadInfo, const DrawInfo &info) const;
+    static uint32_t GetCubemapFaces(const SkyDrawState &state, const float *viewProjCubemap);
+
 private:
     std::vector<DrawInfo> skyDrawInfos;
+
+    std::vector<SkyDrawState> skyDrawStates;
+    std::vector<SkyDrawState> prevSkyDrawStates;
 };
 
 }
\ No newline at end of file
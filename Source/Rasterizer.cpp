@@ -32,7 +32,7 @@
 namespace RTGL1
 {
 
-
+constexpr uint32_t ALL_CUBEMAP_FACES = 0b111111;
 
 struct RasterizedPushConst
 {
@@ -80,7 +80,11 @@ Rasterizer::Rasterizer(
     allocator(std::move(_allocator)),
     cmdManager(std::move(_cmdManager)),
     storageFramebuffers(std::move(_storageFramebuffers)),
-    isCubemapOutdated(true)
+    dirtySkyCubemapFaces(ALL_CUBEMAP_FACES),
+    skyCubemapFacesPerFrame(_instanceInfo.rasterizedSkyCubemapFacesPerFrame),
+    nextSkyCubemapFace(0),
+    skyCubemapViewerPosition{},
+    isSkyGeometryReused(false)
 {
     collectorGeneral = std::make_shared<RasterizedDataCollectorGeneral>(device, allocator, _textureManager, _instanceInfo.rasterizedMaxVertexCount, _instanceInfo.rasterizedMaxIndexCount);
     collectorSky = std::make_shared<RasterizedDataCollectorSky>(device, allocator, _textureManager, _instanceInfo.rasterizedSkyMaxVertexCount, _instanceInfo.rasterizedSkyMaxIndexCount);
@@ -106,9 +110,10 @@ void Rasterizer::PrepareForFrame(uint32_t frameIndex, bool requestRasterizedSkyG
     if (!requestRasterizedSkyGeometryReuse)
     {
         collectorSky->Clear(frameIndex);
-        isCubemapOutdated = true;
     }
 
+    isSkyGeometryReused = requestRasterizedSkyGeometryReuse;
+
     lensFlares->PrepareForFrame(frameIndex);
 }
 
@@ -121,11 +126,7 @@ void Rasterizer::Upload(uint32_t frameIndex,
     bool addedSkyGeom = collectorSky->TryAddGeometry(frameIndex, uploadInfo, viewProjection, viewport);
 
     // if trying to add geometry, but requestRasterizedSkyGeometryReuse was true
-    if (addedSkyGeom && !isCubemapOutdated)
-    {
-        assert(0);
-        isCubemapOutdated = true;
-    }
+    assert(!(addedSkyGeom && isSkyGeometryReused));
 }
 
 void Rasterizer::UploadLensFlare(uint32_t frameIndex, const RgLensFlareUploadInfo &uploadInfo)
@@ -133,6 +134,21 @@ void Rasterizer::UploadLensFlare(uint32_t frameIndex, const RgLensFlareUploadInf
     lensFlares->Upload(frameIndex, uploadInfo);
 }
 
+void Rasterizer::UpdateLensFlareIntensity(const RgUpdateLensFlareIntensityInfo &updateInfo)
+{
+    lensFlares->UpdateIntensity(updateInfo);
+}
+
+void Rasterizer::StartNewStaticLensFlares()
+{
+    lensFlares->StartNewStatic();
+}
+
+void Rasterizer::SubmitStaticLensFlares()
+{
+    lensFlares->SubmitStatic();
+}
+
 void Rasterizer::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
 {
     CmdLabel label(cmd, "Copying rasterizer data");
@@ -143,17 +159,60 @@ void Rasterizer::SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex)
     lensFlares->SubmitForFrame(cmd, frameIndex);
 }
 
+void Rasterizer::SetRenderSize(uint32_t renderWidth, uint32_t renderHeight)
+{
+    rasterPass->SetRenderSize(renderWidth, renderHeight);
+}
+
 void Rasterizer::DrawSkyToCubemap(VkCommandBuffer cmd, uint32_t frameIndex, 
                                   const std::shared_ptr<TextureManager> &textureManager, 
                                   const std::shared_ptr<GlobalUniform> &uniform)
 {
-    if (isCubemapOutdated)
+    const ShGlobalUniform *gu = uniform->GetData();
+
+    // cubemap is centered at the viewer position
+    if (memcmp(skyCubemapViewerPosition, gu->skyViewerPosition, sizeof(skyCubemapViewerPosition)) != 0)
+    {
+        memcpy(skyCubemapViewerPosition, gu->skyViewerPosition, sizeof(skyCubemapViewerPosition));
+        dirtySkyCubemapFaces = ALL_CUBEMAP_FACES;
+    }
+
+    // unchanged sky uploads don't invalidate the cubemap
+    dirtySkyCubemapFaces |= collectorSky->TakeChangedCubemapFaces(gu->viewProjCubemap);
+
+    if (dirtySkyCubemapFaces == 0)
+    {
+        return;
+    }
+
+    uint32_t facesToDraw = dirtySkyCubemapFaces;
+
+    if (skyCubemapFacesPerFrame > 0)
+    {
+        facesToDraw = 0;
+
+        // round-robin, so constantly changing faces don't starve the others
+        for (uint32_t i = 0, drawn = 0; i < 6 && drawn < skyCubemapFacesPerFrame; i++)
+        {
+            uint32_t f = (nextSkyCubemapFace + i) % 6;
+
+            if (dirtySkyCubemapFaces & (1u << f))
+            {
+                facesToDraw |= 1u << f;
+                drawn++;
+
+                nextSkyCubemapFace = (f + 1) % 6;
+            }
+        }
+    }
+
     {
         CmdLabel label(cmd, "Rasterized sky to cubemap");
 
-        renderCubemap->Draw(cmd, frameIndex, collectorSky, textureManager, uniform);
-        isCubemapOutdated = false;        
+        renderCubemap->Draw(cmd, frameIndex, facesToDraw, collectorSky, textureManager, uniform);
     }
+
+    dirtySkyCubemapFaces &= ~facesToDraw;
 }
 
 void Rasterizer::DrawSkyToAlbedo(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<TextureManager> &textureManager, 
@@ -197,11 +256,22 @@ void Rasterizer::DrawSkyToAlbedo(VkCommandBuffer cmd, uint32_t frameIndex, const
     Draw(cmd, frameIndex, params);
 }
 
+void Rasterizer::CullLensFlares(VkCommandBuffer cmd, uint32_t frameIndex, const RgDrawFrameLensFlareParams *pLensFlareParams)
+{
+    CmdLabel label(cmd, "Lens flares culling");
+
+
+    storageFramebuffers->BarrierOne(cmd, frameIndex, FramebufferImageIndex::FB_IMAGE_INDEX_DEPTH);
+
+
+    lensFlares->SetParams(pLensFlareParams);
+    lensFlares->Cull(cmd, frameIndex);
+}
+
 void Rasterizer::DrawToFinalImage(VkCommandBuffer cmd, uint32_t frameIndex, 
                                   const std::shared_ptr<TextureManager> &textureManager, 
                                   float *view, float *proj,
-                                  bool werePrimaryTraced,
-                                  const RgDrawFrameLensFlareParams *pLensFlareParams)
+                                  bool werePrimaryTraced)
 {
     CmdLabel label(cmd, "Rasterized to final framebuf");
 
@@ -215,11 +285,6 @@ void Rasterizer::DrawToFinalImage(VkCommandBuffer cmd, uint32_t frameIndex,
     storageFramebuffers->BarrierMultiple(cmd, frameIndex, fs);
 
 
-    // prepare lens flares draw commands
-    lensFlares->SetParams(pLensFlareParams);
-    lensFlares->Cull(cmd, frameIndex);
-
-
     // copy depth buffer
     rasterPass->PrepareForFinal(cmd, frameIndex, storageFramebuffers, werePrimaryTraced);
 
@@ -404,6 +469,7 @@ void Rasterizer::OnShaderReload(const ShaderManager *shaderManager)
     rasterPass->OnShaderReload(shaderManager);
     swapchainPass->OnShaderReload(shaderManager);
     renderCubemap->OnShaderReload(shaderManager);
+    dirtySkyCubemapFaces = ALL_CUBEMAP_FACES;
     lensFlares->OnShaderReload(shaderManager);
 }
 
@@ -69,11 +69,18 @@ public:
                 const RgRasterizedGeometryUploadInfo &uploadInfo, 
                 const float *viewProjection, const RgViewport *viewport);
     void UploadLensFlare(uint32_t frameIndex, const RgLensFlareUploadInfo &uploadInfo);
+    void UpdateLensFlareIntensity(const RgUpdateLensFlareIntensityInfo &updateInfo);
+    void StartNewStaticLensFlares();
+    void SubmitStaticLensFlares();
 
     void SubmitForFrame(VkCommandBuffer cmd, uint32_t frameIndex);
+    void SetRenderSize(uint32_t renderWidth, uint32_t renderHeight);
     void DrawSkyToCubemap(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<TextureManager> &textureManager, const std::shared_ptr<GlobalUniform> &uniform);
     void DrawSkyToAlbedo(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<TextureManager> &textureManager, float *view, const float skyViewerPos[3], float *proj, const RgFloat2D &jitter, const RenderResolutionHelper &renderResolution);
-    void DrawToFinalImage(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<TextureManager> &textureManager, float *view, float *proj, bool werePrimaryTraced, const RgDrawFrameLensFlareParams *pLensFlareParams);
+    // Prepare lens flares draw commands, must be called before DrawToFinalImage.
+    // Depth buffer must be already filled.
+    void CullLensFlares(VkCommandBuffer cmd, uint32_t frameIndex, const RgDrawFrameLensFlareParams *pLensFlareParams);
+    void DrawToFinalImage(VkCommandBuffer cmd, uint32_t frameIndex, const std::shared_ptr<TextureManager> &textureManager, float *view, float *proj, bool werePrimaryTraced);
     void DrawToSwapchain(VkCommandBuffer cmd, uint32_t frameIndex, FramebufferImageIndex imageToDrawIn, const std::shared_ptr<TextureManager> &textureManager, float *view, float *proj);
     
     void OnShaderReload(const ShaderManager *shaderManager) override;
@@ -126,7 +133,13 @@ private:
     std::shared_ptr<RasterizedDataCollectorGeneral> collectorGeneral;
     std::shared_ptr<RasterizedDataCollectorSky> collectorSky;
 
-    bool isCubemapOutdated;
+    // bit per cubemap face that must be redrawn
+    uint32_t dirtySkyCubemapFaces;
+    uint32_t skyCubemapFacesPerFrame;
+    // to start time-sliced redraw from the face after the last drawn
+    uint32_t nextSkyCubemapFace;
+    float skyCubemapViewerPosition[3];
+    bool isSkyGeometryReused;
     std::shared_ptr<RenderCubemap> renderCubemap;
 
     std::unique_ptr<LensFlares> lensFlares;
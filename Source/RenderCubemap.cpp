@@ -39,12 +39,14 @@ struct RasterizedMultiviewPushConst
     float model[16];
     float color[4];
     uint32_t textureIndex;
+    uint32_t faceMask;
 
-    explicit RasterizedMultiviewPushConst(const RasterizedDataCollector::DrawInfo &info)
+    explicit RasterizedMultiviewPushConst(const RasterizedDataCollector::DrawInfo &info, uint32_t _faceMask)
     {
         Matrix::ToMat4Transposed(model, info.transform);
         memcpy(color, info.color, 4 * sizeof(float));
         textureIndex = info.textureIndex;
+        faceMask = _faceMask;
     }
 };
 
@@ -113,14 +115,14 @@ void RTGL1::RenderCubemap::OnShaderReload(const ShaderManager *shaderManager)
     pipelines->SetShaders(shaderManager, "VertRasterizerMultiview", "FragRasterizer");
 }
 
-void RTGL1::RenderCubemap::Draw(VkCommandBuffer cmd, uint32_t frameIndex,
+void RTGL1::RenderCubemap::Draw(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t faceMask,
                                 const std::shared_ptr<RasterizedDataCollectorSky> &skyDataCollector,
                                 const std::shared_ptr<TextureManager> &textureManager,
                                 const std::shared_ptr<GlobalUniform> &uniform)
 {
     const auto &drawInfos = skyDataCollector->GetSkyDrawInfos();
 
-    if (drawInfos.empty())
+    if (drawInfos.empty() || faceMask == 0)
     {
         return;
     }
@@ -173,7 +175,7 @@ void RTGL1::RenderCubemap::Draw(VkCommandBuffer cmd, uint32_t frameIndex,
 
         // push const
         {
-            RasterizedMultiviewPushConst push(info);
+            RasterizedMultiviewPushConst push(info, faceMask);
 
             vkCmdPushConstants(
                 cmd, pipelines->GetPipelineLayout(),
@@ -221,7 +223,7 @@ void RTGL1::RenderCubemap::CreatePipelineLayout(VkDescriptorSetLayout texturesSe
     };
     const uint32_t setLayoutCount = sizeof(setLayouts) / sizeof(setLayouts[0]);
 
-    static_assert(sizeof(RasterizedMultiviewPushConst) == 16 * sizeof(float) + 4 * sizeof(float) + sizeof(uint32_t), "");
+    static_assert(sizeof(RasterizedMultiviewPushConst) == 16 * sizeof(float) + 4 * sizeof(float) + 2 * sizeof(uint32_t), "");
 
     VkPushConstantRange pushConst = {};
     pushConst.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -249,7 +251,8 @@ void RTGL1::RenderCubemap::CreateRenderPass()
     auto &colorAttch = attchs[0];
     colorAttch.format = CUBEMAP_FORMAT;
     colorAttch.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttch.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    // faces that are not redrawn must keep their content
+    colorAttch.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
     colorAttch.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttch.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttch.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -288,7 +291,7 @@ void RTGL1::RenderCubemap::CreateRenderPass()
     dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.srcAccessMask = 0;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
 
     // cubemap, 6 faces
@@ -48,8 +48,9 @@ public:
     RenderCubemap &operator=(const RenderCubemap &other) = delete;
     RenderCubemap &operator=(RenderCubemap &&other) noexcept = delete;
 
-    // Draw to a cubemap
-    void Draw(VkCommandBuffer cmd, uint32_t frameIndex,
+    // Draw to cubemap faces, which bits are set in 'faceMask',
+    // other faces keep their previous content
+    void Draw(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t faceMask,
               const std::shared_ptr<RasterizedDataCollectorSky> &skyDataCollector,
               const std::shared_ptr<TextureManager> &textureManager,
               const std::shared_ptr<GlobalUniform> &uniform);
@@ -0,0 +1,155 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RenderGraph.h"
+
+#include <algorithm>
+
+#include "CmdLabel.h"
+
+using namespace RTGL1;
+
+RenderGraph::RenderGraph(std::shared_ptr<Framebuffers> _framebuffers)
+    : framebuffers(std::move(_framebuffers))
+{}
+
+void RenderGraph::AddPass(const char *name,
+                          VkPipelineStageFlags2KHR stage,
+                          std::initializer_list<FramebufferImageIndex> reads,
+                          std::initializer_list<FramebufferImageIndex> writes,
+                          PassFunction function)
+{
+    assert(stage != 0);
+
+    passes.push_back(Pass
+    {
+        name,
+        stage,
+        reads,
+        writes,
+        std::move(function),
+    });
+}
+
+void RenderGraph::MarkOutput(FramebufferImageIndex output)
+{
+    if (std::find(outputs.begin(), outputs.end(), output) == outputs.end())
+    {
+        outputs.push_back(output);
+    }
+}
+
+uint32_t RenderGraph::GetResource(std::vector<VkImage> &images, FramebufferImageIndex f, uint32_t frameIndex) const
+{
+    VkImage image = framebuffers->GetImage(f, frameIndex);
+
+    auto it = std::find(images.begin(), images.end(), image);
+
+    if (it != images.end())
+    {
+        return static_cast<uint32_t>(it - images.begin());
+    }
+
+    images.push_back(image);
+    return static_cast<uint32_t>(images.size() - 1);
+}
+
+void RenderGraph::Execute(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    std::vector<VkImage> images;
+
+    std::vector<RenderGraphCompiler::PassDesc> descs;
+    descs.reserve(passes.size());
+
+    for (const Pass &p : passes)
+    {
+        RenderGraphCompiler::PassDesc d = {};
+        d.stage = p.stage;
+
+        for (FramebufferImageIndex r : p.reads)
+        {
+            d.reads.push_back(GetResource(images, r, frameIndex));
+        }
+
+        for (FramebufferImageIndex w : p.writes)
+        {
+            d.writes.push_back(GetResource(images, w, frameIndex));
+        }
+
+        descs.push_back(std::move(d));
+    }
+
+    std::vector<uint32_t> outputResources;
+
+    for (FramebufferImageIndex o : outputs)
+    {
+        outputResources.push_back(GetResource(images, o, frameIndex));
+    }
+
+    const std::vector<RenderGraphCompiler::CompiledPass> compiled = RenderGraphCompiler::Compile(descs, outputResources);
+
+    std::vector<VkImageMemoryBarrier2KHR> barriers;
+
+    for (const RenderGraphCompiler::CompiledPass &c : compiled)
+    {
+        barriers.clear();
+
+        for (const RenderGraphCompiler::Barrier &src : c.barriers)
+        {
+            VkImageMemoryBarrier2KHR b = {};
+            b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+            b.image = images[src.resource];
+            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.srcStageMask = src.srcStage;
+            b.srcAccessMask = src.srcAccess;
+            b.dstStageMask = src.dstStage;
+            b.dstAccessMask = src.dstAccess;
+            // framebuffers are always in general layout
+            b.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+            b.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+            b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            b.subresourceRange.baseMipLevel = 0;
+            b.subresourceRange.levelCount = 1;
+            b.subresourceRange.baseArrayLayer = 0;
+            b.subresourceRange.layerCount = 1;
+
+            barriers.push_back(b);
+        }
+
+        if (!barriers.empty())
+        {
+            VkDependencyInfoKHR dependencyInfo = {};
+            dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+            dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+            dependencyInfo.pImageMemoryBarriers = barriers.data();
+
+            svkCmdPipelineBarrier2KHR(cmd, &dependencyInfo);
+        }
+
+        const Pass &p = passes[c.passIndex];
+
+        CmdLabel label(cmd, p.name);
+        p.function(cmd);
+    }
+
+    passes.clear();
+    outputs.clear();
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Framebuffers.h"
+#include "RenderGraphCompiler.h"
+
+namespace RTGL1
+{
+
+// Declarative list of passes that access framebuffer images.
+// Each pass declares the images it reads and writes, and barriers
+// between the passes are derived from that by RenderGraphCompiler:
+// only read-after-write, write-after-write and write-after-read hazards
+// are synchronized, and all barriers of a pass are batched into one call.
+// Passes that don't contribute to the marked outputs are culled.
+// Passes are recorded in the order they were added.
+class RenderGraph
+{
+public:
+    typedef std::function<void(VkCommandBuffer cmd)> PassFunction;
+
+public:
+    explicit RenderGraph(std::shared_ptr<Framebuffers> framebuffers);
+    ~RenderGraph() = default;
+
+    RenderGraph(const RenderGraph &other) = delete;
+    RenderGraph(RenderGraph &&other) noexcept = delete;
+    RenderGraph &operator=(const RenderGraph &other) = delete;
+    RenderGraph &operator=(RenderGraph &&other) noexcept = delete;
+
+    // "stage" is a shader stage, in which the pass accesses the images.
+    void AddPass(const char *name,
+                 VkPipelineStageFlags2KHR stage,
+                 std::initializer_list<FramebufferImageIndex> reads,
+                 std::initializer_list<FramebufferImageIndex> writes,
+                 PassFunction function);
+
+    // Images that are used after the graph execution.
+    // If none is marked, then no passes are culled.
+    void MarkOutput(FramebufferImageIndex output);
+
+    void Execute(VkCommandBuffer cmd, uint32_t frameIndex);
+
+private:
+    struct Pass
+    {
+        const char                          *name;
+        VkPipelineStageFlags2KHR            stage;
+        std::vector<FramebufferImageIndex>  reads;
+        std::vector<FramebufferImageIndex>  writes;
+        PassFunction                        function;
+    };
+
+private:
+    // Identifier of an image for RenderGraphCompiler;
+    // different framebuffer indices may refer to the same image, e.g. history ones.
+    uint32_t GetResource(std::vector<VkImage> &images, FramebufferImageIndex f, uint32_t frameIndex) const;
+
+private:
+    std::shared_ptr<Framebuffers> framebuffers;
+
+    std::vector<Pass> passes;
+    std::vector<FramebufferImageIndex> outputs;
+};
+
+}
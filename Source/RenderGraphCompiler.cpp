@@ -0,0 +1,188 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RenderGraphCompiler.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace RTGL1;
+
+namespace
+{
+
+bool Contains(const std::vector<uint32_t> &v, uint32_t r)
+{
+    return std::find(v.begin(), v.end(), r) != v.end();
+}
+
+}
+
+std::vector<RenderGraphCompiler::CompiledPass> RenderGraphCompiler::Compile(const std::vector<PassDesc> &passes,
+                                                                            const std::vector<uint32_t> &outputs)
+{
+    const std::vector<bool> isCulled = FindCulledPasses(passes, outputs);
+
+    std::vector<ResourceState> states;
+    std::vector<CompiledPass> compiled;
+
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        if (isCulled[i])
+        {
+            continue;
+        }
+
+        const PassDesc &p = passes[i];
+        assert(p.stage != 0);
+
+        CompiledPass c = {};
+        c.passIndex = i;
+
+        // read-after-write
+        for (uint32_t r : p.reads)
+        {
+            ResourceState &s = GetState(states, r);
+
+            if (s.writeStages != 0 && (p.stage & ~s.visibleStages) != 0)
+            {
+                AddBarrier(c.barriers, r,
+                           s.writeStages, s.writeAccess,
+                           p.stage, VK_ACCESS_2_SHADER_READ_BIT_KHR);
+
+                s.visibleStages |= p.stage;
+            }
+
+            s.readStages |= p.stage;
+        }
+
+        // write-after-write and write-after-read
+        for (uint32_t w : p.writes)
+        {
+            ResourceState &s = GetState(states, w);
+
+            if (s.writeStages != 0 || s.readStages != 0)
+            {
+                // previous reads require only an execution dependency
+                AddBarrier(c.barriers, w,
+                           s.writeStages | s.readStages, s.writeAccess,
+                           p.stage, VK_ACCESS_2_SHADER_WRITE_BIT_KHR);
+            }
+
+            s.writeStages = p.stage;
+            s.writeAccess = VK_ACCESS_2_SHADER_WRITE_BIT_KHR;
+            s.readStages = 0;
+            s.visibleStages = 0;
+        }
+
+        compiled.push_back(std::move(c));
+    }
+
+    return compiled;
+}
+
+std::vector<bool> RenderGraphCompiler::FindCulledPasses(const std::vector<PassDesc> &passes,
+                                                        const std::vector<uint32_t> &outputs)
+{
+    std::vector<bool> isCulled(passes.size(), false);
+
+    if (outputs.empty())
+    {
+        return isCulled;
+    }
+
+    // resources, which contents are needed by the passes that are after the current one
+    std::vector<uint32_t> live = outputs;
+
+    for (size_t i = passes.size(); i-- > 0; )
+    {
+        const PassDesc &p = passes[i];
+
+        bool isUsed = p.writes.empty() ||
+            std::any_of(p.writes.begin(), p.writes.end(), [&live] (uint32_t w) { return Contains(live, w); });
+
+        if (!isUsed)
+        {
+            isCulled[i] = true;
+            continue;
+        }
+
+        // writes may be partial, so written resources stay live
+        for (uint32_t r : p.reads)
+        {
+            if (!Contains(live, r))
+            {
+                live.push_back(r);
+            }
+        }
+    }
+
+    return isCulled;
+}
+
+RenderGraphCompiler::ResourceState &RenderGraphCompiler::GetState(std::vector<ResourceState> &states, uint32_t resource)
+{
+    for (ResourceState &s : states)
+    {
+        if (s.resource == resource)
+        {
+            return s;
+        }
+    }
+
+    // accesses before the graph are unknown, so the first access is fully synchronized
+    states.push_back(ResourceState
+    {
+        resource,
+        VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR,
+        VK_ACCESS_2_MEMORY_WRITE_BIT_KHR,
+        0,
+        0,
+    });
+
+    return states.back();
+}
+
+void RenderGraphCompiler::AddBarrier(std::vector<Barrier> &barriers, uint32_t resource,
+                                     VkPipelineStageFlags2KHR srcStage, VkAccessFlags2KHR srcAccess,
+                                     VkPipelineStageFlags2KHR dstStage, VkAccessFlags2KHR dstAccess)
+{
+    // merge with a barrier for the same resource, if it's a read-write access
+    for (Barrier &b : barriers)
+    {
+        if (b.resource == resource)
+        {
+            b.srcStage |= srcStage;
+            b.srcAccess |= srcAccess;
+            b.dstStage |= dstStage;
+            b.dstAccess |= dstAccess;
+            return;
+        }
+    }
+
+    barriers.push_back(Barrier
+    {
+        resource,
+        srcStage,
+        srcAccess,
+        dstStage,
+        dstAccess,
+    });
+}
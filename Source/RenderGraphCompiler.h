@@ -0,0 +1,91 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace RTGL1
+{
+
+// Derives pass culling and barriers of a RenderGraph.
+// Works only on resource identifiers and flags, and doesn't record
+// any commands, so it doesn't require a Vulkan device.
+class RenderGraphCompiler
+{
+public:
+    struct PassDesc
+    {
+        // shader stage, in which the pass accesses the resources
+        VkPipelineStageFlags2KHR    stage;
+        std::vector<uint32_t>       reads;
+        std::vector<uint32_t>       writes;
+    };
+
+    struct Barrier
+    {
+        uint32_t                    resource;
+        VkPipelineStageFlags2KHR    srcStage;
+        VkAccessFlags2KHR           srcAccess;
+        VkPipelineStageFlags2KHR    dstStage;
+        VkAccessFlags2KHR           dstAccess;
+    };
+
+    struct CompiledPass
+    {
+        uint32_t                    passIndex;
+        // at most one barrier per resource, must be recorded before the pass
+        std::vector<Barrier>        barriers;
+    };
+
+public:
+    // Passes are in recording order, they are never reordered.
+    // Resources with the same identifier are the same image.
+    // Passes that don't contribute to 'outputs' are culled;
+    // if 'outputs' is empty, no passes are culled.
+    static std::vector<CompiledPass> Compile(const std::vector<PassDesc> &passes,
+                                             const std::vector<uint32_t> &outputs);
+
+private:
+    // Synchronization state of a resource between passes
+    struct ResourceState
+    {
+        uint32_t                    resource;
+        VkPipelineStageFlags2KHR    writeStages;
+        VkAccessFlags2KHR           writeAccess;
+        // stages that read the resource after the last write
+        VkPipelineStageFlags2KHR    readStages;
+        // stages that the last write was already made visible to
+        VkPipelineStageFlags2KHR    visibleStages;
+    };
+
+private:
+    static std::vector<bool> FindCulledPasses(const std::vector<PassDesc> &passes,
+                                              const std::vector<uint32_t> &outputs);
+    static ResourceState &GetState(std::vector<ResourceState> &states, uint32_t resource);
+    static void AddBarrier(std::vector<Barrier> &barriers, uint32_t resource,
+                           VkPipelineStageFlags2KHR srcStage, VkAccessFlags2KHR srcAccess,
+                           VkPipelineStageFlags2KHR dstStage, VkAccessFlags2KHR dstAccess);
+};
+
+}
@@ -20,7 +20,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 #include "DLSS.h"
 #include "RgException.h"
@@ -40,9 +42,118 @@ public:
     RenderResolutionHelper &operator=(const RenderResolutionHelper &other) = delete;
     RenderResolutionHelper &operator=(RenderResolutionHelper &&other) noexcept = delete;
 
+    // lastGpuFrameTime is in milliseconds, negative if unknown
     void Setup(const RgDrawFrameRenderResolutionParams *pParams, 
                uint32_t fullWidth, uint32_t fullHeight,
-               const std::shared_ptr<DLSS> &dlss)
+               const std::shared_ptr<DLSS> &dlss,
+               float lastGpuFrameTime)
+    {
+        SetupMaxSize(pParams, fullWidth, fullHeight, dlss);
+
+        allocatedWidth = renderWidth;
+        allocatedHeight = renderHeight;
+
+        if (pParams == nullptr || !pParams->dynamicResolution)
+        {
+            // start from the best quality, when dynamic mode is enabled again
+            dynamicScale = -1.0f;
+            smoothedGpuFrameTime = -1.0f;
+            framesSinceDynamicChange = 0;
+
+            return;
+        }
+
+        // nothing to render, e.g. window is minimized
+        if (renderWidth == 0 || renderHeight == 0)
+        {
+            return;
+        }
+
+        float minScale = pParams->dynamicMinScale > 0.0f ? pParams->dynamicMinScale : DEFAULT_DYNAMIC_MIN_SCALE;
+        float maxScale = pParams->dynamicMaxScale > 0.0f ? pParams->dynamicMaxScale : DEFAULT_DYNAMIC_MAX_SCALE;
+
+        if (minScale > 1.0f || maxScale > 1.0f || minScale > maxScale)
+        {
+            throw RgException(RG_WRONG_ARGUMENT, "RgDrawFrameRenderResolutionParams::dynamicMinScale and dynamicMaxScale must be in (0, 1], and min must not be greater than max");
+        }
+
+        float target = pParams->dynamicTargetGpuFrameTime > 0.0f ? pParams->dynamicTargetGpuFrameTime : DEFAULT_DYNAMIC_TARGET_GPU_FRAME_TIME;
+        float scale = ChooseDynamicScale(target, lastGpuFrameTime, minScale, maxScale);
+
+        // framebuffers are allocated for the max scale, so the render size is always not greater
+        allocatedWidth  = std::max(1u, static_cast<uint32_t>(maxScale * renderWidth));
+        allocatedHeight = std::max(1u, static_cast<uint32_t>(maxScale * renderHeight));
+
+        renderWidth     = std::max(1u, static_cast<uint32_t>(scale * renderWidth));
+        renderHeight    = std::max(1u, static_cast<uint32_t>(scale * renderHeight));
+
+        assert(renderWidth <= allocatedWidth && renderHeight <= allocatedHeight);
+    }
+
+    float GetMipLodBias(float nativeBias = 0.0f) const
+    {
+        // DLSS Programming Guide, Section 3.5;
+        // allocated size is used, to not recreate samplers on each dynamic resolution change
+        float ratio = (float)AllocatedWidth() / (float)UpscaledWidth();
+        float bias =  nativeBias + log2f(std::max(0.01f, ratio)) - 1.0f;
+
+        if (bias < 0)
+        {
+            // softer for non-dlss
+            if (!IsNvDlssEnabled())
+            {
+                bias *= 0.5f;
+            }
+        }
+
+        return bias;
+    }
+
+    // Render width always must be even for checkerboarding!
+    uint32_t Width()            const { return renderWidth + renderWidth % 2; }
+    uint32_t Height()           const { return renderHeight; }
+
+    // Size of render framebuffers; not less than Width() / Height()
+    uint32_t AllocatedWidth()   const { return allocatedWidth + allocatedWidth % 2; }
+    uint32_t AllocatedHeight()  const { return allocatedHeight; }
+
+    uint32_t UpscaledWidth()    const { return upscaledWidth; }
+    uint32_t UpscaledHeight()   const { return upscaledHeight; }
+
+    bool IsAmdFsrEnabled()      const { return upscaleTechnique == RG_RENDER_UPSCALE_TECHNIQUE_AMD_FSR; }
+    bool IsNvDlssEnabled()      const { return upscaleTechnique == RG_RENDER_UPSCALE_TECHNIQUE_NVIDIA_DLSS; }
+    bool IsUpscaleEnabled()     const { return IsAmdFsrEnabled() || IsNvDlssEnabled(); }
+
+    float GetAmdFsrSharpness()  const { return 1.0f; }          // 0.0 - max, 1.0 - min
+    float GetNvDlssSharpness()  const { return dlssSharpness; } 
+
+    // For the additional sharpening pass
+    RgRenderSharpenTechnique GetSharpeningTechnique() const { return sharpenTechnique; }
+    bool                     IsSharpeningEnabled()    const { return sharpenTechnique != RG_RENDER_SHARPEN_TECHNIQUE_NONE; }
+    float                    GetSharpeningIntensity() const { return 1.0f; }
+
+    VkFilter                 GetBlitFilter() const { return upscaleTechnique == RG_RENDER_UPSCALE_TECHNIQUE_NEAREST ? VK_FILTER_NEAREST : VK_FILTER_LINEAR; }
+
+    // RgRenderResolutionMode   GetResolutionMode()      const { return resolutionMode; }
+
+    // Sizes to allocate framebuffers with
+    ResolutionState GetResolutionState() const
+    {
+        assert(AllocatedWidth() % 2 == 0);
+        return ResolutionState{ AllocatedWidth(), AllocatedHeight(), UpscaledWidth(), UpscaledHeight() };
+    }
+
+    // Sizes of the area that is actually rendered in this frame
+    ResolutionState GetActiveResolutionState() const
+    {
+        assert(Width() % 2 == 0);
+        return ResolutionState{ Width(), Height(), UpscaledWidth(), UpscaledHeight() };
+    }
+
+private:
+    void SetupMaxSize(const RgDrawFrameRenderResolutionParams *pParams, 
+                      uint32_t fullWidth, uint32_t fullHeight,
+                      const std::shared_ptr<DLSS> &dlss)
     {   
         renderWidth = fullWidth;
         renderHeight = fullHeight;
@@ -147,57 +258,66 @@ public:
         }
     }
 
-    float GetMipLodBias(float nativeBias = 0.0f) const
+    float ChooseDynamicScale(float targetGpuFrameTime, float lastGpuFrameTime, float minScale, float maxScale)
     {
-        // DLSS Programming Guide, Section 3.5
-        float ratio = (float)Width() / (float)UpscaledWidth();
-        float bias =  nativeBias + log2f(std::max(0.01f, ratio)) - 1.0f;
+        // start from the best quality; bounds could be changed by the user
+        dynamicScale = dynamicScale < 0.0f ? maxScale : std::clamp(dynamicScale, minScale, maxScale);
 
-        if (bias < 0)
+        framesSinceDynamicChange++;
+
+        // timestamps are read back with a delay of MAX_FRAMES_IN_FLIGHT,
+        // so ignore the ones that were measured with the previous scale
+        if (lastGpuFrameTime < 0.0f || framesSinceDynamicChange <= MAX_FRAMES_IN_FLIGHT)
         {
-            // softer for non-dlss
-            if (!IsNvDlssEnabled())
-            {
-                bias *= 0.5f;
-            }
+            return dynamicScale;
         }
 
-        return bias;
-    }
-
-    // Render width always must be even for checkerboarding!
-    uint32_t Width()            const { return renderWidth + renderWidth % 2; }
-    uint32_t Height()           const { return renderHeight; }
-
-    uint32_t UpscaledWidth()    const { return upscaledWidth; }
-    uint32_t UpscaledHeight()   const { return upscaledHeight; }
+        smoothedGpuFrameTime = smoothedGpuFrameTime < 0.0f ?
+            lastGpuFrameTime :
+            smoothedGpuFrameTime + (lastGpuFrameTime - smoothedGpuFrameTime) * DYNAMIC_SMOOTHING_FACTOR;
 
-    bool IsAmdFsrEnabled()      const { return upscaleTechnique == RG_RENDER_UPSCALE_TECHNIQUE_AMD_FSR; }
-    bool IsNvDlssEnabled()      const { return upscaleTechnique == RG_RENDER_UPSCALE_TECHNIQUE_NVIDIA_DLSS; }
-    bool IsUpscaleEnabled()     const { return IsAmdFsrEnabled() || IsNvDlssEnabled(); }
+        if (framesSinceDynamicChange < MAX_FRAMES_IN_FLIGHT + DYNAMIC_MIN_FRAMES_BETWEEN_CHANGES)
+        {
+            return dynamicScale;
+        }
 
-    float GetAmdFsrSharpness()  const { return 1.0f; }          // 0.0 - max, 1.0 - min
-    float GetNvDlssSharpness()  const { return dlssSharpness; } 
+        const float ratio = targetGpuFrameTime / std::max(smoothedGpuFrameTime, 0.01f);
 
-    // For the additional sharpening pass
-    RgRenderSharpenTechnique GetSharpeningTechnique() const { return sharpenTechnique; }
-    bool                     IsSharpeningEnabled()    const { return sharpenTechnique != RG_RENDER_SHARPEN_TECHNIQUE_NONE; }
-    float                    GetSharpeningIntensity() const { return 1.0f; }
+        // dead band to prevent oscillating around the target
+        if (std::abs(ratio - 1.0f) < DYNAMIC_TOLERANCE)
+        {
+            return dynamicScale;
+        }
 
-    VkFilter                 GetBlitFilter() const { return upscaleTechnique == RG_RENDER_UPSCALE_TECHNIQUE_NEAREST ? VK_FILTER_NEAREST : VK_FILTER_LINEAR; }
+        // GPU time is mostly proportional to the pixel count, i.e. to the squared scale
+        const float desired = dynamicScale * std::sqrt(ratio);
+        const float newScale = std::clamp(dynamicScale + (desired - dynamicScale) * DYNAMIC_DAMPING, minScale, maxScale);
 
-    // RgRenderResolutionMode   GetResolutionMode()      const { return resolutionMode; }
+        if (newScale != dynamicScale)
+        {
+            dynamicScale = newScale;
+            smoothedGpuFrameTime = -1.0f;
+            framesSinceDynamicChange = 0;
+        }
 
-    ResolutionState GetResolutionState() const
-    {
-        assert(Width() % 2 == 0);
-        return ResolutionState{ Width(), Height(), UpscaledWidth(), UpscaledHeight() };
+        return dynamicScale;
     }
 
 private:
+    constexpr static float DEFAULT_DYNAMIC_TARGET_GPU_FRAME_TIME = 16.6f;
+    constexpr static float DEFAULT_DYNAMIC_MIN_SCALE = 0.5f;
+    constexpr static float DEFAULT_DYNAMIC_MAX_SCALE = 1.0f;
+    constexpr static float DYNAMIC_SMOOTHING_FACTOR = 0.25f;
+    constexpr static float DYNAMIC_TOLERANCE = 0.05f;
+    constexpr static float DYNAMIC_DAMPING = 0.5f;
+    constexpr static uint32_t DYNAMIC_MIN_FRAMES_BETWEEN_CHANGES = 4;
+
     uint32_t renderWidth = 0;
     uint32_t renderHeight = 0;
 
+    uint32_t allocatedWidth = 0;
+    uint32_t allocatedHeight = 0;
+
     uint32_t upscaledWidth = 0;
     uint32_t upscaledHeight = 0;
 
@@ -206,6 +326,10 @@ private:
     RgRenderResolutionMode      resolutionMode   = RG_RENDER_RESOLUTION_MODE_CUSTOM;
 
     float dlssSharpness = 0.0f;
+
+    float dynamicScale = -1.0f;
+    float smoothedGpuFrameTime = -1.0f;
+    uint32_t framesSinceDynamicChange = 0;
 };
 
 }
\ No newline at end of file
@@ -213,6 +213,7 @@ void Scene::SubmitStatic()
     }
 
     asManager->SubmitStaticGeometry();
+    lightManager->SubmitStatic();
     isRecordingStatic = false;
 
     submittedStaticInCurrentFrame = true;
@@ -276,11 +277,21 @@ void Scene::UploadLight(uint32_t frameIndex, const std::shared_ptr<GlobalUniform
 
 void Scene::UploadLight(uint32_t frameIndex, const RgSphericalLightUploadInfo &lightInfo)
 {
+    if (lightInfo.isStatic && !isRecordingStatic)
+    {
+        throw RgException(RG_WRONG_FUNCTION_CALL, "Static lights must be uploaded only between rgStartNewScene and rgSubmitStaticGeometries calls");
+    }
+
     lightManager->AddSphericalLight(frameIndex, lightInfo);
 }
 
 void RTGL1::Scene::UploadLight(uint32_t frameIndex, const RgPolygonalLightUploadInfo &lightInfo)
 {
+    if (lightInfo.isStatic && !isRecordingStatic)
+    {
+        throw RgException(RG_WRONG_FUNCTION_CALL, "Static lights must be uploaded only between rgStartNewScene and rgSubmitStaticGeometries calls");
+    }
+
     lightManager->AddPolygonalLight(frameIndex, lightInfo);
 }
 
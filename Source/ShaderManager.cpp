@@ -63,6 +63,7 @@ static ShaderModuleDefinition G_SHADERS[] =
     {"CASVGFGradientSamples",   "CmASVGFGradientSamples.comp.spv"      },
     {"CASVGFGradientAtrous",    "CmASVGFGradientAtrous.comp.spv"       },
     {"CBloomDownsample",        "CmBloomDownsample.comp.spv"           },
+    {"CBloomDownsampleSinglePass", "CmBloomDownsampleSinglePass.comp.spv" },
     {"CBloomUpsample",          "CmBloomUpsample.comp.spv"             },
     {"CBloomApply",             "CmBloomApply.comp.spv"                },
     {"CCheckerboard",           "CmCheckerboard.comp.spv"              },
@@ -74,6 +75,7 @@ static ShaderModuleDefinition G_SHADERS[] =
     {"CCullLensFlares",         "CmCullLensFlares.comp.spv"            },
     {"VertDecal",               "RsDecal.vert.spv"                     },
     {"FragDecal",               "RsDecal.frag.spv"                     },
+    {"CDecalApplyTiled",        "CmDecalApplyTiled.comp.spv"           },
     {"EffectWipe",                  "EfWipe.comp.spv"                  },
     {"EffectRadialBlur",            "EfRadialBlur.comp.spv"            },
     {"EffectChromaticAberration",   "EfChromaticAberration.comp.spv"   },
@@ -83,11 +85,12 @@ static ShaderModuleDefinition G_SHADERS[] =
     {"EffectHueShift",              "EfHueShift.comp.spv"              },
     {"EffectCrtDemodulateEncode",   "EfCrtDemodulateEncode.comp.spv"   },
     {"EffectCrtDecode",             "EfCrtDecode.comp.spv"             },
+    {"EffectSimpleFused",           "EfSimpleFused.comp.spv"           },
 };
 
 
 ShaderManager::ShaderManager(VkDevice _device, const char *_pShaderFolderPath, std::shared_ptr<UserFileLoad> _userFileLoad)
-    : device(_device), userFileLoad(std::move(_userFileLoad)), shaderFolderPath(_pShaderFolderPath)
+    : device(_device), userFileLoad(std::move(_userFileLoad)), shaderFolderPath(_pShaderFolderPath), pRecordedUsage(nullptr)
 {
     LoadShaderModules();
 }
@@ -99,14 +102,82 @@ ShaderManager::~ShaderManager()
 
 void ShaderManager::ReloadShaders()
 {
+    std::vector<std::pair<const char *, ShaderModule>> changed;
+
+    // load all changed modules first, so a failure leaves the current ones untouched
+    try
+    {
+        for (const auto &s : G_SHADERS)
+        {
+            const auto &cur = modules.find(s.name);
+            assert(cur != modules.end());
+
+            auto path = shaderFolderPath + s.filename;
+
+            uint64_t hash = 0;
+            VkShaderModule m = LoadModule(path.c_str(), cur->second.contentHash, &hash);
+
+            if (m != VK_NULL_HANDLE)
+            {
+                SET_DEBUG_NAME(device, m, VK_OBJECT_TYPE_SHADER_MODULE, s.name);
+                changed.emplace_back(s.name, ShaderModule{ m, s.stage, hash });
+            }
+        }
+    }
+    catch (...)
+    {
+        for (auto &c : changed)
+        {
+            vkDestroyShaderModule(device, c.second.module, nullptr);
+        }
+
+        throw;
+    }
+
+    if (changed.empty())
+    {
+        return;
+    }
+
+
     vkDeviceWaitIdle(device);
 
-    UnloadShaderModules();
-    LoadShaderModules();
+    rgl::unordered_set<std::string> changedNames;
+    std::vector<VkShaderModule> oldModules;
 
-    NotifySubscribersAboutReload();
+    for (auto &c : changed)
+    {
+        ShaderModule &dst = modules[c.first];
+
+        oldModules.push_back(dst.module);
+        dst = c.second;
+
+        changedNames.insert(c.first);
+    }
+
+    // old modules are already replaced, so they must be destroyed even if a subscriber throws
+    try
+    {
+        NotifySubscribersAboutReload(changedNames);
+    }
+    catch (...)
+    {
+        vkDeviceWaitIdle(device);
+
+        for (VkShaderModule m : oldModules)
+        {
+            vkDestroyShaderModule(device, m, nullptr);
+        }
+
+        throw;
+    }
 
     vkDeviceWaitIdle(device);
+
+    for (VkShaderModule m : oldModules)
+    {
+        vkDestroyShaderModule(device, m, nullptr);
+    }
 }
 
 void ShaderManager::LoadShaderModules()
@@ -124,10 +195,11 @@ void ShaderManager::LoadShaderModules()
 
         auto path = shaderFolderPath + s.filename;
 
-        VkShaderModule m = LoadModule(path.c_str());
+        uint64_t hash = 0;
+        VkShaderModule m = LoadModule(path.c_str(), 0, &hash);
         SET_DEBUG_NAME(device, m, VK_OBJECT_TYPE_SHADER_MODULE, s.name);
 
-        modules[s.name] = { m, s.stage };
+        modules[s.name] = { m, s.stage, hash };
     }
 }
 
@@ -143,6 +215,8 @@ void ShaderManager::UnloadShaderModules()
 
 VkShaderModule ShaderManager::GetShaderModule(const char* name) const
 {
+    RecordUsage(name);
+
     const auto &m = modules.find(name);
     return m != modules.end() ? m->second.module : VK_NULL_HANDLE;
 }
@@ -155,6 +229,8 @@ VkShaderStageFlagBits ShaderManager::GetModuleStage(const char* name) const
 
 VkPipelineShaderStageCreateInfo ShaderManager::GetStageInfo(const char *name) const
 {
+    RecordUsage(name);
+
     const auto &m = modules.find(name);
 
     if (m == modules.end())
@@ -174,7 +250,7 @@ VkPipelineShaderStageCreateInfo ShaderManager::GetStageInfo(const char *name) co
     return info;
 }
 
-VkShaderModule RTGL1::ShaderManager::LoadModule(const char *path)
+VkShaderModule RTGL1::ShaderManager::LoadModule(const char *path, uint64_t unchangedHash, uint64_t *pOutHash)
 {
     if (userFileLoad->Exists())
     {
@@ -186,15 +262,15 @@ VkShaderModule RTGL1::ShaderManager::LoadModule(const char *path)
             throw RgException(RG_WRONG_ARGUMENT, "Can't load shader file \""s + path + "\" using user's file load function"s);
         }
 
-        return LoadModuleFromMemory(static_cast<const uint32_t*>(fileHandle.pData), fileHandle.dataSize);
+        return LoadModuleFromMemory(static_cast<const uint32_t*>(fileHandle.pData), fileHandle.dataSize, unchangedHash, pOutHash);
     }
     else
     {
-        return LoadModuleFromFile(path);
+        return LoadModuleFromFile(path, unchangedHash, pOutHash);
     }
 }
 
-VkShaderModule ShaderManager::LoadModuleFromFile(const char *path)
+VkShaderModule ShaderManager::LoadModuleFromFile(const char *path, uint64_t unchangedHash, uint64_t *pOutHash)
 {
     std::ifstream shaderFile(path, std::ios::binary);
     std::vector<uint8_t> shaderSource(std::istreambuf_iterator<char>(shaderFile), {});
@@ -205,11 +281,26 @@ VkShaderModule ShaderManager::LoadModuleFromFile(const char *path)
         throw RgException(RG_WRONG_ARGUMENT, "Can't find shader file: \""s + path + "\"");
     }
 
-    return LoadModuleFromMemory(reinterpret_cast<const uint32_t*>(shaderSource.data()), shaderSource.size());
+    return LoadModuleFromMemory(reinterpret_cast<const uint32_t*>(shaderSource.data()), shaderSource.size(), unchangedHash, pOutHash);
 }
 
-VkShaderModule ShaderManager::LoadModuleFromMemory(const uint32_t *pCode, uint32_t codeSize)
+VkShaderModule ShaderManager::LoadModuleFromMemory(const uint32_t *pCode, uint32_t codeSize, uint64_t unchangedHash, uint64_t *pOutHash)
 {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t i = 0; i < codeSize; i++)
+    {
+        hash ^= reinterpret_cast<const uint8_t *>(pCode)[i];
+        hash *= 1099511628211ull;
+    }
+
+    *pOutHash = hash;
+
+    if (hash == unchangedHash)
+    {
+        return VK_NULL_HANDLE;
+    }
+
     VkShaderModule shaderModule;
 
     VkShaderModuleCreateInfo moduleInfo = {};
@@ -286,14 +377,14 @@ VkShaderStageFlagBits ShaderManager::GetStageByExtension(const char *name)
 
 void ShaderManager::Subscribe(std::shared_ptr<IShaderDependency> subscriber)
 {
-    subscribers.emplace_back(subscriber);
+    subscribers.push_back({ subscriber, {} });
 }
 
 void ShaderManager::Unsubscribe(const IShaderDependency *subscriber)
 {
-    subscribers.remove_if([subscriber] (const std::weak_ptr<IShaderDependency> &ws)
+    subscribers.remove_if([subscriber] (const Subscriber &sub)
     {
-        if (const auto s = ws.lock())
+        if (const auto s = sub.ptr.lock())
         {
             return s.get() == subscriber;
         }
@@ -302,13 +393,58 @@ void ShaderManager::Unsubscribe(const IShaderDependency *subscriber)
     });
 }
 
-void ShaderManager::NotifySubscribersAboutReload()
+void ShaderManager::NotifySubscribersAboutReload(const rgl::unordered_set<std::string> &changedShaders)
 {
-    for (auto &ws : subscribers)
+    for (auto &sub : subscribers)
     {
-        if (auto s = ws.lock())
+        auto s = sub.ptr.lock();
+
+        if (!s)
+        {
+            continue;
+        }
+
+        // if dependencies are known, skip subscribers that don't use any of the changed shaders
+        if (!sub.usedShaders.empty())
+        {
+            bool isAffected = false;
+
+            for (const auto &name : changedShaders)
+            {
+                if (sub.usedShaders.find(name) != sub.usedShaders.end())
+                {
+                    isAffected = true;
+                    break;
+                }
+            }
+
+            if (!isAffected)
+            {
+                continue;
+            }
+        }
+
+        // union with previous, as some pipelines might be created lazily
+        pRecordedUsage = &sub.usedShaders;
+
+        try
         {
             s->OnShaderReload(this);
         }
+        catch (...)
+        {
+            pRecordedUsage = nullptr;
+            throw;
+        }
+
+        pRecordedUsage = nullptr;
+    }
+}
+
+void ShaderManager::RecordUsage(const char *name) const
+{
+    if (pRecordedUsage != nullptr)
+    {
+        pRecordedUsage->insert(name);
     }
 }
@@ -43,6 +43,10 @@ public:
     ShaderManager& operator=(const ShaderManager& other) = delete;
     ShaderManager& operator=(ShaderManager&& other) noexcept = delete;
 
+    // Reload only shader modules which content was changed,
+    // and notify only the subscribers that use them.
+    // Synchronous: modules are loaded and the subscribers rebuild their pipelines
+    // on the calling thread, as they recreate them in place.
     void ReloadShaders();
 
     VkShaderModule GetShaderModule(const char *name) const;
@@ -50,7 +54,9 @@ public:
     VkPipelineShaderStageCreateInfo GetStageInfo(const char *name) const;
 
     // Subscribe to shader reload event.
-    // shared_ptr will be transformed to weak_ptr
+    // shared_ptr will be transformed to weak_ptr.
+    // Shaders that are requested by a subscriber in its OnShaderReload are recorded;
+    // until something is recorded, the subscriber is notified about any change.
     void Subscribe(std::shared_ptr<IShaderDependency> subscriber);
     void Unsubscribe(const IShaderDependency *subscriber);
 
@@ -59,18 +65,27 @@ private:
     {
         VkShaderModule module;
         VkShaderStageFlagBits shaderStage;
+        uint64_t contentHash;
+    };
+
+    struct Subscriber
+    {
+        std::weak_ptr<IShaderDependency> ptr;
+        rgl::unordered_set<std::string> usedShaders;
     };
 
 private:
     static VkShaderStageFlagBits GetStageByExtension(const char *name);
 
-    VkShaderModule LoadModule(const char *path);
-    VkShaderModule LoadModuleFromFile(const char *path);
-    VkShaderModule LoadModuleFromMemory(const uint32_t *pCode, uint32_t codeSize);
+    // Returns VK_NULL_HANDLE, if the content hash is equal to 'unchangedHash'
+    VkShaderModule LoadModule(const char *path, uint64_t unchangedHash, uint64_t *pOutHash);
+    VkShaderModule LoadModuleFromFile(const char *path, uint64_t unchangedHash, uint64_t *pOutHash);
+    VkShaderModule LoadModuleFromMemory(const uint32_t *pCode, uint32_t codeSize, uint64_t unchangedHash, uint64_t *pOutHash);
     void LoadShaderModules();
     void UnloadShaderModules();
 
-    void NotifySubscribersAboutReload();
+    void NotifySubscribersAboutReload(const rgl::unordered_set<std::string> &changedShaders);
+    void RecordUsage(const char *name) const;
 
 private:
     VkDevice device;
@@ -79,7 +94,9 @@ private:
 
     rgl::unordered_map<std::string, ShaderModule> modules;
 
-    std::list<std::weak_ptr<IShaderDependency>> subscribers;
+    std::list<Subscriber> subscribers;
+    // if not null, names of requested shaders are inserted here
+    mutable rgl::unordered_set<std::string> *pRecordedUsage;
 };
 
 }
\ No newline at end of file
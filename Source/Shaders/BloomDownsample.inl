@@ -0,0 +1,129 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Common functions for the bloom downsampling,
+// stepIndex must be defined: source is the mip stepIndex, the result is the mip (stepIndex + 1)
+
+vec2 getInverseSrcSize()
+{
+    return vec2(float(1 << stepIndex) / globalUniform.renderWidth, float(1 << stepIndex) / globalUniform.renderHeight);
+}
+
+vec2 getInverseDownsampledSize()
+{
+    return vec2(float(1 << (stepIndex + 1)) / globalUniform.renderWidth, float(1 << (stepIndex + 1)) / globalUniform.renderHeight);
+}
+
+// get UV coords in [0..1] range
+vec2 getSrcUV(const ivec2 downsampledPix)
+{
+    return (vec2(downsampledPix) + 0.5) * getInverseDownsampledSize();
+}
+
+vec3 getSample(sampler2D srcSampler, vec2 uv)
+{
+    // don't read outside of the render area, and transform to the texture space
+    uv = getRenderAreaUV(clamp(uv, 0.0, 1.0));
+
+    if (stepIndex == 0)
+    {
+        const vec4 albedo4 = textureLodAlbedo(uv);
+        
+        if (globalUniform.areFramebufsInitedByRT != 0 && !isSky(albedo4))
+        {
+            vec3 emis = albedo4.rgb;
+            emis = mix(vec3(getLuminance(emis)), emis, 1.0 + globalUniform.bloomEmissionSaturationBias);
+            emis = clamp(emis, 0, 1) * getScreenEmissionFromAlbedo4(albedo4) * globalUniform.bloomEmissionMultiplier;
+            
+            const vec3 illum = textureLod(srcSampler, uv, 0).rgb * getExposure();
+            float f = smoothstep(globalUniform.bloomThreshold, globalUniform.bloomThreshold + globalUniform.bloomThresholdLength, getLuminance(illum));
+
+            return illum * f + emis;
+        }
+        else
+        {
+            return albedo4.rgb * getScreenEmissionFromAlbedo4_Sky(albedo4) /* * globalUniform.skyColorMultiplier */;
+        }
+    }
+
+    return textureLod(srcSampler, uv, 0).rgb;
+}
+
+float getKarisWeight(const vec3 box4x4)
+{
+    return 1.0 / (1.0 + getLuminance(box4x4));
+}
+
+vec3 downsample13tap(sampler2D srcSampler, const vec2 centerUV)
+{
+    const vec2 invSrcSize = getInverseSrcSize();
+
+    // line by line indexing, slide 153
+    const vec3 taps[] = 
+    {
+        getSample(srcSampler, centerUV + vec2(-2,-2) * invSrcSize),
+        getSample(srcSampler, centerUV + vec2( 0,-2) * invSrcSize),
+        getSample(srcSampler, centerUV + vec2( 2,-2) * invSrcSize),
+
+        getSample(srcSampler, centerUV + vec2(-1,-1) * invSrcSize),
+        getSample(srcSampler, centerUV + vec2( 1,-1) * invSrcSize),
+
+        getSample(srcSampler, centerUV + vec2(-2, 0) * invSrcSize),
+        getSample(srcSampler, centerUV + vec2( 0, 0) * invSrcSize),
+        getSample(srcSampler, centerUV + vec2( 2, 0) * invSrcSize),
+
+        getSample(srcSampler, centerUV + vec2(-1, 1) * invSrcSize),
+        getSample(srcSampler, centerUV + vec2( 1, 1) * invSrcSize),
+
+        getSample(srcSampler, centerUV + vec2(-2, 2) * invSrcSize),
+        getSample(srcSampler, centerUV + vec2( 0, 2) * invSrcSize),
+        getSample(srcSampler, centerUV + vec2( 2, 2) * invSrcSize),
+    };
+
+    // on the first downsample use Karis average
+    if (stepIndex == 0)
+    {
+        const vec3 box[] =
+        {
+            0.25 * (taps[3] + taps[4] + taps[8]  + taps[9]), 
+            0.25 * (taps[0] + taps[1] + taps[5]  + taps[6]), 
+            0.25 * (taps[1] + taps[2] + taps[6]  + taps[7]), 
+            0.25 * (taps[5] + taps[6] + taps[10] + taps[11]), 
+            0.25 * (taps[6] + taps[7] + taps[11] + taps[12]), 
+        };
+
+        // weight by partial Karis average to reduce fireflies
+        return 
+            0.5   * getKarisWeight(box[0]) * box[0] + 
+            0.125 * getKarisWeight(box[1]) * box[1] + 
+            0.125 * getKarisWeight(box[2]) * box[2] + 
+            0.125 * getKarisWeight(box[3]) * box[3] + 
+            0.125 * getKarisWeight(box[4]) * box[4];
+    }
+    else
+    {
+        return 
+            0.5   * (0.25 * (taps[3] + taps[4] + taps[8]  + taps[9]))  + 
+            0.125 * (0.25 * (taps[0] + taps[1] + taps[5]  + taps[6]))  + 
+            0.125 * (0.25 * (taps[1] + taps[2] + taps[6]  + taps[7]))  + 
+            0.125 * (0.25 * (taps[5] + taps[6] + taps[10] + taps[11])) + 
+            0.125 * (0.25 * (taps[6] + taps[7] + taps[11] + taps[12]));
+    }
+}
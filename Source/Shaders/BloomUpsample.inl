@@ -0,0 +1,60 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Common functions for the bloom upsampling,
+// stepIndex must be defined: source is the mip (stepIndex + 1), the result is the mip stepIndex
+
+vec2 getInverseSrcSize()
+{
+    return vec2(float(1 << (stepIndex + 1)) / globalUniform.renderWidth, float(1 << (stepIndex + 1)) / globalUniform.renderHeight);
+}
+
+vec3 getSample(sampler2D srcSampler, const vec2 uv)
+{
+    return textureLod(srcSampler, getRenderAreaUV(clamp(uv, 0.0, 1.0)), 0).rgb;
+}
+
+vec3 filterTent3x3(sampler2D srcSampler, const vec2 centerUV)
+{
+    const vec2 invSrcSize = getInverseSrcSize();
+
+    const vec2 offsets[] = 
+    {
+        vec2(-1,-1), vec2(0,-1), vec2(1,-1),
+        vec2(-1, 0), vec2(0, 0), vec2(1, 0),
+        vec2(-1, 1), vec2(0, 1), vec2(1, 1),
+    };
+
+    const float weights[] = 
+    {
+        1.0 / 16.0, 2.0 / 16.0, 1.0 / 16.0,
+        2.0 / 16.0, 4.0 / 16.0, 2.0 / 16.0,
+        1.0 / 16.0, 2.0 / 16.0, 1.0 / 16.0,
+    };
+    
+    vec3 r = vec3(0.0);
+
+    for (int i = 0; i < 9; i++)
+    {
+        r += weights[i] * getSample(srcSampler, centerUV + offsets[i] * invSrcSize * globalUniform.bloomUpsampleRadius);
+    }
+
+    return r;
+}
@@ -38,8 +38,7 @@ void main()
     const ShDecalInstance decal = decalInstances[instanceIndex];
     
     const vec3 worldPosition = texelFetch(framebufSurfacePosition_Sampler, pix, 0).xyz;
-    const mat4 worldToLocal = inverse(decal.transform); // TODO: on CPU
-    const vec4 localPosition = worldToLocal * vec4(worldPosition, 1.0);
+    const vec4 localPosition = decal.worldToLocal * vec4(worldPosition, 1.0);
 
     // if not inside [-0.5, 0.5] box
     if (any(greaterThan(abs(localPosition.xyz), vec3(0.5))))
@@ -51,6 +51,8 @@ void main()
         outColor = color;
     }
 
+    outColor.rgb *= lensFlareInstances[gl_InstanceIndex].intensity;
+
     outTexCoord = texCoord;
     outTextureIndex = lensFlareInstances[gl_InstanceIndex].textureIndex;
 
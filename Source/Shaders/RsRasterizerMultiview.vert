@@ -35,6 +35,7 @@ layout (location = 1) out vec2 outTexCoord;
 layout(push_constant) uniform RasterizerVert_BT 
 {
     layout(offset = 0) mat4 model;
+    layout(offset = 84) uint faceMask;
 } rasterizerVertInfo;
 
 layout (constant_id = 0) const uint applyVertexColorGamma = 0;
@@ -52,6 +53,13 @@ void main()
 
     outTexCoord = texCoord;
 
+    if ((rasterizerVertInfo.faceMask & (1u << gl_ViewIndex)) == 0)
+    {
+        // face is up-to-date: all vertices of a primitive are outside of the clip volume
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
     const mat4 viewProj = globalUniform.viewProjCubemap[gl_ViewIndex];
     gl_Position = viewProj * rasterizerVertInfo.model * vec4(position, 1.0);
 }
@@ -39,6 +39,7 @@
 //                                 define TONEMAPPING_BUFFER_WRITEABLE for writing
 // * DESC_SET_LENS_FLARES
 // * DESC_SET_DECALS
+//                                 define DECAL_TILES for screen tile bins
 
 
 
@@ -232,10 +233,14 @@ layout(set = DESC_SET_LENS_FLARES, binding = BINDING_LENS_FLARES_CULLING_INPUT)
     ShIndirectDrawCommand lensFlareCullingInput[];
 };
 
+// Count is first, so the buffer can grow; padded to 16 bytes
 layout(set = DESC_SET_LENS_FLARES, binding = BINDING_LENS_FLARES_DRAW_CMDS) buffer LensFlareDrawCmds_BT
 {
-    ShIndirectDrawCommand lensFlareDrawCmds[LENS_FLARES_MAX_DRAW_CMD_COUNT];
     uint lensFlareDrawCmdsCount;
+    uint lensFlareDrawCmdsCount_pad0;
+    uint lensFlareDrawCmdsCount_pad1;
+    uint lensFlareDrawCmdsCount_pad2;
+    ShIndirectDrawCommand lensFlareDrawCmds[];
 };
 #endif // DESC_SET_LENS_FLARES
 
@@ -246,6 +251,19 @@ layout(set = DESC_SET_DECALS, binding = BINDING_DECAL_INSTANCES) buffer DecalIns
 {
     ShDecalInstance decalInstances[];
 };
+
+#ifdef DECAL_TILES
+// (offset, count) into decalTileIndices for each screen tile
+layout(set = DESC_SET_DECALS, binding = BINDING_DECAL_TILES) readonly buffer DecalTiles_BT
+{
+    uvec2 decalTiles[];
+};
+
+layout(set = DESC_SET_DECALS, binding = BINDING_DECAL_TILE_INDICES) readonly buffer DecalTileIndices_BT
+{
+    uint decalTileIndices[];
+};
+#endif // DECAL_TILES
 #endif // DESC_SET_DECALS
 
 
@@ -258,8 +276,10 @@ vec2 getPrevScreenPos(const vec2 motionCurToPrev, const ivec2 pix)
 {
     const vec2 screenSize = vec2(globalUniform.renderWidth / float(CHECKERBOARD_SEPARATOR_DIVISOR), globalUniform.renderHeight);
     const vec2 invScreenSize = vec2(1.0 / screenSize.x, 1.0 / screenSize.y);
+    // render size can be different in the previous frame, if dynamic resolution is enabled
+    const vec2 screenSizePrev = vec2(globalUniform.renderWidthPrev / float(CHECKERBOARD_SEPARATOR_DIVISOR), globalUniform.renderHeightPrev);
    
-    return ((vec2(pix) + vec2(0.5)) * invScreenSize + motionCurToPrev) * screenSize;
+    return ((vec2(pix) + vec2(0.5)) * invScreenSize + motionCurToPrev) * screenSizePrev;
 }
 
 vec2 getPrevScreenPos(sampler2D motionSampler, const ivec2 pix)
@@ -346,6 +366,31 @@ ivec3 getCheckerboardedRenderArea(const ivec2 checkerboardPix)
         CHECKERBOARD_FULL_HEIGHT
     );
 }
+
+#ifdef DESC_SET_GLOBAL_UNIFORM
+// Render area in the previous frame for a pixel of the current frame,
+// to test pixels that were found with getPrevFramePix
+ivec3 getCheckerboardedRenderAreaPrev(const ivec2 checkerboardPix)
+{
+    const int sepPrev = int(globalUniform.renderWidthPrev) / CHECKERBOARD_SEPARATOR_DIVISOR;
+    const int isOdd = isCheckerboardPixOdd(checkerboardPix);
+
+    return ivec3(
+        // left bound
+        (isOdd + 0) * sepPrev,
+        // right bound
+        (isOdd + 1) * sepPrev,
+        int(globalUniform.renderHeightPrev)
+    );
+}
+
+// Framebuffers are allocated for the maximum render size, and only
+// the top-left area is used. Transform UV in the render area to the texture UV.
+vec2 getRenderAreaUV(const vec2 uv)
+{
+    return uv * vec2(globalUniform.renderAreaScaleX, globalUniform.renderAreaScaleY);
+}
+#endif // DESC_SET_GLOBAL_UNIFORM
 #endif // CHECKERBOARD_FULL_HEIGHT
 #endif // CHECKERBOARD_FULL_WIDTH
 
@@ -406,6 +451,21 @@ SH texelFetchUnfilteredIndirectSH(ivec2 pix)
         pix);
 }
 
+// Indirect illumination can be traced only for some pixels, see INDIRECT_ILLUMINATION_RATE_*.
+// Not traced pixels are marked with a negative L00 coefficient, as it's always non-negative otherwise.
+SH getIndirectSHNotTracedMarker()
+{
+    SH sh = newSH();
+    sh.r.x = -1.0;
+
+    return sh;
+}
+
+bool isIndirectSHTraced(const SH sh)
+{
+    return sh.r.x > -0.5;
+}
+
 SH texelFetchIndirAccumSH(ivec2 pix)
 {
     return texelFetchSH(
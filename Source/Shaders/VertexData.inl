@@ -109,6 +109,16 @@ layout(
     uint triangleSectorIndices[];
 };
 
+layout(
+    set = DESC_SET_VERTEX_DATA,
+    binding = BINDING_ANIMATED_MATERIALS)
+    readonly 
+    buffer AnimatedMaterials_BT
+{
+    // texture indices of the current frame of each animated material
+    uint animatedMaterialTextures[];
+};
+
 vec3 getStaticVerticesPositions(uint index)
 {
     return vec3(
@@ -393,6 +403,22 @@ uvec3 getGeometryInstanceMaterialLayer(const ShGeometryInstance inst, int layer)
     );
 }*/
 
+// animated materials reference the table, instead of the actual texture indices
+uint resolveMaterialTexture(uint textureIndex)
+{
+    if ((textureIndex & MATERIAL_ANIMATED_TEXTURE_BIT) != 0)
+    {
+        return animatedMaterialTextures[textureIndex & ~MATERIAL_ANIMATED_TEXTURE_BIT];
+    }
+
+    return textureIndex;
+}
+
+uvec3 resolveMaterialTextures(uint a, uint b, uint c)
+{
+    return uvec3(resolveMaterialTexture(a), resolveMaterialTexture(b), resolveMaterialTexture(c));
+}
+
 // localGeometryIndex is index of geometry in pGeometries in BLAS
 // primitiveId is index of a triangle
 ShTriangle getTriangle(int instanceID, int instanceCustomIndex, int localGeometryIndex, int primitiveId)
@@ -412,7 +438,7 @@ ShTriangle getTriangle(int instanceID, int instanceCustomIndex, int localGeometr
         tr = getTriangleDynamic(vertIndices, inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
 
         // only one material for dynamic geometry
-        tr.materials[0] = uvec3(inst.materials0A, inst.materials0B, inst.materials0C);
+        tr.materials[0] = resolveMaterialTextures(inst.materials0A, inst.materials0B, inst.materials0C);
         tr.materials[1] = uvec3(MATERIAL_NO_TEXTURE);
         tr.materials[2] = uvec3(MATERIAL_NO_TEXTURE);
         
@@ -454,9 +480,9 @@ ShTriangle getTriangle(int instanceID, int instanceCustomIndex, int localGeometr
 
         tr = getTriangleStatic(vertIndices, inst.baseVertexIndex, inst.baseIndexIndex, primitiveId);
 
-        tr.materials[0] = uvec3(inst.materials0A, inst.materials0B, inst.materials0C);
-        tr.materials[1] = uvec3(inst.materials1A, inst.materials1B, inst.materials1C);
-        tr.materials[2] = uvec3(inst.materials2A, inst.materials2B, MATERIAL_NO_TEXTURE);
+        tr.materials[0] = resolveMaterialTextures(inst.materials0A, inst.materials0B, inst.materials0C);
+        tr.materials[1] = resolveMaterialTextures(inst.materials1A, inst.materials1B, inst.materials1C);
+        tr.materials[2] = resolveMaterialTextures(inst.materials2A, inst.materials2B, MATERIAL_NO_TEXTURE);
 
         tr.materialColors[0] = inst.materialColors[0];
         tr.materialColors[1] = inst.materialColors[1];
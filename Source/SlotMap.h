@@ -0,0 +1,183 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "Common.h"
+
+namespace RTGL1
+{
+
+// Generational slot map: O(1) insert, erase and lookup by handle.
+// Values are stored densely, so iteration over them is cache-friendly.
+// A handle contains a slot index and the slot's generation, that is incremented
+// on erase, so stale handles are not resolved to the values that reuse the slot.
+// Handle 0 is never returned, so it can be used as an empty one.
+template <typename T>
+class SlotMap
+{
+public:
+    static constexpr uint32_t IndexBitCount         = 20;
+    static constexpr uint32_t GenerationBitCount    = 11;
+    static constexpr uint32_t MaxSize               = 1u << IndexBitCount;
+    static constexpr uint32_t InvalidHandle         = 0;
+
+    // If tag is true, the highest bit of the handles is set,
+    // so handles of two slot maps can share the same space.
+    explicit SlotMap(bool tag = false) : tagBit(tag ? 1u << (IndexBitCount + GenerationBitCount) : 0) {}
+
+    SlotMap(const SlotMap &other) = delete;
+    SlotMap(SlotMap &&other) noexcept = delete;
+    SlotMap &operator=(const SlotMap &other) = delete;
+    SlotMap &operator=(SlotMap &&other) noexcept = delete;
+
+    // Returns InvalidHandle, if there is no free slot.
+    uint32_t Insert(T value)
+    {
+        uint32_t slotIndex;
+
+        if (!freeSlots.empty())
+        {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else if (slots.size() < MaxSize)
+        {
+            slotIndex = (uint32_t)slots.size();
+            slots.push_back({ 0, 1 });
+        }
+        else
+        {
+            return InvalidHandle;
+        }
+
+        Slot &s = slots[slotIndex];
+        s.valueIndex = (uint32_t)values.size();
+
+        values.push_back(std::move(value));
+        valueSlots.push_back(slotIndex);
+
+        return tagBit | (s.generation << IndexBitCount) | slotIndex;
+    }
+
+    T *Find(uint32_t handle)
+    {
+        const Slot *s = FindSlot(handle);
+        return s != nullptr ? &values[s->valueIndex] : nullptr;
+    }
+
+    const T *Find(uint32_t handle) const
+    {
+        const Slot *s = FindSlot(handle);
+        return s != nullptr ? &values[s->valueIndex] : nullptr;
+    }
+
+    // Returns false, if handle is stale or invalid.
+    bool Erase(uint32_t handle)
+    {
+        const Slot *found = FindSlot(handle);
+
+        if (found == nullptr)
+        {
+            return false;
+        }
+
+        const uint32_t slotIndex = handle & (MaxSize - 1);
+        const uint32_t valueIndex = found->valueIndex;
+        const uint32_t lastValueIndex = (uint32_t)values.size() - 1;
+
+        // move the last value to the erased one's place
+        if (valueIndex != lastValueIndex)
+        {
+            values[valueIndex] = std::move(values[lastValueIndex]);
+            valueSlots[valueIndex] = valueSlots[lastValueIndex];
+
+            slots[valueSlots[valueIndex]].valueIndex = valueIndex;
+        }
+
+        values.pop_back();
+        valueSlots.pop_back();
+
+        // invalidate handles to this slot
+        Slot &s = slots[slotIndex];
+        s.valueIndex = FreeValueIndex;
+        s.generation = (s.generation + 1) & GenerationMask;
+        s.generation = s.generation != 0 ? s.generation : 1;
+
+        freeSlots.push_back(slotIndex);
+        return true;
+    }
+
+    uint32_t Size() const
+    {
+        return (uint32_t)values.size();
+    }
+
+    typename std::vector<T>::iterator begin() { return values.begin(); }
+    typename std::vector<T>::iterator end() { return values.end(); }
+    typename std::vector<T>::const_iterator begin() const { return values.begin(); }
+    typename std::vector<T>::const_iterator end() const { return values.end(); }
+
+private:
+    static constexpr uint32_t GenerationMask = (1u << GenerationBitCount) - 1;
+    static constexpr uint32_t FreeValueIndex = UINT32_MAX;
+
+    struct Slot
+    {
+        uint32_t valueIndex;
+        uint32_t generation;
+    };
+
+    const Slot *FindSlot(uint32_t handle) const
+    {
+        const uint32_t tagMask = 1u << (IndexBitCount + GenerationBitCount);
+
+        if ((handle & tagMask) != tagBit)
+        {
+            return nullptr;
+        }
+
+        const uint32_t slotIndex = handle & (MaxSize - 1);
+        const uint32_t generation = (handle >> IndexBitCount) & GenerationMask;
+
+        if (slotIndex >= slots.size() || 
+            slots[slotIndex].generation != generation ||
+            slots[slotIndex].valueIndex == FreeValueIndex)
+        {
+            return nullptr;
+        }
+
+        return &slots[slotIndex];
+    }
+
+private:
+    uint32_t tagBit;
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+
+    std::vector<T> values;
+    // slot index of each value
+    std::vector<uint32_t> valueSlots;
+};
+
+}
@@ -89,9 +89,9 @@ RTGL1::FramebufferImageIndex RTGL1::SuperResolution::Apply(
         FsrPush easuCon;
         FsrEasuCon(
             easuCon.con0, easuCon.con1, easuCon.con2, easuCon.con3,
-            (AF1)renderResolution.Width(),         (AF1)renderResolution.Height(),          // viewport size
-            (AF1)renderResolution.Width(),         (AF1)renderResolution.Height(),          // image resource size
-            (AF1)renderResolution.UpscaledWidth(), (AF1)renderResolution.UpscaledHeight()   // upscaled size
+            (AF1)renderResolution.Width(),          (AF1)renderResolution.Height(),           // viewport size
+            (AF1)renderResolution.AllocatedWidth(), (AF1)renderResolution.AllocatedHeight(),  // image resource size
+            (AF1)renderResolution.UpscaledWidth(),  (AF1)renderResolution.UpscaledHeight()    // upscaled size
         );
 
         vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
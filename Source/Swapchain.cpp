@@ -26,20 +26,68 @@
 
 using namespace RTGL1;
 
+namespace
+{
+
+bool IsPresentModeSupported(VkPresentModeKHR mode, const std::vector<VkPresentModeKHR> &supported)
+{
+    return std::find(supported.begin(), supported.end(), mode) != supported.end();
+}
+
+VkPresentModeKHR ChoosePresentMode(RgPresentMode requested, VkPresentModeKHR defaultMode, const std::vector<VkPresentModeKHR> &supported)
+{
+    // FIFO is always supported
+    VkPresentModeKHR candidates[3] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR };
+
+    switch (requested)
+    {
+        case RG_PRESENT_MODE_IMMEDIATE:
+            candidates[0] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            candidates[1] = VK_PRESENT_MODE_MAILBOX_KHR;
+            break;
+        case RG_PRESENT_MODE_MAILBOX:
+            candidates[0] = VK_PRESENT_MODE_MAILBOX_KHR;
+            break;
+        case RG_PRESENT_MODE_FIFO_RELAXED:
+            candidates[0] = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+            break;
+        case RG_PRESENT_MODE_FIFO:
+            break;
+        default:
+            return defaultMode;
+    }
+
+    for (VkPresentModeKHR m : candidates)
+    {
+        if (IsPresentModeSupported(m, supported))
+        {
+            return m;
+        }
+    }
+
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+}
+
 Swapchain::Swapchain(VkDevice device, VkSurfaceKHR surface,
                      std::shared_ptr<PhysicalDevice> physDevice,
-                     std::shared_ptr<CommandBufferManager> cmdManager) :
+                     std::shared_ptr<CommandBufferManager> cmdManager,
+                     const RgInstanceCreateInfo &instanceInfo) :
     surfaceFormat{},
     surfCapabilities{},
     // default
     presentModeVsync(VK_PRESENT_MODE_FIFO_KHR),
     presentModeImmediate(VK_PRESENT_MODE_FIFO_KHR),
+    minImageCount(instanceInfo.swapchainMinImageCount > 0 ? instanceInfo.swapchainMinImageCount : 3),
+    recreateAsync(!!instanceInfo.swapchainRecreateAsync),
     requestedExtent({ 0, 0 }),
     requestedVsync(true),
     surfaceExtent{ UINT32_MAX, UINT32_MAX },
     isVsync(true),
     swapchain(VK_NULL_HANDLE),
-    currentSwapchainIndex(UINT32_MAX)
+    currentSwapchainIndex(UINT32_MAX),
+    lastPresentedSwapchainIndex(UINT32_MAX)
 {
     this->device = device;
     this->surface = surface;
@@ -93,7 +141,7 @@ Swapchain::Swapchain(VkDevice device, VkSurfaceKHR surface,
         r = vkGetPhysicalDeviceSurfacePresentModesKHR(physDevice->Get(), surface, &presentModeCount, presentModes.data());
         VK_CHECKERROR(r);
 
-        // try to find mailbox / fifo-relaxed
+        // by default, try to find mailbox / fifo-relaxed
         for (auto p : presentModes)
         {
             if (p == VK_PRESENT_MODE_MAILBOX_KHR)
@@ -106,6 +154,9 @@ Swapchain::Swapchain(VkDevice device, VkSurfaceKHR surface,
                 presentModeVsync = p;
             }
         }
+
+        presentModeVsync = ChoosePresentMode(instanceInfo.presentModeVsync, presentModeVsync, presentModes);
+        presentModeImmediate = ChoosePresentMode(instanceInfo.presentModeNoVsync, presentModeImmediate, presentModes);
     }
 }
 
@@ -124,14 +175,30 @@ bool Swapchain::RequestVsync(bool enable)
     return requestedVsync != isVsync;
 }
 
-void Swapchain::AcquireImage(VkSemaphore imageAvailableSemaphore)
+bool Swapchain::AcquireImage(VkSemaphore imageAvailableSemaphore)
 {
+    if (!TryFinishAsyncRecreation())
+    {
+        return false;
+    }
+
     // if requested params are different
     if (requestedExtent.width != surfaceExtent.width || 
         requestedExtent.height != surfaceExtent.height || 
         requestedVsync != isVsync)
     {
-        TryRecreate(requestedExtent.width, requestedExtent.height, requestedVsync);
+        // the first creation is always synchronous, there's nothing to present meanwhile
+        if (recreateAsync && swapchain != VK_NULL_HANDLE)
+        {
+            if (TryStartAsyncRecreation(requestedExtent.width, requestedExtent.height, requestedVsync))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            TryRecreate(requestedExtent.width, requestedExtent.height, requestedVsync);
+        }
     }
 
     while (true)
@@ -143,7 +210,7 @@ void Swapchain::AcquireImage(VkSemaphore imageAvailableSemaphore)
 
         if (r == VK_SUCCESS)
         {
-            break;
+            return true;
         }
         else if (r == VK_ERROR_OUT_OF_DATE_KHR || r == VK_SUBOPTIMAL_KHR)
         {
@@ -220,14 +287,16 @@ void Swapchain::Present(const std::shared_ptr<Queues> &queues, VkSemaphore rende
     presentInfo.pResults = nullptr;
 
     VkResult r = vkQueuePresentKHR(queues->GetGraphics(), &presentInfo);
+    lastPresentedSwapchainIndex = currentSwapchainIndex;
 
-    if (r == VK_ERROR_OUT_OF_DATE_KHR || r == VK_SUBOPTIMAL_KHR)
+    // in async mode, let the next acquire to start the recreation
+    if ((r == VK_ERROR_OUT_OF_DATE_KHR || r == VK_SUBOPTIMAL_KHR) && !recreateAsync)
     {
         TryRecreate(requestedExtent.width, requestedExtent.height, requestedVsync);
     }
 }
 
-bool Swapchain::TryRecreate(uint32_t newWidth, uint32_t newHeight, bool vsync)
+bool Swapchain::IsRecreationNeeded(uint32_t &newWidth, uint32_t &newHeight, bool vsync)
 {
     VkResult r = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physDevice->Get(), surface, &surfCapabilities);
     VK_CHECKERROR(r);
@@ -244,7 +313,12 @@ bool Swapchain::TryRecreate(uint32_t newWidth, uint32_t newHeight, bool vsync)
         newHeight = clamp(newHeight, surfCapabilities.minImageExtent.height, surfCapabilities.maxImageExtent.height);
     }
 
-    if (surfaceExtent.width == newWidth && surfaceExtent.height == newHeight && isVsync == vsync)
+    return surfaceExtent.width != newWidth || surfaceExtent.height != newHeight || isVsync != vsync;
+}
+
+bool Swapchain::TryRecreate(uint32_t newWidth, uint32_t newHeight, bool vsync)
+{
+    if (!IsRecreationNeeded(newWidth, newHeight, vsync))
     {
         return false;
     }
@@ -259,24 +333,19 @@ bool Swapchain::TryRecreate(uint32_t newWidth, uint32_t newHeight, bool vsync)
 
 void Swapchain::Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwapchainKHR oldSwapchain)
 {
-    this->isVsync = vsync;
-    this->surfaceExtent = { newWidth, newHeight };
-
-    VkResult r;
-
 #ifndef NDEBUG
-    r = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physDevice->Get(), surface, &surfCapabilities);
+    VkResult r = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physDevice->Get(), surface, &surfCapabilities);
     VK_CHECKERROR(r);
 
     if (surfCapabilities.currentExtent.width  != UINT32_MAX && surfCapabilities.currentExtent.height != UINT32_MAX)
     {
-        assert(surfaceExtent.width  == surfCapabilities.currentExtent.width && 
-               surfaceExtent.height == surfCapabilities.currentExtent.height);
+        assert(newWidth  == surfCapabilities.currentExtent.width && 
+               newHeight == surfCapabilities.currentExtent.height);
     }
     else
     {
-        assert(surfCapabilities.minImageExtent.width  <= surfaceExtent.width  && surfaceExtent.width  <= surfCapabilities.maxImageExtent.width);
-        assert(surfCapabilities.minImageExtent.height <= surfaceExtent.height && surfaceExtent.height <= surfCapabilities.maxImageExtent.height);
+        assert(surfCapabilities.minImageExtent.width  <= newWidth  && newWidth  <= surfCapabilities.maxImageExtent.width);
+        assert(surfCapabilities.minImageExtent.height <= newHeight && newHeight <= surfCapabilities.maxImageExtent.height);
     }
 #endif
 
@@ -284,10 +353,39 @@ void Swapchain::Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwap
     assert(swapchainImages.empty());
     assert(swapchainViews.empty());
 
-    uint32_t imageCount = std::max(3U, surfCapabilities.minImageCount);
-    if (surfCapabilities.maxImageCount > 0)
+    CreatedSwapchain created = CreateSwapchainObjects(newWidth, newHeight, vsync, oldSwapchain);
+
+    if (oldSwapchain != VK_NULL_HANDLE)
+    {
+        vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
+    }
+
+    SetSwapchainObjects(std::move(created));
+}
+
+Swapchain::CreatedSwapchain Swapchain::CreateSwapchainObjects(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwapchainKHR oldSwapchain) const
+{
+    VkResult r;
+
+    // query again, as the surface could be resized while waiting for the thread
+    VkSurfaceCapabilitiesKHR caps = {};
+    r = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physDevice->Get(), surface, &caps);
+    VK_CHECKERROR(r);
+
+    if (caps.currentExtent.width != UINT32_MAX && caps.currentExtent.height != UINT32_MAX)
+    {
+        newWidth  = caps.currentExtent.width;
+        newHeight = caps.currentExtent.height;
+    }
+
+    CreatedSwapchain created = {};
+    created.extent = { newWidth, newHeight };
+    created.isVsync = vsync;
+
+    uint32_t imageCount = std::max(minImageCount, caps.minImageCount);
+    if (caps.maxImageCount > 0)
     {
-        imageCount = std::min(imageCount, surfCapabilities.maxImageCount);
+        imageCount = std::min(imageCount, caps.maxImageCount);
     }
 
     VkSwapchainCreateInfoKHR swapchainInfo = {};
@@ -296,41 +394,36 @@ void Swapchain::Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwap
     swapchainInfo.minImageCount = imageCount;
     swapchainInfo.imageFormat = surfaceFormat.format;
     swapchainInfo.imageColorSpace = surfaceFormat.colorSpace;
-    swapchainInfo.imageExtent = surfaceExtent;
+    swapchainInfo.imageExtent = created.extent;
     swapchainInfo.imageArrayLayers = 1;
     swapchainInfo.imageUsage =
         VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
         VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
         VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     swapchainInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    swapchainInfo.preTransform = surfCapabilities.currentTransform;
+    swapchainInfo.preTransform = caps.currentTransform;
     swapchainInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    swapchainInfo.presentMode = vsync ? presentModeVsync : presentModeImmediate;
+    swapchainInfo.presentMode = GetPresentMode(vsync);
     swapchainInfo.clipped = VK_FALSE;
     swapchainInfo.oldSwapchain = oldSwapchain;
 
-    r = vkCreateSwapchainKHR(device, &swapchainInfo, nullptr, &swapchain);
+    r = vkCreateSwapchainKHR(device, &swapchainInfo, nullptr, &created.swapchain);
     VK_CHECKERROR(r);
 
-    if (oldSwapchain != VK_NULL_HANDLE)
-    {
-        vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
-    }
-
-    r = vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
+    r = vkGetSwapchainImagesKHR(device, created.swapchain, &imageCount, nullptr);
     VK_CHECKERROR(r);
 
-    swapchainImages.resize(imageCount);
-    swapchainViews.resize(imageCount);
+    created.images.resize(imageCount);
+    created.views.resize(imageCount);
 
-    r = vkGetSwapchainImagesKHR(device, swapchain, &imageCount, swapchainImages.data());
+    r = vkGetSwapchainImagesKHR(device, created.swapchain, &imageCount, created.images.data());
     VK_CHECKERROR(r);
 
     for (uint32_t i = 0; i < imageCount; i++)
     {
         VkImageViewCreateInfo viewInfo = {};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        viewInfo.image = swapchainImages[i];
+        viewInfo.image = created.images[i];
         viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
         viewInfo.format = surfaceFormat.format;
         viewInfo.components = {};
@@ -340,19 +433,32 @@ void Swapchain::Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwap
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
-        r = vkCreateImageView(device, &viewInfo, nullptr, &swapchainViews[i]);
+        r = vkCreateImageView(device, &viewInfo, nullptr, &created.views[i]);
         VK_CHECKERROR(r);
 
-        SET_DEBUG_NAME(device, swapchainImages[i], VK_OBJECT_TYPE_IMAGE, "Swapchain image");
-        SET_DEBUG_NAME(device, swapchainViews[i], VK_OBJECT_TYPE_IMAGE_VIEW, "Swapchain image view");
+        SET_DEBUG_NAME(device, created.images[i], VK_OBJECT_TYPE_IMAGE, "Swapchain image");
+        SET_DEBUG_NAME(device, created.views[i], VK_OBJECT_TYPE_IMAGE_VIEW, "Swapchain image view");
     }
 
+    return created;
+}
+
+void Swapchain::SetSwapchainObjects(CreatedSwapchain &&created)
+{
+    assert(swapchain == VK_NULL_HANDLE);
+
+    this->swapchain = created.swapchain;
+    this->swapchainImages = std::move(created.images);
+    this->swapchainViews = std::move(created.views);
+    this->surfaceExtent = created.extent;
+    this->isVsync = created.isVsync;
+
     VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
 
-    for (uint32_t i = 0; i < imageCount; i++)
+    for (VkImage img : swapchainImages)
     {
         Utils::BarrierImage(
-            cmd, swapchainImages[i],
+            cmd, img,
             0, 0,
             VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
     }
@@ -363,6 +469,52 @@ void Swapchain::Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwap
     CallCreateSubscribers();
 }
 
+VkPresentModeKHR Swapchain::GetPresentMode(bool vsync) const
+{
+    return vsync ? presentModeVsync : presentModeImmediate;
+}
+
+bool Swapchain::TryStartAsyncRecreation(uint32_t newWidth, uint32_t newHeight, bool vsync)
+{
+    assert(!asyncRecreation.valid());
+
+    if (!IsRecreationNeeded(newWidth, newHeight, vsync))
+    {
+        return false;
+    }
+
+    // the old swapchain is retired by the new one, so it must not be used until the thread is finished
+    asyncRecreation = std::async(std::launch::async,
+                                 &Swapchain::CreateSwapchainObjects, this,
+                                 newWidth, newHeight, vsync, swapchain);
+    return true;
+}
+
+bool Swapchain::TryFinishAsyncRecreation()
+{
+    if (!asyncRecreation.valid())
+    {
+        return true;
+    }
+
+    if (asyncRecreation.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return false;
+    }
+
+    CreatedSwapchain created = asyncRecreation.get();
+
+    // old swapchain can be destroyed only when its images are not in use
+    VkSwapchainKHR old = DestroyWithoutSwapchain();
+    if (old != VK_NULL_HANDLE)
+    {
+        vkDestroySwapchainKHR(device, old, nullptr);
+    }
+
+    SetSwapchainObjects(std::move(created));
+    return true;
+}
+
 void Swapchain::Destroy()
 {
     VkSwapchainKHR old = DestroyWithoutSwapchain();
@@ -385,6 +537,7 @@ VkSwapchainKHR RTGL1::Swapchain::DestroyWithoutSwapchain()
 
     swapchainViews.clear();
     swapchainImages.clear();
+    lastPresentedSwapchainIndex = UINT32_MAX;
 
     VkSwapchainKHR old = swapchain;
     swapchain = VK_NULL_HANDLE;
@@ -416,6 +569,17 @@ void Swapchain::CallDestroySubscribers()
 
 Swapchain::~Swapchain()
 {
+    if (asyncRecreation.valid())
+    {
+        CreatedSwapchain created = asyncRecreation.get();
+
+        for (VkImageView v : created.views)
+        {
+            vkDestroyImageView(device, v, nullptr);
+        }
+        vkDestroySwapchainKHR(device, created.swapchain, nullptr);
+    }
+
     Destroy();
 }
 
@@ -457,6 +621,11 @@ uint32_t Swapchain::GetCurrentImageIndex() const
     return currentSwapchainIndex;
 }
 
+uint32_t Swapchain::GetLastPresentedImageIndex() const
+{
+    return lastPresentedSwapchainIndex;
+}
+
 uint32_t Swapchain::GetImageCount() const
 {
     assert(swapchainViews.size() == swapchainImages.size());
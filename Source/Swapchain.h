@@ -20,9 +20,12 @@
 
 #pragma once
 
+#include <future>
 #include <list>
 #include <vector>
 
+#include <RTGL1/RTGL1.h>
+
 #include "Common.h"
 #include "PhysicalDevice.h"
 #include "CommandBufferManager.h"
@@ -38,7 +41,8 @@ public:
         VkDevice device, 
         VkSurfaceKHR surface, 
         std::shared_ptr<PhysicalDevice> physDevice, 
-        std::shared_ptr<CommandBufferManager> cmdManager);
+        std::shared_ptr<CommandBufferManager> cmdManager,
+        const RgInstanceCreateInfo &instanceInfo);
     ~Swapchain();
 
     Swapchain(const Swapchain &other) = delete;
@@ -52,7 +56,9 @@ public:
     bool RequestNewSize(uint32_t newWidth, uint32_t newHeight);
     bool RequestVsync(bool enable);
 
-    void AcquireImage(VkSemaphore imageAvailableSemaphore);
+    // Returns false, if the image wasn't acquired, as the swapchain is being recreated
+    // on a separate thread. In that case, the frame must not be presented.
+    bool AcquireImage(VkSemaphore imageAvailableSemaphore);
     void BlitForPresent(VkCommandBuffer cmd, VkImage srcImage, uint32_t srcImageWidth, uint32_t srcImageHeight, VkFilter filter, VkImageLayout srcImageLayout = VK_IMAGE_LAYOUT_GENERAL);
     void Present(const std::shared_ptr<Queues> &queues, VkSemaphore renderFinishedSemaphore);
 
@@ -65,16 +71,41 @@ public:
     uint32_t GetWidth() const;
     uint32_t GetHeight() const;
     uint32_t GetCurrentImageIndex() const;
+    // UINT32_MAX, if no image was presented since the swapchain creation.
+    uint32_t GetLastPresentedImageIndex() const;
     uint32_t GetImageCount() const;
     VkImageView GetImageView(uint32_t index) const;
     VkImage GetImage(uint32_t index) const;
     const VkImageView *GetImageViews() const;
 
 private:
+    struct CreatedSwapchain
+    {
+        VkSwapchainKHR swapchain;
+        std::vector<VkImage> images;
+        std::vector<VkImageView> views;
+        VkExtent2D extent;
+        bool isVsync;
+    };
+
+private:
+    // Normalize the extent by the surface capabilities.
+    // Returns false, if the swapchain already has such parameters.
+    bool IsRecreationNeeded(uint32_t &newWidth, uint32_t &newHeight, bool vsync);
+
     // Safe to call even if swapchain wasn't created
     bool TryRecreate(uint32_t newWidth, uint32_t newHeight, bool vsync);
+    // Returns true, if the recreation was started
+    bool TryStartAsyncRecreation(uint32_t newWidth, uint32_t newHeight, bool vsync);
+    // Returns false, if the recreation is still in progress
+    bool TryFinishAsyncRecreation();
 
     void Create(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+    // Doesn't modify the members, so can be called from another thread,
+    // if the old swapchain is not used in the meantime
+    CreatedSwapchain CreateSwapchainObjects(uint32_t newWidth, uint32_t newHeight, bool vsync, VkSwapchainKHR oldSwapchain) const;
+    void SetSwapchainObjects(CreatedSwapchain &&created);
+    VkPresentModeKHR GetPresentMode(bool vsync) const;
     void Destroy();
     // Destroy dresources but not the swapchain itself. Old swapchain is returned.
     VkSwapchainKHR DestroyWithoutSwapchain();
@@ -92,6 +123,10 @@ private:
     VkSurfaceCapabilitiesKHR surfCapabilities;
     VkPresentModeKHR presentModeVsync;
     VkPresentModeKHR presentModeImmediate;
+    uint32_t minImageCount;
+
+    bool recreateAsync;
+    std::future<CreatedSwapchain> asyncRecreation;
 
     // user requests this extent
     VkExtent2D requestedExtent;
@@ -105,6 +140,7 @@ private:
     std::vector<VkImageView> swapchainViews;
 
     uint32_t currentSwapchainIndex;
+    uint32_t lastPresentedSwapchainIndex;
 
     std::list<std::weak_ptr<ISwapchainDependency>> subscribers;
 };
@@ -0,0 +1,531 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Const.h"
+#include "Utils.h"
+
+using namespace RTGL1;
+
+namespace
+{
+
+constexpr uint32_t CACHE_MAGIC = 0x43425452; // "RTBC"
+constexpr uint32_t CACHE_VERSION = 1;
+constexpr uint32_t BLOCK_SIZE = 4;
+
+struct CacheHeader
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    format;
+    uint32_t    width;
+    uint32_t    height;
+    uint32_t    levelCount;
+    uint32_t    levelSizes[MAX_PREGENERATED_MIPMAP_LEVELS];
+};
+
+struct HashDesc
+{
+    uint32_t    version;
+    uint32_t    format;
+    uint32_t    width;
+    uint32_t    height;
+    uint32_t    useMipmaps;
+};
+
+uint32_t GetBlockCount(uint32_t size)
+{
+    return (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+}
+
+uint16_t To565(const uint8_t *c)
+{
+    return (uint16_t)(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+}
+
+void From565(uint16_t v, int32_t *c)
+{
+    const int32_t r = (v >> 11) & 31;
+    const int32_t g = (v >> 5) & 63;
+    const int32_t b = v & 31;
+
+    c[0] = (r << 3) | (r >> 2);
+    c[1] = (g << 2) | (g >> 4);
+    c[2] = (b << 3) | (b >> 2);
+}
+
+// Bounding box of the block's colors, inset to reduce the error.
+// The loops are fixed-size, so they can be vectorized by a compiler.
+void EncodeColorBlock(const uint8_t block[64], uint8_t *pDst)
+{
+    uint8_t minColor[3] = { 255, 255, 255 };
+    uint8_t maxColor[3] = { 0, 0, 0 };
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            minColor[c] = std::min(minColor[c], block[i * 4 + c]);
+            maxColor[c] = std::max(maxColor[c], block[i * 4 + c]);
+        }
+    }
+
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        const uint8_t inset = (uint8_t)((maxColor[c] - minColor[c]) >> 4);
+
+        minColor[c] = (uint8_t)std::min(255, minColor[c] + inset);
+        maxColor[c] = (uint8_t)std::max(0, maxColor[c] - inset);
+    }
+
+    uint16_t c0 = To565(maxColor);
+    uint16_t c1 = To565(minColor);
+
+    // c0 > c1 for the 4 color mode
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+    }
+
+    uint32_t indices = 0;
+
+    if (c0 != c1)
+    {
+        int32_t palette[4][3];
+        From565(c0, palette[0]);
+        From565(c1, palette[1]);
+
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t best = 0;
+            int32_t bestDist = INT32_MAX;
+
+            for (uint32_t p = 0; p < 4; p++)
+            {
+                const int32_t dr = block[i * 4 + 0] - palette[p][0];
+                const int32_t dg = block[i * 4 + 1] - palette[p][1];
+                const int32_t db = block[i * 4 + 2] - palette[p][2];
+                const int32_t dist = dr * dr + dg * dg + db * db;
+
+                if (dist < bestDist)
+                {
+                    bestDist = dist;
+                    best = p;
+                }
+            }
+
+            indices |= best << (i * 2);
+        }
+    }
+
+    pDst[0] = (uint8_t)(c0 & 0xFF);
+    pDst[1] = (uint8_t)(c0 >> 8);
+    pDst[2] = (uint8_t)(c1 & 0xFF);
+    pDst[3] = (uint8_t)(c1 >> 8);
+    memcpy(&pDst[4], &indices, sizeof(indices));
+}
+
+void EncodeAlphaBlock(const uint8_t block[64], uint8_t *pDst)
+{
+    uint8_t a0 = 0;
+    uint8_t a1 = 255;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        a0 = std::max(a0, block[i * 4 + 3]);
+        a1 = std::min(a1, block[i * 4 + 3]);
+    }
+
+    uint64_t indices = 0;
+
+    // a0 > a1 for the 8 alpha mode
+    if (a0 != a1)
+    {
+        int32_t palette[8];
+        palette[0] = a0;
+        palette[1] = a1;
+
+        for (int32_t p = 1; p < 7; p++)
+        {
+            palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint64_t best = 0;
+            int32_t bestDist = INT32_MAX;
+
+            for (uint32_t p = 0; p < 8; p++)
+            {
+                const int32_t dist = std::abs(block[i * 4 + 3] - palette[p]);
+
+                if (dist < bestDist)
+                {
+                    bestDist = dist;
+                    best = p;
+                }
+            }
+
+            indices |= best << (i * 3);
+        }
+    }
+
+    pDst[0] = a0;
+    pDst[1] = a1;
+
+    for (uint32_t b = 0; b < 6; b++)
+    {
+        pDst[2 + b] = (uint8_t)((indices >> (b * 8)) & 0xFF);
+    }
+}
+
+// Edge pixels are replicated for partial blocks.
+void FetchBlock(const uint8_t *pLevel, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t block[64])
+{
+    for (uint32_t y = 0; y < BLOCK_SIZE; y++)
+    {
+        const uint32_t sy = std::min(blockY * BLOCK_SIZE + y, height - 1);
+
+        for (uint32_t x = 0; x < BLOCK_SIZE; x++)
+        {
+            const uint32_t sx = std::min(blockX * BLOCK_SIZE + x, width - 1);
+
+            memcpy(&block[(y * BLOCK_SIZE + x) * 4], &pLevel[(sy * width + sx) * 4], 4);
+        }
+    }
+}
+
+bool HasAlpha(const uint8_t *pData, uint32_t pixelCount)
+{
+    for (uint32_t i = 0; i < pixelCount; i++)
+    {
+        if (pData[i * 4 + 3] != 255)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
+
+
+TextureCompressor::TextureCompressor(
+    std::shared_ptr<WorkerPool> _workerPool,
+    std::shared_ptr<const MipmapGenerator> _mipmapGenerator,
+    const char *pCacheFolderPath)
+:
+    workerPool(std::move(_workerPool)),
+    mipmapGenerator(std::move(_mipmapGenerator)),
+    cacheFolderPath(pCacheFolderPath != nullptr ? pCacheFolderPath : "")
+{
+    if (!cacheFolderPath.empty() && cacheFolderPath.back() != '/' && cacheFolderPath.back() != '\\')
+    {
+        cacheFolderPath += '/';
+    }
+}
+
+bool TextureCompressor::CanCompress(const ImageLoader::ResultInfo &info)
+{
+    return
+        info.pData != nullptr &&
+        !info.isPregenerated &&
+        info.levelCount == 1 &&
+        (info.format == VK_FORMAT_R8G8B8A8_SRGB || info.format == VK_FORMAT_R8G8B8A8_UNORM) &&
+        info.baseSize.width > 0 && info.baseSize.height > 0 &&
+        info.levelSizes[0] == info.baseSize.width * info.baseSize.height * 4;
+}
+
+bool TextureCompressor::Compress(const ImageLoader::ResultInfo &info, bool useMipmaps, ImageLoader::ResultInfo *pResult)
+{
+    if (!CanCompress(info))
+    {
+        return false;
+    }
+
+    const bool isSRGB = info.format == VK_FORMAT_R8G8B8A8_SRGB;
+    const uint8_t *pBase = info.pData + info.levelOffsets[0];
+
+    HashDesc desc = {};
+    desc.version = CACHE_VERSION;
+    desc.format = info.format;
+    desc.width = info.baseSize.width;
+    desc.height = info.baseSize.height;
+    desc.useMipmaps = useMipmaps ? 1 : 0;
+
+    const uint64_t key = Utils::HashBytes(pBase, info.levelSizes[0], Utils::HashBytes(&desc, sizeof(desc)));
+
+    const bool withAlpha = HasAlpha(pBase, info.baseSize.width * info.baseSize.height);
+    const uint32_t bytesPerBlock = withAlpha ? 16 : 8;
+
+    VkFormat format;
+
+    if (withAlpha)
+    {
+        format = isSRGB ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+    }
+    else
+    {
+        format = isSRGB ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    }
+
+    const uint32_t maxLevelCount = useMipmaps ? MAX_PREGENERATED_MIPMAP_LEVELS : 1;
+
+    if (ReadFromCache(key, info.baseSize, format, bytesPerBlock, maxLevelCount, pResult))
+    {
+        return true;
+    }
+
+
+    ImageLoader::ResultInfo &r = *pResult;
+    r = {};
+    r.format = format;
+
+    uint32_t uncompressedOffsets[MAX_PREGENERATED_MIPMAP_LEVELS];
+    uint32_t uncompressedSizes[MAX_PREGENERATED_MIPMAP_LEVELS];
+
+    const uint32_t levelCount = mipmapGenerator->Generate(
+        pBase, info.baseSize, info.format, maxLevelCount,
+        uncompressed, uncompressedOffsets, uncompressedSizes);
+
+    if (levelCount == 0)
+    {
+        return false;
+    }
+
+    // job is a row of blocks
+    struct BlockRow
+    {
+        uint32_t level;
+        uint32_t blockY;
+    };
+    std::vector<BlockRow> rows;
+
+    uint32_t dataSize = 0;
+
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        const uint32_t w = std::max(info.baseSize.width >> level, 1u);
+        const uint32_t h = std::max(info.baseSize.height >> level, 1u);
+
+        r.levelOffsets[level] = dataSize;
+        r.levelSizes[level] = GetBlockCount(w) * GetBlockCount(h) * bytesPerBlock;
+        dataSize += r.levelSizes[level];
+
+        for (uint32_t by = 0; by < GetBlockCount(h); by++)
+        {
+            rows.push_back({ level, by });
+        }
+    }
+
+    compressed.resize(dataSize);
+
+    const std::function<void(uint32_t)> encodeRow = [&] (uint32_t rowIndex)
+    {
+        const BlockRow &row = rows[rowIndex];
+
+        const uint32_t w = std::max(info.baseSize.width >> row.level, 1u);
+        const uint32_t h = std::max(info.baseSize.height >> row.level, 1u);
+        const uint32_t blockCountX = GetBlockCount(w);
+
+        const uint8_t *pLevel = &uncompressed[uncompressedOffsets[row.level]];
+        uint8_t *pDst = &compressed[r.levelOffsets[row.level] + row.blockY * blockCountX * bytesPerBlock];
+
+        uint8_t block[64];
+
+        for (uint32_t bx = 0; bx < blockCountX; bx++)
+        {
+            FetchBlock(pLevel, w, h, bx, row.blockY, block);
+
+            if (withAlpha)
+            {
+                EncodeAlphaBlock(block, pDst);
+                EncodeColorBlock(block, pDst + 8);
+            }
+            else
+            {
+                EncodeColorBlock(block, pDst);
+            }
+
+            pDst += bytesPerBlock;
+        }
+    };
+
+    workerPool->ParallelFor((uint32_t)rows.size(), encodeRow);
+
+    r.levelCount = levelCount;
+    r.isPregenerated = true;
+    r.pData = compressed.data();
+    r.dataSize = dataSize;
+    r.baseSize = info.baseSize;
+
+    WriteToCache(key, r);
+    return true;
+}
+
+std::string TextureCompressor::GetCacheFilePath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.rtbc", (unsigned long long)key);
+
+    return cacheFolderPath + name;
+}
+
+bool TextureCompressor::ReadFromCache(
+    uint64_t key, const RgExtent2D &expectedSize, VkFormat expectedFormat, uint32_t bytesPerBlock, uint32_t maxLevelCount,
+    ImageLoader::ResultInfo *pResult)
+{
+    if (cacheFolderPath.empty())
+    {
+        return false;
+    }
+
+    FILE *f = fopen(GetCacheFilePath(key).c_str(), "rb");
+
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    // the same count that Compress would generate
+    const uint32_t expectedLevelCount =
+        std::min(std::min(MipmapGenerator::GetLevelCount(expectedSize), maxLevelCount), MAX_PREGENERATED_MIPMAP_LEVELS);
+
+    CacheHeader header = {};
+    bool valid =
+        fread(&header, sizeof(header), 1, f) == 1 &&
+        header.magic == CACHE_MAGIC &&
+        header.version == CACHE_VERSION &&
+        header.format == (uint32_t)expectedFormat &&
+        header.width == expectedSize.width && header.height == expectedSize.height &&
+        header.levelCount == expectedLevelCount;
+
+    ImageLoader::ResultInfo r = {};
+
+    if (valid)
+    {
+        // don't trust the stored sizes, they must be the same as computed in Compress
+        uint64_t dataSize = 0;
+
+        for (uint32_t level = 0; level < header.levelCount; level++)
+        {
+            const uint32_t w = std::max(header.width >> level, 1u);
+            const uint32_t h = std::max(header.height >> level, 1u);
+
+            const uint64_t levelSize = (uint64_t)GetBlockCount(w) * GetBlockCount(h) * bytesPerBlock;
+
+            if (header.levelSizes[level] != levelSize)
+            {
+                valid = false;
+                break;
+            }
+
+            r.levelOffsets[level] = (uint32_t)dataSize;
+            r.levelSizes[level] = header.levelSizes[level];
+            dataSize += levelSize;
+
+            if (dataSize > UINT32_MAX)
+            {
+                valid = false;
+                break;
+            }
+        }
+
+        if (valid)
+        {
+            compressed.resize((size_t)dataSize);
+            valid = dataSize > 0 && fread(compressed.data(), (size_t)dataSize, 1, f) == 1;
+
+            r.levelCount = header.levelCount;
+            r.isPregenerated = true;
+            r.pData = compressed.data();
+            r.dataSize = (uint32_t)dataSize;
+            r.baseSize = { header.width, header.height };
+            r.format = expectedFormat;
+        }
+    }
+
+    fclose(f);
+
+    // a rejected entry is treated as a miss, Compress will overwrite it
+    if (valid)
+    {
+        *pResult = r;
+    }
+
+    return valid;
+}
+
+void TextureCompressor::WriteToCache(uint64_t key, const ImageLoader::ResultInfo &result) const
+{
+    if (cacheFolderPath.empty())
+    {
+        return;
+    }
+
+    CacheHeader header = {};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.format = result.format;
+    header.width = result.baseSize.width;
+    header.height = result.baseSize.height;
+    header.levelCount = result.levelCount;
+
+    for (uint32_t level = 0; level < result.levelCount; level++)
+    {
+        header.levelSizes[level] = result.levelSizes[level];
+    }
+
+    // write to a temporary file, so other processes won't read a partially written one
+    const std::string path = GetCacheFilePath(key);
+    const std::string tempPath = path + ".tmp";
+
+    FILE *f = fopen(tempPath.c_str(), "wb");
+
+    if (f == nullptr)
+    {
+        return;
+    }
+
+    const bool written =
+        fwrite(&header, sizeof(header), 1, f) == 1 &&
+        fwrite(result.pData, result.dataSize, 1, f) == 1;
+
+    fclose(f);
+
+    if (!written || std::rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tempPath.c_str());
+    }
+}
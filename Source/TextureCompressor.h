@@ -0,0 +1,74 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "ImageLoader.h"
+#include "MipmapGenerator.h"
+#include "WorkerPool.h"
+
+namespace RTGL1
+{
+
+// Compresses raw RGBA8 textures to BC1 (opaque) or BC3 (with alpha) on CPU.
+// Mip levels are generated on CPU before encoding, blocks are encoded by a worker pool.
+// Results can be cached on disk by a content hash, so next runs skip encoding.
+class TextureCompressor
+{
+public:
+    // If pCacheFolderPath is null or empty, the disk cache is disabled; the folder must exist.
+    TextureCompressor(std::shared_ptr<WorkerPool> workerPool,
+                      std::shared_ptr<const MipmapGenerator> mipmapGenerator,
+                      const char *pCacheFolderPath);
+    ~TextureCompressor() = default;
+
+    TextureCompressor(const TextureCompressor &other) = delete;
+    TextureCompressor(TextureCompressor &&other) noexcept = delete;
+    TextureCompressor &operator=(const TextureCompressor &other) = delete;
+    TextureCompressor &operator=(TextureCompressor &&other) noexcept = delete;
+
+    static bool CanCompress(const ImageLoader::ResultInfo &info);
+
+    // Returns false, if the texture can't be compressed. The result's data
+    // is owned by the compressor and is valid until the next call.
+    bool Compress(const ImageLoader::ResultInfo &info, bool useMipmaps, ImageLoader::ResultInfo *pResult);
+
+private:
+    // Returns false, if there's no entry or it doesn't match the parameters that Compress would use.
+    bool ReadFromCache(uint64_t key, const RgExtent2D &expectedSize, VkFormat expectedFormat, uint32_t bytesPerBlock,
+                       uint32_t maxLevelCount, ImageLoader::ResultInfo *pResult);
+    void WriteToCache(uint64_t key, const ImageLoader::ResultInfo &result) const;
+    std::string GetCacheFilePath(uint64_t key) const;
+
+private:
+    std::shared_ptr<WorkerPool> workerPool;
+    std::shared_ptr<const MipmapGenerator> mipmapGenerator;
+
+    std::string cacheFolderPath;
+
+    std::vector<uint8_t> uncompressed;
+    std::vector<uint8_t> compressed;
+};
+
+}
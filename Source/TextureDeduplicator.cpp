@@ -0,0 +1,218 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TextureDeduplicator.h"
+
+#include <algorithm>
+
+#include "Utils.h"
+
+using namespace RTGL1;
+
+namespace
+{
+
+// any constant that differs from the seed of the main hash
+constexpr uint64_t DATA_HASH_SEED = 0x9E3779B97F4A7C15ULL;
+
+}
+
+bool TextureDeduplicator::ContentKey::operator==(const ContentKey &other) const
+{
+    return
+        hash            == other.hash &&
+        dataHash        == other.dataHash &&
+        width           == other.width &&
+        height          == other.height &&
+        format          == other.format &&
+        dataSize        == other.dataSize &&
+        levelCount      == other.levelCount &&
+        isPregenerated  == other.isPregenerated &&
+        useMipmaps      == other.useMipmaps;
+}
+
+TextureDeduplicator::ContentKey TextureDeduplicator::MakeContentKey(const ImageLoader::ResultInfo &info, bool useMipmaps)
+{
+    assert(info.pData != nullptr && info.dataSize > 0);
+
+    struct
+    {
+        uint32_t    width;
+        uint32_t    height;
+        uint32_t    format;
+        uint32_t    levelCount;
+        uint32_t    isPregenerated;
+        uint32_t    useMipmaps;
+        uint32_t    levelOffsets[MAX_PREGENERATED_MIPMAP_LEVELS];
+        uint32_t    levelSizes[MAX_PREGENERATED_MIPMAP_LEVELS];
+    } desc = {};
+
+    desc.width = info.baseSize.width;
+    desc.height = info.baseSize.height;
+    desc.format = static_cast<uint32_t>(info.format);
+    desc.levelCount = std::min(info.levelCount, MAX_PREGENERATED_MIPMAP_LEVELS);
+    desc.isPregenerated = info.isPregenerated ? 1 : 0;
+    desc.useMipmaps = useMipmaps ? 1 : 0;
+
+    for (uint32_t level = 0; level < desc.levelCount; level++)
+    {
+        desc.levelOffsets[level] = info.levelOffsets[level];
+        desc.levelSizes[level] = info.levelSizes[level];
+    }
+
+    uint64_t descHash = Utils::HashBytes(&desc, sizeof(desc));
+
+    ContentKey key = {};
+    key.hash = Utils::HashBytes(info.pData, info.dataSize, descHash);
+    key.dataHash = Utils::HashBytes(info.pData, info.dataSize, DATA_HASH_SEED);
+    key.width = desc.width;
+    key.height = desc.height;
+    key.format = info.format;
+    key.dataSize = info.dataSize;
+    key.levelCount = desc.levelCount;
+    key.isPregenerated = info.isPregenerated;
+    key.useMipmaps = useMipmaps;
+
+    return key;
+}
+
+uint32_t TextureDeduplicator::Find(const ContentKey &key) const
+{
+    auto it = textureByHash.find(key.hash);
+
+    if (it == textureByHash.end())
+    {
+        return EMPTY_TEXTURE_INDEX;
+    }
+
+    auto e = entries.find(it->second);
+    assert(e != entries.end());
+
+    // same hash, but different contents
+    if (e == entries.end() || !(e->second.key == key))
+    {
+        return EMPTY_TEXTURE_INDEX;
+    }
+
+    return it->second;
+}
+
+void TextureDeduplicator::Add(uint32_t textureIndex, const ContentKey &key, const ImageLoader::ResultInfo &info)
+{
+    assert(textureIndex != EMPTY_TEXTURE_INDEX);
+    assert(entries.find(textureIndex) == entries.end());
+
+    Entry e = {};
+    e.key = key;
+    e.refCount = 1;
+    e.levelCount = std::min(info.levelCount, MAX_PREGENERATED_MIPMAP_LEVELS);
+
+    if (info.isPregenerated)
+    {
+        for (uint32_t level = 0; level < e.levelCount; level++)
+        {
+            e.levelSizes[level] = info.levelSizes[level];
+        }
+    }
+    else
+    {
+        // mip levels are generated on GPU, count only the provided data
+        e.levelCount = 1;
+        e.levelSizes[0] = info.dataSize;
+    }
+
+    entries[textureIndex] = e;
+
+    // if there is a texture with the same contents, but it couldn't be shared
+    // (e.g. because of another sampler), keep the first one
+    textureByHash.emplace(key.hash, textureIndex);
+}
+
+void TextureDeduplicator::AddReference(uint32_t textureIndex)
+{
+    auto it = entries.find(textureIndex);
+    assert(it != entries.end());
+
+    if (it != entries.end())
+    {
+        it->second.refCount++;
+    }
+}
+
+bool TextureDeduplicator::RemoveReference(uint32_t textureIndex)
+{
+    auto it = entries.find(textureIndex);
+
+    if (it == entries.end())
+    {
+        return false;
+    }
+
+    assert(it->second.refCount > 0);
+    it->second.refCount--;
+
+    if (it->second.refCount > 0)
+    {
+        return true;
+    }
+
+    auto h = textureByHash.find(it->second.key.hash);
+
+    if (h != textureByHash.end() && h->second == textureIndex)
+    {
+        textureByHash.erase(h);
+    }
+
+    entries.erase(it);
+    return false;
+}
+
+void TextureDeduplicator::GetStats(RgTextureDeduplicationStats *pResult) const
+{
+    assert(pResult != nullptr);
+    *pResult = {};
+
+    constexpr uint32_t statsLevelCount = sizeof(pResult->savedBytesPerMipLevel) / sizeof(pResult->savedBytesPerMipLevel[0]);
+
+    for (const auto &p : entries)
+    {
+        const Entry &e = p.second;
+
+        pResult->uniqueTextureCount++;
+
+        if (e.refCount <= 1)
+        {
+            continue;
+        }
+
+        const uint32_t reused = e.refCount - 1;
+
+        pResult->sharedTextureCount++;
+        pResult->reusedReferenceCount += reused;
+
+        for (uint32_t level = 0; level < e.levelCount; level++)
+        {
+            const uint64_t saved = static_cast<uint64_t>(e.levelSizes[level]) * reused;
+
+            pResult->savedBytes += saved;
+            pResult->savedBytesPerMipLevel[std::min(level, statsLevelCount - 1)] += saved;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Common.h"
+#include "Containers.h"
+#include "ImageLoader.h"
+
+namespace RTGL1
+{
+
+// Reference counting of static textures with identical contents,
+// so such textures are uploaded once and share a descriptor slot.
+class TextureDeduplicator
+{
+public:
+    TextureDeduplicator() = default;
+    ~TextureDeduplicator() = default;
+
+    TextureDeduplicator(const TextureDeduplicator &other) = delete;
+    TextureDeduplicator(TextureDeduplicator &&other) noexcept = delete;
+    TextureDeduplicator &operator=(const TextureDeduplicator &other) = delete;
+    TextureDeduplicator &operator=(TextureDeduplicator &&other) noexcept = delete;
+
+    // Identifies texture contents. Textures are shared only if all members are equal:
+    // the description is compared exactly, and two independently seeded hashes
+    // of pixel data make an accidental match of different data practically impossible.
+    struct ContentKey
+    {
+        uint64_t    hash;
+        uint64_t    dataHash;
+        uint32_t    width;
+        uint32_t    height;
+        VkFormat    format;
+        uint32_t    dataSize;
+        uint32_t    levelCount;
+        bool        isPregenerated;
+        bool        useMipmaps;
+
+        bool operator==(const ContentKey &other) const;
+    };
+
+    static ContentKey MakeContentKey(const ImageLoader::ResultInfo &info, bool useMipmaps);
+
+    // Returns EMPTY_TEXTURE_INDEX, if there is no texture with such contents.
+    uint32_t Find(const ContentKey &key) const;
+
+    // Register a newly uploaded texture with 1 reference.
+    // 'info' is the uploaded data, it may differ from the one that was used for the key.
+    void Add(uint32_t textureIndex, const ContentKey &key, const ImageLoader::ResultInfo &info);
+    void AddReference(uint32_t textureIndex);
+    // Returns true, if the texture is still referenced and must not be destroyed.
+    bool RemoveReference(uint32_t textureIndex);
+
+    void GetStats(RgTextureDeduplicationStats *pResult) const;
+
+private:
+    struct Entry
+    {
+        ContentKey  key;
+        uint32_t    refCount;
+        uint32_t    levelCount;
+        uint32_t    levelSizes[MAX_PREGENERATED_MIPMAP_LEVELS];
+    };
+
+private:
+    rgl::unordered_map<uint64_t, uint32_t> textureByHash;
+    rgl::unordered_map<uint32_t, Entry> entries;
+};
+
+}
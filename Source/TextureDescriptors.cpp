@@ -23,7 +23,8 @@
 
 using namespace RTGL1;
 
-TextureDescriptors::TextureDescriptors(VkDevice _device, std::shared_ptr<SamplerManager> _samplerManager, uint32_t _maxTextureCount, uint32_t _bindingIndex) :
+TextureDescriptors::TextureDescriptors(VkDevice _device, std::shared_ptr<SamplerManager> _samplerManager, uint32_t _maxTextureCount, uint32_t _bindingIndex,
+                                       bool _partiallyBound) :
     device(_device),
     samplerManager(std::move(_samplerManager)),
     bindingIndex(_bindingIndex),
@@ -42,7 +43,7 @@ TextureDescriptors::TextureDescriptors(VkDevice _device, std::shared_ptr<Sampler
         writeCache[i].resize(_maxTextureCount);
     }
 
-    CreateDescriptors(_maxTextureCount);
+    CreateDescriptors(_maxTextureCount, _partiallyBound);
 }
 
 TextureDescriptors::~TextureDescriptors()
@@ -67,7 +68,7 @@ void TextureDescriptors::SetEmptyTextureInfo(VkImageView view)
     emptyTextureImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 }
 
-void TextureDescriptors::CreateDescriptors(uint32_t maxTextureCount)
+void TextureDescriptors::CreateDescriptors(uint32_t maxTextureCount, bool partiallyBound)
 {
     VkDescriptorSetLayoutBinding binding = {};
 
@@ -81,6 +82,18 @@ void TextureDescriptors::CreateDescriptors(uint32_t maxTextureCount)
     layoutInfo.bindingCount = 1;
     layoutInfo.pBindings = &binding;
 
+    VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+    if (partiallyBound)
+    {
+        layoutInfo.pNext = &bindingFlagsInfo;
+    }
+
     VkResult r = vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descLayout);
     VK_CHECKERROR(r);
 
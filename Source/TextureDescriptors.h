@@ -31,7 +31,9 @@ namespace RTGL1
 class TextureDescriptors
 {
 public:
-    explicit TextureDescriptors(VkDevice device, std::shared_ptr<SamplerManager> samplerManager, uint32_t maxTextureCount, uint32_t bindingIndex);
+    // If partiallyBound, descriptors that are not accessed by shaders can be left unwritten.
+    explicit TextureDescriptors(VkDevice device, std::shared_ptr<SamplerManager> samplerManager, uint32_t maxTextureCount, uint32_t bindingIndex,
+                                bool partiallyBound = false);
     ~TextureDescriptors();
 
     TextureDescriptors(const TextureDescriptors &other) = delete;
@@ -54,7 +56,7 @@ public:
     void SetEmptyTextureInfo(VkImageView view);
 
 private:
-    void CreateDescriptors(uint32_t maxTextureCount);
+    void CreateDescriptors(uint32_t maxTextureCount, bool partiallyBound);
 
     bool IsCached(uint32_t frameIndex, uint32_t textureIndex, VkImageView view, SamplerManager::Handle samplerHandle);
     void AddToCache(uint32_t frameIndex, uint32_t textureIndex, VkImageView view, SamplerManager::Handle samplerHandle);
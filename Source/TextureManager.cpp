@@ -20,8 +20,9 @@
 
 #include "TextureManager.h"
 
-#include <numeric>
+#include <algorithm>
 
+#include "CmdLabel.h"
 #include "Const.h"
 #include "Utils.h"
 #include "TextureOverrides.h"
@@ -39,14 +40,19 @@ constexpr RgSamplerFilter DefaultDynamicSamplerFilter = RG_SAMPLER_FILTER_LINEAR
 
 TextureManager::TextureManager(
     VkDevice _device,
+    const std::shared_ptr<PhysicalDevice> &_physDevice,
     std::shared_ptr<MemoryAllocator> _memAllocator,
     std::shared_ptr<SamplerManager> _samplerMgr,
     const std::shared_ptr<CommandBufferManager> &_cmdManager,
     std::shared_ptr<UserFileLoad> _userFileLoad,
+    std::shared_ptr<const OverrideFolderIndex> _overrideFolderIndex,
+    std::shared_ptr<const TexturePack> _texturePack,
     const RgInstanceCreateInfo &_info)
 :
     device(_device),
     samplerMgr(std::move(_samplerMgr)),
+    isTextureDescPartiallyBound(_physDevice->IsDescriptorPartiallyBoundSupported()),
+    animatedMaterials(true),
     currentDynamicSamplerFilter(DefaultDynamicSamplerFilter)
 {
     this->defaultTexturesPath = _info.pOverridenTexturesFolderPath != nullptr ? _info.pOverridenTexturesFolderPath : DEFAULT_TEXTURES_PATH;
@@ -71,13 +77,52 @@ TextureManager::TextureManager(
         this->overridenIsSRGB[i] = userOverridenIsSRGB[i];
     }
 
-    const uint32_t maxTextureCount = std::max<uint32_t>(TEXTURE_COUNT_MIN, std::min<uint32_t>(_info.maxTextureCount, TEXTURE_COUNT_MAX));
+    uint32_t upperTextureCount = TEXTURE_COUNT_MAX;
 
-    imageLoader = std::make_shared<ImageLoader>(std::move(_userFileLoad));
-    textureDesc = std::make_shared<TextureDescriptors>(device, samplerMgr, maxTextureCount, BINDING_TEXTURES);
+    // unused slots don't need valid descriptors, so the array can be larger
+    if (isTextureDescPartiallyBound)
+    {
+        const uint32_t deviceLimit = _physDevice->GetMaxSampledImageDescriptorCount();
+
+        if (deviceLimit > TEXTURE_COUNT_RESERVED_DESCRIPTORS)
+        {
+            upperTextureCount = std::min(TEXTURE_COUNT_MAX_PARTIALLY_BOUND, deviceLimit - TEXTURE_COUNT_RESERVED_DESCRIPTORS);
+            upperTextureCount = std::max(upperTextureCount, TEXTURE_COUNT_MAX);
+        }
+    }
+
+    const uint32_t maxTextureCount = std::max<uint32_t>(TEXTURE_COUNT_MIN, std::min<uint32_t>(_info.maxTextureCount, upperTextureCount));
+
+    imageLoader = std::make_shared<ImageLoader>(std::move(_userFileLoad), std::move(_overrideFolderIndex), std::move(_texturePack));
+    textureDesc = std::make_shared<TextureDescriptors>(device, samplerMgr, maxTextureCount, BINDING_TEXTURES, isTextureDescPartiallyBound);
+    animatedMaterialTable = std::make_shared<AnimatedMaterialTable>(device, _memAllocator);
     textureUploader = std::make_shared<TextureUploader>(device, std::move(_memAllocator));
 
+    if (_info.textureStreamingEnable)
+    {
+        const uint64_t budgetInMB = _info.textureStreamingBudgetInMB > 0 ? _info.textureStreamingBudgetInMB : TEXTURE_STREAMING_DEFAULT_BUDGET_MB;
+        const uint32_t mipTailSize = _info.textureStreamingMipTailSize > 0 ? _info.textureStreamingMipTailSize : TEXTURE_STREAMING_DEFAULT_MIP_TAIL_SIZE;
+
+        textureStreamer = std::make_shared<TextureStreamer>(budgetInMB * 1024 * 1024, mipTailSize, TEXTURE_STREAMING_MAX_UPLOAD_PER_FRAME);
+    }
+
+    if (_info.textureDeduplicationEnable)
+    {
+        textureDeduplicator = std::make_shared<TextureDeduplicator>();
+    }
+
+    // threads are started only if CPU mip generation or compression is used
+    workerPool = std::make_shared<WorkerPool>(_info.textureCompressionThreadCount);
+    mipmapGenerator = std::make_shared<MipmapGenerator>(workerPool);
+
+    if (_info.textureCompressionEnable)
+    {
+        textureCompressor = std::make_shared<TextureCompressor>(workerPool, mipmapGenerator, _info.pTextureCompressionCachePath);
+    }
+
     textures.resize(maxTextureCount);
+    textureVersions.resize(maxTextureCount, 0);
+    textureSlots = std::make_shared<TextureSlotAllocator>(maxTextureCount);
 
     // submit cmd to create empty texture
     VkCommandBuffer cmd = _cmdManager->StartGraphicsCmd();
@@ -110,7 +155,7 @@ void TextureManager::CreateEmptyTexture(VkCommandBuffer cmd, uint32_t frameIndex
 
     SamplerManager::Handle samplerHandle(RG_SAMPLER_FILTER_NEAREST, RG_SAMPLER_ADDRESS_MODE_REPEAT, RG_SAMPLER_ADDRESS_MODE_REPEAT, 0);
 
-    uint32_t textureIndex = PrepareStaticTexture(cmd, frameIndex, info, samplerHandle, false, "Empty texture");
+    uint32_t textureIndex = PrepareStaticTexture(cmd, frameIndex, info, samplerHandle, false, "Empty texture", nullptr);
 
     // must have specific index
     assert(textureIndex == EMPTY_TEXTURE_INDEX);
@@ -144,7 +189,7 @@ void RTGL1::TextureManager::CreateWaterNormalTexture(VkCommandBuffer cmd, uint32
     // try to load image file
     TextureOverrides ovrd(pFilePath, defaultData, false, defaultSize, parseInfo, imageLoader);
 
-    this->waterNormalTextureIndex = PrepareStaticTexture(cmd, frameIndex, ovrd.GetResult(0), samplerHandle, true, "Water normal");
+    this->waterNormalTextureIndex = PrepareStaticTexture(cmd, frameIndex, ovrd.GetResult(0), samplerHandle, true, "Water normal", nullptr);
 }
 
 TextureManager::~TextureManager()
@@ -178,6 +223,9 @@ void TextureManager::PrepareForFrame(uint32_t frameIndex)
     }
     texturesToDestroy[frameIndex].clear();
 
+    // slots of the destroyed textures can be reused
+    textureSlots->PrepareForFrame(frameIndex);
+
     // clear staging buffer that are not in use
     textureUploader->ClearStaging(frameIndex);
 }
@@ -202,8 +250,11 @@ void TextureManager::SubmitDescriptors(uint32_t frameIndex,
         textureDesc->ResetAllCache(frameIndex);
     }
 
+    // if partially bound, never used slots can be skipped
+    const uint32_t slotCount = isTextureDescPartiallyBound ? textureSlots->GetUsedRangeEnd() : (uint32_t)textures.size();
+
     // update desc set with current values
-    for (uint32_t i = 0; i < textures.size(); i++)
+    for (uint32_t i = 0; i < slotCount; i++)
     {
         textures[i].samplerHandle.SetIfHasDynamicSamplerFilter(newDynamicSamplerFilter);
 
@@ -249,16 +300,76 @@ uint32_t TextureManager::CreateStaticMaterial(VkCommandBuffer cmd, uint32_t fram
 
     MaterialTextures mtextures = {};
 
+    const bool useMipmaps = !(createInfo.flags & RG_MATERIAL_CREATE_DONT_GENERATE_MIPMAPS_BIT);
+
     for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
     {
-        mtextures.indices[i] = PrepareStaticTexture(cmd, frameIndex, ovrd.GetResult(i), samplerHandle,
-                                                   !(createInfo.flags & RG_MATERIAL_CREATE_DONT_GENERATE_MIPMAPS_BIT), ovrd.GetDebugName());
+        const ImageLoader::ResultInfo &loaded = ovrd.GetResult(i);
+        const bool deduplicate = textureDeduplicator && loaded.pData != nullptr && loaded.dataSize > 0;
+
+        TextureDeduplicator::ContentKey contentKey = {};
+
+        if (deduplicate)
+        {
+            // hash source data, so duplicates are not compressed
+            contentKey = TextureDeduplicator::MakeContentKey(loaded, useMipmaps);
+            const uint32_t existing = textureDeduplicator->Find(contentKey);
+
+            // share, if the sampler is the same, as it's a part of the descriptor
+            if (existing != EMPTY_TEXTURE_INDEX && textures[existing].samplerHandle == samplerHandle)
+            {
+                textureDeduplicator->AddReference(existing);
+                mtextures.indices[i] = existing;
+
+                continue;
+            }
+        }
+
+        // compress only raw user data, BC1 is too lossy for normal maps
+        ImageLoader::ResultInfo compressed;
+        const bool wasCompressed =
+            textureCompressor &&
+            i != MATERIAL_NORMAL_INDEX &&
+            ovrd.GetFilePath(i) == nullptr &&
+            textureCompressor->Compress(loaded, useMipmaps, &compressed);
+
+        const ImageLoader::ResultInfo &result = wasCompressed ? compressed : loaded;
+
+        mtextures.indices[i] = PrepareStaticTexture(cmd, frameIndex, result, samplerHandle, useMipmaps, ovrd.GetDebugName(),
+                                                   ovrd.GetFilePath(i));
+
+        if (deduplicate && mtextures.indices[i] != EMPTY_TEXTURE_INDEX)
+        {
+            textureDeduplicator->Add(mtextures.indices[i], contentKey, result);
+        }
     }
 
 
     return InsertMaterial(mtextures, false);
 }
 
+void TextureManager::CreateStaticMaterials(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t count,
+                                           const RgStaticMaterialCreateInfo *pCreateInfos, uint32_t *pResults)
+{
+    textureUploader->BeginBatch();
+
+    try
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            pResults[i] = CreateStaticMaterial(cmd, frameIndex, pCreateInfos[i]);
+        }
+    }
+    catch (...)
+    {
+        // materials that were created before the error must be valid
+        textureUploader->EndBatch(cmd);
+        throw;
+    }
+
+    textureUploader->EndBatch(cmd);
+}
+
 uint32_t TextureManager::CreateDynamicMaterial(VkCommandBuffer cmd, uint32_t frameIndex, const RgDynamicMaterialCreateInfo &createInfo)
 {
     SamplerManager::Handle samplerHandle(createInfo.filter, createInfo.addressModeU, createInfo.addressModeV, createInfo.flags);
@@ -290,12 +401,12 @@ uint32_t TextureManager::CreateDynamicMaterial(VkCommandBuffer cmd, uint32_t fra
 
 bool TextureManager::UpdateDynamicMaterial(VkCommandBuffer cmd, const RgDynamicMaterialUpdateInfo &updateInfo)
 {
-    const auto it = materials.find(updateInfo.dynamicMaterial);
+    Material *material = materials.Find(updateInfo.dynamicMaterial);
 
     // if exist and dynamic
-    if (it != materials.end())
+    if (material != nullptr)
     {
-        if (!it->second.isDynamic)
+        if (!material->isDynamic)
         {
             throw RgException(RG_CANT_UPDATE_DYNAMIC_MATERIAL,
                               "Material with ID=" + std::to_string(updateInfo.dynamicMaterial) + " is not dynamic");
@@ -308,7 +419,7 @@ bool TextureManager::UpdateDynamicMaterial(VkCommandBuffer cmd, const RgDynamicM
             updateInfo.textures.normal.pData,
         };
 
-        auto &textureIndices = it->second.textures.indices;
+        auto &textureIndices = material->textures.indices;
         static_assert(sizeof(textureIndices) / sizeof(textureIndices[0]) == TEXTURES_PER_MATERIAL_COUNT, "");
 
         bool wasUpdated = false;
@@ -329,7 +440,7 @@ bool TextureManager::UpdateDynamicMaterial(VkCommandBuffer cmd, const RgDynamicM
                 continue;
             }
 
-            textureUploader->UpdateDynamicImage(cmd, img, updateData[i]);
+            textureUploader->UpdateDynamicImage(cmd, img, updateData[i], updateInfo.pDirtyRects, updateInfo.dirtyRectCount);
             wasUpdated = true;
         }
 
@@ -348,7 +459,7 @@ uint32_t TextureManager::PrepareStaticTexture(
     VkCommandBuffer cmd, uint32_t frameIndex, 
     const ImageLoader::ResultInfo &imageInfo,
     SamplerManager::Handle samplerHandle, bool useMipmaps,
-    const char *debugName)
+    const char *debugName, const char *streamedFilePath)
 {
     // only dynamic textures can have null data
     if (imageInfo.pData == nullptr)
@@ -369,20 +480,52 @@ uint32_t TextureManager::PrepareStaticTexture(
     assert(imageInfo.dataSize > 0);
     assert(imageInfo.levelCount > 0 && imageInfo.levelSizes[0] > 0);
 
+    // if mip levels can't be blitted on GPU, generate them on CPU
+    if (useMipmaps && 
+        !imageInfo.isPregenerated && 
+        !TextureUploader::DoesFormatSupportBlit(imageInfo.format) &&
+        MipmapGenerator::IsFormatSupported(imageInfo.format) &&
+        MipmapGenerator::GetLevelCount(imageInfo.baseSize) > 1)
+    {
+        ImageLoader::ResultInfo withMipmaps = imageInfo;
+
+        withMipmaps.levelCount = mipmapGenerator->Generate(
+            imageInfo.pData + imageInfo.levelOffsets[0], imageInfo.baseSize, imageInfo.format, MAX_PREGENERATED_MIPMAP_LEVELS,
+            generatedMipmaps, withMipmaps.levelOffsets, withMipmaps.levelSizes);
+
+        if (withMipmaps.levelCount > 0)
+        {
+            withMipmaps.isPregenerated = true;
+            withMipmaps.pData = generatedMipmaps.data();
+            withMipmaps.dataSize = (uint32_t)generatedMipmaps.size();
+
+            // generated levels are not in the file, so it can't be streamed
+            return PrepareStaticTexture(cmd, frameIndex, withMipmaps, samplerHandle, useMipmaps, debugName, nullptr);
+        }
+    }
+
+    // if streamed, upload only the mip tail
+    uint32_t residentLevel = 0;
+
+    if (textureStreamer && streamedFilePath != nullptr && useMipmaps)
+    {
+        residentLevel = textureStreamer->GetInitialResidentLevel(imageInfo);
+    }
+
     TextureUploader::UploadInfo info = {};
     info.cmd = cmd;
     info.frameIndex = frameIndex;
     info.pData = imageInfo.pData;
     info.dataSize = imageInfo.dataSize;
-    info.baseSize = imageInfo.baseSize;
+    info.baseSize = { std::max(imageInfo.baseSize.width >> residentLevel, 1u), std::max(imageInfo.baseSize.height >> residentLevel, 1u) };
     info.format = imageInfo.format;
     info.isDynamic = false;
     info.useMipmaps = useMipmaps;
     info.pDebugName = debugName;
     info.isCubemap = false;
-    info.pregeneratedLevelCount = imageInfo.isPregenerated ? imageInfo.levelCount : 0;
-    info.pLevelDataOffsets = imageInfo.levelOffsets;
-    info.pLevelDataSizes = imageInfo.levelSizes;
+    info.pregeneratedLevelCount = imageInfo.isPregenerated ? imageInfo.levelCount - residentLevel : 0;
+    info.pLevelDataOffsets = imageInfo.levelOffsets + residentLevel;
+    info.pLevelDataSizes = imageInfo.levelSizes + residentLevel;
 
     auto result = textureUploader->UploadImage(info);
 
@@ -391,7 +534,14 @@ uint32_t TextureManager::PrepareStaticTexture(
         return EMPTY_TEXTURE_INDEX;
     }
 
-    return InsertTexture(frameIndex, result.image, result.view, samplerHandle);
+    uint32_t textureIndex = InsertTexture(frameIndex, result.image, result.view, samplerHandle);
+
+    if (residentLevel > 0 && textureIndex != EMPTY_TEXTURE_INDEX)
+    {
+        textureStreamer->Register(textureIndex, streamedFilePath, imageInfo, residentLevel);
+    }
+
+    return textureIndex;
 }
 
 uint32_t TextureManager::PrepareDynamicTexture(
@@ -407,6 +557,17 @@ uint32_t TextureManager::PrepareDynamicTexture(
 
     assert(size.width > 0 && size.height > 0);
 
+    // mip levels of a dynamic texture are regenerated on each update with blits,
+    // the CPU generator is used only for static textures
+    if (generateMipmaps && !TextureUploader::DoesFormatSupportBlit(format))
+    {
+        using namespace std::string_literals;
+
+        throw RgException(RG_WRONG_MATERIAL_PARAMETER, "Can't generate mip levels for a dynamic texture with format "s +
+                          std::to_string(format) + ", as it doesn't support blitting" +
+                          (debugName != nullptr ? ". Name: "s + debugName : ""s));
+    }
+
     TextureUploader::UploadInfo info = {};
     info.cmd = cmd;
     info.frameIndex = frameIndex;
@@ -439,21 +600,18 @@ uint32_t TextureManager::CreateAnimatedMaterial(VkCommandBuffer cmd, uint32_t fr
     std::vector<uint32_t> materialIndices(createInfo.frameCount);
 
     // animated material is a series of static materials
-    for (uint32_t i = 0; i < createInfo.frameCount; i++)
-    {
-        materialIndices[i] = CreateStaticMaterial(cmd, frameIndex, createInfo.pFrames[i]);
-    }
+    CreateStaticMaterials(cmd, frameIndex, createInfo.frameCount, createInfo.pFrames, materialIndices.data());
 
     return InsertAnimatedMaterial(materialIndices);
 }
 
 bool TextureManager::ChangeAnimatedMaterialFrame(uint32_t animMaterial, uint32_t materialFrame)
 {
-    const auto animIt = animatedMaterials.find(animMaterial);
+    AnimatedMaterial *found = animatedMaterials.Find(animMaterial);
 
-    if (animIt != animatedMaterials.end())
+    if (found != nullptr)
     {
-        AnimatedMaterial &anim = animIt->second;
+        AnimatedMaterial &anim = *found;
 
         uint32_t maxFrameCount = (uint32_t)anim.materialIndices.size();
         if (materialFrame >= maxFrameCount)
@@ -466,20 +624,21 @@ bool TextureManager::ChangeAnimatedMaterialFrame(uint32_t animMaterial, uint32_t
 
         anim.currentFrame = materialFrame;
 
-        // notify subscribers
-        for (auto &ws : subscribers)
+        const MaterialTextures frameTextures = GetMaterialTextures(anim.materialIndices[anim.currentFrame]);
+
+        // geometry instances reference the table, so only one entry should be updated
+        if (anim.tableSlot != ANIMATED_MATERIAL_NO_SLOT)
+        {
+            animatedMaterialTable->Write(anim.tableSlot, frameTextures);
+        }
+        else
         {
-            // if subscriber still exist
-            if (auto s = ws.lock())
+            // the table is full, geometry instances contain actual texture indices
+            for (auto &ws : subscribers)
             {
-                uint32_t frameMatIndex = anim.materialIndices[anim.currentFrame];
-
-                // find MaterialTextures
-                auto it = materials.find(frameMatIndex);
-
-                if (it != materials.end())
+                if (auto s = ws.lock())
                 {
-                    s->OnMaterialChange(animMaterial, it->second.textures);
+                    s->OnMaterialChange(animMaterial, frameTextures);
                 }
             }
         }
@@ -494,31 +653,6 @@ bool TextureManager::ChangeAnimatedMaterialFrame(uint32_t animMaterial, uint32_t
     return false;
 }
 
-uint32_t TextureManager::GenerateMaterialIndex(const MaterialTextures &materialTextures)
-{
-    uint32_t matIndex = materialTextures.indices[0] + materialTextures.indices[1] + materialTextures.indices[2];
-
-    while (materials.find(matIndex) != materials.end())
-    {
-        matIndex++;
-    }
-
-    return matIndex;
-}
-
-uint32_t TextureManager::GenerateMaterialIndex(const std::vector<uint32_t> &materialIndices)
-{
-    uint32_t matIndex = std::accumulate(materialIndices.begin(), materialIndices.end(), 0u);
-
-    // all materials share the same pool of indices
-    while (materials.find(matIndex) != materials.end())
-    {
-        matIndex++;
-    }
-
-    return matIndex;
-}
-
 uint32_t TextureManager::InsertMaterial(const MaterialTextures &materialTextures, bool isDynamic)
 {
     bool isEmpty = true;
@@ -537,13 +671,19 @@ uint32_t TextureManager::InsertMaterial(const MaterialTextures &materialTextures
         return RG_NO_MATERIAL;
     }
 
-    uint32_t matIndex = GenerateMaterialIndex(materialTextures);
-
     Material material = {};
     material.isDynamic = isDynamic;
     material.textures = materialTextures;
 
-    materials[matIndex] = material;
+    uint32_t matIndex = materials.Insert(material);
+    static_assert(decltype(materials)::InvalidHandle == RG_NO_MATERIAL, "");
+
+    if (matIndex == RG_NO_MATERIAL)
+    {
+        // TODO: properly warn user, add severity to print
+        assert(false && "Too many materials");
+    }
+
     return matIndex;
 }
 
@@ -565,24 +705,41 @@ uint32_t TextureManager::InsertAnimatedMaterial(std::vector<uint32_t> &materialI
         return RG_NO_MATERIAL;
     }
 
-    uint32_t animMatIndex = GenerateMaterialIndex(materialIndices);
+    uint32_t animMatIndex = animatedMaterials.Insert({});
+    static_assert(decltype(animatedMaterials)::InvalidHandle == RG_NO_MATERIAL, "");
 
-    animatedMaterials[animMatIndex] = {};
+    if (animMatIndex == RG_NO_MATERIAL)
+    {
+        // TODO: properly warn user, add severity to print
+        assert(false && "Too many animated materials");
+        return RG_NO_MATERIAL;
+    }
 
-    AnimatedMaterial &animMat = animatedMaterials[animMatIndex];
+    AnimatedMaterial &animMat = *animatedMaterials.Find(animMatIndex);
     animMat.currentFrame = 0;
     animMat.materialIndices = std::move(materialIndices);
+    animMat.tableSlot = animatedMaterialTable->AllocateSlot();
+
+    if (animMat.tableSlot != ANIMATED_MATERIAL_NO_SLOT)
+    {
+        animatedMaterialTable->Write(animMat.tableSlot, GetMaterialTextures(animMat.materialIndices[0]));
+    }
+    else
+    {
+        // TODO: properly warn user, add severity to print
+        assert(false && "Too many animated materials, frame changes will rewrite geometry instances");
+    }
 
     return animMatIndex;
 }
 
 void TextureManager::DestroyMaterialTextures(uint32_t frameIndex, uint32_t materialIndex)
 {
-    auto it = materials.find(materialIndex);
+    const Material *material = materials.Find(materialIndex);
 
-    if (it != materials.end())
+    if (material != nullptr)
     {
-        DestroyMaterialTextures(frameIndex, it->second);
+        DestroyMaterialTextures(frameIndex, *material);
     }
 }
 
@@ -592,14 +749,28 @@ void TextureManager::DestroyMaterialTextures(uint32_t frameIndex, const Material
     {
         if (t != EMPTY_TEXTURE_INDEX)
         {
+            // other materials still use it
+            if (textureDeduplicator && textureDeduplicator->RemoveReference(t))
+            {
+                continue;
+            }
+
             Texture &texture = textures[t];
 
+            if (textureStreamer)
+            {
+                textureStreamer->Unregister(t);
+            }
+
             AddToBeDestroyed(frameIndex, texture);
 
             // null data
             texture.image = VK_NULL_HANDLE;
             texture.view = VK_NULL_HANDLE;
             texture.samplerHandle = SamplerManager::Handle();
+            textureVersions[t]++;
+
+            textureSlots->Free(frameIndex, t);
         }
     }
 }
@@ -611,29 +782,38 @@ void TextureManager::DestroyMaterial(uint32_t currentFrameIndex, uint32_t materi
         return;
     }
 
-    const auto animIt = animatedMaterials.find(materialIndex);
+    AnimatedMaterial *found = animatedMaterials.Find(materialIndex);
 
     // if it's an animated material
-    if (animIt != animatedMaterials.end())
+    if (found != nullptr)
     {
-        AnimatedMaterial &anim = animIt->second;
+        AnimatedMaterial &anim = *found;
 
         // destroy each material
         for (auto &mat : anim.materialIndices)
         {
             DestroyMaterialTextures(currentFrameIndex, mat);
+            materials.Erase(mat);
+        }
+
+        if (anim.tableSlot != ANIMATED_MATERIAL_NO_SLOT)
+        {
+            // geometry instances are notified below, so the slot can be reused right away;
+            // static geometry will reference empty textures
+            animatedMaterialTable->Write(anim.tableSlot, EmptyMaterialTextures);
+            animatedMaterialTable->FreeSlot(anim.tableSlot);
         }
 
-        animatedMaterials.erase(animIt);
+        animatedMaterials.Erase(materialIndex);
     }
     else
     {
-        auto it = materials.find(materialIndex);
+        const Material *material = materials.Find(materialIndex);
 
-        if (it != materials.end())
+        if (material != nullptr)
         {
-            DestroyMaterialTextures(currentFrameIndex, it->second);
-            materials.erase(it);
+            DestroyMaterialTextures(currentFrameIndex, *material);
+            materials.Erase(materialIndex);
         }
     }
 
@@ -650,13 +830,10 @@ void TextureManager::DestroyMaterial(uint32_t currentFrameIndex, uint32_t materi
 
 uint32_t TextureManager::InsertTexture(uint32_t frameIndex, VkImage image, VkImageView view, SamplerManager::Handle samplerHandle)
 {
-    auto texture = std::find_if(textures.begin(), textures.end(), [] (const Texture &t)
-    {
-        return t.image == VK_NULL_HANDLE && t.view == VK_NULL_HANDLE;
-    });
+    const uint32_t slot = textureSlots->Allocate();
 
     // if coudn't find empty space, use empty texture
-    if (texture == textures.end())
+    if (slot == TEXTURE_NO_SLOT)
     {
         // clean created data
         Texture t = {};
@@ -670,11 +847,15 @@ uint32_t TextureManager::InsertTexture(uint32_t frameIndex, VkImage image, VkIma
         return EMPTY_TEXTURE_INDEX;
     }
 
-    texture->image = image;
-    texture->view = view;
-    texture->samplerHandle = samplerHandle;
+    Texture &texture = textures[slot];
+    assert(texture.image == VK_NULL_HANDLE && texture.view == VK_NULL_HANDLE);
 
-    return (uint32_t)std::distance(textures.begin(), texture);
+    texture.image = image;
+    texture.view = view;
+    texture.samplerHandle = samplerHandle;
+    textureVersions[slot]++;
+
+    return slot;
 }
 
 void TextureManager::DestroyTexture(const Texture &texture)
@@ -697,24 +878,57 @@ MaterialTextures TextureManager::GetMaterialTextures(uint32_t materialIndex) con
         return EmptyMaterialTextures;
     }
 
-    const auto animIt = animatedMaterials.find(materialIndex);
+    const AnimatedMaterial *anim = animatedMaterials.Find(materialIndex);
 
-    if (animIt != animatedMaterials.end())
+    if (anim != nullptr)
     {
-        const AnimatedMaterial &anim = animIt->second;
-
         // return material textures of the current frame
-        return GetMaterialTextures(anim.materialIndices[anim.currentFrame]);
+        return GetMaterialTextures(anim->materialIndices[anim->currentFrame]);
     }
 
-    const auto it = materials.find(materialIndex);
+    const Material *material = materials.Find(materialIndex);
 
-    if (it == materials.end())
+    if (material == nullptr)
     {
         return EmptyMaterialTextures;
     }
 
-    return it->second.textures;
+    return material->textures;
+}
+
+bool TextureManager::IsDynamicMaterial(uint32_t materialIndex) const
+{
+    const Material *material = materials.Find(materialIndex);
+    return material != nullptr && material->isDynamic;
+}
+
+uint32_t TextureManager::GetTextureVersion(uint32_t textureIndex) const
+{
+    return textureIndex < textureVersions.size() ? textureVersions[textureIndex] : 0;
+}
+
+MaterialTextures TextureManager::GetGeometryMaterialTextures(uint32_t materialIndex) const
+{
+    const AnimatedMaterial *anim = animatedMaterials.Find(materialIndex);
+
+    if (anim != nullptr && anim->tableSlot != ANIMATED_MATERIAL_NO_SLOT)
+    {
+        return AnimatedMaterialTable::GetIndirectTextures(anim->tableSlot);
+    }
+
+    return GetMaterialTextures(materialIndex);
+}
+
+void TextureManager::SubmitAnimatedMaterials(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    CmdLabel label(cmd, "Animated materials");
+
+    animatedMaterialTable->CopyFromStaging(cmd, frameIndex);
+}
+
+VkBuffer TextureManager::GetAnimatedMaterialTableBuffer() const
+{
+    return animatedMaterialTable->GetBuffer();
 }
 
 VkDescriptorSet TextureManager::GetDescSet(uint32_t frameIndex) const
@@ -749,3 +963,158 @@ uint32_t TextureManager::GetWaterNormalTextureIndex() const
 {
     return waterNormalTextureIndex;
 }
+
+void TextureManager::MarkMaterialUsed(uint32_t materialIndex, bool isStatic)
+{
+    if (!textureStreamer || materialIndex == RG_NO_MATERIAL)
+    {
+        return;
+    }
+
+    const AnimatedMaterial *anim = animatedMaterials.Find(materialIndex);
+
+    // all frames, as they'll be switched soon
+    if (anim != nullptr)
+    {
+        for (uint32_t frameMatIndex : anim->materialIndices)
+        {
+            MarkMaterialUsed(frameMatIndex, isStatic);
+        }
+
+        return;
+    }
+
+    const Material *material = materials.Find(materialIndex);
+
+    if (material == nullptr)
+    {
+        return;
+    }
+
+    for (uint32_t t : material->textures.indices)
+    {
+        if (t != EMPTY_TEXTURE_INDEX)
+        {
+            textureStreamer->MarkUsed(t, isStatic);
+        }
+    }
+}
+
+void TextureManager::ResetStaticMaterialUsage()
+{
+    if (textureStreamer)
+    {
+        textureStreamer->ResetStaticUsage();
+    }
+}
+
+void TextureManager::UpdateStreaming(VkCommandBuffer cmd, uint32_t frameIndex)
+{
+    if (!textureStreamer)
+    {
+        return;
+    }
+
+    textureStreamer->Plan(streamingChanges);
+
+    if (streamingChanges.empty())
+    {
+        return;
+    }
+
+    CmdLabel label(cmd, "Texture streaming");
+
+    for (const auto &change : streamingChanges)
+    {
+        const TextureStreamer::Entry *entry = textureStreamer->Find(change.textureIndex);
+        Texture &texture = textures[change.textureIndex];
+
+        if (entry == nullptr || texture.image == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+
+        ImageLoader::ResultInfo source = {};
+
+        // higher mip levels must be loaded, evicting is done only on GPU
+        if (change.newResidentLevel < entry->residentLevel)
+        {
+            bool isSame = imageLoader->Load(entry->filePath.c_str(), &source) &&
+                source.isPregenerated &&
+                source.baseSize.width == entry->baseSize.width &&
+                source.baseSize.height == entry->baseSize.height &&
+                std::min(source.levelCount, MAX_PREGENERATED_MIPMAP_LEVELS) == entry->levelCount;
+
+            for (uint32_t level = change.newResidentLevel; isSame && level < entry->residentLevel; level++)
+            {
+                isSame = source.levelSizes[level] == entry->levelSizes[level];
+            }
+
+            // file was changed or removed, keep the current mip levels
+            if (!isSame)
+            {
+                textureStreamer->Unregister(change.textureIndex);
+                continue;
+            }
+        }
+
+        TextureUploader::ReallocateInfo info = {};
+        info.cmd = cmd;
+        info.frameIndex = frameIndex;
+        info.oldImage = texture.image;
+        info.oldBaseLevel = entry->residentLevel;
+        info.newBaseLevel = change.newResidentLevel;
+        info.levelCount = entry->levelCount;
+        info.baseSize = entry->baseSize;
+        info.format = entry->format;
+        info.pData = source.pData;
+        info.pLevelDataOffsets = source.levelOffsets;
+        info.pLevelDataSizes = source.levelSizes;
+        info.pDebugName = entry->filePath.c_str();
+
+        auto result = textureUploader->ReallocateImage(info);
+
+        if (!result.wasUploaded)
+        {
+            continue;
+        }
+
+        // old image can be still in use by previous frame
+        AddToBeDestroyed(frameIndex, texture);
+
+        texture.image = result.image;
+        texture.view = result.view;
+        textureVersions[change.textureIndex]++;
+
+        textureStreamer->OnResidencyChanged(change.textureIndex, change.newResidentLevel);
+    }
+
+    imageLoader->FreeLoaded();
+}
+
+bool TextureManager::GetStreamingStats(RgTextureStreamingStats *pResult) const
+{
+    if (!textureStreamer)
+    {
+        return false;
+    }
+
+    textureStreamer->GetStats(pResult);
+    return true;
+}
+
+bool TextureManager::GetDeduplicationStats(RgTextureDeduplicationStats *pResult) const
+{
+    if (!textureDeduplicator)
+    {
+        return false;
+    }
+
+    textureDeduplicator->GetStats(pResult);
+    return true;
+}
+
+void TextureManager::GetSlotStats(RgTextureSlotStats *pResult) const
+{
+    textureSlots->GetStats(pResult);
+}
@@ -24,14 +24,23 @@
 #include <string>
 
 #include "Common.h"
+#include "AnimatedMaterialTable.h"
 #include "CommandBufferManager.h"
 #include "Material.h"
 #include "ImageLoader.h"
 #include "IMaterialDependency.h"
 #include "MemoryAllocator.h"
+#include "MipmapGenerator.h"
+#include "PhysicalDevice.h"
 #include "SamplerManager.h"
+#include "SlotMap.h"
+#include "TextureCompressor.h"
+#include "TextureDeduplicator.h"
 #include "TextureDescriptors.h"
+#include "TextureSlotAllocator.h"
+#include "TextureStreamer.h"
 #include "TextureUploader.h"
+#include "WorkerPool.h"
 
 namespace RTGL1
 {
@@ -41,10 +50,13 @@ class TextureManager
 public:
     explicit TextureManager(
         VkDevice device,
+        const std::shared_ptr<PhysicalDevice> &physDevice,
         std::shared_ptr<MemoryAllocator> memAllocator,
         std::shared_ptr<SamplerManager> samplerManager,
         const std::shared_ptr<CommandBufferManager> &cmdManager,
         std::shared_ptr<UserFileLoad> userFileLoad,
+        std::shared_ptr<const OverrideFolderIndex> overrideFolderIndex,
+        std::shared_ptr<const TexturePack> texturePack,
         const RgInstanceCreateInfo &info);
     ~TextureManager();
 
@@ -59,6 +71,9 @@ public:
                            bool forceUpdateAllDescriptors = false); // true, if mip lod bias was changed, for example
 
     uint32_t CreateStaticMaterial(VkCommandBuffer cmd, uint32_t frameIndex, const RgStaticMaterialCreateInfo &createInfo);
+    // Create several static materials, their images are prepared in one batch.
+    void CreateStaticMaterials(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t count,
+                               const RgStaticMaterialCreateInfo *pCreateInfos, uint32_t *pResults);
 
     uint32_t CreateAnimatedMaterial(VkCommandBuffer cmd, uint32_t frameIndex, const RgAnimatedMaterialCreateInfo &createInfo);
     bool ChangeAnimatedMaterialFrame(uint32_t animMaterial, uint32_t materialFrame);
@@ -69,6 +84,32 @@ public:
     void DestroyMaterial(uint32_t currentFrameIndex, uint32_t materialIndex);
 
     MaterialTextures GetMaterialTextures(uint32_t materialIndex) const;
+    // Dynamic material's texture content can be changed without changing its indices
+    bool IsDynamicMaterial(uint32_t materialIndex) const;
+    // Incremented each time when an image in the texture slot is created, destroyed
+    // or its resident mip levels are changed, i.e. when the slot's contents differ.
+    uint32_t GetTextureVersion(uint32_t textureIndex) const;
+    // Texture indices to store in geometry instances. For animated materials,
+    // these are references to the animated material table, so frame changes
+    // don't require rewriting geometry instances.
+    MaterialTextures GetGeometryMaterialTextures(uint32_t materialIndex) const;
+
+    // Copy animated material frame changes to GPU.
+    void SubmitAnimatedMaterials(VkCommandBuffer cmd, uint32_t frameIndex);
+    VkBuffer GetAnimatedMaterialTableBuffer() const;
+
+    // If texture streaming is enabled, request the full resolution of the material's textures.
+    // Static materials are requested until the static scene is reset.
+    void MarkMaterialUsed(uint32_t materialIndex, bool isStatic);
+    void ResetStaticMaterialUsage();
+    // Upload or evict mip levels of the streamed textures.
+    // Must be called before SubmitDescriptors.
+    void UpdateStreaming(VkCommandBuffer cmd, uint32_t frameIndex);
+    // Returns false, if texture streaming is disabled.
+    bool GetStreamingStats(RgTextureStreamingStats *pResult) const;
+    // Returns false, if texture deduplication is disabled.
+    bool GetDeduplicationStats(RgTextureDeduplicationStats *pResult) const;
+    void GetSlotStats(RgTextureSlotStats *pResult) const;
 
     static constexpr uint32_t GetEmptyTextureIndex();
     uint32_t GetWaterNormalTextureIndex() const;
@@ -87,7 +128,8 @@ private:
 
     uint32_t PrepareStaticTexture(
         VkCommandBuffer cmd, uint32_t frameIndex, const ImageLoader::ResultInfo &info,
-        SamplerManager::Handle samplerHandle, bool useMipmaps, const char *debugName);
+        SamplerManager::Handle samplerHandle, bool useMipmaps, const char *debugName,
+        const char *streamedFilePath);
 
     uint32_t PrepareDynamicTexture(
         VkCommandBuffer cmd, uint32_t frameIndex, const void *data, uint32_t dataSize, const RgExtent2D &size,
@@ -97,9 +139,6 @@ private:
     void DestroyTexture(const Texture &texture);
     void AddToBeDestroyed(uint32_t frameIndex, const Texture &texture);
 
-    uint32_t GenerateMaterialIndex(const MaterialTextures &materialTextures);
-    uint32_t GenerateMaterialIndex(const std::vector<uint32_t> &materialIndices);
-
     uint32_t InsertMaterial(const MaterialTextures &materialTextures, bool isDynamic);
     uint32_t InsertAnimatedMaterial(std::vector<uint32_t> &materialIndices);
 
@@ -114,14 +153,32 @@ private:
     std::shared_ptr<SamplerManager> samplerMgr;
     std::shared_ptr<TextureDescriptors> textureDesc;
     std::shared_ptr<TextureUploader> textureUploader;
+    std::shared_ptr<AnimatedMaterialTable> animatedMaterialTable;
+    // null, if texture streaming is disabled
+    std::shared_ptr<TextureStreamer> textureStreamer;
+    std::vector<TextureStreamer::ResidencyChange> streamingChanges;
+    // null, if texture deduplication is disabled
+    std::shared_ptr<TextureDeduplicator> textureDeduplicator;
+    std::shared_ptr<WorkerPool> workerPool;
+    std::shared_ptr<MipmapGenerator> mipmapGenerator;
+    // storage for the levels generated on CPU, until they're copied to staging
+    std::vector<uint8_t> generatedMipmaps;
+    // null, if texture compression is disabled
+    std::shared_ptr<TextureCompressor> textureCompressor;
 
     std::vector<Texture> textures;
+    std::vector<uint32_t> textureVersions;
+    std::shared_ptr<TextureSlotAllocator> textureSlots;
+    // if true, descriptors only of the used slots are written
+    bool isTextureDescPartiallyBound;
     // Textures are not destroyed immediately, but when
     // they won't be in use
     std::vector<Texture> texturesToDestroy[MAX_FRAMES_IN_FLIGHT];
 
-    rgl::unordered_map<uint32_t, AnimatedMaterial> animatedMaterials;
-    rgl::unordered_map<uint32_t, Material> materials;
+    // static and dynamic materials
+    SlotMap<Material> materials;
+    // handles are tagged, so they don't intersect with the ones of 'materials'
+    SlotMap<AnimatedMaterial> animatedMaterials;
 
     uint32_t waterNormalTextureIndex;
 
@@ -21,6 +21,7 @@
 #include "TextureOverrides.h"
 #include "Const.h"
 #include <stdio.h>
+#include <string.h>
 
 using namespace RTGL1;
 
@@ -88,6 +89,7 @@ TextureOverrides::TextureOverrides(
 :
     results{},
     debugName{},
+    filePaths{},
     imageLoader(_imageLoader)
 {
     const RgTextureData *defaultData[TEXTURES_PER_MATERIAL_COUNT] =
@@ -111,7 +113,10 @@ TextureOverrides::TextureOverrides(
         {
             for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL_COUNT; i++)
             {
-                _imageLoader->Load(paths[i], &results[i]);
+                if (_imageLoader->Load(paths[i], &results[i]))
+                {
+                    strncpy(filePaths[i], paths[i], TEXTURE_FILE_PATH_MAX_LENGTH - 1);
+                }
 
                 // fix format, if needed
                 results[i].format = _overrideInfo.overridenIsSRGB[i] ?
@@ -240,6 +245,12 @@ const char *RTGL1::TextureOverrides::GetDebugName() const
     return debugName;
 }
 
+const char *RTGL1::TextureOverrides::GetFilePath(uint32_t index) const
+{
+    assert(index < TEXTURES_PER_MATERIAL_COUNT);
+    return filePaths[index][0] != '\0' ? filePaths[index] : nullptr;
+}
+
 bool TextureOverrides::ParseOverrideTexturePaths(
     char paths[TEXTURES_PER_MATERIAL_COUNT][TEXTURE_FILE_PATH_MAX_LENGTH],
     const char *relativePath,
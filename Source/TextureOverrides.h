@@ -68,6 +68,8 @@ public:
 
     const ImageLoader::ResultInfo &GetResult(uint32_t index) const;
     const char *GetDebugName() const;
+    // Null, if the texture wasn't loaded from a file.
+    const char *GetFilePath(uint32_t index) const;
 
 private:
     bool ParseOverrideTexturePaths(
@@ -78,6 +80,7 @@ private:
 private:
     ImageLoader::ResultInfo results[TEXTURES_PER_MATERIAL_COUNT];
     char debugName[TEXTURE_DEBUG_NAME_MAX_LENGTH];
+    char filePaths[TEXTURES_PER_MATERIAL_COUNT][TEXTURE_FILE_PATH_MAX_LENGTH];
 
     std::weak_ptr<ImageLoader> imageLoader;
 };
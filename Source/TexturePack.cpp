@@ -0,0 +1,321 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TexturePack.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "OverrideFolderIndex.h"
+#include "RgException.h"
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace RTGL1;
+
+namespace
+{
+
+char ToLowerASCII(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+}
+
+TexturePack::TexturePack(const char *packPath, const char *_folderPath)
+    :
+    folderPath(OverrideFolderIndex::Normalize(_folderPath != nullptr ? _folderPath : "")),
+    pMapped(nullptr),
+    mappedSize(0),
+    pEntries(nullptr),
+    entryCount(0),
+#ifdef _WIN32
+    fileHandle(INVALID_HANDLE_VALUE),
+    mappingHandle(nullptr)
+#else
+    fileDescriptor(-1)
+#endif
+{
+    if (packPath == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Texture pack path must not be null");
+    }
+
+    if (!folderPath.empty() && folderPath.back() != '/')
+    {
+        folderPath += '/';
+    }
+
+    Map(packPath);
+
+    if (mappedSize < sizeof(Header))
+    {
+        Unmap();
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Texture pack is too small: ") + packPath);
+    }
+
+    Header header;
+    memcpy(&header, pMapped, sizeof(Header));
+
+    if (header.magic != TEXTURE_PACK_MAGIC || header.version != TEXTURE_PACK_VERSION)
+    {
+        Unmap();
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Texture pack has wrong magic number or version: ") + packPath);
+    }
+
+    if (header.entriesOffset % alignof(Entry) != 0 ||
+        header.entriesOffset > mappedSize ||
+        (mappedSize - header.entriesOffset) / sizeof(Entry) < header.entryCount)
+    {
+        Unmap();
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Texture pack has corrupted entry table: ") + packPath);
+    }
+
+    pEntries = reinterpret_cast<const Entry *>(pMapped + header.entriesOffset);
+    entryCount = header.entryCount;
+}
+
+TexturePack::~TexturePack()
+{
+    Unmap();
+}
+
+const uint8_t *TexturePack::Find(const char *filePath, uint64_t *pOutSize) const
+{
+    assert(pOutSize != nullptr);
+    *pOutSize = 0;
+
+    if (filePath == nullptr || entryCount == 0)
+    {
+        return nullptr;
+    }
+
+    std::string p = OverrideFolderIndex::Normalize(filePath);
+
+    // pack contains only the files of the overriden textures folder
+    if (p.compare(0, folderPath.length(), folderPath) != 0)
+    {
+        return nullptr;
+    }
+
+    const char *pPathStart = p.c_str() + folderPath.length();
+    const char *pPathEnd = p.c_str() + p.length();
+
+    const uint64_t hash = HashPath(pPathStart, pPathEnd);
+
+    const Entry *pEnd = pEntries + entryCount;
+    const Entry *it = std::lower_bound(pEntries, pEnd, hash, [] (const Entry &e, uint64_t h)
+    {
+        return e.pathHash < h;
+    });
+
+    // different paths may have the same hash
+    for (; it != pEnd && it->pathHash == hash; ++it)
+    {
+        if (!IsSamePath(*it, pPathStart, pPathEnd))
+        {
+            continue;
+        }
+
+        if (it->offset > mappedSize || it->size > mappedSize - it->offset)
+        {
+            assert(0 && "Texture pack entry is out of bounds");
+            return nullptr;
+        }
+
+        *pOutSize = it->size;
+        return pMapped + it->offset;
+    }
+
+    return nullptr;
+}
+
+bool TexturePack::IsSamePath(const Entry &entry, const char *pStart, const char *pEnd) const
+{
+    if (entry.pathOffset > mappedSize || entry.pathLength > mappedSize - entry.pathOffset)
+    {
+        assert(0 && "Texture pack entry path is out of bounds");
+        return false;
+    }
+
+    if (entry.pathLength != static_cast<uint64_t>(pEnd - pStart))
+    {
+        return false;
+    }
+
+    const char *pStored = reinterpret_cast<const char *>(pMapped + entry.pathOffset);
+
+    for (uint32_t i = 0; i < entry.pathLength; i++)
+    {
+        if (ToLowerASCII(pStart[i]) != pStored[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t TexturePack::GetEntryCount() const
+{
+    return entryCount;
+}
+
+uint64_t TexturePack::HashPath(const char *pStart, const char *pEnd)
+{
+    // 64-bit FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+
+    for (const char *p = pStart; p < pEnd; p++)
+    {
+        // keys are case-insensitive, so the same pack can be used on any platform;
+        // only ASCII is folded, to match Tools/CreateTexturePack.py regardless of the locale
+        h ^= static_cast<uint8_t>(ToLowerASCII(*p));
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+void TexturePack::Map(const char *packPath)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(packPath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Couldn't open texture pack: ") + packPath);
+    }
+
+    LARGE_INTEGER size = {};
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Couldn't get size of texture pack: ") + packPath);
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Couldn't map texture pack: ") + packPath);
+    }
+
+    void *pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (pView == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Couldn't map texture pack: ") + packPath);
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    pMapped = static_cast<const uint8_t *>(pView);
+    mappedSize = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = open(packPath, O_RDONLY);
+
+    if (fd < 0)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Couldn't open texture pack: ") + packPath);
+    }
+
+    struct stat st = {};
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Couldn't get size of texture pack: ") + packPath);
+    }
+
+    void *pView = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (pView == MAP_FAILED)
+    {
+        close(fd);
+        throw RgException(RG_WRONG_ARGUMENT, std::string("Couldn't map texture pack: ") + packPath);
+    }
+
+    // textures are requested in arbitrary order
+    madvise(pView, static_cast<size_t>(st.st_size), MADV_RANDOM);
+
+    fileDescriptor = fd;
+    pMapped = static_cast<const uint8_t *>(pView);
+    mappedSize = static_cast<uint64_t>(st.st_size);
+#endif
+}
+
+void TexturePack::Unmap()
+{
+#ifdef _WIN32
+    if (pMapped != nullptr)
+    {
+        UnmapViewOfFile(pMapped);
+    }
+
+    if (mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (pMapped != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(pMapped), static_cast<size_t>(mappedSize));
+    }
+
+    if (fileDescriptor >= 0)
+    {
+        close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+
+    pMapped = nullptr;
+    mappedSize = 0;
+    pEntries = nullptr;
+    entryCount = 0;
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+
+#include "Common.h"
+
+namespace RTGL1
+{
+
+// Single file that contains KTX2 files of the overriding textures.
+// The file is memory-mapped, so image data is read directly from the page cache
+// into the staging buffers without intermediate copies on the heap.
+// Created by Tools/CreateTexturePack.py.
+//
+// Layout (little-endian):
+//  Header
+//  Entry[entryCount]   -- sorted by pathHash
+//  paths               -- not null-terminated, referenced by entries
+//  payloads            -- each KTX2 file starts at TEXTURE_PACK_ALIGNMENT
+class TexturePack
+{
+public:
+    static constexpr uint32_t TEXTURE_PACK_MAGIC = 0x4B505452;    // "RTPK"
+    static constexpr uint32_t TEXTURE_PACK_VERSION = 2;
+    static constexpr uint64_t TEXTURE_PACK_ALIGNMENT = 4096;
+
+    struct Header
+    {
+        uint32_t    magic;
+        uint32_t    version;
+        uint32_t    entryCount;
+        uint32_t    reserved;
+        uint64_t    entriesOffset;
+        uint64_t    reserved2;
+    };
+
+    struct Entry
+    {
+        // FNV-1a of the path relative to the overriden textures folder,
+        // with forward slashes and lowercase ASCII letters
+        uint64_t    pathHash;
+        uint64_t    offset;
+        uint64_t    size;
+        // the hashed path itself, to resolve hash collisions
+        uint64_t    pathOffset;
+        uint32_t    pathLength;
+        uint32_t    reserved;
+    };
+
+public:
+    // folderPath is a folder which is replaced by the pack,
+    // i.e. file paths are looked up relative to it
+    TexturePack(const char *packPath, const char *folderPath);
+    ~TexturePack();
+
+    TexturePack(const TexturePack &other) = delete;
+    TexturePack(TexturePack &&other) noexcept = delete;
+    TexturePack &operator=(const TexturePack &other) = delete;
+    TexturePack &operator=(TexturePack &&other) noexcept = delete;
+
+    // Returns pointer to the mapped KTX2 file, or null if
+    // the file is not in the pack. The pointer is valid while the pack exists.
+    const uint8_t *Find(const char *filePath, uint64_t *pOutSize) const;
+
+    uint32_t GetEntryCount() const;
+
+    static uint64_t HashPath(const char *pStart, const char *pEnd);
+
+private:
+    bool IsSamePath(const Entry &entry, const char *pStart, const char *pEnd) const;
+    void Map(const char *packPath);
+    void Unmap();
+
+private:
+    std::string folderPath;
+
+    const uint8_t *pMapped;
+    uint64_t mappedSize;
+
+    const Entry *pEntries;
+    uint32_t entryCount;
+
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+}
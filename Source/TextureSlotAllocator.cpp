@@ -0,0 +1,105 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TextureSlotAllocator.h"
+
+#include <algorithm>
+
+using namespace RTGL1;
+
+TextureSlotAllocator::TextureSlotAllocator(uint32_t _slotCount)
+    : slotCount(_slotCount), usedRangeEnd(0), usedCount(0), peakUsedCount(0), failedAllocationCount(0)
+{
+    freeSlots.reserve(slotCount);
+}
+
+uint32_t TextureSlotAllocator::Allocate()
+{
+    uint32_t slot;
+
+    // reuse freed slots first, to keep the used range compact
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else if (usedRangeEnd < slotCount)
+    {
+        slot = usedRangeEnd++;
+    }
+    else
+    {
+        failedAllocationCount++;
+        return TEXTURE_NO_SLOT;
+    }
+
+    usedCount++;
+    peakUsedCount = std::max(peakUsedCount, usedCount);
+
+    return slot;
+}
+
+void TextureSlotAllocator::Free(uint32_t frameIndex, uint32_t slot)
+{
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+    assert(slot < usedRangeEnd);
+    assert(usedCount > 0);
+
+    pendingSlots[frameIndex].push_back(slot);
+    usedCount--;
+}
+
+void TextureSlotAllocator::PrepareForFrame(uint32_t frameIndex)
+{
+    assert(frameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    auto &pending = pendingSlots[frameIndex];
+
+    freeSlots.insert(freeSlots.end(), pending.begin(), pending.end());
+    pending.clear();
+}
+
+uint32_t TextureSlotAllocator::GetUsedRangeEnd() const
+{
+    return usedRangeEnd;
+}
+
+uint32_t TextureSlotAllocator::GetSlotCount() const
+{
+    return slotCount;
+}
+
+void TextureSlotAllocator::GetStats(RgTextureSlotStats *pResult) const
+{
+    uint32_t pendingCount = 0;
+
+    for (const auto &pending : pendingSlots)
+    {
+        pendingCount += (uint32_t)pending.size();
+    }
+
+    *pResult = {};
+    pResult->slotCount = slotCount;
+    pResult->usedSlotCount = usedCount;
+    pResult->pendingSlotCount = pendingCount;
+    pResult->peakUsedSlotCount = peakUsedCount;
+    pResult->usedRangeEnd = usedRangeEnd;
+    pResult->failedAllocationCount = failedAllocationCount;
+}
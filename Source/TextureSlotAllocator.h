@@ -0,0 +1,72 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "Common.h"
+#include "Const.h"
+#include "RTGL1/RTGL1.h"
+
+namespace RTGL1
+{
+
+// Allocates indices in the bindless texture array.
+// Freed slots are reused only after MAX_FRAMES_IN_FLIGHT frames,
+// so frames in flight don't see another texture through an old index.
+class TextureSlotAllocator
+{
+public:
+    explicit TextureSlotAllocator(uint32_t slotCount);
+    ~TextureSlotAllocator() = default;
+
+    TextureSlotAllocator(const TextureSlotAllocator &other) = delete;
+    TextureSlotAllocator(TextureSlotAllocator &&other) noexcept = delete;
+    TextureSlotAllocator &operator=(const TextureSlotAllocator &other) = delete;
+    TextureSlotAllocator &operator=(TextureSlotAllocator &&other) noexcept = delete;
+
+    // Returns TEXTURE_NO_SLOT, if all slots are in use.
+    uint32_t Allocate();
+    // Slot will be available after the frame with the same index is finished.
+    void Free(uint32_t frameIndex, uint32_t slot);
+    // Make slots that were freed on this frame index available.
+    void PrepareForFrame(uint32_t frameIndex);
+
+    // Slots in [0, GetUsedRangeEnd()) were allocated at least once,
+    // others were never used and their descriptors don't need to be written.
+    uint32_t GetUsedRangeEnd() const;
+    uint32_t GetSlotCount() const;
+
+    void GetStats(RgTextureSlotStats *pResult) const;
+
+private:
+    uint32_t slotCount;
+    uint32_t usedRangeEnd;
+
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> pendingSlots[MAX_FRAMES_IN_FLIGHT];
+
+    uint32_t usedCount;
+    uint32_t peakUsedCount;
+    uint32_t failedAllocationCount;
+};
+
+}
@@ -0,0 +1,317 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace RTGL1;
+
+namespace
+{
+
+// if a texture wasn't used during this amount of frames,
+// its top mips are not requested and can be evicted
+constexpr uint32_t TEXTURE_STREAMING_UNUSED_FRAME_COUNT = 120;
+
+}
+
+TextureStreamer::TextureStreamer(uint64_t _budgetInBytes, uint32_t _mipTailSize, uint64_t _maxUploadBytesPerFrame)
+    :
+    budget(_budgetInBytes),
+    mipTailSize(std::max(_mipTailSize, 1u)),
+    maxUploadBytesPerFrame(_maxUploadBytesPerFrame),
+    currentFrame(1),
+    residentBytes(0),
+    lastFrameStreamedInBytes(0),
+    lastFrameEvictedBytes(0)
+{}
+
+uint32_t TextureStreamer::GetInitialResidentLevel(const ImageLoader::ResultInfo &info) const
+{
+    // nothing to stream, if the mip levels are generated on GPU
+    if (!info.isPregenerated || info.levelCount <= 1)
+    {
+        return 0;
+    }
+
+    for (uint32_t level = 0; level < info.levelCount; level++)
+    {
+        uint32_t w = info.baseSize.width >> level;
+        uint32_t h = info.baseSize.height >> level;
+
+        if (std::max(w, h) <= mipTailSize)
+        {
+            return level;
+        }
+    }
+
+    return info.levelCount - 1;
+}
+
+void TextureStreamer::Register(uint32_t textureIndex, const char *filePath, const ImageLoader::ResultInfo &info, uint32_t residentLevel)
+{
+    assert(filePath != nullptr && filePath[0] != '\0');
+    assert(info.isPregenerated && residentLevel < info.levelCount);
+    assert(entries.find(textureIndex) == entries.end());
+
+    Entry e = {};
+    e.filePath = filePath;
+    e.baseSize = info.baseSize;
+    e.format = info.format;
+    e.levelCount = std::min(info.levelCount, MAX_PREGENERATED_MIPMAP_LEVELS);
+    e.tailLevel = GetInitialResidentLevel(info);
+    e.residentLevel = residentLevel;
+    e.lastUsedFrame = 0;
+    e.usedByStaticScene = false;
+
+    for (uint32_t level = 0; level < e.levelCount; level++)
+    {
+        e.levelSizes[level] = info.levelSizes[level];
+    }
+
+    residentBytes += GetResidentBytes(e, e.residentLevel);
+
+    entries[textureIndex] = std::move(e);
+}
+
+void TextureStreamer::Unregister(uint32_t textureIndex)
+{
+    auto it = entries.find(textureIndex);
+
+    if (it == entries.end())
+    {
+        return;
+    }
+
+    residentBytes -= GetResidentBytes(it->second, it->second.residentLevel);
+
+    entries.erase(it);
+}
+
+const TextureStreamer::Entry *TextureStreamer::Find(uint32_t textureIndex) const
+{
+    auto it = entries.find(textureIndex);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+void TextureStreamer::MarkUsed(uint32_t textureIndex, bool isStatic)
+{
+    auto it = entries.find(textureIndex);
+
+    if (it == entries.end())
+    {
+        return;
+    }
+
+    it->second.lastUsedFrame = currentFrame;
+    it->second.usedByStaticScene |= isStatic;
+}
+
+void TextureStreamer::ResetStaticUsage()
+{
+    for (auto &p : entries)
+    {
+        if (p.second.usedByStaticScene)
+        {
+            // don't evict immediately, as the new static scene may use it too
+            p.second.lastUsedFrame = currentFrame;
+            p.second.usedByStaticScene = false;
+        }
+    }
+}
+
+bool TextureStreamer::IsRecentlyUsed(const Entry &e) const
+{
+    return e.usedByStaticScene ||
+        (e.lastUsedFrame > 0 && e.lastUsedFrame + TEXTURE_STREAMING_UNUSED_FRAME_COUNT >= currentFrame);
+}
+
+uint64_t TextureStreamer::GetResidentBytes(const Entry &e, uint32_t residentLevel) const
+{
+    uint64_t sum = 0;
+
+    for (uint32_t level = residentLevel; level < e.levelCount; level++)
+    {
+        sum += e.levelSizes[level];
+    }
+
+    return sum;
+}
+
+void TextureStreamer::Plan(std::vector<ResidencyChange> &outChanges)
+{
+    outChanges.clear();
+
+    currentFrame++;
+    lastFrameStreamedInBytes = 0;
+    lastFrameEvictedBytes = 0;
+
+    std::vector<std::pair<uint32_t, const Entry *>> requested;
+    std::vector<std::pair<uint32_t, const Entry *>> evictable;
+
+    for (const auto &p : entries)
+    {
+        const Entry &e = p.second;
+
+        if (IsRecentlyUsed(e))
+        {
+            if (e.residentLevel > 0)
+            {
+                requested.emplace_back(p.first, &e);
+            }
+        }
+        else if (e.residentLevel < e.tailLevel)
+        {
+            evictable.emplace_back(p.first, &e);
+        }
+    }
+
+    if (requested.empty())
+    {
+        return;
+    }
+
+    // the lowest resolution first, so all visible textures get sharper evenly
+    std::sort(requested.begin(), requested.end(), [] (const std::pair<uint32_t, const Entry *> &a, const std::pair<uint32_t, const Entry *> &b)
+    {
+        if (a.second->residentLevel != b.second->residentLevel)
+        {
+            return a.second->residentLevel > b.second->residentLevel;
+        }
+
+        return a.second->lastUsedFrame > b.second->lastUsedFrame;
+    });
+
+    // least recently used first
+    std::sort(evictable.begin(), evictable.end(), [] (const std::pair<uint32_t, const Entry *> &a, const std::pair<uint32_t, const Entry *> &b)
+    {
+        return a.second->lastUsedFrame < b.second->lastUsedFrame;
+    });
+
+    uint64_t projectedBytes = residentBytes;
+    uint64_t uploadBytes = 0;
+    size_t nextVictim = 0;
+    bool budgetExhausted = false;
+
+    for (const auto &r : requested)
+    {
+        const Entry &e = *r.second;
+        uint32_t newLevel = e.residentLevel;
+
+        while (newLevel > 0)
+        {
+            const uint64_t levelBytes = e.levelSizes[newLevel - 1];
+
+            // allow at least one level per frame, even if it's too large
+            if (uploadBytes > 0 && uploadBytes + levelBytes > maxUploadBytesPerFrame)
+            {
+                break;
+            }
+
+            // evict whole top mip chains of the least recently used textures
+            while (projectedBytes + levelBytes > budget && nextVictim < evictable.size())
+            {
+                const auto &v = evictable[nextVictim];
+                nextVictim++;
+
+                projectedBytes -= GetResidentBytes(*v.second, v.second->residentLevel) - GetResidentBytes(*v.second, v.second->tailLevel);
+                outChanges.push_back({ v.first, v.second->tailLevel });
+            }
+
+            if (projectedBytes + levelBytes > budget)
+            {
+                budgetExhausted = true;
+                break;
+            }
+
+            projectedBytes += levelBytes;
+            uploadBytes += levelBytes;
+            newLevel--;
+        }
+
+        if (newLevel != e.residentLevel)
+        {
+            outChanges.push_back({ r.first, newLevel });
+        }
+
+        if (budgetExhausted || uploadBytes >= maxUploadBytesPerFrame)
+        {
+            break;
+        }
+    }
+}
+
+void TextureStreamer::OnResidencyChanged(uint32_t textureIndex, uint32_t newResidentLevel)
+{
+    auto it = entries.find(textureIndex);
+
+    if (it == entries.end())
+    {
+        return;
+    }
+
+    Entry &e = it->second;
+    assert(newResidentLevel < e.levelCount);
+
+    const uint64_t oldBytes = GetResidentBytes(e, e.residentLevel);
+    const uint64_t newBytes = GetResidentBytes(e, newResidentLevel);
+
+    if (newBytes > oldBytes)
+    {
+        lastFrameStreamedInBytes += newBytes - oldBytes;
+    }
+    else
+    {
+        lastFrameEvictedBytes += oldBytes - newBytes;
+    }
+
+    residentBytes = residentBytes - oldBytes + newBytes;
+    e.residentLevel = newResidentLevel;
+}
+
+void TextureStreamer::GetStats(RgTextureStreamingStats *pResult) const
+{
+    assert(pResult != nullptr);
+    *pResult = {};
+
+    pResult->streamedTextureCount = static_cast<uint32_t>(entries.size());
+    pResult->residentBytes = residentBytes;
+    pResult->budgetBytes = budget;
+    pResult->lastFrameStreamedInBytes = lastFrameStreamedInBytes;
+    pResult->lastFrameEvictedBytes = lastFrameEvictedBytes;
+
+    for (const auto &p : entries)
+    {
+        const Entry &e = p.second;
+
+        pResult->fullResidencyBytes += GetResidentBytes(e, 0);
+
+        if (e.residentLevel == 0)
+        {
+            pResult->fullyResidentTextureCount++;
+        }
+        else if (IsRecentlyUsed(e))
+        {
+            pResult->pendingTextureCount++;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "Containers.h"
+#include "ImageLoader.h"
+
+namespace RTGL1
+{
+
+// Bookkeeping for the textures that are loaded progressively:
+// at first, only the mip tail is resident, higher mips are uploaded
+// over next frames for the recently used textures. If the budget is exceeded,
+// the top mips of the least recently used textures are evicted.
+// Residency changes themselves are performed by TextureManager.
+class TextureStreamer
+{
+public:
+    struct Entry
+    {
+        std::string     filePath;
+        RgExtent2D      baseSize;
+        VkFormat        format;
+        uint32_t        levelCount;
+        uint32_t        levelSizes[MAX_PREGENERATED_MIPMAP_LEVELS];
+        // the largest mip level that can be evicted
+        uint32_t        tailLevel;
+        // the largest mip level that is in the memory
+        uint32_t        residentLevel;
+        uint32_t        lastUsedFrame;
+        bool            usedByStaticScene;
+    };
+
+    struct ResidencyChange
+    {
+        uint32_t        textureIndex;
+        uint32_t        newResidentLevel;
+    };
+
+public:
+    TextureStreamer(uint64_t budgetInBytes, uint32_t mipTailSize, uint64_t maxUploadBytesPerFrame);
+    ~TextureStreamer() = default;
+
+    TextureStreamer(const TextureStreamer &other) = delete;
+    TextureStreamer(TextureStreamer &&other) noexcept = delete;
+    TextureStreamer &operator=(const TextureStreamer &other) = delete;
+    TextureStreamer &operator=(TextureStreamer &&other) noexcept = delete;
+
+    // Returns the mip level that should be uploaded on the texture creation.
+    uint32_t GetInitialResidentLevel(const ImageLoader::ResultInfo &info) const;
+
+    void Register(uint32_t textureIndex, const char *filePath, const ImageLoader::ResultInfo &info, uint32_t residentLevel);
+    void Unregister(uint32_t textureIndex);
+    const Entry *Find(uint32_t textureIndex) const;
+
+    void MarkUsed(uint32_t textureIndex, bool isStatic);
+    // Static scene was reset, so its textures are not in use anymore.
+    void ResetStaticUsage();
+
+    // Increments the frame counter and fills the list of residency changes for this frame.
+    // TextureManager must call OnResidencyChanged for each successful one.
+    void Plan(std::vector<ResidencyChange> &outChanges);
+    void OnResidencyChanged(uint32_t textureIndex, uint32_t newResidentLevel);
+
+    void GetStats(RgTextureStreamingStats *pResult) const;
+
+private:
+    bool IsRecentlyUsed(const Entry &e) const;
+    uint64_t GetResidentBytes(const Entry &e, uint32_t residentLevel) const;
+
+private:
+    uint64_t budget;
+    uint32_t mipTailSize;
+    uint64_t maxUploadBytesPerFrame;
+
+    uint32_t currentFrame;
+    uint64_t residentBytes;
+    uint64_t lastFrameStreamedInBytes;
+    uint64_t lastFrameEvictedBytes;
+
+    rgl::unordered_map<uint32_t, Entry> entries;
+};
+
+}
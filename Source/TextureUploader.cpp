@@ -29,11 +29,13 @@
 using namespace RTGL1;
 
 TextureUploader::TextureUploader(VkDevice _device, std::shared_ptr<MemoryAllocator> _memAllocator)
-    : device(_device), memAllocator(std::move(_memAllocator))
+    : device(_device), memAllocator(std::move(_memAllocator)), isBatching(false)
 {}
 
 TextureUploader::~TextureUploader()
 {
+    assert(!isBatching && batchedImages.empty());
+
     for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
         for (VkBuffer staging : stagingToFree[i])
@@ -60,7 +62,7 @@ void TextureUploader::ClearStaging(uint32_t frameIndex)
 
 }
 
-bool TextureUploader::DoesFormatSupportBlit(VkFormat format) const
+bool TextureUploader::DoesFormatSupportBlit(VkFormat format)
 {
     // very simple test
     return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_R8G8B8A8_UNORM;
@@ -457,7 +459,14 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
         memcpy(mappedData, data, dataSize);
 
         // and copy it to image
-        PrepareImage(image, &stagingBuffer, info, ImagePrepareType::INIT);
+        if (isBatching && !info.isDynamic)
+        {
+            AddToBatch(image, stagingBuffer, info);
+        }
+        else
+        {
+            PrepareImage(image, &stagingBuffer, info, ImagePrepareType::INIT);
+        }
     }
 
     // create image view
@@ -475,6 +484,7 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
         updateInfo.mappedData = mappedData;
         updateInfo.dataSize = (uint32_t)dataSize;
         updateInfo.imageSize = size;
+        updateInfo.format = info.format;
         updateInfo.generateMipmaps = info.useMipmaps;
 
         dynamicImageInfos[image] = updateInfo;
@@ -493,7 +503,183 @@ TextureUploader::UploadResult TextureUploader::UploadImage(const UploadInfo &inf
     return result;
 }
 
-void TextureUploader::UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicImage, const void *data)
+TextureUploader::UploadResult TextureUploader::ReallocateImage(const ReallocateInfo &info)
+{
+    assert(info.oldImage != VK_NULL_HANDLE);
+    assert(info.levelCount <= MAX_PREGENERATED_MIPMAP_LEVELS);
+    assert(info.oldBaseLevel < info.levelCount && info.newBaseLevel < info.levelCount);
+    assert(info.oldBaseLevel != info.newBaseLevel);
+
+    UploadResult result = {};
+    result.wasUploaded = false;
+
+    VkCommandBuffer cmd = info.cmd;
+
+    const auto getLevelSize = [&info] (uint32_t level) -> VkExtent3D
+    {
+        return { std::max(info.baseSize.width >> level, 1u), std::max(info.baseSize.height >> level, 1u), 1 };
+    };
+
+    const VkExtent3D newSize = getLevelSize(info.newBaseLevel);
+    const uint32_t newLevelCount = info.levelCount - info.newBaseLevel;
+    const uint32_t oldLevelCount = info.levelCount - info.oldBaseLevel;
+
+
+    // 1. Copy the levels that are not in the old image to staging
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    uint32_t uploadRegionCount = 0;
+    VkBufferImageCopy uploadRegions[MAX_PREGENERATED_MIPMAP_LEVELS];
+
+    if (info.newBaseLevel < info.oldBaseLevel)
+    {
+        assert(info.pData != nullptr);
+
+        VkDeviceSize stagingSize = 0;
+
+        for (uint32_t level = info.newBaseLevel; level < info.oldBaseLevel; level++)
+        {
+            stagingSize += info.pLevelDataSizes[level];
+        }
+
+        VkBufferCreateInfo stagingInfo = {};
+        stagingInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        stagingInfo.size = stagingSize;
+        stagingInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        void *mappedData;
+        stagingBuffer = memAllocator->CreateStagingSrcTextureBuffer(&stagingInfo, info.pDebugName, &mappedData);
+
+        if (stagingBuffer == VK_NULL_HANDLE)
+        {
+            return result;
+        }
+
+        SET_DEBUG_NAME(device, stagingBuffer, VK_OBJECT_TYPE_BUFFER, info.pDebugName);
+
+        VkDeviceSize offset = 0;
+
+        for (uint32_t level = info.newBaseLevel; level < info.oldBaseLevel; level++)
+        {
+            const uint32_t size = info.pLevelDataSizes[level];
+
+            memcpy(static_cast<uint8_t *>(mappedData) + offset,
+                   static_cast<const uint8_t *>(info.pData) + info.pLevelDataOffsets[level],
+                   size);
+
+            VkBufferImageCopy &cr = uploadRegions[uploadRegionCount++];
+            cr = {};
+            cr.bufferOffset = offset;
+            cr.imageExtent = getLevelSize(level);
+            cr.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            cr.imageSubresource.mipLevel = level - info.newBaseLevel;
+            cr.imageSubresource.baseArrayLayer = 0;
+            cr.imageSubresource.layerCount = 1;
+
+            offset += size;
+        }
+    }
+
+
+    // 2. Create new image
+
+    UploadInfo createInfo = {};
+    createInfo.baseSize = { newSize.width, newSize.height };
+    createInfo.format = info.format;
+    createInfo.useMipmaps = true;
+    createInfo.pregeneratedLevelCount = newLevelCount;
+    createInfo.pDebugName = info.pDebugName;
+    createInfo.isCubemap = false;
+
+    VkImage image;
+
+    if (!CreateImage(createInfo, &image))
+    {
+        if (stagingBuffer != VK_NULL_HANDLE)
+        {
+            memAllocator->DestroyStagingSrcTextureBuffer(stagingBuffer);
+        }
+
+        return result;
+    }
+
+
+    // 3. Copy levels from the old image and from staging
+
+    VkImageSubresourceRange newAllMipmaps = {};
+    newAllMipmaps.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    newAllMipmaps.baseMipLevel = 0;
+    newAllMipmaps.levelCount = newLevelCount;
+    newAllMipmaps.baseArrayLayer = 0;
+    newAllMipmaps.layerCount = 1;
+
+    VkImageSubresourceRange oldAllMipmaps = newAllMipmaps;
+    oldAllMipmaps.levelCount = oldLevelCount;
+
+    Utils::BarrierImage(
+        cmd, image,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        newAllMipmaps);
+
+    // old image is not used after, so it's not transitioned back
+    Utils::BarrierImage(
+        cmd, info.oldImage,
+        VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        oldAllMipmaps);
+
+    uint32_t copyRegionCount = 0;
+    VkImageCopy copyRegions[MAX_PREGENERATED_MIPMAP_LEVELS];
+
+    for (uint32_t level = std::max(info.newBaseLevel, info.oldBaseLevel); level < info.levelCount; level++)
+    {
+        VkImageCopy &cr = copyRegions[copyRegionCount++];
+        cr = {};
+        cr.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        cr.srcSubresource.mipLevel = level - info.oldBaseLevel;
+        cr.srcSubresource.baseArrayLayer = 0;
+        cr.srcSubresource.layerCount = 1;
+        cr.dstSubresource = cr.srcSubresource;
+        cr.dstSubresource.mipLevel = level - info.newBaseLevel;
+        cr.extent = getLevelSize(level);
+    }
+
+    vkCmdCopyImage(
+        cmd,
+        info.oldImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        copyRegionCount, copyRegions);
+
+    if (uploadRegionCount > 0)
+    {
+        vkCmdCopyBufferToImage(
+            cmd, stagingBuffer, image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, uploadRegionCount, uploadRegions);
+
+        stagingToFree[info.frameIndex].push_back(stagingBuffer);
+    }
+
+    Utils::BarrierImage(
+        cmd, image,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        newAllMipmaps);
+
+
+    VkImageView imageView = CreateImageView(image, info.format, false, newLevelCount);
+    SET_DEBUG_NAME(device, imageView, VK_OBJECT_TYPE_IMAGE_VIEW, info.pDebugName);
+
+    result.wasUploaded = true;
+    result.image = image;
+    result.view = imageView;
+    return result;
+}
+
+void TextureUploader::UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicImage, const void *data, const RgRect2D *pDirtyRects, uint32_t dirtyRectCount)
 {
     assert(dynamicImage != VK_NULL_HANDLE);
 
@@ -504,6 +690,13 @@ void TextureUploader::UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicIma
         auto &updateInfo = it->second;
 
         assert(updateInfo.mappedData != nullptr);
+
+        if (pDirtyRects != nullptr && dirtyRectCount > 0)
+        {
+            UpdateDynamicImageRegions(cmd, dynamicImage, updateInfo, data, pDirtyRects, dirtyRectCount);
+            return;
+        }
+
         memcpy(updateInfo.mappedData, data, updateInfo.dataSize);
 
         UploadInfo info = {};
@@ -516,6 +709,228 @@ void TextureUploader::UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicIma
     }
 }
 
+// Clamp to the image and merge overlapping rectangles,
+// as regions of one copy / blit command shouldn't overlap.
+static void PrepareRegions(std::vector<RgRect2D> &rects, const RgExtent2D &size)
+{
+    for (auto &r : rects)
+    {
+        const int64_t x0 = std::max<int64_t>(r.x, 0);
+        const int64_t y0 = std::max<int64_t>(r.y, 0);
+        const int64_t x1 = std::min<int64_t>((int64_t)r.x + r.width, size.width);
+        const int64_t y1 = std::min<int64_t>((int64_t)r.y + r.height, size.height);
+
+        r.x = (int32_t)x0;
+        r.y = (int32_t)y0;
+        r.width = x1 > x0 ? (uint32_t)(x1 - x0) : 0;
+        r.height = y1 > y0 ? (uint32_t)(y1 - y0) : 0;
+    }
+
+    rects.erase(std::remove_if(rects.begin(), rects.end(), [] (const RgRect2D &r)
+    {
+        return r.width == 0 || r.height == 0;
+    }), rects.end());
+
+    bool merged = true;
+
+    while (merged)
+    {
+        merged = false;
+
+        for (size_t i = 0; i < rects.size() && !merged; i++)
+        {
+            for (size_t j = i + 1; j < rects.size(); j++)
+            {
+                RgRect2D &a = rects[i];
+                const RgRect2D &b = rects[j];
+
+                const bool overlap =
+                    a.x < b.x + (int32_t)b.width && b.x < a.x + (int32_t)a.width &&
+                    a.y < b.y + (int32_t)b.height && b.y < a.y + (int32_t)a.height;
+
+                if (overlap)
+                {
+                    const int32_t x1 = std::max(a.x + (int32_t)a.width, b.x + (int32_t)b.width);
+                    const int32_t y1 = std::max(a.y + (int32_t)a.height, b.y + (int32_t)b.height);
+
+                    a.x = std::min(a.x, b.x);
+                    a.y = std::min(a.y, b.y);
+                    a.width = (uint32_t)(x1 - a.x);
+                    a.height = (uint32_t)(y1 - a.y);
+
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void TextureUploader::UpdateDynamicImageRegions(
+    VkCommandBuffer cmd, VkImage image, const DynamicImageInfo &updateInfo,
+    const void *data, const RgRect2D *pDirtyRects, uint32_t dirtyRectCount)
+{
+    const RgExtent2D &size = updateInfo.imageSize;
+    const uint32_t bytesPerPixel = updateInfo.dataSize / (size.width * size.height);
+
+    std::vector<RgRect2D> rects(pDirtyRects, pDirtyRects + dirtyRectCount);
+    PrepareRegions(rects, size);
+
+    if (rects.empty())
+    {
+        return;
+    }
+
+    UploadInfo info = {};
+    info.baseSize = size;
+    info.useMipmaps = updateInfo.generateMipmaps;
+
+    const uint32_t mipmapCount = DoesFormatSupportBlit(updateInfo.format) ? GetMipmapCount(size, info) : 1;
+
+    VkImageSubresourceRange allMipmaps = {};
+    allMipmaps.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    allMipmaps.baseMipLevel = 0;
+    allMipmaps.levelCount = mipmapCount;
+    allMipmaps.baseArrayLayer = 0;
+    allMipmaps.layerCount = 1;
+
+    // staging has the same layout as the whole image, copy only the dirty rows
+    std::vector<VkBufferImageCopy> copyRegions(rects.size());
+
+    for (size_t i = 0; i < rects.size(); i++)
+    {
+        const RgRect2D &r = rects[i];
+        const uint32_t rowSize = r.width * bytesPerPixel;
+
+        for (uint32_t y = r.y; y < r.y + r.height; y++)
+        {
+            const uint32_t offset = (y * size.width + r.x) * bytesPerPixel;
+            memcpy(static_cast<uint8_t *>(updateInfo.mappedData) + offset, static_cast<const uint8_t *>(data) + offset, rowSize);
+        }
+
+        VkBufferImageCopy &cr = copyRegions[i];
+        cr = {};
+        cr.bufferOffset = (r.y * size.width + r.x) * bytesPerPixel;
+        cr.bufferRowLength = size.width;
+        cr.bufferImageHeight = size.height;
+        cr.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        cr.imageSubresource.mipLevel = 0;
+        cr.imageSubresource.baseArrayLayer = 0;
+        cr.imageSubresource.layerCount = 1;
+        cr.imageOffset = { r.x, r.y, 0 };
+        cr.imageExtent = { r.width, r.height, 1 };
+    }
+
+    // old layout is not UNDEFINED, so the texels outside of the regions are preserved
+    Utils::BarrierImage(
+        cmd, image,
+        VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        allMipmaps);
+
+    vkCmdCopyBufferToImage(
+        cmd, updateInfo.stagingBuffer, image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)copyRegions.size(), copyRegions.data());
+
+    // regenerate only the footprints of the regions
+    std::vector<VkImageBlit> blits;
+
+    for (uint32_t mipLevel = 1; mipLevel < mipmapCount; mipLevel++)
+    {
+        const uint32_t prevMipWidth = std::max(size.width >> (mipLevel - 1), 1u);
+        const uint32_t prevMipHeight = std::max(size.height >> (mipLevel - 1), 1u);
+        const RgExtent2D mipSize = { std::max(size.width >> mipLevel, 1u), std::max(size.height >> mipLevel, 1u) };
+
+        for (auto &r : rects)
+        {
+            const int32_t x0 = std::min(r.x / 2, (int32_t)mipSize.width - 1);
+            const int32_t y0 = std::min(r.y / 2, (int32_t)mipSize.height - 1);
+            const int32_t x1 = std::max(std::min((r.x + (int32_t)r.width + 1) / 2, (int32_t)mipSize.width), x0 + 1);
+            const int32_t y1 = std::max(std::min((r.y + (int32_t)r.height + 1) / 2, (int32_t)mipSize.height), y0 + 1);
+
+            r.x = x0;
+            r.y = y0;
+            r.width = (uint32_t)(x1 - x0);
+            r.height = (uint32_t)(y1 - y0);
+        }
+        PrepareRegions(rects, mipSize);
+
+        blits.resize(rects.size());
+
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            const RgRect2D &r = rects[i];
+            VkImageBlit &b = blits[i];
+
+            b = {};
+            b.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            b.srcSubresource.mipLevel = mipLevel - 1;
+            b.srcSubresource.baseArrayLayer = 0;
+            b.srcSubresource.layerCount = 1;
+            b.srcOffsets[0] = { r.x * 2, r.y * 2, 0 };
+            // regions at the edge include the last texel of odd sizes
+            b.srcOffsets[1] = 
+            {
+                r.x + r.width == mipSize.width ? (int32_t)prevMipWidth : (r.x + (int32_t)r.width) * 2,
+                r.y + r.height == mipSize.height ? (int32_t)prevMipHeight : (r.y + (int32_t)r.height) * 2,
+                1
+            };
+
+            b.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            b.dstSubresource.mipLevel = mipLevel;
+            b.dstSubresource.baseArrayLayer = 0;
+            b.dstSubresource.layerCount = 1;
+            b.dstOffsets[0] = { r.x, r.y, 0 };
+            b.dstOffsets[1] = { r.x + (int32_t)r.width, r.y + (int32_t)r.height, 1 };
+        }
+
+        VkImageSubresourceRange prevMipmap = allMipmaps;
+        prevMipmap.baseMipLevel = mipLevel - 1;
+        prevMipmap.levelCount = 1;
+
+        // previous mip to TRANSFER_SRC
+        Utils::BarrierImage(
+            cmd, image,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            prevMipmap);
+
+        vkCmdBlitImage(
+            cmd,
+            image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            (uint32_t)blits.size(), blits.data(), VK_FILTER_LINEAR);
+    }
+
+    // all, except the last one, are in TRANSFER_SRC
+    if (mipmapCount > 1)
+    {
+        VkImageSubresourceRange srcMipmaps = allMipmaps;
+        srcMipmaps.levelCount = mipmapCount - 1;
+
+        Utils::BarrierImage(
+            cmd, image,
+            VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            srcMipmaps);
+    }
+
+    VkImageSubresourceRange lastMipmap = allMipmaps;
+    lastMipmap.baseMipLevel = mipmapCount - 1;
+    lastMipmap.levelCount = 1;
+
+    Utils::BarrierImage(
+        cmd, image,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        lastMipmap);
+}
+
 void TextureUploader::DestroyImage(VkImage image, VkImageView view)
 {
     auto it = dynamicImageInfos.find(image);
@@ -533,3 +948,214 @@ void TextureUploader::DestroyImage(VkImage image, VkImageView view)
     memAllocator->DestroyTextureImage(image);
     vkDestroyImageView(device, view, nullptr);
 }
+
+void TextureUploader::BeginBatch()
+{
+    assert(!isBatching && batchedImages.empty());
+    isBatching = true;
+}
+
+void TextureUploader::AddToBatch(VkImage image, VkBuffer stagingBuffer, const UploadInfo &info)
+{
+    assert(isBatching && !info.isCubemap && !info.isDynamic);
+
+    BatchedImage b = {};
+    b.image = image;
+    b.stagingBuffer = stagingBuffer;
+    b.baseSize = info.baseSize;
+    b.levelCount = GetMipmapCount(info.baseSize, info);
+    b.isPregenerated = AreMipmapsPregenerated(info);
+    b.generateMipmaps = !b.isPregenerated && b.levelCount > 1 && DoesFormatSupportBlit(info.format);
+
+    if (b.isPregenerated)
+    {
+        // info's offsets are not valid after returning from UploadImage
+        memcpy(b.levelDataOffsets, info.pLevelDataOffsets, b.levelCount * sizeof(uint32_t));
+    }
+
+    batchedImages.push_back(b);
+}
+
+static VkImageMemoryBarrier MakeImageBarrier(
+    VkImage image,
+    VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
+    VkImageLayout oldLayout, VkImageLayout newLayout,
+    uint32_t baseLevel, uint32_t levelCount)
+{
+    VkImageMemoryBarrier b = {};
+    b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    b.srcAccessMask = srcAccessMask;
+    b.dstAccessMask = dstAccessMask;
+    b.oldLayout = oldLayout;
+    b.newLayout = newLayout;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = image;
+    b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.baseMipLevel = baseLevel;
+    b.subresourceRange.levelCount = levelCount;
+    b.subresourceRange.baseArrayLayer = 0;
+    b.subresourceRange.layerCount = 1;
+
+    return b;
+}
+
+void TextureUploader::EndBatch(VkCommandBuffer cmd)
+{
+    assert(isBatching);
+    isBatching = false;
+
+    if (batchedImages.empty())
+    {
+        return;
+    }
+
+    std::vector<VkImageMemoryBarrier> barriers;
+    barriers.reserve(batchedImages.size() * 2);
+
+    const auto flushBarriers = [cmd, &barriers] (VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
+    {
+        if (!barriers.empty())
+        {
+            vkCmdPipelineBarrier(
+                cmd, srcStageMask, dstStageMask, 0,
+                0, nullptr,
+                0, nullptr,
+                (uint32_t)barriers.size(), barriers.data());
+
+            barriers.clear();
+        }
+    };
+
+
+    // 1. All levels of all images to TRANSFER_DST
+
+    uint32_t maxLevelCount = 1;
+
+    for (const BatchedImage &b : batchedImages)
+    {
+        barriers.push_back(MakeImageBarrier(
+            b.image,
+            0, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            0, b.levelCount));
+
+        if (b.generateMipmaps)
+        {
+            maxLevelCount = std::max(maxLevelCount, b.levelCount);
+        }
+    }
+
+    flushBarriers(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+
+    // 2. Copy staging data
+
+    for (const BatchedImage &b : batchedImages)
+    {
+        if (b.isPregenerated)
+        {
+            UploadInfo info = {};
+            info.baseSize = b.baseSize;
+            info.useMipmaps = true;
+            info.pregeneratedLevelCount = b.levelCount;
+            info.pLevelDataOffsets = b.levelDataOffsets;
+
+            CopyStagingToImageMipmaps(cmd, b.stagingBuffer, b.image, 0, info);
+        }
+        else
+        {
+            CopyStagingToImage(cmd, b.stagingBuffer, b.image, b.baseSize, 0, 1);
+        }
+    }
+
+
+    // 3. Generate mipmaps level by level, for all images at once
+
+    for (uint32_t mipLevel = 1; mipLevel < maxLevelCount; mipLevel++)
+    {
+        // previous level to TRANSFER_SRC
+        for (const BatchedImage &b : batchedImages)
+        {
+            if (b.generateMipmaps && mipLevel < b.levelCount)
+            {
+                barriers.push_back(MakeImageBarrier(
+                    b.image,
+                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    mipLevel - 1, 1));
+            }
+        }
+
+        flushBarriers(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        for (const BatchedImage &b : batchedImages)
+        {
+            if (!b.generateMipmaps || mipLevel >= b.levelCount)
+            {
+                continue;
+            }
+
+            const int32_t prevMipWidth  = (int32_t)std::max(b.baseSize.width  >> (mipLevel - 1), 1u);
+            const int32_t prevMipHeight = (int32_t)std::max(b.baseSize.height >> (mipLevel - 1), 1u);
+            const int32_t mipWidth      = (int32_t)std::max(b.baseSize.width  >> mipLevel, 1u);
+            const int32_t mipHeight     = (int32_t)std::max(b.baseSize.height >> mipLevel, 1u);
+
+            VkImageBlit curBlit = {};
+
+            curBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            curBlit.srcSubresource.mipLevel = mipLevel - 1;
+            curBlit.srcSubresource.baseArrayLayer = 0;
+            curBlit.srcSubresource.layerCount = 1;
+            curBlit.srcOffsets[0] = { 0,0,0 };
+            curBlit.srcOffsets[1] = { prevMipWidth, prevMipHeight, 1 };
+
+            curBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            curBlit.dstSubresource.mipLevel = mipLevel;
+            curBlit.dstSubresource.baseArrayLayer = 0;
+            curBlit.dstSubresource.layerCount = 1;
+            curBlit.dstOffsets[0] = { 0,0,0 };
+            curBlit.dstOffsets[1] = { mipWidth, mipHeight, 1 };
+
+            vkCmdBlitImage(
+                cmd,
+                b.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                b.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1, &curBlit, VK_FILTER_LINEAR);
+        }
+    }
+
+
+    // 4. Prepare all images for reading in ray tracing and fragment shaders
+
+    for (const BatchedImage &b : batchedImages)
+    {
+        if (b.generateMipmaps)
+        {
+            // all levels, except the last one, were blit sources
+            barriers.push_back(MakeImageBarrier(
+                b.image,
+                VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                0, b.levelCount - 1));
+
+            barriers.push_back(MakeImageBarrier(
+                b.image,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                b.levelCount - 1, 1));
+        }
+        else
+        {
+            barriers.push_back(MakeImageBarrier(
+                b.image,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                0, b.levelCount));
+        }
+    }
+
+    flushBarriers(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    batchedImages.clear();
+}
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "Common.h"
+#include "Const.h"
 #include "MemoryAllocator.h"
 #include "RTGL1/RTGL1.h"
 
@@ -63,6 +64,27 @@ public:
         bool                isCubemap;
     };
 
+    // Recreate static image with mip levels [newBaseLevel, levelCount).
+    // Levels that are in the old image are copied from it,
+    // others are uploaded from pData.
+    struct ReallocateInfo
+    {
+        VkCommandBuffer     cmd;
+        uint32_t            frameIndex;
+        VkImage             oldImage;
+        uint32_t            oldBaseLevel;
+        uint32_t            newBaseLevel;
+        uint32_t            levelCount;
+        // size of the level 0
+        RgExtent2D          baseSize;
+        VkFormat            format;
+        // can be null, if newBaseLevel > oldBaseLevel
+        const void          *pData;
+        const uint32_t      *pLevelDataOffsets;
+        const uint32_t      *pLevelDataSizes;
+        const char          *pDebugName;
+    };
+
 public:
     TextureUploader(VkDevice device, std::shared_ptr<MemoryAllocator> memAllocator);
     virtual ~TextureUploader();
@@ -76,9 +98,23 @@ public:
     void ClearStaging(uint32_t frameIndex);
 
     virtual UploadResult UploadImage(const UploadInfo &info);
-    void UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicImage, const void *data);
+    UploadResult ReallocateImage(const ReallocateInfo &info);
+    // If pDirtyRects is not null, only these regions are copied from data,
+    // and only their footprints are regenerated in the mip levels.
+    void UpdateDynamicImage(VkCommandBuffer cmd, VkImage dynamicImage, const void *data,
+                            const RgRect2D *pDirtyRects = nullptr, uint32_t dirtyRectCount = 0);
     void DestroyImage(VkImage image, VkImageView view);
 
+    // Between these calls, static images are created but not prepared.
+    // On EndBatch, their layout transitions, copies and mip blits are recorded
+    // together, so one barrier is used per step instead of one per image.
+    // Batched images must not be used in shaders before EndBatch.
+    void BeginBatch();
+    void EndBatch(VkCommandBuffer cmd);
+
+    // If false, mip levels can't be generated on GPU.
+    static bool DoesFormatSupportBlit(VkFormat format);
+
 protected:
     enum class ImagePrepareType
     {
@@ -88,7 +124,6 @@ protected:
     };
 
 protected:
-    bool DoesFormatSupportBlit(VkFormat format) const;
     bool AreMipmapsPregenerated(const UploadInfo &info) const;
     uint32_t GetMipmapCount(const RgExtent2D &size, const UploadInfo &info) const;
 
@@ -116,9 +151,28 @@ private:
         void        *mappedData;
         uint32_t    dataSize;
         RgExtent2D  imageSize;
+        VkFormat    format;
         bool        generateMipmaps;
     };
 
+    void UpdateDynamicImageRegions(
+        VkCommandBuffer cmd, VkImage image, const DynamicImageInfo &updateInfo,
+        const void *data, const RgRect2D *pDirtyRects, uint32_t dirtyRectCount);
+
+    struct BatchedImage
+    {
+        VkImage     image;
+        VkBuffer    stagingBuffer;
+        RgExtent2D  baseSize;
+        uint32_t    levelCount;
+        bool        isPregenerated;
+        // if true, levels [1, levelCount) are blitted from the level 0
+        bool        generateMipmaps;
+        uint32_t    levelDataOffsets[MAX_PREGENERATED_MIPMAP_LEVELS];
+    };
+
+    void AddToBatch(VkImage image, VkBuffer stagingBuffer, const UploadInfo &info);
+
 protected:
     VkDevice device;
 
@@ -130,6 +184,10 @@ protected:
 
     // Each dynamic image has its pointer to HOST_VISIBLE data for updating.
     rgl::unordered_map<VkImage, DynamicImageInfo> dynamicImageInfos;
+
+private:
+    bool isBatching;
+    std::vector<BatchedImage> batchedImages;
 };
 
 }
@@ -247,3 +247,109 @@ uint32_t RTGL1::Utils::GetWorkGroupCount(uint32_t size, uint32_t groupSize)
 
     return 1 + (size + (groupSize - 1)) / groupSize;
 }
+
+namespace
+{
+
+constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t RotL64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t Read64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t Read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t XXH64Round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = RotL64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+uint64_t XXH64MergeRound(uint64_t acc, uint64_t val)
+{
+    acc ^= XXH64Round(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+}
+
+uint64_t RTGL1::Utils::HashBytes(const void *pData, size_t size, uint64_t seed)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(pData);
+    const uint8_t *pEnd = p + size;
+
+    uint64_t h;
+
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+
+        for (; p + 32 <= pEnd; p += 32)
+        {
+            v1 = XXH64Round(v1, Read64(p));
+            v2 = XXH64Round(v2, Read64(p + 8));
+            v3 = XXH64Round(v3, Read64(p + 16));
+            v4 = XXH64Round(v4, Read64(p + 24));
+        }
+
+        h = RotL64(v1, 1) + RotL64(v2, 7) + RotL64(v3, 12) + RotL64(v4, 18);
+        h = XXH64MergeRound(h, v1);
+        h = XXH64MergeRound(h, v2);
+        h = XXH64MergeRound(h, v3);
+        h = XXH64MergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + XXH_PRIME64_5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    for (; p + 8 <= pEnd; p += 8)
+    {
+        h ^= XXH64Round(0, Read64(p));
+        h = RotL64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+
+    if (p + 4 <= pEnd)
+    {
+        h ^= static_cast<uint64_t>(Read32(p)) * XXH_PRIME64_1;
+        h = RotL64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+
+    for (; p < pEnd; p++)
+    {
+        h ^= static_cast<uint64_t>(*p) * XXH_PRIME64_5;
+        h = RotL64(h, 11) * XXH_PRIME64_1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
@@ -75,6 +75,9 @@ namespace Utils
     
     uint32_t GetWorkGroupCount(float size, uint32_t groupSize);
     uint32_t GetWorkGroupCount(uint32_t size, uint32_t groupSize);
+
+    // Fast non-cryptographic hash (XXH64).
+    uint64_t HashBytes(const void *pData, size_t size, uint64_t seed = 0);
 };
 
 template<typename T>
@@ -42,6 +42,8 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     currentFrameState(),
     frameId(1),
     waitForOutOfFrameFence(false),
+    isLowLatencyFrame(false),
+    isSwapchainImageAcquired(false),
     enableValidationLayer(info->enableValidationLayer == RG_TRUE),
     debugMessenger(VK_NULL_HANDLE),
     userPrint{ std::make_unique<UserPrint>(info->pfnPrint, info->pUserPrintData) },
@@ -89,9 +91,14 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
 
     cmdManager          = std::make_shared<CommandBufferManager>(device, queues);
 
+    gpuFrameTimer       = std::make_shared<GpuFrameTimer>(device, physDevice);
+    latencyTracker      = std::make_shared<FrameLatencyTracker>();
+
+    asyncCompute        = std::make_shared<AsyncCompute>(device, queues, cmdManager);
+
     uniform             = std::make_shared<GlobalUniform>(device, memAllocator);
 
-    swapchain           = std::make_shared<Swapchain>(device, surface, physDevice, cmdManager);
+    swapchain           = std::make_shared<Swapchain>(device, surface, physDevice, cmdManager, *info);
 
     // for world samplers with modifyable lod biad
     worldSamplerManager     = std::make_shared<SamplerManager>(device, 8, info->textureSamplerForceMinificationFilterLinear);
@@ -109,12 +116,30 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         cmdManager, 
         userFileLoad);
 
+    if (info->overridenTexturesFolderIndexEnable)
+    {
+        overrideFolderIndex = std::make_shared<OverrideFolderIndex>(
+            info->pOverridenTexturesFolderPath != nullptr ? info->pOverridenTexturesFolderPath : DEFAULT_TEXTURES_PATH,
+            info->pOverridenTexturesIndexManifestPath,
+            userFileLoad);
+    }
+
+    if (info->pOverridenTexturesPackPath != nullptr)
+    {
+        texturePack = std::make_shared<TexturePack>(
+            info->pOverridenTexturesPackPath,
+            info->pOverridenTexturesFolderPath != nullptr ? info->pOverridenTexturesFolderPath : DEFAULT_TEXTURES_PATH);
+    }
+
     textureManager      = std::make_shared<TextureManager>(
         device, 
+        physDevice,
         memAllocator,
         worldSamplerManager,
         cmdManager,
         userFileLoad,
+        overrideFolderIndex,
+        texturePack,
         *info);
 
     cubemapManager      = std::make_shared<CubemapManager>(
@@ -123,6 +148,8 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         genericSamplerManager,
         cmdManager,
         userFileLoad,
+        overrideFolderIndex,
+        texturePack,
         info->pOverridenTexturesFolderPath,
         info->pOverridenAlbedoAlphaTexturePostfix);
 
@@ -158,7 +185,8 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
         shaderManager,
         uniform,
         framebuffers,
-        textureManager);
+        textureManager,
+        !!info->decalsTiled);
 
     rtPipeline          = std::make_shared<RayTracingPipeline>(
         device, 
@@ -238,6 +266,7 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     effectCrtDemodulateEncode   = CONSTRUCT_SIMPLE_EFFECT(EffectCrtDemodulateEncode);
     effectCrtDecode             = CONSTRUCT_SIMPLE_EFFECT(EffectCrtDecode);
 #undef SIMPLE_EFFECT_CONSTRUCTOR_PARAMS
+    effectSimpleFused           = std::make_shared<EffectSimpleFused>(device, framebuffers, uniform, shaderManager);
 
 
     shaderManager->Subscribe(denoiser);
@@ -259,6 +288,7 @@ VulkanDevice::VulkanDevice(const RgInstanceCreateInfo *info) :
     shaderManager->Subscribe(effectColorTint);
     shaderManager->Subscribe(effectCrtDemodulateEncode);
     shaderManager->Subscribe(effectCrtDecode);
+    shaderManager->Subscribe(effectSimpleFused);
 
     framebuffers->Subscribe(rasterizer);
     framebuffers->Subscribe(decalManager);
@@ -272,6 +302,9 @@ VulkanDevice::~VulkanDevice()
     queues.reset();
     swapchain.reset();
     cmdManager.reset();
+    gpuFrameTimer.reset();
+    latencyTracker.reset();
+    asyncCompute.reset();
     framebuffers.reset();
     tonemapping.reset();
     imageComposition.reset();
@@ -288,6 +321,7 @@ VulkanDevice::~VulkanDevice()
     effectColorTint.reset();
     effectCrtDemodulateEncode.reset();
     effectCrtDecode.reset();
+    effectSimpleFused.reset();
     denoiser.reset();
     uniform.reset();
     scene.reset();
@@ -314,6 +348,10 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
 {
     uint32_t frameIndex = currentFrameState.IncrementFrameIndexAndGet();
 
+    isLowLatencyFrame = !!startInfo.requestLowLatency;
+    latencyTracker->StartNewFrame(isLowLatencyFrame);
+
+    latencyTracker->BeginCpuWait();
     if (!waitForOutOfFrameFence)
     {
         // wait for previous cmd with the same frame index
@@ -323,12 +361,24 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
     {
         Utils::WaitAndResetFences(device, frameFences[frameIndex], outOfFrameFences[frameIndex]);
     }
+    latencyTracker->EndCpuWait();
+
+    // the frame with this index was completed, so its GPU time is available
+    gpuFrameTimer->ReadResults(frameIndex);
+    latencyTracker->OnCompleted(frameIndex);
 
     swapchain->RequestNewSize(startInfo.surfaceSize.width, startInfo.surfaceSize.height);
     swapchain->RequestVsync(startInfo.requestVSync);
-    swapchain->AcquireImage(imageAvailableSemaphores[frameIndex]);
 
-    VkSemaphore semaphoreToWaitOnSubmit = imageAvailableSemaphores[frameIndex];
+    VkSemaphore semaphoreToWaitOnSubmit = VK_NULL_HANDLE;
+
+    // in low latency mode, the image is acquired in EndFrame
+    isSwapchainImageAcquired = !isLowLatencyFrame && swapchain->AcquireImage(imageAvailableSemaphores[frameIndex]);
+
+    if (isSwapchainImageAcquired)
+    {
+        semaphoreToWaitOnSubmit = imageAvailableSemaphores[frameIndex];
+    }
 
 
     // if out-of-frame cmd exist, submit it
@@ -340,9 +390,12 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
             // Signal outOfFrameFences, but for the next frame
             // because we can't reset cmd pool with cmds (in this case 
             // it's preFrameCmd) that are in use.
+            const CommandBufferManager::SubmitSemaphore wait = { semaphoreToWaitOnSubmit, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT };
+            const CommandBufferManager::SubmitSemaphore signal = { inFrameSemaphores[frameIndex], 0, 0 };
+
             cmdManager->Submit(preFrameCmd,
-                               semaphoreToWaitOnSubmit, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                               inFrameSemaphores[frameIndex],
+                               &wait, wait.semaphore != VK_NULL_HANDLE ? 1 : 0,
+                               &signal, 1,
                                outOfFrameFences[(frameIndex + 1) % MAX_FRAMES_IN_FLIGHT]);
 
             // should wait other semaphore in this case
@@ -377,6 +430,8 @@ VkCommandBuffer VulkanDevice::BeginFrame(const RgStartFrameInfo &startInfo)
 
     VkCommandBuffer cmd = cmdManager->StartGraphicsCmd();
 
+    gpuFrameTimer->WriteBegin(cmd, frameIndex);
+
     BeginCmdLabel(cmd, "Prepare for frame");
 
     // start dynamic geometry recording to current frame
@@ -429,11 +484,19 @@ void VulkanDevice::FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawI
     }
 
     {
+        // on the first frame, there is no previous size
+        gu->renderWidthPrev = gu->renderWidth > 0 ? gu->renderWidth : (float)renderResolution.Width();
+        gu->renderHeightPrev = gu->renderHeight > 0 ? gu->renderHeight : (float)renderResolution.Height();
+
         gu->renderWidth = (float)renderResolution.Width();
         gu->renderHeight = (float)renderResolution.Height();
         // render width must be always even for checkerboarding!
         assert((int)gu->renderWidth % 2 == 0);
 
+        // with dynamic resolution, only a part of framebuffers is used
+        gu->renderAreaScaleX = (float)renderResolution.Width() / (float)renderResolution.AllocatedWidth();
+        gu->renderAreaScaleY = (float)renderResolution.Height() / (float)renderResolution.AllocatedHeight();
+
         gu->upscaledRenderWidth = (float)renderResolution.UpscaledWidth();
         gu->upscaledRenderHeight = (float)renderResolution.UpscaledHeight();
 
@@ -761,11 +824,34 @@ void VulkanDevice::FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawI
 
     gu->useSqrtRoughnessForIndirect = !!drawInfo.useSqrtRoughnessForIndirect;
 
+    static_assert(
+        RG_INDIRECT_ILLUMINATION_RATE_FULL == INDIRECT_ILLUMINATION_RATE_FULL &&
+        RG_INDIRECT_ILLUMINATION_RATE_HALF_CHECKERBOARD == INDIRECT_ILLUMINATION_RATE_HALF_CHECKERBOARD &&
+        RG_INDIRECT_ILLUMINATION_RATE_QUARTER_INTERLEAVED == INDIRECT_ILLUMINATION_RATE_QUARTER_INTERLEAVED &&
+        RG_INDIRECT_ILLUMINATION_RATE_HALF_BLUE_NOISE == INDIRECT_ILLUMINATION_RATE_HALF_BLUE_NOISE,
+        "Interface and GLSL constants must be identical");
+
+    switch (drawInfo.indirectIlluminationRate)
+    {
+        case RG_INDIRECT_ILLUMINATION_RATE_FULL:
+        case RG_INDIRECT_ILLUMINATION_RATE_HALF_CHECKERBOARD:
+        case RG_INDIRECT_ILLUMINATION_RATE_QUARTER_INTERLEAVED:
+        case RG_INDIRECT_ILLUMINATION_RATE_HALF_BLUE_NOISE:
+            gu->indirectIlluminationRate = drawInfo.indirectIlluminationRate;
+            break;
+        default:
+            throw RgException(RG_WRONG_ARGUMENT, "RgDrawFrameInfo::indirectIlluminationRate is incorrect");
+    }
+
+    gu->denoiserAtrousIterationCount = denoiserQuality.GetAtrousIterationCount();
+    gu->denoiserIndirHalfRes = denoiserQuality.IsIndirHalfRes();
+    gu->denoiserGradientsEnabled = denoiserQuality.AreGradientsEnabled();
+
     gu->lensFlareCullingInputCount = rasterizer->GetLensFlareCullingInputCount();
     gu->applyViewProjToLensFlares = !lensFlareVerticesInScreenSpace;
 }
 
-void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
+VkCommandBuffer VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo, FramebufferImageIndex *pOutResultImage)
 {
     // end of "Prepare for frame" label
     EndCmdLabel(cmd);
@@ -777,6 +863,8 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
     bool mipLodBiasUpdated = worldSamplerManager->TryChangeMipLodBias(frameIndex, renderResolution.GetMipLodBias());
     const RgFloat2D jitter = renderResolution.IsNvDlssEnabled() ? HaltonSequence::GetJitter_Halton23(frameId) : RgFloat2D{ 0, 0 };
 
+    textureManager->UpdateStreaming(cmd, frameIndex);
+    textureManager->SubmitAnimatedMaterials(cmd, frameIndex);
     textureManager->SubmitDescriptors(frameIndex, drawInfo.pTexturesParams, mipLodBiasUpdated);
     cubemapManager->SubmitDescriptors(frameIndex);
 
@@ -789,7 +877,8 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
                                                        drawInfo.disableRayTracing);
 
 
-    framebuffers->PrepareForSize(renderResolution.GetResolutionState());
+    framebuffers->PrepareForSize(renderResolution.GetResolutionState(), renderResolution.GetActiveResolutionState());
+    rasterizer->SetRenderSize(renderResolution.Width(), renderResolution.Height());
     
 
     if (!drawInfo.disableRasterization)
@@ -808,9 +897,12 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
     assert(!!(uniform->GetData()->areFramebufsInitedByRT) == raysCanBeTraced);
 
 
+    bool lensFlaresCulled = false;
+
+
     if (raysCanBeTraced)
     {
-        decalManager->SubmitForFrame(cmd, frameIndex);
+        decalManager->SubmitForFrame(cmd, frameIndex, uniform);
 
         pathTracer->Bind(
             cmd, frameIndex, 
@@ -827,6 +919,19 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
             pathTracer->TraceReflectionRefractionRays(cmd, frameIndex, renderResolution.Width(), renderResolution.Height(), framebuffers);
         }
 
+        // depth buffer is final at this point, so lens flares
+        // can be culled on the async compute queue, while illumination is traced
+        if (asyncCompute->IsEnabled() && !drawInfo.disableRasterization)
+        {
+            cmd = asyncCompute->SplitGraphicsCmd(cmd);
+
+            VkCommandBuffer computeCmd = asyncCompute->StartComputeCmd();
+            rasterizer->CullLensFlares(computeCmd, frameIndex, drawInfo.pLensFlareParams);
+            asyncCompute->SubmitComputeCmd(computeCmd);
+
+            lensFlaresCulled = true;
+        }
+
         // save and merge samples from previous illumination results
         denoiser->MergeSamples(cmd, frameIndex, uniform, scene->GetASManager());
 
@@ -843,9 +948,12 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     bool enableBloom = drawInfo.pBloomParams == nullptr || (drawInfo.pBloomParams != nullptr && drawInfo.pBloomParams->bloomIntensity > 0.0f);
 
+    bool bloomSinglePassDownsample = drawInfo.pBloomParams != nullptr && drawInfo.pBloomParams->singlePassDownsample;
+    bool bloomFuseUpsample = drawInfo.pBloomParams != nullptr && drawInfo.pBloomParams->fuseUpsampleWithApply;
+
     if (enableBloom)
     {
-        bloom->Prepare(cmd, frameIndex, uniform, tonemapping);
+        bloom->Prepare(cmd, frameIndex, uniform, tonemapping, bloomSinglePassDownsample, bloomFuseUpsample);
     }
 
 
@@ -854,10 +962,15 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
 
     if (!drawInfo.disableRasterization)
     {
+        if (!lensFlaresCulled)
+        {
+            rasterizer->CullLensFlares(cmd, frameIndex, drawInfo.pLensFlareParams);
+        }
+
         // draw rasterized geometry into the final image
         rasterizer->DrawToFinalImage(cmd, frameIndex, textureManager,
                                      uniform->GetData()->view, uniform->GetData()->projection,
-                                     raysCanBeTraced, drawInfo.pLensFlareParams);
+                                     raysCanBeTraced);
     }
 
 
@@ -892,35 +1005,84 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
     // apply prepared bloom
     if (enableBloom)
     {
-        currentResultImage = bloom->Apply(cmd, frameIndex, uniform, renderResolution.UpscaledWidth(), renderResolution.UpscaledHeight(), currentResultImage);
+        currentResultImage = bloom->Apply(cmd, frameIndex, uniform, renderResolution.UpscaledWidth(), renderResolution.UpscaledHeight(), currentResultImage, bloomFuseUpsample);
     }
 
 
     const CommonnlyUsedEffectArguments args = { cmd, frameIndex, framebuffers, uniform, renderResolution.UpscaledWidth(), renderResolution.UpscaledHeight(), (float)currentFrameTime };
     {
+        const bool fuseSimpleEffects = !!drawInfo.postEffectParams.fuseSimpleEffects;
+
         if (effectColorTint->Setup(args, drawInfo.postEffectParams.pColorTint))
         {
-            currentResultImage = effectColorTint->Apply(args, currentResultImage);
+            if (fuseSimpleEffects)
+            {
+                effectSimpleFused->Add(*effectColorTint);
+            }
+            else
+            {
+                currentResultImage = effectColorTint->Apply(args, currentResultImage);
+            }
         }
         if (effectInverseBW->Setup(args, drawInfo.postEffectParams.pInverseBlackAndWhite))
         {
-            currentResultImage = effectInverseBW->Apply(args, currentResultImage);
+            if (fuseSimpleEffects)
+            {
+                effectSimpleFused->Add(*effectInverseBW);
+            }
+            else
+            {
+                currentResultImage = effectInverseBW->Apply(args, currentResultImage);
+            }
         }
         if (effectHueShift->Setup(args, drawInfo.postEffectParams.pHueShift))
         {
-            currentResultImage = effectHueShift->Apply(args, currentResultImage);
+            if (fuseSimpleEffects)
+            {
+                effectSimpleFused->Add(*effectHueShift);
+            }
+            else
+            {
+                currentResultImage = effectHueShift->Apply(args, currentResultImage);
+            }
         }
         if (effectChromaticAberration->Setup(args, drawInfo.postEffectParams.pChromaticAberration))
         {
-            currentResultImage = effectChromaticAberration->Apply(args, currentResultImage);
+            if (fuseSimpleEffects)
+            {
+                effectSimpleFused->Add(*effectChromaticAberration);
+            }
+            else
+            {
+                currentResultImage = effectChromaticAberration->Apply(args, currentResultImage);
+            }
         }
         if (effectDistortedSides->Setup(args, drawInfo.postEffectParams.pDistortedSides))
         {
-            currentResultImage = effectDistortedSides->Apply(args, currentResultImage);
+            if (fuseSimpleEffects)
+            {
+                effectSimpleFused->Add(*effectDistortedSides);
+            }
+            else
+            {
+                currentResultImage = effectDistortedSides->Apply(args, currentResultImage);
+            }
         }
         if (effectRadialBlur->Setup(args, drawInfo.postEffectParams.pRadialBlur))
         {
-            currentResultImage = effectRadialBlur->Apply(args, currentResultImage);
+            if (fuseSimpleEffects)
+            {
+                effectSimpleFused->Add(*effectRadialBlur);
+            }
+            else
+            {
+                currentResultImage = effectRadialBlur->Apply(args, currentResultImage);
+            }
+        }
+
+        if (fuseSimpleEffects)
+        {
+            currentResultImage = effectSimpleFused->Apply(args, currentResultImage);
         }
     }
 
@@ -947,27 +1109,127 @@ void VulkanDevice::Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo)
         }
     }
 
-    // blit result image to present on a surface
-    framebuffers->PresentToSwapchain(
-        cmd, frameIndex, swapchain,
-        currentResultImage, VK_FILTER_NEAREST);
+    // the blit to the swapchain is done in EndFrame,
+    // as the image might be not acquired yet
+    *pOutResultImage = currentResultImage;
+
+    return cmd;
 }
 
-void VulkanDevice::EndFrame(VkCommandBuffer cmd)
+void VulkanDevice::EndFrame(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo, const FramebufferImageIndex *pImageToPresent)
 {
     uint32_t frameIndex = currentFrameState.GetFrameIndex();
+    uint32_t prevFrameIndex = FrameState::GetPrevFrameIndex(frameIndex);
     VkSemaphore semaphoreToWait = currentFrameState.GetSemaphoreForWaitAndRemove();
 
-    // submit command buffer, but wait until presentation engine has completed using image
-    cmdManager->Submit(
-        cmd, 
-        semaphoreToWait,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
-        renderFinishedSemaphores[frameIndex],
-        frameFences[frameIndex]);
+    CommandBufferManager::SubmitSemaphore computeWait = {};
+
+    // culled lens flares are consumed by the indirect draw
+    bool waitForCompute = asyncCompute->GetWaitForCompute(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, computeWait);
+
+    CommandBufferManager::SubmitSemaphore waits[2] = {};
+    uint32_t waitCount = 0;
+
+    // if the image was acquired, wait until presentation engine has completed using it
+    if (semaphoreToWait != VK_NULL_HANDLE)
+    {
+        waits[waitCount++] = { semaphoreToWait, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT };
+    }
+
+    if (waitForCompute)
+    {
+        waits[waitCount++] = computeWait;
+    }
+
+    const CommandBufferManager::SubmitSemaphore renderFinished = { renderFinishedSemaphores[frameIndex], 0, 0 };
+
+    if (!isLowLatencyFrame)
+    {
+        // the previous frame might be finished already
+        if (vkGetFenceStatus(device, frameFences[prevFrameIndex]) == VK_SUCCESS)
+        {
+            latencyTracker->OnCompleted(prevFrameIndex);
+        }
+
+        // blit result image to present on a surface
+        if (isSwapchainImageAcquired && pImageToPresent != nullptr)
+        {
+            framebuffers->PresentToSwapchain(
+                cmd, frameIndex, swapchain,
+                *pImageToPresent, VK_FILTER_NEAREST);
+        }
+
+        gpuFrameTimer->WriteEnd(cmd, frameIndex);
+
+        cmdManager->Submit(
+            cmd,
+            waits, waitCount,
+            &renderFinished, isSwapchainImageAcquired ? 1 : 0,
+            frameFences[frameIndex]);
+
+        latencyTracker->OnSubmit(frameIndex);
+    }
+    else
+    {
+        // don't let the queue hold more than one frame: submitting right after
+        // the previous frame is finished, makes the camera to be sampled as late as possible
+        latencyTracker->BeginCpuWait();
+        {
+            VkResult r = vkWaitForFences(device, 1, &frameFences[prevFrameIndex], VK_TRUE, UINT64_MAX);
+            VK_CHECKERROR(r);
+        }
+        latencyTracker->EndCpuWait();
+        latencyTracker->OnCompleted(prevFrameIndex);
+
+        // if async compute was used, the uniform was already submitted
+        if (drawInfo.pfnLateLatchView != nullptr && !waitForCompute)
+        {
+            float view[16];
+            memcpy(view, drawInfo.view, 16 * sizeof(float));
+
+            drawInfo.pfnLateLatchView(view, drawInfo.pLateLatchUserData);
+
+            uniform->LateLatchView(frameIndex, view);
+        }
+
+        // end timestamp is written before the blit, so the presentation
+        // engine wait for the swapchain image is not counted as GPU time
+        gpuFrameTimer->WriteEnd(cmd, frameIndex);
+
+        // the frame doesn't depend on the swapchain image, so it can start immediately
+        cmdManager->Submit(cmd, waits, waitCount, nullptr, 0, VK_NULL_HANDLE);
+
+        latencyTracker->OnSubmit(frameIndex);
+
+        isSwapchainImageAcquired = swapchain->AcquireImage(imageAvailableSemaphores[frameIndex]);
+
+        // only the blit waits for the presentation engine
+        VkCommandBuffer presentCmd = cmdManager->StartGraphicsCmd();
+
+        if (isSwapchainImageAcquired && pImageToPresent != nullptr)
+        {
+            framebuffers->PresentToSwapchain(
+                presentCmd, frameIndex, swapchain,
+                *pImageToPresent, VK_FILTER_NEAREST);
+        }
+
+        const CommandBufferManager::SubmitSemaphore imageAvailable = 
+        {
+            imageAvailableSemaphores[frameIndex], 0, VK_PIPELINE_STAGE_TRANSFER_BIT
+        };
+
+        cmdManager->Submit(
+            presentCmd,
+            &imageAvailable, isSwapchainImageAcquired ? 1 : 0,
+            &renderFinished, isSwapchainImageAcquired ? 1 : 0,
+            frameFences[frameIndex]);
+    }
 
     // present on a surface when rendering will be finished
-    swapchain->Present(queues, renderFinishedSemaphores[frameIndex]);
+    if (isSwapchainImageAcquired)
+    {
+        swapchain->Present(queues, renderFinishedSemaphores[frameIndex]);
+    }
 
     frameId++;
 }
@@ -1015,15 +1277,27 @@ void VulkanDevice::DrawFrame(const RgDrawFrameInfo *drawInfo)
     currentFrameTime = drawInfo->currentTime;
 
     renderResolution.Setup(drawInfo->pRenderResolutionParams,
-                           swapchain->GetWidth(), swapchain->GetHeight(), nvDlss);
+                           swapchain->GetWidth(), swapchain->GetHeight(), nvDlss,
+                           gpuFrameTimer->GetLastFrameTime());
+
+    denoiserQuality.Setup(drawInfo->pDenoiserParams, drawInfo->view, gpuFrameTimer->GetLastFrameTime());
+
+    asyncCompute->PrepareForFrame(!!drawInfo->enableAsyncCompute);
 
     if (renderResolution.Width() > 0 && renderResolution.Height() > 0)
     {
         FillUniform(uniform->GetData(), *drawInfo);
-        Render(cmd, *drawInfo);
+
+        FramebufferImageIndex resultImage;
+        cmd = Render(cmd, *drawInfo, &resultImage);
+
+        EndFrame(cmd, *drawInfo, &resultImage);
+    }
+    else
+    {
+        EndFrame(cmd, *drawInfo, nullptr);
     }
 
-    EndFrame(cmd);
     currentFrameState.OnEndFrame();
 }
 
@@ -1117,6 +1391,11 @@ void VulkanDevice::UploadGeometry(const RgGeometryUploadInfo *uploadInfo)
     }
 
     scene->Upload(currentFrameState.GetFrameIndex(), *uploadInfo);
+
+    for (RgMaterial m : uploadInfo->geomMaterial.layerMaterials)
+    {
+        textureManager->MarkMaterialUsed(m, uploadInfo->geomType != RG_GEOMETRY_TYPE_DYNAMIC);
+    }
 }
 
 void VulkanDevice::UpdateGeometryTransform(const RgUpdateTransformInfo *updateInfo)
@@ -1167,6 +1446,7 @@ void VulkanDevice::UploadRasterizedGeometry(const RgRasterizedGeometryUploadInfo
     }
 
     rasterizer->Upload(currentFrameState.GetFrameIndex(), *pUploadInfo, pViewProjection, pViewport);
+    textureManager->MarkMaterialUsed(pUploadInfo->material, false);
 }
 
 void RTGL1::VulkanDevice::UploadLensFlare(const RgLensFlareUploadInfo *pUploadInfo)
@@ -1187,6 +1467,17 @@ void RTGL1::VulkanDevice::UploadLensFlare(const RgLensFlareUploadInfo *pUploadIn
     }
 
     rasterizer->UploadLensFlare(currentFrameState.GetFrameIndex(), *pUploadInfo);
+    textureManager->MarkMaterialUsed(pUploadInfo->material, !!pUploadInfo->isStatic);
+}
+
+void RTGL1::VulkanDevice::UpdateLensFlareIntensity(const RgUpdateLensFlareIntensityInfo *pUpdateInfo)
+{
+    if (pUpdateInfo == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    rasterizer->UpdateLensFlareIntensity(*pUpdateInfo);
 }
 
 void RTGL1::VulkanDevice::UploadDecal(const RgDecalUploadInfo *pUploadInfo)
@@ -1197,16 +1488,20 @@ void RTGL1::VulkanDevice::UploadDecal(const RgDecalUploadInfo *pUploadInfo)
     }
 
     decalManager->Upload(currentFrameState.GetFrameIndex(), *pUploadInfo, textureManager);
+    textureManager->MarkMaterialUsed(pUploadInfo->material, false);
 }
 
 void VulkanDevice::SubmitStaticGeometries()
 {
     scene->SubmitStatic();
+    rasterizer->SubmitStaticLensFlares();
 }
 
 void VulkanDevice::StartNewStaticScene()
 {
     scene->StartNewStatic();
+    rasterizer->StartNewStaticLensFlares();
+    textureManager->ResetStaticMaterialUsage();
 }
 
 void VulkanDevice::UploadLight(const RgDirectionalLightUploadInfo *pLightInfo)
@@ -1266,6 +1561,32 @@ void VulkanDevice::CreateStaticMaterial(const RgStaticMaterialCreateInfo *create
                                                    *createInfo);
 }
 
+void VulkanDevice::CreateStaticMaterials(uint32_t count, const RgStaticMaterialCreateInfo *createInfos, RgMaterial *results)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (createInfos == nullptr || results == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    VkCommandBuffer cmd = currentFrameState.GetCmdBufferForMaterials(cmdManager);
+    uint32_t frameIndex = currentFrameState.GetFrameIndex();
+
+    // out-of-frame command buffer is not measured
+    bool isMeasured = currentFrameState.WasFrameStarted() && gpuFrameTimer->WriteUploadBegin(cmd, frameIndex);
+
+    textureManager->CreateStaticMaterials(cmd, frameIndex, count, createInfos, results);
+
+    if (isMeasured)
+    {
+        gpuFrameTimer->WriteUploadEnd(cmd, frameIndex);
+    }
+}
+
 void VulkanDevice::CreateAnimatedMaterial(const RgAnimatedMaterialCreateInfo *createInfo, RgMaterial *result)
 {
     if (createInfo == nullptr)
@@ -1338,6 +1659,65 @@ void VulkanDevice::DestroyCubemap(RgCubemap cubemap)
 {
     cubemapManager->DestroyCubemap(currentFrameState.GetFrameIndex(), cubemap);
 }
+
+void VulkanDevice::RefreshOverridenTexturesIndex()
+{
+    if (!overrideFolderIndex)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Overriden textures folder index wasn't enabled in RgInstanceCreateInfo");
+    }
+
+    overrideFolderIndex->Refresh();
+}
+
+void VulkanDevice::GetTextureStreamingStats(RgTextureStreamingStats *pOutStats) const
+{
+    if (pOutStats == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    if (!textureManager->GetStreamingStats(pOutStats))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Texture streaming wasn't enabled in RgInstanceCreateInfo");
+    }
+}
+
+void VulkanDevice::GetTextureDeduplicationStats(RgTextureDeduplicationStats *pOutStats) const
+{
+    if (pOutStats == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    if (!textureManager->GetDeduplicationStats(pOutStats))
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Texture deduplication wasn't enabled in RgInstanceCreateInfo");
+    }
+}
+
+void VulkanDevice::GetTextureSlotStats(RgTextureSlotStats *pOutStats) const
+{
+    if (pOutStats == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    textureManager->GetSlotStats(pOutStats);
+}
+
+void VulkanDevice::GetFrameLatencyStats(RgFrameLatencyStats *pOutStats) const
+{
+    if (pOutStats == nullptr)
+    {
+        throw RgException(RG_WRONG_ARGUMENT, "Argument is null");
+    }
+
+    latencyTracker->GetStats(pOutStats);
+
+    pOutStats->lastGpuFrameTime = gpuFrameTimer->GetLastFrameTime();
+    pOutStats->lastStaticMaterialBatchGpuTime = gpuFrameTimer->GetLastUploadTime();
+}
 #pragma endregion 
 
 
@@ -1544,10 +1924,12 @@ void VulkanDevice::CreateDevice()
     vulkan12Features.samplerMirrorClampToEdge = 1;
     vulkan12Features.runtimeDescriptorArray = 1;
     vulkan12Features.shaderSampledImageArrayNonUniformIndexing = 1;
+    vulkan12Features.descriptorBindingPartiallyBound = physDevice->IsDescriptorPartiallyBoundSupported();
     vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = 1;
     vulkan12Features.bufferDeviceAddress = 1;
     vulkan12Features.shaderFloat16 = 1;
     vulkan12Features.drawIndirectCount = 1;
+    vulkan12Features.timelineSemaphore = 1;
 
     VkPhysicalDeviceMultiviewFeatures multiviewFeatures = {};
     multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES;
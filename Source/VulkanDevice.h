@@ -48,9 +48,14 @@
 #include "Sharpening.h"
 #include "DLSS.h"
 #include "RenderResolutionHelper.h"
+#include "DenoiserQualityHelper.h"
+#include "GpuFrameTimer.h"
+#include "FrameLatencyTracker.h"
+#include "AsyncCompute.h"
 #include "DecalManager.h"
 #include "EffectWipe.h"
 #include "EffectSimple_Instances.h"
+#include "EffectSimpleFused.h"
 
 namespace RTGL1
 {
@@ -73,6 +78,7 @@ public:
     void UploadRasterizedGeometry(const RgRasterizedGeometryUploadInfo *pUploadInfo,
                                   const float *pViewProjection, const RgViewport *pViewport);
     void UploadLensFlare(const RgLensFlareUploadInfo *pUploadInfo);
+    void UpdateLensFlareIntensity(const RgUpdateLensFlareIntensityInfo *pUpdateInfo);
     void UploadDecal(const RgDecalUploadInfo *pUploadInfo);
 
     void SubmitStaticGeometries();
@@ -86,6 +92,7 @@ public:
     void SetPotentialVisibility(SectorID sectorID_A, SectorID sectorID_B);
 
     void CreateStaticMaterial(const RgStaticMaterialCreateInfo *pCreateInfo, RgMaterial *pResult);
+    void CreateStaticMaterials(uint32_t count, const RgStaticMaterialCreateInfo *pCreateInfos, RgMaterial *pResults);
     void CreateAnimatedMaterial(const RgAnimatedMaterialCreateInfo *pCreateInfo, RgMaterial *pResult);
     void ChangeAnimatedMaterialFrame(RgMaterial animatedMaterial, uint32_t frameIndex);
     void CreateDynamicMaterial(const RgDynamicMaterialCreateInfo *pCreateInfo, RgMaterial *pResult);
@@ -95,6 +102,12 @@ public:
     void CreateSkyboxCubemap(const RgCubemapCreateInfo *pCreateInfo, RgCubemap *pResult);
     void DestroyCubemap(RgCubemap cubemap);
 
+    void RefreshOverridenTexturesIndex();
+    void GetTextureStreamingStats(RgTextureStreamingStats *pOutStats) const;
+    void GetTextureDeduplicationStats(RgTextureDeduplicationStats *pOutStats) const;
+    void GetTextureSlotStats(RgTextureSlotStats *pOutStats) const;
+    void GetFrameLatencyStats(RgFrameLatencyStats *pOutStats) const;
+
 
     void StartFrame(const RgStartFrameInfo *pStartInfo);
     void DrawFrame(const RgDrawFrameInfo *pFrameInfo);
@@ -119,8 +132,10 @@ private:
     void FillUniform(ShGlobalUniform *gu, const RgDrawFrameInfo &drawInfo) const;
 
     VkCommandBuffer BeginFrame(const RgStartFrameInfo &startInfo);
-    void Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo);
-    void EndFrame(VkCommandBuffer cmd);
+    // Returns the command buffer that should be submitted at the end of the frame
+    VkCommandBuffer Render(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo, FramebufferImageIndex *pOutResultImage);
+    // If pImageToPresent is null, the swapchain image is not written
+    void EndFrame(VkCommandBuffer cmd, const RgDrawFrameInfo &drawInfo, const FramebufferImageIndex *pImageToPresent);
 
 private:
     struct FrameState
@@ -250,6 +265,11 @@ private:
     bool                waitForOutOfFrameFence;
     VkFence             outOfFrameFences[MAX_FRAMES_IN_FLIGHT] = {};
 
+    // if true, the swapchain image is acquired right before the submission
+    bool                isLowLatencyFrame;
+    // false, if the swapchain is being recreated, so the frame is not presented
+    bool                isSwapchainImageAcquired;
+
     std::shared_ptr<PhysicalDevice>         physDevice;
     std::shared_ptr<Queues>                 queues;
     std::shared_ptr<Swapchain>              swapchain;
@@ -258,6 +278,10 @@ private:
 
     std::shared_ptr<CommandBufferManager>   cmdManager;
 
+    std::shared_ptr<GpuFrameTimer>          gpuFrameTimer;
+    std::shared_ptr<FrameLatencyTracker>    latencyTracker;
+    std::shared_ptr<AsyncCompute>           asyncCompute;
+
     std::shared_ptr<Framebuffers>           framebuffers;
 
     std::shared_ptr<GlobalUniform>          uniform;
@@ -284,6 +308,7 @@ private:
     std::shared_ptr<EffectColorTint>            effectColorTint;
     std::shared_ptr<EffectCrtDemodulateEncode>  effectCrtDemodulateEncode;
     std::shared_ptr<EffectCrtDecode>            effectCrtDecode;
+    std::shared_ptr<EffectSimpleFused>          effectSimpleFused;
 
     std::shared_ptr<SamplerManager>         worldSamplerManager;
     std::shared_ptr<SamplerManager>         genericSamplerManager;
@@ -295,6 +320,10 @@ private:
     VkDebugUtilsMessengerEXT                debugMessenger;
     std::unique_ptr<UserPrint>              userPrint;
     std::shared_ptr<UserFileLoad>           userFileLoad;
+    // null, if overriden textures folder is not indexed
+    std::shared_ptr<OverrideFolderIndex>    overrideFolderIndex;
+    // null, if overriden textures are not packed
+    std::shared_ptr<TexturePack>            texturePack;
 
     VertexBufferProperties                  vbProperties = {};
     bool                                    rayCullBackFacingTriangles;
@@ -302,6 +331,7 @@ private:
     bool                                    lensFlareVerticesInScreenSpace;
 
     RenderResolutionHelper                  renderResolution;
+    DenoiserQualityHelper                   denoiserQuality;
 
     double                                  previousFrameTime;
     double                                  currentFrameTime;
@@ -0,0 +1,167 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace RTGL1;
+
+constexpr uint32_t MAX_WORKER_COUNT = 32;
+
+WorkerPool::WorkerPool(uint32_t _threadCount)
+:
+    threadCount(_threadCount),
+    areWorkersStarted(false),
+    currentJob(nullptr),
+    currentJobCount(0),
+    nextJobIndex(0),
+    finishedJobCount(0),
+    activeWorkerCount(0),
+    jobGeneration(0),
+    stopWorkers(false)
+{}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopWorkers = true;
+    }
+    jobStart.notify_all();
+
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+}
+
+void WorkerPool::StartWorkers()
+{
+    assert(!areWorkersStarted);
+    areWorkersStarted = true;
+
+    if (threadCount == 0)
+    {
+        // calling thread participates too
+        const uint32_t hw = std::thread::hardware_concurrency();
+        threadCount = hw > 1 ? hw - 1 : 0;
+    }
+
+    threadCount = std::min(threadCount, MAX_WORKER_COUNT);
+
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+void WorkerPool::WorkerLoop()
+{
+    uint64_t seenGeneration = 0;
+
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        jobStart.wait(lock, [this, &seenGeneration] { return stopWorkers || jobGeneration != seenGeneration; });
+
+        if (stopWorkers)
+        {
+            return;
+        }
+
+        seenGeneration = jobGeneration;
+
+        // the job might be already finished by others
+        if (currentJob == nullptr)
+        {
+            continue;
+        }
+
+        activeWorkerCount++;
+        lock.unlock();
+
+        RunJobs();
+
+        lock.lock();
+        activeWorkerCount--;
+        lock.unlock();
+
+        jobFinish.notify_one();
+    }
+}
+
+void WorkerPool::RunJobs()
+{
+    while (true)
+    {
+        const uint32_t i = nextJobIndex.fetch_add(1);
+
+        if (i >= currentJobCount)
+        {
+            return;
+        }
+
+        (*currentJob)(i);
+
+        finishedJobCount.fetch_add(1);
+    }
+}
+
+void WorkerPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)> &func)
+{
+    // threads are created only when there is a job to split
+    if (!areWorkersStarted && count > 1)
+    {
+        StartWorkers();
+    }
+
+    if (workers.empty() || count <= 1)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            func(i);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+
+        currentJob = &func;
+        currentJobCount = count;
+        nextJobIndex = 0;
+        finishedJobCount = 0;
+        jobGeneration++;
+    }
+    jobStart.notify_all();
+
+    RunJobs();
+
+    // wait for the workers that took the job, so none of them references it after return
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobFinish.wait(lock, [this] { return activeWorkerCount == 0; });
+
+    assert(finishedJobCount == currentJobCount);
+    currentJob = nullptr;
+    currentJobCount = 0;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2022 Sultim Tsyrendashiev
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RTGL1
+{
+
+// Persistent threads for splitting CPU texture processing into jobs.
+class WorkerPool
+{
+public:
+    // If threadCount is 0, the count is chosen from the hardware concurrency.
+    // Threads are started on the first ParallelFor that has more than one job.
+    explicit WorkerPool(uint32_t threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &other) = delete;
+    WorkerPool(WorkerPool &&other) noexcept = delete;
+    WorkerPool &operator=(const WorkerPool &other) = delete;
+    WorkerPool &operator=(WorkerPool &&other) noexcept = delete;
+
+    // Call func for each index in [0, count) on the worker threads and the calling one.
+    // Returns when all calls are finished.
+    void ParallelFor(uint32_t count, const std::function<void(uint32_t)> &func);
+
+private:
+    void StartWorkers();
+    void WorkerLoop();
+    void RunJobs();
+
+private:
+    uint32_t threadCount;
+    bool areWorkersStarted;
+    std::vector<std::thread> workers;
+
+    std::mutex jobMutex;
+    std::condition_variable jobStart;
+    std::condition_variable jobFinish;
+    const std::function<void(uint32_t)> *currentJob;
+    uint32_t currentJobCount;
+    std::atomic<uint32_t> nextJobIndex;
+    std::atomic<uint32_t> finishedJobCount;
+    uint32_t activeWorkerCount;
+    uint64_t jobGeneration;
+    bool stopWorkers;
+};
+
+}
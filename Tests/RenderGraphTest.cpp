@@ -0,0 +1,235 @@
+// Tests of the render graph compiler: pass culling and barrier derivation.
+// Doesn't require a Vulkan device, only the headers.
+
+#include <cstdio>
+#include <vector>
+
+#include "../Source/RenderGraphCompiler.h"
+
+using namespace RTGL1;
+
+typedef RenderGraphCompiler::PassDesc       PassDesc;
+typedef RenderGraphCompiler::CompiledPass   CompiledPass;
+typedef RenderGraphCompiler::Barrier        Barrier;
+
+static int g_FailedCount = 0;
+
+#define CHECK(x)                                                        \
+    do {                                                                \
+        if (!(x)) {                                                     \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); \
+            g_FailedCount++;                                            \
+        }                                                               \
+    } while (0)
+
+constexpr VkPipelineStageFlags2KHR CS = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
+constexpr VkPipelineStageFlags2KHR FS = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR;
+constexpr VkPipelineStageFlags2KHR RT = VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
+
+constexpr VkAccessFlags2KHR READ = VK_ACCESS_2_SHADER_READ_BIT_KHR;
+constexpr VkAccessFlags2KHR WRITE = VK_ACCESS_2_SHADER_WRITE_BIT_KHR;
+
+static const Barrier *FindBarrier(const CompiledPass &c, uint32_t resource)
+{
+    for (const Barrier &b : c.barriers)
+    {
+        if (b.resource == resource)
+        {
+            return &b;
+        }
+    }
+
+    return nullptr;
+}
+
+static void TestFirstAccessIsFullySynchronized()
+{
+    std::vector<PassDesc> passes =
+    {
+        { CS, { 0 }, { 1 } },
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, {});
+
+    CHECK(c.size() == 1);
+    CHECK(c[0].barriers.size() == 2);
+
+    const Barrier *r = FindBarrier(c[0], 0);
+    CHECK(r != nullptr && r->srcStage == VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR);
+    CHECK(r != nullptr && r->srcAccess == VK_ACCESS_2_MEMORY_WRITE_BIT_KHR);
+    CHECK(r != nullptr && r->dstStage == CS && r->dstAccess == READ);
+
+    const Barrier *w = FindBarrier(c[0], 1);
+    CHECK(w != nullptr && w->srcStage == VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR);
+    CHECK(w != nullptr && w->dstStage == CS && w->dstAccess == WRITE);
+}
+
+static void TestReadAfterWrite()
+{
+    std::vector<PassDesc> passes =
+    {
+        { CS, {}, { 0 } },
+        { FS, { 0 }, { 1 } },
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, {});
+
+    CHECK(c.size() == 2);
+
+    const Barrier *b = FindBarrier(c[1], 0);
+    CHECK(b != nullptr);
+    CHECK(b != nullptr && b->srcStage == CS && b->srcAccess == WRITE);
+    CHECK(b != nullptr && b->dstStage == FS && b->dstAccess == READ);
+}
+
+static void TestVisibleWriteIsNotSynchronizedAgain()
+{
+    std::vector<PassDesc> passes =
+    {
+        { CS, {}, { 0 } },
+        { CS, { 0 }, { 1 } },
+        { CS, { 0 }, { 2 } },
+        { RT, { 0 }, { 3 } },
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, {});
+
+    CHECK(c.size() == 4);
+    CHECK(FindBarrier(c[1], 0) != nullptr);
+    // already visible to the compute stage
+    CHECK(FindBarrier(c[2], 0) == nullptr);
+    // but not to the ray tracing stage
+    const Barrier *b = FindBarrier(c[3], 0);
+    CHECK(b != nullptr && b->srcStage == CS && b->dstStage == RT);
+}
+
+static void TestWriteAfterRead()
+{
+    std::vector<PassDesc> passes =
+    {
+        { CS, {}, { 0 } },
+        { FS, { 0 }, { 1 } },
+        { RT, { 0 }, { 2 } },
+        { CS, {}, { 0 } },
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, {});
+
+    CHECK(c.size() == 4);
+
+    // waits for the previous write and all reads after it
+    const Barrier *b = FindBarrier(c[3], 0);
+    CHECK(b != nullptr && b->srcStage == (CS | FS | RT));
+    CHECK(b != nullptr && b->srcAccess == WRITE);
+    CHECK(b != nullptr && b->dstStage == CS && b->dstAccess == WRITE);
+}
+
+static void TestReadWriteIsOneBarrier()
+{
+    std::vector<PassDesc> passes =
+    {
+        { CS, {}, { 0 } },
+        { CS, { 0 }, { 0 } },
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, {});
+
+    CHECK(c.size() == 2);
+    CHECK(c[1].barriers.size() == 1);
+
+    const Barrier *b = FindBarrier(c[1], 0);
+    CHECK(b != nullptr && b->dstAccess == (READ | WRITE));
+}
+
+static void TestIndependentResourcesAreNotSynchronized()
+{
+    std::vector<PassDesc> passes =
+    {
+        { CS, {}, { 0 } },
+        { CS, {}, { 1 } },
+        { CS, { 0 }, { 2 } },
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, {});
+
+    CHECK(c.size() == 3);
+    CHECK(FindBarrier(c[2], 1) == nullptr);
+    CHECK(FindBarrier(c[2], 0) != nullptr);
+}
+
+static void TestCulling()
+{
+    std::vector<PassDesc> passes =
+    {
+        { CS, {}, { 0 } },          // needed by 2
+        { CS, {}, { 1 } },          // not needed
+        { CS, { 0 }, { 2 } },       // output
+        { CS, { 2 }, { 3 } },       // not needed
+        { CS, { 2 }, {} },          // no writes, never culled
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, { 2 });
+
+    CHECK(c.size() == 3);
+    CHECK(c.size() == 3 && c[0].passIndex == 0);
+    CHECK(c.size() == 3 && c[1].passIndex == 2);
+    CHECK(c.size() == 3 && c[2].passIndex == 4);
+
+    // without outputs, nothing is culled
+    auto all = RenderGraphCompiler::Compile(passes, {});
+    CHECK(all.size() == passes.size());
+}
+
+static void TestCullingKeepsPartialWrites()
+{
+    // the second write may be partial, so the first one is still needed
+    std::vector<PassDesc> passes =
+    {
+        { CS, {}, { 0 } },
+        { CS, {}, { 0 } },
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, { 0 });
+
+    CHECK(c.size() == 2);
+    CHECK(c.size() == 2 && c[1].barriers.size() == 1);
+}
+
+static void TestCulledPassesDontAffectBarriers()
+{
+    std::vector<PassDesc> passes =
+    {
+        { CS, {}, { 0 } },
+        { RT, { 0 }, { 1 } },       // culled
+        { FS, { 0 }, { 2 } },
+    };
+
+    auto c = RenderGraphCompiler::Compile(passes, { 2 });
+
+    CHECK(c.size() == 2);
+
+    const Barrier *b = c.size() == 2 ? FindBarrier(c[1], 0) : nullptr;
+    CHECK(b != nullptr && b->srcStage == CS && b->dstStage == FS);
+}
+
+int main()
+{
+    TestFirstAccessIsFullySynchronized();
+    TestReadAfterWrite();
+    TestVisibleWriteIsNotSynchronizedAgain();
+    TestWriteAfterRead();
+    TestReadWriteIsOneBarrier();
+    TestIndependentResourcesAreNotSynchronized();
+    TestCulling();
+    TestCullingKeepsPartialWrites();
+    TestCulledPassesDontAffectBarriers();
+
+    if (g_FailedCount > 0)
+    {
+        std::printf("%d checks failed\n", g_FailedCount);
+        return 1;
+    }
+
+    std::printf("All checks passed\n");
+    return 0;
+}
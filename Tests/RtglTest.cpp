@@ -1,5 +1,6 @@
 #include <chrono>
 #include <iostream>
+#include <vector>
 
 
 #define RG_USE_SURFACE_WIN32
@@ -38,6 +39,8 @@ static float        ctl_Metallicity         = 0.5f;
 static RgBool32     ctl_MoveBoxes           = 0;
 static RgBool32     ctl_ShowGradients       = 0;
 static RgBool32     ctl_ReloadShaders       = 0;
+static RgBool32     ctl_DecalBenchmark      = 0;
+static RgBool32     ctl_MaterialBenchmark   = 0;
 
 static bool ProcessWindow()
 {
@@ -101,6 +104,8 @@ static void ProcessInput()
     ControlSwitch(GLFW_KEY_Z,       ctl_MoveBoxes);
     ControlSwitch(GLFW_KEY_G,       ctl_ShowGradients);
     ControlSwitch(GLFW_KEY_H,       ctl_ReloadShaders);
+    ControlSwitch(GLFW_KEY_B,       ctl_DecalBenchmark);
+    ControlSwitch(GLFW_KEY_N,       ctl_MaterialBenchmark);
 }
 
 static double GetCurrentTimeInSeconds()
@@ -143,6 +148,124 @@ static const uint32_t s_QuadColorsABGR[] = {
 
 
 
+// 2k static materials with raw 64x64 textures are created inside of a frame.
+// On each switch, batched and one-by-one creation alternate, to compare:
+//  - recording time, i.e. CPU time of the creation calls;
+//  - GPU time of the frame with the uploads, against the frame before it;
+//  - GPU time of the batch uploads, measured with timestamps around them.
+// GPU times are printed when the frame is completed.
+// Materials are destroyed after that.
+struct MaterialBenchmark
+{
+    static constexpr uint32_t   MaterialCount       = 2048;
+    static constexpr uint32_t   TextureSize         = 64;
+
+    RgBool32                    lastSwitch          = 0;
+    bool                        isBatched           = true;
+    uint64_t                    frameId             = 0;
+    float                       baseGpuFrameTime    = -1.0f;
+    std::vector<RgMaterial>     materials;
+    std::vector<uint32_t>       pixels;
+
+    void Create(RgInstance instance, uint64_t currentFrameId)
+    {
+        RgResult r;
+
+        const uint32_t texelCount = TextureSize * TextureSize;
+        pixels.resize(MaterialCount * texelCount);
+
+        std::vector<RgStaticMaterialCreateInfo> infos(MaterialCount);
+
+        for (uint32_t i = 0; i < MaterialCount; i++)
+        {
+            uint32_t *pTexels = &pixels[i * texelCount];
+
+            // different contents, so they are not deduplicated
+            for (uint32_t t = 0; t < texelCount; t++)
+            {
+                pTexels[t] = 0xFF000000 | (i * 2654435761u + t);
+            }
+
+            infos[i] =
+            {
+                .size = { TextureSize, TextureSize },
+                .textures = { .albedoAlpha = { .pData = pTexels, .isSRGB = true } },
+            };
+        }
+
+        RgFrameLatencyStats stats = {};
+        r = rgGetFrameLatencyStats(instance, &stats);
+        RG_CHECK(r);
+
+        baseGpuFrameTime = stats.lastGpuFrameTime;
+
+        materials.resize(MaterialCount);
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (isBatched)
+        {
+            r = rgCreateStaticMaterials(instance, MaterialCount, infos.data(), materials.data());
+            RG_CHECK(r);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < MaterialCount; i++)
+            {
+                r = rgCreateStaticMaterial(instance, &infos[i], &materials[i]);
+                RG_CHECK(r);
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "Material benchmark, " << (isBatched ? "batched" : "one by one") << ": recording "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+
+        frameId = currentFrameId;
+    }
+
+    // Must be called each frame, after rgStartFrame.
+    void Update(RgInstance instance, uint64_t currentFrameId)
+    {
+        if (lastSwitch != ctl_MaterialBenchmark && materials.empty())
+        {
+            lastSwitch = ctl_MaterialBenchmark;
+            Create(instance, currentFrameId);
+            return;
+        }
+
+        // wait until the frame with the uploads is completed, there are 2 frames in flight
+        if (materials.empty() || currentFrameId < frameId + 2)
+        {
+            return;
+        }
+
+        RgFrameLatencyStats stats = {};
+        RgResult r = rgGetFrameLatencyStats(instance, &stats);
+        RG_CHECK(r);
+
+        std::cout << "Material benchmark, " << (isBatched ? "batched" : "one by one") << ": GPU frame time with uploads "
+                  << stats.lastGpuFrameTime << " ms, without " << baseGpuFrameTime << " ms";
+
+        if (isBatched)
+        {
+            std::cout << ", GPU time of the batch " << stats.lastStaticMaterialBatchGpuTime << " ms";
+        }
+
+        std::cout << std::endl;
+
+        for (RgMaterial m : materials)
+        {
+            r = rgDestroyMaterial(instance, m);
+            RG_CHECK(r);
+        }
+
+        materials.clear();
+        isBatched = !isBatched;
+    }
+};
+
 static void MainLoop(RgInstance instance)
 {
     RgResult    r           = RG_SUCCESS;
@@ -150,6 +273,8 @@ static void MainLoop(RgInstance instance)
     RgMaterial  material    = RG_NO_MATERIAL;
     RgCubemap   skybox      = RG_NO_MATERIAL;
 
+    MaterialBenchmark materialBenchmark;
+
     const uint64_t MovableGeomUniqueID = 200;
 
 
@@ -323,6 +448,9 @@ static void MainLoop(RgInstance instance)
         }
 
 
+        materialBenchmark.Update(instance, frameId);
+
+
         // transform of movable geometry can be changed
         RgUpdateTransformInfo transformUpdateInfo = 
         {
@@ -404,6 +532,28 @@ static void MainLoop(RgInstance instance)
         r = rgUploadDecal(instance, &decalInfo);
         RG_CHECK(r);
 
+        // 10k small decals on a 50x50 grid around the origin, most of them are out of view
+        if (ctl_DecalBenchmark)
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                for (int j = 0; j < 100; j++)
+                {
+                    RgDecalUploadInfo benchDecal =
+                    {
+                        .transform = {
+                            0.3f, 0, 0, -25.0f + 0.5f * float(i),
+                            0, 0.3f, 0, 0,
+                            0, 0, 0.3f, -25.0f + 0.5f * float(j)
+                        },
+                        .material = RG_NO_MATERIAL
+                    };
+                    r = rgUploadDecal(instance, &benchDecal);
+                    RG_CHECK(r);
+                }
+            }
+        }
+
 
         // upload sun
         RgDirectionalLightUploadInfo dirLight = 
@@ -528,7 +678,8 @@ int main()
         .rasterizedSkyMaxIndexCount         = 2048,
         .rasterizedSkyCubemapSize           = 256,
 
-        .maxTextureCount                    = 1024,
+        // enough for the material benchmark
+        .maxTextureCount                    = 4096,
         .overridenAlbedoAlphaTextureIsSRGB  = true,
         .pWaterNormalTexturePath            = ASSET_DIRECTORY"WaterNormal_n.ktx2",
 
@@ -536,6 +687,9 @@ int main()
         .vertexNormalStride                 = 3 * sizeof(float),
         .vertexTexCoordStride               = 2 * sizeof(float),
         .vertexColorStride                  = sizeof(uint32_t),
+
+        // set to true, to compare with the raster path on the decal benchmark
+        .decalsTiled                        = false,
     };
 
     r = rgCreateInstance(&info, &instance);
@@ -0,0 +1,126 @@
+// Benchmark of material handle allocation: the generational slot map
+// against the previous scheme, where a material ID was the sum of its texture
+// indices, and a free ID was found by linear probing of a hash map.
+// Doesn't require a Vulkan device, only the headers.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../Source/Containers.h"
+#include "../Source/SlotMap.h"
+
+using namespace RTGL1;
+
+constexpr uint32_t MATERIAL_COUNT = 50000;
+
+struct Material
+{
+    uint32_t    textures[3];
+};
+
+// The allocator before the slot map.
+class ProbingAllocator
+{
+public:
+    uint32_t Insert(const Material &m)
+    {
+        uint32_t id = m.textures[0] + m.textures[1] + m.textures[2];
+
+        while (materials.find(id) != materials.end())
+        {
+            id++;
+        }
+
+        materials[id] = m;
+        return id;
+    }
+
+    bool Erase(uint32_t id)
+    {
+        return materials.erase(id) > 0;
+    }
+
+private:
+    rgl::unordered_map<uint32_t, Material> materials;
+};
+
+class SlotMapAllocator
+{
+public:
+    uint32_t Insert(const Material &m)
+    {
+        return materials.Insert(m);
+    }
+
+    bool Erase(uint32_t id)
+    {
+        return materials.Erase(id);
+    }
+
+private:
+    SlotMap<Material> materials;
+};
+
+// If 'isClustered', materials share a few textures, so the sums of their texture indices
+// are the same, as with texture deduplication or materials that differ only in a sampler.
+static std::vector<Material> MakeMaterials(bool isClustered)
+{
+    std::vector<Material> ms(MATERIAL_COUNT);
+
+    for (uint32_t i = 0; i < MATERIAL_COUNT; i++)
+    {
+        uint32_t t = isClustered ? 1 + i % 16 : 1 + i * 3;
+        ms[i] = { { t, t + 1, t + 2 } };
+    }
+
+    return ms;
+}
+
+// Create all materials, then destroy them in random order.
+template <typename Allocator>
+static double Run(const std::vector<Material> &ms, uint32_t iterationCount)
+{
+    std::mt19937 rnd(1234);
+    std::vector<uint32_t> ids(ms.size());
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t iter = 0; iter < iterationCount; iter++)
+    {
+        Allocator a;
+
+        for (size_t i = 0; i < ms.size(); i++)
+        {
+            ids[i] = a.Insert(ms[i]);
+        }
+
+        std::shuffle(ids.begin(), ids.end(), rnd);
+
+        for (uint32_t id : ids)
+        {
+            bool erased = a.Erase(id);
+            (void)erased;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterationCount;
+}
+
+int main()
+{
+    const std::vector<Material> distinct = MakeMaterials(false);
+    const std::vector<Material> clustered = MakeMaterials(true);
+
+    std::printf("Create and destroy %u materials:\n", MATERIAL_COUNT);
+    std::printf("  slot map,          distinct textures:  %10.2f ms\n", Run<SlotMapAllocator>(distinct, 16));
+    std::printf("  slot map,          shared textures:    %10.2f ms\n", Run<SlotMapAllocator>(clustered, 16));
+    std::printf("  probing allocator, distinct textures:  %10.2f ms\n", Run<ProbingAllocator>(distinct, 16));
+    // quadratic, so only one run
+    std::printf("  probing allocator, shared textures:    %10.2f ms\n", Run<ProbingAllocator>(clustered, 1));
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+# Copyright (c) 2022 Sultim Tsyrendashiev
+# 
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+# 
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+# 
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+import sys
+import os
+import struct
+
+DEFAULT_INPUT_FOLDER_NAME = "Compressed"
+DEFAULT_OUTPUT_FILE_NAME = "OverridenTextures.rgpack"
+
+INPUT_EXTENSIONS = [".ktx2"]
+
+# must be the same as in TexturePack.h
+PACK_MAGIC = 0x4B505452
+PACK_VERSION = 2
+PACK_ALIGNMENT = 4096
+
+HEADER_FORMAT = "<IIIIQQ"
+ENTRY_FORMAT = "<QQQQII"
+
+
+def toKey(path):
+    # only ASCII letters are lowercased, byte by byte, as in TexturePack.cpp;
+    # str.lower() would also fold non-ASCII letters, producing other bytes
+    return bytes(b + 32 if 65 <= b <= 90 else b for b in path.encode("utf-8"))
+
+
+def hashKey(key):
+    # 64-bit FNV-1a
+    h = 14695981039346656037
+    for b in key:
+        h ^= b
+        h = (h * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def alignUp(x, alignment):
+    return (x + alignment - 1) // alignment * alignment
+
+
+def main():
+    if "--help" in sys.argv or "--h" in sys.argv or "-help" in sys.argv or "-h" in sys.argv:
+        print("Usage: CreateTexturePack.py [input folder] [output file]")
+        print("")
+        print("  CreateTexturePack packs all KTX2 files from input folder")
+        print("  (default: \"" + DEFAULT_INPUT_FOLDER_NAME + "\") into a single file")
+        print("  (default: \"" + DEFAULT_OUTPUT_FILE_NAME + "\").")
+        print("")
+        print("  Files are identified by their paths relative to the input folder,")
+        print("  so the input folder should be the one that is specified")
+        print("  in RgInstanceCreateInfo::pOverridenTexturesFolderPath.")
+        print("  Set RgInstanceCreateInfo::pOverridenTexturesPackPath to the output file.")
+        return
+
+    inputFolder = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_INPUT_FOLDER_NAME
+    outputFile = sys.argv[2] if len(sys.argv) > 2 else DEFAULT_OUTPUT_FILE_NAME
+
+    if not os.path.isdir(inputFolder):
+        print("> Input folder doesn't exist: " + inputFolder)
+        return
+
+    files = {}
+
+    for currentPath, folders, fileNames in os.walk(inputFolder):
+        for fileName in fileNames:
+            if os.path.splitext(fileName)[1].lower() not in INPUT_EXTENSIONS:
+                continue
+
+            fullPath = os.path.join(currentPath, fileName)
+            relativePath = os.path.relpath(fullPath, inputFolder).replace("\\", "/")
+
+            key = toKey(relativePath)
+
+            if key in files:
+                print("> Same path with different case, skipping: " + relativePath + " and " + files[key][0])
+                continue
+
+            files[key] = (relativePath, fullPath)
+
+    # paths with the same hash are adjacent, and all of them are checked on lookup
+    entries = sorted(files.items(), key=lambda item: (hashKey(item[0]), item[0]))
+
+    entriesOffset = struct.calcsize(HEADER_FORMAT)
+    pathsOffset = entriesOffset + len(entries) * struct.calcsize(ENTRY_FORMAT)
+    pathsSize = sum(len(key) for key, _ in entries)
+    offset = alignUp(pathsOffset + pathsSize, PACK_ALIGNMENT)
+
+    layout = []
+    pathOffset = pathsOffset
+    for key, (relativePath, fullPath) in entries:
+        size = os.path.getsize(fullPath)
+        layout.append((hashKey(key), offset, size, pathOffset, key, fullPath))
+        offset = alignUp(offset + size, PACK_ALIGNMENT)
+        pathOffset += len(key)
+
+    with open(outputFile, "wb") as pack:
+        pack.write(struct.pack(HEADER_FORMAT, PACK_MAGIC, PACK_VERSION, len(layout), 0, entriesOffset, 0))
+
+        for h, fileOffset, size, pathOffset, key, fullPath in layout:
+            pack.write(struct.pack(ENTRY_FORMAT, h, fileOffset, size, pathOffset, len(key), 0))
+
+        for h, fileOffset, size, pathOffset, key, fullPath in layout:
+            pack.write(key)
+
+        for h, fileOffset, size, pathOffset, key, fullPath in layout:
+            pack.write(b"\0" * (fileOffset - pack.tell()))
+
+            with open(fullPath, "rb") as f:
+                pack.write(f.read())
+
+    print("> Packed " + str(len(layout)) + " files to " + outputFile)
+
+
+if __name__ == '__main__':
+    main()